@@ -20,23 +20,52 @@
 
 #include <unity/util/DefinesPtrs.h>
 
+#include <QList>
 #include <QMap>
 #include <QString>
 
+#include <functional>
+
 namespace agent {
 
+/**
+ * Stores connection secrets on behalf of the secret agent.
+ *
+ * None of the methods wait for the store. save() and clear() return
+ * straight away, and get() reports back through one of its callbacks,
+ * which may happen before it returns if the secrets are at hand.
+ */
 class CredentialStore {
 public:
 	UNITY_DEFINES_PTRS(CredentialStore);
 
+	struct Secret {
+		QString settingName;
+
+		QString settingKey;
+
+		QString displayName;
+
+		QString secret;
+	};
+
+	typedef QList<Secret> Secrets;
+
+	typedef std::function<void(const QMap<QString, QString>& secrets)> GetCallback;
+
+	typedef std::function<void(const QString& message)> ErrorCallback;
+
 	CredentialStore();
 
 	virtual ~CredentialStore();
 
-	virtual void save(const QString& uuid, const QString& settingName, const QString& settingKey,
-			const QString& displayName, const QString& secret) = 0;
+	/**
+	 * Saves all the given secrets of one connection.
+	 */
+	virtual void save(const QString& uuid, const Secrets& secrets) = 0;
 
-	virtual QMap<QString, QString> get(const QString& uuid, const QString& settingName) = 0;
+	virtual void get(const QString& uuid, const QString& settingName,
+			GetCallback callback, ErrorCallback error) = 0;
 
 	virtual void clear(const QString& uuid) = 0;
 };
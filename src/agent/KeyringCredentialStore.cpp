@@ -17,6 +17,7 @@
  */
 
 #include <agent/KeyringCredentialStore.h>
+#include <agent/LockedSecretCache.h>
 
 #include <libsecret/secret.h>
 #include <QDebug>
@@ -50,105 +51,215 @@ using namespace std;
 
 namespace agent {
 
-KeyringCredentialStore::KeyringCredentialStore() {
-}
+namespace {
 
-KeyringCredentialStore::~KeyringCredentialStore() {
+QString takeErrorMessage(GError* error) {
+	QString message;
+	if (error != NULL) {
+		if (error->message) {
+			message = QString::fromUtf8(error->message);
+		}
+		g_error_free(error);
+	}
+	return message;
 }
 
-void KeyringCredentialStore::save(const QString& uuid,
-		const QString& settingName, const QString& settingKey,
-		const QString& displayName, const QString& secret) {
-	shared_ptr<GHashTable> attrs(
-			secret_attributes_build(&network_manager_secret_schema,
-			KEYRING_UUID_TAG, uuid.toUtf8().constData(),
-			KEYRING_SN_TAG, settingName.toUtf8().constData(),
-			KEYRING_SK_TAG, settingKey.toUtf8().constData(),
-			NULL), &g_hash_table_unref);
-
+void logFinished(gboolean (*finish)(GAsyncResult*, GError**), GAsyncResult* result) {
 	GError* error = NULL;
-	if (!secret_password_storev_sync(&network_manager_secret_schema,
-			attrs.get(),
-			NULL,
-			displayName.toUtf8().constData(),
-			secret.toUtf8().constData(),
-			NULL, &error)) {
-		QString message;
-		if (error != NULL) {
-			if (error->message) {
-				message = QString::fromUtf8(error->message);
-			}
+	if (!finish(result, &error)) {
+		if (error != NULL && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
 			g_error_free(error);
+			return;
+		}
+		QString message(takeErrorMessage(error));
+		if (!message.isEmpty()) {
+			qCritical() << message;
 		}
-		qCritical() << message;
 	}
 }
 
-QMap<QString, QString> KeyringCredentialStore::get(const QString& uuid, const QString& settingName) {
-	QMap<QString, QString> result;
+}
 
-	shared_ptr<GHashTable> attrs(secret_attributes_build(
-					&network_manager_secret_schema,
-					KEYRING_UUID_TAG, uuid.toUtf8().constData(),
-					KEYRING_SN_TAG, settingName.toUtf8().constData(),
-					NULL), &g_hash_table_unref);
+class KeyringCredentialStore::Priv {
+public:
+	struct SearchRequest {
+		weak_ptr<Priv> priv;
 
-	GError* error = NULL;
-	shared_ptr<GList> list(secret_service_search_sync(NULL,
-			&network_manager_secret_schema, attrs.get(),
-			(SecretSearchFlags) (SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK
-					| SECRET_SEARCH_LOAD_SECRETS), NULL, &error), [](GList* list) {
-		g_list_free_full (list, g_object_unref);
-	});
-
-	if (list == NULL) {
-		if (error != NULL) {
-			string errorMessage;
-			if (error->message) {
-				errorMessage = error->message;
-			}
-			g_error_free(error);
-			throw domain_error(errorMessage);
-		}
+		QString uuid;
 
-		return result;
+		QString settingName;
+
+		quint64 generation;
+
+		GetCallback callback;
+
+		ErrorCallback error;
+	};
+
+	Priv() :
+			m_cancellable(g_cancellable_new(), &g_object_unref) {
 	}
 
-	for (GList* iter = list.get(); iter != NULL; iter = g_list_next(iter)) {
-		SecretItem *item = (SecretItem *) iter->data;
-		shared_ptr<SecretValue> secret(secret_item_get_secret(item), &secret_value_unref);
-		if (secret) {
-			shared_ptr<GHashTable> attributes(secret_item_get_attributes(item), &g_hash_table_unref);
-			const char *keyName = (const char *) g_hash_table_lookup(attributes.get(),
-					KEYRING_SK_TAG);
-			if (!keyName) {
-				continue;
-			}
+	~Priv() {
+		// Outstanding calls still finish, but find us gone
+		g_cancellable_cancel(m_cancellable.get());
+	}
 
-			QString keyString = QString::fromUtf8(keyName);
-			QString secretString = QString::fromUtf8(secret_value_get(secret.get(), NULL));
+	// Anything that changes the keyring makes searches already under way
+	// too old to cache. Searches can be answered before a write lands, so
+	// that goes for its start and its finish both.
+	void invalidate() {
+		++m_generation;
+	}
 
-			result[keyString] = secretString;
+	void writeStarted() {
+		invalidate();
+		++m_writesPending;
+	}
+
+	static void writeFinished(gpointer userData) {
+		unique_ptr<weak_ptr<Priv>> request(static_cast<weak_ptr<Priv>*>(userData));
+		auto priv = request->lock();
+		if (priv) {
+			priv->invalidate();
+			--priv->m_writesPending;
 		}
 	}
 
-	return result;
-}
+	static void searchFinished(GObject*, GAsyncResult* result, gpointer userData) {
+		unique_ptr<SearchRequest> request(static_cast<SearchRequest*>(userData));
 
-void KeyringCredentialStore::clear(const QString& uuid) {
-	GError *error = NULL;
-	if (!secret_password_clear_sync(&network_manager_secret_schema, NULL, &error,
-						   KEYRING_UUID_TAG, uuid.toUtf8().constData(),
-						   NULL)) {
-		if (error != NULL) {
-			QString message;
-			if (error->message) {
-				message = QString::fromUtf8(error->message);
+		GError* error = NULL;
+		shared_ptr<GList> list(secret_service_search_finish(NULL, result, &error), [](GList* list) {
+			g_list_free_full (list, g_object_unref);
+		});
+
+		auto priv = request->priv.lock();
+		if (!priv) {
+			if (error != NULL) {
+				g_error_free(error);
 			}
-			g_error_free(error);
-			qCritical() << message;
+			return;
+		}
+
+		if (list == NULL && error != NULL) {
+			request->error(takeErrorMessage(error));
+			return;
+		}
+
+		QMap<QString, QString> secrets;
+		for (GList* iter = list.get(); iter != NULL; iter = g_list_next(iter)) {
+			SecretItem *item = (SecretItem *) iter->data;
+			shared_ptr<SecretValue> secret(secret_item_get_secret(item), &secret_value_unref);
+			if (secret) {
+				shared_ptr<GHashTable> attributes(secret_item_get_attributes(item), &g_hash_table_unref);
+				const char *keyName = (const char *) g_hash_table_lookup(attributes.get(),
+						KEYRING_SK_TAG);
+				if (!keyName) {
+					continue;
+				}
+
+				QString keyString = QString::fromUtf8(keyName);
+				QString secretString = QString::fromUtf8(secret_value_get(secret.get(), NULL));
+
+				secrets[keyString] = secretString;
+			}
+		}
+
+		if (!secrets.isEmpty() && request->generation == priv->m_generation
+				&& priv->m_writesPending == 0) {
+			priv->m_cache.insert(request->uuid, request->settingName, secrets);
 		}
+
+		request->callback(secrets);
+	}
+
+	static void storeFinished(GObject*, GAsyncResult* result, gpointer userData) {
+		logFinished(&secret_password_store_finish, result);
+		writeFinished(userData);
 	}
+
+	static void clearFinished(GObject*, GAsyncResult* result, gpointer userData) {
+		logFinished(&secret_password_clear_finish, result);
+		writeFinished(userData);
+	}
+
+	shared_ptr<GCancellable> m_cancellable;
+
+	LockedSecretCache m_cache;
+
+	quint64 m_generation = 0;
+
+	// Keyring writes issued that have not finished yet
+	quint64 m_writesPending = 0;
+};
+
+KeyringCredentialStore::KeyringCredentialStore() :
+		d(new Priv) {
+}
+
+KeyringCredentialStore::~KeyringCredentialStore() {
+}
+
+void KeyringCredentialStore::save(const QString& uuid, const Secrets& secrets) {
+	// Anything the cache knows to be in the keyring already needs no write
+	auto changed = d->m_cache.changed(uuid, secrets);
+	if (changed.isEmpty()) {
+		return;
+	}
+
+	// The writes are all issued before any of them finishes
+	for (const auto& secret: changed) {
+		d->writeStarted();
+		d->m_cache.remove(uuid, secret.settingName);
+
+		shared_ptr<GHashTable> attrs(
+				secret_attributes_build(&network_manager_secret_schema,
+				KEYRING_UUID_TAG, uuid.toUtf8().constData(),
+				KEYRING_SN_TAG, secret.settingName.toUtf8().constData(),
+				KEYRING_SK_TAG, secret.settingKey.toUtf8().constData(),
+				NULL), &g_hash_table_unref);
+
+		secret_password_storev(&network_manager_secret_schema,
+				attrs.get(),
+				NULL,
+				secret.displayName.toUtf8().constData(),
+				secret.secret.toUtf8().constData(),
+				d->m_cancellable.get(), &Priv::storeFinished,
+				new weak_ptr<Priv>(d));
+	}
+}
+
+void KeyringCredentialStore::get(const QString& uuid, const QString& settingName,
+		GetCallback callback, ErrorCallback error) {
+	QMap<QString, QString> secrets;
+	if (d->m_cache.find(uuid, settingName, secrets)) {
+		callback(secrets);
+		return;
+	}
+
+	shared_ptr<GHashTable> attrs(secret_attributes_build(
+					&network_manager_secret_schema,
+					KEYRING_UUID_TAG, uuid.toUtf8().constData(),
+					KEYRING_SN_TAG, settingName.toUtf8().constData(),
+					NULL), &g_hash_table_unref);
+
+	secret_service_search(NULL,
+			&network_manager_secret_schema, attrs.get(),
+			(SecretSearchFlags) (SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK
+					| SECRET_SEARCH_LOAD_SECRETS), d->m_cancellable.get(),
+			&Priv::searchFinished,
+			new Priv::SearchRequest{d, uuid, settingName, d->m_generation, callback, error});
+}
+
+void KeyringCredentialStore::clear(const QString& uuid) {
+	d->writeStarted();
+	d->m_cache.remove(uuid);
+
+	secret_password_clear(&network_manager_secret_schema, d->m_cancellable.get(),
+			&Priv::clearFinished, new weak_ptr<Priv>(d),
+			KEYRING_UUID_TAG, uuid.toUtf8().constData(),
+			NULL);
 }
 
 }
@@ -20,25 +20,37 @@
 
 #include <agent/CredentialStore.h>
 
-#include <QList>
-#include <QPair>
 #include <QString>
 
+#include <memory>
+
 namespace agent {
 
+/**
+ * Keeps secrets in the user's keyring using libsecret's asynchronous calls,
+ * so a keyring that has to be unlocked first doesn't hold up the agent.
+ *
+ * Secrets read from the keyring are remembered in a LockedSecretCache, so
+ * reconnecting to a known network doesn't need the keyring at all. Saving
+ * skips secrets the cache shows to be unchanged and drops the entries of
+ * the settings it does write; clearing drops the connection's entries.
+ */
 class KeyringCredentialStore: public CredentialStore {
 public:
 	KeyringCredentialStore();
 
 	~KeyringCredentialStore();
 
-	void save(const QString& uuid, const QString& settingName,
-			const QString& settingKey, const QString& displayName,
-			const QString& secret) override;
+	void save(const QString& uuid, const Secrets& secrets) override;
 
-	QMap<QString, QString> get(const QString& uuid, const QString& settingName) override;
+	void get(const QString& uuid, const QString& settingName,
+			GetCallback callback, ErrorCallback error) override;
 
 	void clear(const QString& uuid) override;
+
+protected:
+	class Priv;
+	std::shared_ptr<Priv> d;
 };
 
 }
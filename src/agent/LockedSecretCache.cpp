@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <agent/LockedSecretCache.h>
+
+#include <QByteArray>
+#include <QDebug>
+
+#include <cstring>
+
+#include <sys/mman.h>
+
+using namespace std;
+
+namespace agent {
+
+namespace {
+
+// A plain memset of memory that is about to be released can be optimised away
+void secureZero(void* data, size_t size) {
+	volatile char* p = static_cast<volatile char*>(data);
+	while (size--) {
+		*p++ = 0;
+	}
+}
+
+// Each secret is stored as its key and its value, both UTF-8 and prefixed
+// with their length
+bool append(char* entry, size_t& size, const QString& string) {
+	QByteArray bytes(string.toUtf8());
+	quint32 length = bytes.size();
+	bool fits = size + sizeof(length) + length <= LockedSecretCache::ENTRY_SIZE;
+	if (fits) {
+		memcpy(entry + size, &length, sizeof(length));
+		memcpy(entry + size + sizeof(length), bytes.constData(), length);
+		size += sizeof(length) + length;
+	}
+	secureZero(bytes.data(), bytes.size());
+	return fits;
+}
+
+QString read(const char* entry, size_t& offset) {
+	quint32 length;
+	memcpy(&length, entry + offset, sizeof(length));
+	QString string(QString::fromUtf8(entry + offset + sizeof(length), length));
+	offset += sizeof(length) + length;
+	return string;
+}
+
+}
+
+LockedSecretCache::LockedSecretCache(size_t entries) :
+		m_size(entries * ENTRY_SIZE) {
+	void* memory = mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) {
+		qWarning() << "Unable to allocate secret cache, not caching secrets";
+		return;
+	}
+
+	if (mlock(memory, m_size) != 0) {
+		qWarning() << "Unable to lock secret cache into memory, not caching secrets";
+		munmap(memory, m_size);
+		return;
+	}
+	madvise(memory, m_size, MADV_DONTDUMP);
+
+	m_memory = static_cast<char*>(memory);
+	m_entries.resize(entries);
+}
+
+LockedSecretCache::~LockedSecretCache() {
+	if (m_memory) {
+		secureZero(m_memory, m_size);
+		munlock(m_memory, m_size);
+		munmap(m_memory, m_size);
+	}
+}
+
+bool LockedSecretCache::isEnabled() const {
+	return m_memory;
+}
+
+char* LockedSecretCache::payload(int index) const {
+	return m_memory + index * ENTRY_SIZE;
+}
+
+void LockedSecretCache::wipe(int index) {
+	auto& entry = m_entries[index];
+	secureZero(payload(index), entry.size);
+	entry = Entry();
+}
+
+bool LockedSecretCache::find(const QString& uuid, const QString& settingName,
+		QMap<QString, QString>& secrets) {
+	for (int i = 0; i < m_entries.size(); ++i) {
+		auto& entry = m_entries[i];
+		if (!entry.used || entry.uuid != uuid || entry.settingName != settingName) {
+			continue;
+		}
+
+		secrets.clear();
+		size_t offset = 0;
+		while (offset < entry.size) {
+			QString key(read(payload(i), offset));
+			secrets[key] = read(payload(i), offset);
+		}
+		entry.lastUsed = ++m_clock;
+		return true;
+	}
+	return false;
+}
+
+void LockedSecretCache::insert(const QString& uuid, const QString& settingName,
+		const QMap<QString, QString>& secrets) {
+	if (!m_memory) {
+		return;
+	}
+
+	remove(uuid, settingName);
+
+	// Take a free entry, or else the least recently used one
+	int index = 0;
+	for (int i = 0; i < m_entries.size(); ++i) {
+		if (!m_entries[i].used) {
+			index = i;
+			break;
+		}
+		if (m_entries[i].lastUsed < m_entries[index].lastUsed) {
+			index = i;
+		}
+	}
+	wipe(index);
+
+	auto& entry = m_entries[index];
+	QMapIterator<QString, QString> it(secrets);
+	while (it.hasNext()) {
+		it.next();
+		if (!append(payload(index), entry.size, it.key())
+				|| !append(payload(index), entry.size, it.value())) {
+			wipe(index);
+			return;
+		}
+	}
+
+	entry.uuid = uuid;
+	entry.settingName = settingName;
+	entry.lastUsed = ++m_clock;
+	entry.used = true;
+}
+
+CredentialStore::Secrets LockedSecretCache::changed(const QString& uuid,
+		const CredentialStore::Secrets& secrets) {
+	QMap<QString, QMap<QString, QString>> cached;
+	CredentialStore::Secrets result;
+	for (const auto& secret: secrets) {
+		if (!cached.contains(secret.settingName)) {
+			find(uuid, secret.settingName, cached[secret.settingName]);
+		}
+		const auto& known = cached[secret.settingName];
+		auto it = known.constFind(secret.settingKey);
+		if (it == known.constEnd() || *it != secret.secret) {
+			result << secret;
+		}
+	}
+	return result;
+}
+
+void LockedSecretCache::remove(const QString& uuid, const QString& settingName) {
+	for (int i = 0; i < m_entries.size(); ++i) {
+		const auto& entry = m_entries[i];
+		if (entry.used && entry.uuid == uuid && entry.settingName == settingName) {
+			wipe(i);
+		}
+	}
+}
+
+void LockedSecretCache::remove(const QString& uuid) {
+	for (int i = 0; i < m_entries.size(); ++i) {
+		const auto& entry = m_entries[i];
+		if (entry.used && entry.uuid == uuid) {
+			wipe(i);
+		}
+	}
+}
+
+void LockedSecretCache::clear() {
+	for (int i = 0; i < m_entries.size(); ++i) {
+		wipe(i);
+	}
+}
+
+}
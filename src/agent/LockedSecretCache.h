@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <agent/CredentialStore.h>
+#include <unity/util/DefinesPtrs.h>
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include <cstddef>
+
+namespace agent {
+
+/**
+ * A small cache of the secrets of recently used connection settings.
+ *
+ * The secrets live in memory that is locked into RAM, so they are never
+ * written to swap, and that is left out of core dumps. Each entry holds
+ * all the secrets of one setting of one connection. When the cache is full
+ * the least recently used entry makes way, and secrets are wiped as soon
+ * as they leave the cache.
+ *
+ * If the memory can't be locked, nothing is cached.
+ */
+class LockedSecretCache {
+public:
+	UNITY_DEFINES_PTRS(LockedSecretCache);
+
+	static constexpr std::size_t DEFAULT_ENTRIES = 16;
+
+	// Room for the secrets of one setting, which are a handful of short
+	// passwords and PINs
+	static constexpr std::size_t ENTRY_SIZE = 2048;
+
+	explicit LockedSecretCache(std::size_t entries = DEFAULT_ENTRIES);
+
+	~LockedSecretCache();
+
+	LockedSecretCache(const LockedSecretCache&) = delete;
+
+	LockedSecretCache& operator=(const LockedSecretCache&) = delete;
+
+	bool isEnabled() const;
+
+	bool find(const QString& uuid, const QString& settingName,
+			QMap<QString, QString>& secrets);
+
+	/**
+	 * Secrets that don't fit in an entry are not cached.
+	 */
+	void insert(const QString& uuid, const QString& settingName,
+			const QMap<QString, QString>& secrets);
+
+	/**
+	 * The secrets of one connection that the cache doesn't hold already,
+	 * with the same value.
+	 */
+	CredentialStore::Secrets changed(const QString& uuid,
+			const CredentialStore::Secrets& secrets);
+
+	void remove(const QString& uuid, const QString& settingName);
+
+	void remove(const QString& uuid);
+
+	void clear();
+
+protected:
+	struct Entry {
+		QString uuid;
+
+		QString settingName;
+
+		quint64 lastUsed = 0;
+
+		std::size_t size = 0;
+
+		bool used = false;
+	};
+
+	char* payload(int index) const;
+
+	void wipe(int index);
+
+	char* m_memory = nullptr;
+
+	std::size_t m_size = 0;
+
+	QVector<Entry> m_entries;
+
+	quint64 m_clock = 0;
+};
+
+}
@@ -19,6 +19,7 @@
 #include <agent/SecretAgent.h>
 #include <agent/SecretRequest.h>
 #include <AgentManagerInterface.h>
+#include <backend-utils.h>
 #include <notify-cpp/notification-manager.h>
 #include <SecretAgentAdaptor.h>
 
@@ -37,24 +38,25 @@ using namespace std;
 namespace agent
 {
 
-class SecretAgent::Priv : public QObject {
+class SecretAgent::Priv : public QObject, public enable_shared_from_this<SecretAgent::Priv> {
 	Q_OBJECT
 
 public:
-	Priv(notify::NotificationManager::SPtr notificationManager,
+	Priv(SecretAgent& parent,
+			notify::NotificationManager::SPtr notificationManager,
 			agent::CredentialStore::SPtr credentialStore,
 			const QDBusConnection &systemConnection,
 			const QDBusConnection &sessionConnection) :
+			p(parent),
 			m_systemConnection(systemConnection),
 			m_sessionConnection(sessionConnection),
 			m_managerWatcher(NM_DBUS_SERVICE, m_systemConnection),
 			m_agentManager(NM_DBUS_SERVICE, NM_DBUS_PATH_AGENT_MANAGER, m_systemConnection),
 			m_notifications(notificationManager),
-			m_credentialStore(credentialStore),
-			m_request(nullptr) {
+			m_credentialStore(credentialStore) {
 	}
 
-	void saveSecret(const QString& id, const QString& uuid,
+	static void addSecret(CredentialStore::Secrets& secrets, const QString& id,
 			const QString& settingName, const QString& settingKey,
 			const QString& secret, const QString& inputDisplayName =
 					QString()) {
@@ -67,7 +69,7 @@ public:
 			displayName = DISPLAY_NAME.arg(id, settingName, settingKey);
 		}
 
-		m_credentialStore->save(uuid, settingName, settingKey, displayName, secret);
+		secrets << CredentialStore::Secret{settingName, settingKey, displayName, secret};
 	}
 
 	static bool isSecret(const QString& settingName, const QString& key) {
@@ -91,35 +93,221 @@ public:
 		return false;
 	}
 
-	void saveSettings(const QString& id, const QString& uuid,
+	static void addSettings(CredentialStore::Secrets& secrets, const QString& id,
 			const QString& settingName, const QVariantMap& setting) {
 
 		QMapIterator<QString, QVariant> iter(setting);
 		while (iter.hasNext()) {
 			iter.next();
 			if (isSecret(settingName, iter.key())) {
-				saveSecret(id, uuid, settingName, iter.key(),
+				addSecret(secrets, id, settingName, iter.key(),
 						iter.value().toString());
 			}
 		}
 	}
 
-	void saveVpnSettings(const QString& id, const QString& uuid,
+	static void addVpnSettings(CredentialStore::Secrets& secrets, const QString& id,
 			const QString& settingName, const QVariantMap& setting) {
 		static const QString DISPLAY_NAME{"VPN %1 secret for %2/%3/%4"};
 
 		QString serviceType = setting[NM_VPN_SERVICE_TYPE].toString();
-		QStringMap secrets;
+		QStringMap vpnSecrets;
 		auto dbusArgument = qvariant_cast<QDBusArgument>(setting[NM_VPN_SECRETS]);
-		dbusArgument >> secrets;
-		QMapIterator<QString, QString> iter(secrets);
+		dbusArgument >> vpnSecrets;
+		QMapIterator<QString, QString> iter(vpnSecrets);
 		while(iter.hasNext()) {
 			iter.next();
-			saveSecret(id, uuid, settingName, iter.key(), iter.value(),
+			addSecret(secrets, id, settingName, iter.key(), iter.value(),
 					DISPLAY_NAME.arg(iter.key(), id, serviceType, NM_VPN_SETTING_NAME));
 		}
 	}
 
+	// Connection path and setting name
+	typedef QPair<QString, QString> RequestKey;
+
+	/**
+	 * A GetSecrets call being answered, along with any identical calls that
+	 * arrived while it was, which all get the same answer.
+	 */
+	struct PendingRequest {
+		typedef std::shared_ptr<PendingRequest> SPtr;
+
+		QList<QDBusMessage> messages;
+
+		QVariantDictMap connection;
+
+		QStringList hints;
+
+		uint flags = 0;
+
+		// Only set for an interactive request while its prompt is showing
+		std::shared_ptr<SecretRequest> prompt;
+	};
+
+	static RequestKey requestKey(const QDBusObjectPath& connectionPath,
+			const QString& settingName) {
+		return RequestKey(connectionPath.path(), settingName);
+	}
+
+	void replyError(const QList<QDBusMessage>& messages, const QString& name,
+			const QString& message) {
+		for (const auto& request: messages) {
+			m_systemConnection.send(request.createErrorReply(name, message));
+		}
+	}
+
+	/**
+	 * Keyring lookups don't need the user, so any number can be under way
+	 * at once.
+	 */
+	void lookUp(const RequestKey& key, const QString& uuid, const QDBusMessage& message) {
+		auto existing = m_lookups.value(key);
+		if (existing) {
+			existing->messages << message;
+			return;
+		}
+
+		auto request = make_shared<PendingRequest>();
+		request->messages << message;
+		m_lookups[key] = request;
+
+		// A cancelled lookup has gone from m_lookups by the time the store
+		// gets back to us, and nobody is left to answer
+		weak_ptr<Priv> weakPriv(shared_from_this());
+		weak_ptr<PendingRequest> weakRequest(request);
+		m_credentialStore->get(uuid, key.second,
+				[weakPriv, weakRequest, key](const QStringMap& secrets) {
+					auto priv = weakPriv.lock();
+					auto request = weakRequest.lock();
+					if (priv && request) {
+						priv->m_lookups.remove(key);
+						for (const auto& message: request->messages) {
+							priv->sendSecrets(message, key.second, secrets);
+						}
+					}
+				},
+				[weakPriv, weakRequest, key](const QString& error) {
+					auto priv = weakPriv.lock();
+					auto request = weakRequest.lock();
+					if (priv && request) {
+						priv->m_lookups.remove(key);
+						priv->replyError(request->messages,
+								"org.freedesktop.NetworkManager.SecretAgent.InternalError",
+								error);
+					}
+				});
+	}
+
+	/**
+	 * Only one snap decision can sensibly be on screen, so interactive
+	 * requests take turns in the order they arrived.
+	 */
+	void prompt(const RequestKey& key, const QVariantDictMap& connection,
+			const QStringList& hints, uint flags, const QDBusMessage& message) {
+		auto existing = m_prompts.value(key);
+		if (existing) {
+			existing->messages << message;
+			return;
+		}
+
+		auto request = make_shared<PendingRequest>();
+		request->messages << message;
+		request->connection = connection;
+		request->hints = hints;
+		request->flags = flags;
+		m_prompts[key] = request;
+		m_promptQueue << key;
+
+		showNextPrompt();
+	}
+
+	void showNextPrompt() {
+		if (m_promptQueue.isEmpty()) {
+			return;
+		}
+
+		const auto& key = m_promptQueue.first();
+		auto request = m_prompts.value(key);
+		if (request->prompt) {
+			return;
+		}
+
+		request->prompt = make_shared<SecretRequest>(p, request->connection,
+				QDBusObjectPath(key.first), key.second, request->hints,
+				request->flags, request->messages.first());
+	}
+
+	void finishPrompt(SecretRequest& secretRequest, bool error) {
+		auto key = requestKey(secretRequest.connectionPath(), secretRequest.settingName());
+		auto request = m_prompts.value(key);
+		if (!request || request->prompt.get() != &secretRequest) {
+			return;
+		}
+
+		if (error) {
+			replyError(request->messages,
+					"org.freedesktop.NetworkManager.SecretAgent.NoSecrets",
+					"No secrets found for this connection.");
+		} else {
+			for (const auto& message: request->messages) {
+				m_systemConnection.send(
+						message.createReply(
+								QVariant::fromValue(secretRequest.connection())));
+			}
+		}
+
+		m_prompts.remove(key);
+		m_promptQueue.removeOne(key);
+		showNextPrompt();
+	}
+
+	void cancel(const RequestKey& key) {
+		auto lookup = m_lookups.take(key);
+		if (lookup) {
+			replyError(lookup->messages,
+					"org.freedesktop.NetworkManager.SecretAgent.AgentCanceled",
+					"Secret request cancelled.");
+		}
+
+		auto prompt = m_prompts.take(key);
+		if (prompt) {
+			// Dropping a prompt closes its notification
+			prompt->prompt.reset();
+			m_promptQueue.removeOne(key);
+			replyError(prompt->messages,
+					"org.freedesktop.NetworkManager.SecretAgent.AgentCanceled",
+					"Secret request cancelled.");
+			showNextPrompt();
+		}
+	}
+
+	void sendSecrets(const QDBusMessage& request, const QString& settingName,
+			const QStringMap& secrets) {
+		if (secrets.isEmpty()) {
+			m_systemConnection.send(
+					request.createErrorReply(
+							"org.freedesktop.NetworkManager.SecretAgent.NoSecrets",
+							"No secrets found for this connection."));
+			return;
+		}
+
+		QVariantDictMap newConnection;
+
+		if (settingName == NM_VPN_SETTING_NAME) {
+			newConnection[settingName][NM_VPN_SECRETS] = QVariant::fromValue(
+					secrets);
+		} else {
+			QMapIterator<QString, QString> it(secrets);
+			while (it.hasNext()) {
+				it.next();
+				newConnection[settingName][it.key()] = it.value();
+			}
+		}
+
+		m_systemConnection.send(
+				request.createReply(QVariant::fromValue(newConnection)));
+	}
+
 public Q_SLOTS:
 	void serviceOwnerChanged(const QString &name, const QString &oldOwner,
 			const QString &newOwner)
@@ -130,7 +318,7 @@ public Q_SLOTS:
 			auto reply = m_agentManager.RegisterWithCapabilities(
 					"com.canonical.indicator.SecretAgent",
 					NM_SECRET_AGENT_CAPABILITY_NONE);
-			reply.waitForFinished();
+			utils::waitForFinished(reply, "org.freedesktop.NetworkManager.AgentManager.RegisterWithCapabilities");
 			if (reply.isError()) {
 				qCritical() << reply.error().message();
 			}
@@ -138,26 +326,34 @@ public Q_SLOTS:
 	}
 
 public:
+	SecretAgent& p;
+
 	QDBusConnection m_systemConnection;
 
 	QDBusConnection m_sessionConnection;
 
 	QDBusServiceWatcher m_managerWatcher;
 
-	OrgFreedesktopNetworkManagerAgentManagerInterface m_agentManager;
+	utils::Instrumented<OrgFreedesktopNetworkManagerAgentManagerInterface> m_agentManager;
 
 	notify::NotificationManager::SPtr m_notifications;
 
 	CredentialStore::SPtr m_credentialStore;
 
-	std::shared_ptr<SecretRequest> m_request;
+	QMap<RequestKey, PendingRequest::SPtr> m_lookups;
+
+	QMap<RequestKey, PendingRequest::SPtr> m_prompts;
+
+	// Interactive requests in the order they get to prompt, the first one
+	// being on screen
+	QList<RequestKey> m_promptQueue;
 };
 
 SecretAgent::SecretAgent(notify::NotificationManager::SPtr notificationManager,
 		agent::CredentialStore::SPtr credentialStore,
 		const QDBusConnection &systemConnection,
 		const QDBusConnection &sessionConnection, QObject *parent) :
-		QObject(parent), d(new Priv(notificationManager, credentialStore, systemConnection, sessionConnection))
+		QObject(parent), d(new Priv(*this, notificationManager, credentialStore, systemConnection, sessionConnection))
 	{
 	// Memory managed by Qt
 	new SecretAgentAdaptor(this);
@@ -174,7 +370,7 @@ SecretAgent::SecretAgent(notify::NotificationManager::SPtr notificationManager,
 	auto reply = d->m_agentManager.RegisterWithCapabilities(
 						"com.canonical.indicator.SecretAgent",
 						NM_SECRET_AGENT_CAPABILITY_NONE);
-	reply.waitForFinished();
+	utils::waitForFinished(reply, "org.freedesktop.NetworkManager.AgentManager.RegisterWithCapabilities");
 	if (reply.isError()) {
 		qCritical() << reply.error().message();
 	}
@@ -182,7 +378,7 @@ SecretAgent::SecretAgent(notify::NotificationManager::SPtr notificationManager,
 
 SecretAgent::~SecretAgent() {
 	auto reply = d->m_agentManager.Unregister();
-	reply.waitForFinished();
+	utils::waitForFinished(reply, "org.freedesktop.NetworkManager.AgentManager.Unregister");
 	if (reply.isError()) {
 		qCritical() << reply.error().message();
 	}
@@ -242,51 +438,16 @@ QVariantDictMap SecretAgent::GetSecrets(const QVariantDictMap &connection,
 				((flags & NM_SECRET_AGENT_GET_SECRETS_FLAG_USER_REQUESTED) > 0)
 			)) {
 		qDebug() << "Requesting secret from user";
-		d->m_request.reset(new SecretRequest(*this, connection,
-						connectionPath, settingName, hints, flags, message()));
+		d->prompt(Priv::requestKey(connectionPath, settingName), connection,
+				hints, flags, message());
 	} else if (((flags == NM_SECRET_AGENT_GET_SECRETS_FLAG_NONE) ||
 				(flags == NM_SECRET_AGENT_GET_SECRETS_FLAG_USER_REQUESTED))) {
 		qDebug() << "Retrieving secret from keyring";
 
-		bool isVpn = (settingName == NM_VPN_SETTING_NAME);
-
+		// The keyring might have to be unlocked first, so reply once it
+		// gets back to us rather than waiting for it here
 		QString uuid = connection[NM_CONNECTION_SETTING_NAME][NM_CONNECTION_UUID].toString();
-
-		QStringMap secrets;
-
-		try {
-			secrets = d->m_credentialStore->get(uuid, settingName);
-		} catch (domain_error& e) {
-			d->m_systemConnection.send(
-					message().createErrorReply(
-							"org.freedesktop.NetworkManager.SecretAgent.InternalError",
-							e.what()));
-			return QVariantDictMap();
-		}
-
-		if (secrets.isEmpty()) {
-			d->m_systemConnection.send(
-					message().createErrorReply(
-							"org.freedesktop.NetworkManager.SecretAgent.NoSecrets",
-							"No secrets found for this connection."));
-			return QVariantDictMap();
-		}
-
-		QVariantDictMap newConnection;
-
-		if (isVpn) {
-			newConnection[settingName][NM_VPN_SECRETS] = QVariant::fromValue(
-					secrets);
-		} else {
-			QMapIterator<QString, QString> it(secrets);
-			while (it.hasNext()) {
-				it.next();
-				newConnection[settingName][it.key()] = it.value();
-			}
-		}
-
-		d->m_systemConnection.send(
-				message().createReply(QVariant::fromValue(newConnection)));
+		d->lookUp(Priv::requestKey(connectionPath, settingName), uuid, message());
 	} else {
 		qDebug() << "Can't get secrets for this connection";
 		d->m_systemConnection.send(
@@ -298,26 +459,12 @@ QVariantDictMap SecretAgent::GetSecrets(const QVariantDictMap &connection,
 }
 
 void SecretAgent::FinishGetSecrets(SecretRequest &request, bool error) {
-	if (error) {
-		d->m_systemConnection.send(
-				request.message().createErrorReply("org.freedesktop.NetworkManager.SecretAgent.NoSecrets",
-						"No secrets found for this connection."));
-	} else {
-		d->m_systemConnection.send(
-				request.message().createReply(
-						QVariant::fromValue(request.connection())));
-	}
-
-	d->m_request.reset();
+	d->finishPrompt(request, error);
 }
 
 void SecretAgent::CancelGetSecrets(const QDBusObjectPath &connectionPath,
 		const QString &settingName) {
-	Q_UNUSED(settingName);
-
-	if (d->m_request && d->m_request->connectionPath() == connectionPath) {
-		d->m_request.reset();
-	}
+	d->cancel(Priv::requestKey(connectionPath, settingName));
 }
 
 void SecretAgent::DeleteSecrets(const QVariantDictMap &connection,
@@ -336,15 +483,22 @@ void SecretAgent::SaveSecrets(const QVariantDictMap &connection,
 	QString uuid = connection[NM_CONNECTION_SETTING_NAME][NM_CONNECTION_UUID].toString();
 	QString type = connection[NM_CONNECTION_SETTING_NAME][NM_CONNECTION_TYPE].toString();
 
+	// Hand every secret of the connection over at once, so the store can
+	// skip what it already has and write the rest together
+	CredentialStore::Secrets secrets;
 	if (type == NM_VPN_SETTING_NAME) {
-		d->saveVpnSettings(id, uuid, NM_VPN_SETTING_NAME, connection[NM_VPN_SETTING_NAME]);
+		Priv::addVpnSettings(secrets, id, NM_VPN_SETTING_NAME, connection[NM_VPN_SETTING_NAME]);
 	} else {
 		QMapIterator<QString, QVariantMap> iter(connection);
 		while (iter.hasNext()) {
 			iter.next();
-			d->saveSettings(id, uuid, iter.key(), iter.value());
+			Priv::addSettings(secrets, id, iter.key(), iter.value());
 		}
 	}
+
+	if (!secrets.isEmpty()) {
+		d->m_credentialStore->save(uuid, secrets);
+	}
 }
 
 notify::NotificationManager::SPtr SecretAgent::notifications() {
@@ -134,4 +134,8 @@ const QDBusObjectPath & SecretRequest::connectionPath() const {
 	return m_connectionPath;
 }
 
+const QString & SecretRequest::settingName() const {
+	return m_settingName;
+}
+
 }
@@ -53,6 +53,8 @@ public:
 
 	const QDBusObjectPath & connectionPath() const;
 
+	const QString & settingName() const;
+
 protected:
 	notify::Notification::UPtr m_notification;
 
@@ -21,6 +21,7 @@
 #include <connectivityqt/internal/sims-list-model-parameters.h>
 #include <connectivityqt/internal/modems-list-model-parameters.h>
 #include <connectivityqt/internal/vpn-connection-list-model-parameters.h>
+#include <connectivityqt/internal/property-dispatcher.h>
 #include <connectivityqt/vpn-connections-list-model.h>
 #include <connectivityqt/modems-list-model.h>
 #include <connectivityqt/sims-list-model.h>
@@ -113,77 +114,81 @@ public Q_SLOTS:
 
     void propertyChanged(const QString& name, const QVariant& value)
     {
-        if (name == "FlightMode")
-        {
-            Q_EMIT p.flightModeUpdated(value.toBool());
-        }
-        else if (name == "WifiEnabled")
-        {
-            Q_EMIT p.wifiEnabledUpdated(value.toBool());
-        }
-        else if (name == "FlightModeSwitchEnabled")
-        {
-            Q_EMIT p.flightModeSwitchEnabledUpdated(value.toBool());
-        }
-        else if (name == "WifiSwitchEnabled")
-        {
-            Q_EMIT p.wifiSwitchEnabledUpdated(value.toBool());
-        }
-        else if (name == "HotspotSwitchEnabled")
-        {
-            Q_EMIT p.hotspotSwitchEnabledUpdated(value.toBool());
-        }
-        else if (name == "Limitations")
-        {
-            auto limitations = toLimitations(value);
-            Q_EMIT p.limitationsUpdated(limitations);
-            Q_EMIT p.limitedBandwithUpdated(limitations.contains(Limitations::Bandwith));
-        }
-        else if (name == "Status")
-        {
-            auto status = toStatus(value);
-            Q_EMIT p.statusUpdated(status);
-            Q_EMIT p.onlineUpdated(status == Status::Online);
-        }
-        else if (name == "ModemAvailable")
-        {
-            Q_EMIT p.modemAvailableUpdated(value.toBool());
-        }
-        else if (name == "HotspotEnabled")
-        {
-            Q_EMIT p.hotspotEnabledUpdated(value.toBool());
-        }
-        else if (name == "HotspotSsid")
-        {
-            Q_EMIT p.hotspotSsidUpdated(value.toByteArray());
-        }
-        else if (name == "HotspotPassword")
-        {
-            Q_EMIT p.hotspotPasswordUpdated(value.toString());
-        }
-        else if (name == "HotspotMode")
-        {
-            Q_EMIT p.hotspotModeUpdated(value.toString());
-        }
-        else if (name == "HotspotAuth")
-        {
-            Q_EMIT p.hotspotAuthUpdated(value.toString());
-        }
-        else if (name == "HotspotStored")
-        {
-            Q_EMIT p.hotspotStoredUpdated(value.toBool());
-        }
-        else if (name == "MobileDataEnabled")
-        {
-            Q_EMIT p.mobileDataEnabledUpdated(value.toBool());
-        }
-        else if (name == "SimForMobileData")
-        {
-            auto path = value.value<QDBusObjectPath>();
-            p.sims();
-            auto sim = m_simsModel->getSimByPath(path);
-            p.setSimForMobileData(sim.get());
-        }
+        static const internal::PropertyDispatcher<Priv> DISPATCHER {
+            {"FlightMode", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.flightModeUpdated(value.toBool());
+            }},
+            {"WifiEnabled", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.wifiEnabledUpdated(value.toBool());
+            }},
+            {"FlightModeSwitchEnabled", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.flightModeSwitchEnabledUpdated(value.toBool());
+            }},
+            {"WifiSwitchEnabled", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.wifiSwitchEnabledUpdated(value.toBool());
+            }},
+            {"HotspotSwitchEnabled", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.hotspotSwitchEnabledUpdated(value.toBool());
+            }},
+            {"Limitations", [](Priv& d, const QVariant& value)
+            {
+                auto limitations = toLimitations(value);
+                Q_EMIT d.p.limitationsUpdated(limitations);
+                Q_EMIT d.p.limitedBandwithUpdated(limitations.contains(Limitations::Bandwith));
+            }},
+            {"Status", [](Priv& d, const QVariant& value)
+            {
+                auto status = toStatus(value);
+                Q_EMIT d.p.statusUpdated(status);
+                Q_EMIT d.p.onlineUpdated(status == Status::Online);
+            }},
+            {"ModemAvailable", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.modemAvailableUpdated(value.toBool());
+            }},
+            {"HotspotEnabled", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.hotspotEnabledUpdated(value.toBool());
+            }},
+            {"HotspotSsid", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.hotspotSsidUpdated(value.toByteArray());
+            }},
+            {"HotspotPassword", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.hotspotPasswordUpdated(value.toString());
+            }},
+            {"HotspotMode", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.hotspotModeUpdated(value.toString());
+            }},
+            {"HotspotAuth", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.hotspotAuthUpdated(value.toString());
+            }},
+            {"HotspotStored", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.hotspotStoredUpdated(value.toBool());
+            }},
+            {"MobileDataEnabled", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.mobileDataEnabledUpdated(value.toBool());
+            }},
+            {"SimForMobileData", [](Priv& d, const QVariant& value)
+            {
+                auto path = value.value<QDBusObjectPath>();
+                d.p.sims();
+                auto sim = d.m_simsModel->getSimByPath(path);
+                d.p.setSimForMobileData(sim.get());
+            }},
+        };
+
+        DISPATCHER.dispatch(*this, name, value);
     }
 
     void simsUpdated()
@@ -19,7 +19,16 @@
 
 #include <connectivityqt/internal/dbus-property-cache.h>
 
-#include <PropertiesInterface.h>
+#include <QDBusContext>
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
+#include <QDebug>
+#include <QTimer>
+
+#include <algorithm>
 
 using namespace std;
 
@@ -28,7 +37,19 @@ namespace connectivityqt
 namespace internal
 {
 
-class DBusPropertyCache::Priv: public QObject
+namespace
+{
+static const QString PROPERTIES_INTERFACE("org.freedesktop.DBus.Properties");
+
+// Backoff between attempts at a GetAll call that failed, in milliseconds
+static const int MIN_RETRY_INTERVAL = 100;
+static const int MAX_RETRY_INTERVAL = 10000;
+
+// Attempts after the first before giving up
+static const int MAX_RETRIES = 8;
+}
+
+class DBusPropertyCache::Priv: public QObject, protected QDBusContext
 {
     Q_OBJECT
 
@@ -36,6 +57,8 @@ public:
     Priv(DBusPropertyCache& parent, const QDBusConnection& connection) :
         p(parent), m_connection(connection)
     {
+        m_retryTimer.setSingleShot(true);
+        connect(&m_retryTimer, &QTimer::timeout, this, &Priv::fetchProperties);
     }
 
     DBusPropertyCache& p;
@@ -50,56 +73,212 @@ public:
 
     shared_ptr<QDBusServiceWatcher> m_serviceWatcher;
 
-    shared_ptr<OrgFreedesktopDBusPropertiesInterface> m_propertiesInterface;
+    // Unique name of the current owner of m_service, once known
+    QString m_owner;
 
     QVariantMap m_propertyCache;
 
-    void refreshProperties(const QStringList& names)
+    bool m_initialized = false;
+
+    // Bumped whenever the service owner changes, so replies to calls made
+    // to a previous owner can be told apart and dropped
+    quint64 m_generation = 0;
+
+    // A GetAll call is in flight
+    bool m_fetching = false;
+
+    // Properties were invalidated while a GetAll call was in flight
+    bool m_refetch = false;
+
+    // Tries a failed GetAll again, waiting twice as long each time
+    QTimer m_retryTimer;
+
+    int m_retryInterval = MIN_RETRY_INTERVAL;
+
+    int m_retries = 0;
+
+    void listen(const QString& service, const QString& interface, const QString& path)
+    {
+        m_service = service;
+        m_interface = interface;
+        m_path = path;
+
+        m_serviceWatcher = make_shared<QDBusServiceWatcher>(service,
+                                                            m_connection);
+
+        connect(m_serviceWatcher.get(), &QDBusServiceWatcher::serviceOwnerChanged,
+                this, &Priv::serviceOwnerChanged);
+
+        // Listen for changes from any sender, and filter on the owner
+        // ourselves. Naming the service here would make Qt look up its
+        // owner with a blocking call.
+        m_connection.connect(QString(), path, PROPERTIES_INTERFACE,
+                             "PropertiesChanged", this,
+                             SLOT(propertiesChanged(const QString&, const QVariantMap&, const QStringList&)));
+    }
+
+    QDBusPendingCall asyncCall(const QString& method, const QVariantList& arguments)
+    {
+        auto message = QDBusMessage::createMethodCall(m_service, m_path,
+                                                      PROPERTIES_INTERFACE,
+                                                      method);
+        message.setArguments(arguments);
+        return m_connection.asyncCall(message);
+    }
+
+    void stopRetrying()
+    {
+        m_retryTimer.stop();
+        m_retryInterval = MIN_RETRY_INTERVAL;
+        m_retries = 0;
+    }
+
+    /**
+     * Whether a failed GetAll is worth trying again. Without an owner, the
+     * service isn't there yet and the watcher tells us when it is. With
+     * one, the call raced the service, so it's as transient as a timeout.
+     */
+    bool isTransient(QDBusError::ErrorType type) const
     {
-        for(const QString& name: names)
+        switch (type)
         {
-            QDBusVariant v = m_propertiesInterface->Get(m_interface, name);
-            QVariant variant = v.variant();
-            m_propertyCache[name] = variant;
-            Q_EMIT p.propertyChanged(name, variant);
+            case QDBusError::NoReply:
+            case QDBusError::Timeout:
+                return true;
+            case QDBusError::ServiceUnknown:
+            case QDBusError::NameHasNoOwner:
+                return !m_owner.isEmpty();
+            default:
+                return false;
         }
     }
 
-public Q_SLOTS:
-    void serviceOwnerChanged(const QString &, const QString &,
-                        const QString & newOwner)
+    void fetchProperties()
     {
-        m_propertiesInterface.reset();
-        m_propertyCache.clear();
+        if (m_fetching)
+        {
+            m_refetch = true;
+            return;
+        }
+
+        m_fetching = true;
+        m_refetch = false;
+
+        auto watcher = new QDBusPendingCallWatcher(asyncCall("GetAll", {m_interface}), this);
+        quint64 generation = m_generation;
+        connect(watcher, &QDBusPendingCallWatcher::finished, this,
+                [this, generation](QDBusPendingCallWatcher* call)
+                {
+                    call->deleteLater();
+                    if (generation != m_generation)
+                    {
+                        return;
+                    }
+                    m_fetching = false;
+                    getAllFinished(*call);
+                });
+    }
 
-        if (newOwner.isEmpty())
+    void getAllFinished(const QDBusPendingCall& call)
+    {
+        QDBusPendingReply<QVariantMap> reply(call);
+        if (reply.isError())
         {
+            auto type = reply.error().type();
+            if (!isTransient(type))
+            {
+                // The service is not there yet, the watcher will let us know
+                if (type != QDBusError::ServiceUnknown && type != QDBusError::NameHasNoOwner)
+                {
+                    qWarning() << __PRETTY_FUNCTION__ << m_path << m_interface
+                            << reply.error().message();
+                }
+                return;
+            }
+
+            if (m_retries >= MAX_RETRIES)
+            {
+                qWarning() << __PRETTY_FUNCTION__ << m_path << m_interface
+                        << "giving up after" << m_retries << "retries:"
+                        << reply.error().message();
+                return;
+            }
+
+            // Nothing else would ask again
+            ++m_retries;
+            m_retryTimer.start(m_retryInterval);
+            m_retryInterval = min(m_retryInterval * 2, MAX_RETRY_INTERVAL);
             return;
         }
 
-        m_propertiesInterface = make_shared<
-                OrgFreedesktopDBusPropertiesInterface>(m_service, m_path,
-                                                       m_connection);
+        stopRetrying();
+        m_owner = reply.reply().service();
+
+        QVariantMap properties = reply.value();
+        for (auto it = properties.constBegin(); it != properties.constEnd(); ++it)
+        {
+            auto cached = m_propertyCache.find(it.key());
+            if (cached == m_propertyCache.end() || *cached != it.value())
+            {
+                m_propertyCache[it.key()] = it.value();
+                Q_EMIT p.propertyChanged(it.key(), it.value());
+            }
+        }
+
+        if (!m_initialized)
+        {
+            m_initialized = true;
+            Q_EMIT p.initialized();
+        }
 
-        connect(m_propertiesInterface.get(),
-                &OrgFreedesktopDBusPropertiesInterface::PropertiesChanged, this,
-                &Priv::propertiesChanged);
+        if (m_refetch)
+        {
+            fetchProperties();
+        }
+    }
 
-        m_propertyCache = m_propertiesInterface->GetAll(m_interface);
-        QMapIterator<QString, QVariant> it(m_propertyCache);
-        while (it.hasNext())
+public Q_SLOTS:
+    void serviceOwnerChanged(const QString &, const QString &,
+                        const QString & newOwner)
+    {
+        ++m_generation;
+        m_fetching = false;
+        m_refetch = false;
+        stopRetrying();
+        m_owner = newOwner;
+        m_propertyCache.clear();
+        m_initialized = false;
+
+        if (!newOwner.isEmpty())
         {
-            it.next();
-            Q_EMIT p.propertyChanged(it.key(), it.value());
+            fetchProperties();
         }
+    }
 
-        Q_EMIT p.initialized();
+    void propertiesChanged(const QString& interface,
+                      const QVariantMap &changedProperties,
+                      const QStringList &invalidatedProperties)
+    {
+        applyChanges(message().service(), interface, changedProperties,
+                     invalidatedProperties);
     }
 
-    void propertiesChanged(const QString &,
+    void applyChanges(const QString& sender, const QString& interface,
                       const QVariantMap &changedProperties,
                       const QStringList &invalidatedProperties)
     {
+        if (interface != m_interface || sender != m_owner)
+        {
+            return;
+        }
+
+        // Anything that changed before we were initialized is already
+        // covered by the GetAll reply we are waiting for
+        if (!m_initialized)
+        {
+            return;
+        }
+
         QMapIterator<QString, QVariant> it(changedProperties);
         while (it.hasNext())
         {
@@ -111,7 +290,11 @@ public Q_SLOTS:
             }
         }
 
-        refreshProperties(invalidatedProperties);
+        // Re-read all invalidated properties with a single GetAll
+        if (!invalidatedProperties.isEmpty())
+        {
+            fetchProperties();
+        }
     }
 
     void dbusCallFinished(QDBusPendingCallWatcher *call)
@@ -131,38 +314,52 @@ DBusPropertyCache::DBusPropertyCache(const QString &service,
                                      const QDBusConnection &connection) :
         d(new Priv(*this, connection))
 {
-    d->m_service = service;
-    d->m_interface = interface;
-    d->m_path = path;
+    d->listen(service, interface, path);
 
-    d->m_serviceWatcher = make_shared<QDBusServiceWatcher>(service,
-                                                           connection);
+    // If the service is already registered, this finds out
+    d->fetchProperties();
+}
 
-    connect(d->m_serviceWatcher.get(), &QDBusServiceWatcher::serviceOwnerChanged,
-            d.get(), &Priv::serviceOwnerChanged);
+DBusPropertyCache::DBusPropertyCache(const QString &service,
+                                     const QString &interface,
+                                     const QString &path,
+                                     const QDBusConnection &connection,
+                                     const QString& owner,
+                                     const QVariantMap& properties) :
+        d(new Priv(*this, connection))
+{
+    d->listen(service, interface, path);
 
-    // If the service is already registered
-    QString serviceOwner = connection.interface()->serviceOwner(service);
-    if (!serviceOwner.isEmpty())
-    {
-        d->serviceOwnerChanged(service, "", serviceOwner);
-    }
+    d->m_owner = owner;
+    d->m_propertyCache = properties;
+    d->m_initialized = true;
 }
 
 DBusPropertyCache::~DBusPropertyCache()
 {
+    d->m_connection.disconnect(QString(), d->m_path, PROPERTIES_INTERFACE,
+                               "PropertiesChanged", d.get(),
+                               SLOT(propertiesChanged(const QString&, const QVariantMap&, const QStringList&)));
 }
 
 void DBusPropertyCache::set(const QString& name, const QVariant& value)
 {
     if (d->m_propertyCache.value(name) != value)
     {
-        auto reply = d->m_propertiesInterface->Set(d->m_interface, name, QDBusVariant(value));
+        auto reply = d->asyncCall("Set", {d->m_interface, name, QVariant::fromValue(QDBusVariant(value))});
         auto watcher(new QDBusPendingCallWatcher(reply, this));
         connect(watcher, &QDBusPendingCallWatcher::finished, d.get(), &Priv::dbusCallFinished);
     }
 }
 
+void DBusPropertyCache::replayPropertiesChanged(const QString& sender,
+                                                const QString& interface,
+                                                const QVariantMap& changed,
+                                                const QStringList& invalidated)
+{
+    d->applyChanges(sender, interface, changed, invalidated);
+}
+
 QVariant DBusPropertyCache::get(const QString& name) const
 {
     return d->m_propertyCache[name];
@@ -170,7 +367,7 @@ QVariant DBusPropertyCache::get(const QString& name) const
 
 bool DBusPropertyCache::isInitialized() const
 {
-    return !d->m_propertyCache.empty();
+    return d->m_initialized;
 }
 
 QDBusConnection DBusPropertyCache::connection() const
@@ -182,4 +379,3 @@ QDBusConnection DBusPropertyCache::connection() const
 }
 
 #include "dbus-property-cache.moc"
-
@@ -22,6 +22,7 @@
 #include <QDBusConnection>
 #include <QObject>
 #include <QString>
+#include <QVariantMap>
 #include <memory>
 
 #include <unity/util/DefinesPtrs.h>
@@ -41,12 +42,29 @@ public:
     DBusPropertyCache(const QString &service, const QString& interface,
                       const QString &path, const QDBusConnection &connection);
 
+    /**
+     * Starts out with properties already fetched from owner, the unique
+     * name of the service, e.g. by one GetManagedObjects call for many
+     * objects, rather than fetching them itself.
+     */
+    DBusPropertyCache(const QString &service, const QString& interface,
+                      const QString &path, const QDBusConnection &connection,
+                      const QString& owner, const QVariantMap& properties);
+
     ~DBusPropertyCache();
 
     void set(const QString& name, const QVariant& value);
 
     QVariant get(const QString& name) const;
 
+    /**
+     * Applies a PropertiesChanged signal from sender that only reached
+     * somebody else's match rule.
+     */
+    void replayPropertiesChanged(const QString& sender, const QString& interface,
+                                 const QVariantMap& changed,
+                                 const QStringList& invalidated);
+
     bool isInitialized() const;
 
     QDBusConnection connection() const;
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QVariant>
+
+#include <initializer_list>
+
+namespace connectivityqt
+{
+namespace internal
+{
+
+/**
+ * Maps D-Bus property names to the handlers reacting to their changes.
+ *
+ * The table is hashed once when it is built, so dispatching a change costs
+ * one hash lookup however many properties the interface has. It is meant
+ * to be kept as a function-local static next to the handlers:
+ *
+ *     static const PropertyDispatcher<Priv> DISPATCHER {
+ *         {"Locked", [](Priv& d, const QVariant& value) {...}},
+ *     };
+ *     DISPATCHER.dispatch(*this, name, value);
+ */
+template<typename T>
+class PropertyDispatcher
+{
+public:
+    typedef void (*Handler)(T&, const QVariant&);
+
+    struct Entry
+    {
+        const char* name;
+        Handler handler;
+    };
+
+    PropertyDispatcher(std::initializer_list<Entry> entries)
+    {
+        m_handlers.reserve(int(entries.size()));
+        for (const auto& entry: entries)
+        {
+            m_handlers.insert(QString::fromLatin1(entry.name), entry.handler);
+        }
+    }
+
+    /**
+     * Returns false if there is no handler for the given property.
+     */
+    bool dispatch(T& target, const QString& name, const QVariant& value) const
+    {
+        auto it = m_handlers.constFind(name);
+        if (it == m_handlers.constEnd())
+        {
+            return false;
+        }
+        (*it)(target, value);
+        return true;
+    }
+
+    bool contains(const QString& name) const
+    {
+        return m_handlers.contains(name);
+    }
+
+protected:
+    QHash<QString, Handler> m_handlers;
+};
+
+}
+}
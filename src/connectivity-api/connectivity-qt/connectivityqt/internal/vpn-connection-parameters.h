@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <connectivityqt/internal/dbus-property-cache.h>
+#include <dbus-types.h>
+
+#include <QDBusConnection>
+#include <QDBusObjectPath>
+#include <QList>
+#include <QPointer>
+
+#include <memory>
+
+namespace connectivityqt
+{
+namespace internal
+{
+
+struct VpnConnectionParameters
+{
+    VpnConnectionParameters(const QDBusObjectPath& path_, const QDBusConnection& connection_) :
+        path(path_), connection(connection_)
+    {
+    }
+
+    DBusPropertyCache::UPtr propertyCache(const QString& interface) const
+    {
+        DBusPropertyCache::UPtr propertyCache;
+        auto properties = interfaces.constFind(interface);
+        if (properties == interfaces.constEnd())
+        {
+            propertyCache = std::make_unique<DBusPropertyCache>(
+                    DBusTypes::DBUS_NAME, interface, path.path(), connection);
+        }
+        else
+        {
+            propertyCache = std::make_unique<DBusPropertyCache>(
+                    DBusTypes::DBUS_NAME, interface, path.path(), connection,
+                    owner, *properties);
+        }
+        if (createdCaches)
+        {
+            createdCaches->append(propertyCache.get());
+        }
+        return propertyCache;
+    }
+
+    QDBusObjectPath path;
+
+    QDBusConnection connection;
+
+    // Properties already fetched from owner, by interface
+    QString owner;
+
+    QVariantDictMap interfaces;
+
+    // Collects every cache built from these parameters, when set
+    std::shared_ptr<QList<QPointer<DBusPropertyCache>>> createdCaches;
+};
+
+}
+}
@@ -95,6 +95,9 @@ Modem::Modem(const QDBusObjectPath& path,
     connect(d->m_propertyCache.get(),
                 &internal::DBusPropertyCache::propertyChanged, d.get(),
                 &Priv::propertyChanged);
+    connect(d->m_propertyCache.get(),
+                &internal::DBusPropertyCache::initialized, this,
+                &Modem::initialized);
 
     d->simsUpdated();
 
@@ -125,6 +128,11 @@ QString Modem::serial() const
     return d->m_propertyCache->get("Serial").toString();
 }
 
+bool Modem::isInitialized() const
+{
+    return d->m_propertyCache->isInitialized();
+}
+
 }
 
 #include "modem.moc"
@@ -55,11 +55,15 @@ public:
     Q_PROPERTY(connectivityqt::Sim* sim READ sim NOTIFY simChanged)
     Sim* sim() const;
 
+    bool isInitialized() const;
+
 public Q_SLOTS:
 
 Q_SIGNALS:
     void simChanged(Sim *sim);
 
+    void initialized();
+
 protected:
     class Priv;
     std::shared_ptr<Priv> d;
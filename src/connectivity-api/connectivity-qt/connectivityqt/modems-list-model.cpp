@@ -23,6 +23,7 @@
 #include "internal/modems-list-model-parameters.h"
 
 #include <QDebug>
+#include <QHash>
 
 using namespace std;
 
@@ -48,6 +49,10 @@ public:
         {
             current << m->path();
         }
+        for (const auto& m: m_pendingModems)
+        {
+            current << m->path();
+        }
 
         auto toRemove(current);
         toRemove.subtract(paths);
@@ -57,6 +62,7 @@ public:
 
         QMutableListIterator<Modem::SPtr> i(m_modems);
         int idx = 0;
+        bool removed = false;
         while (i.hasNext())
         {
             auto modem(i.next());
@@ -64,39 +70,73 @@ public:
             {
                 p.beginRemoveRows(QModelIndex(), idx, idx);
                 i.remove();
+                m_rows.remove(modem.get());
                 p.endRemoveRows();
+                removed = true;
             }
             else
             {
                 ++idx;
             }
         }
+        if (removed)
+        {
+            updateRows();
+        }
 
-        if (!toAdd.isEmpty())
+        QMutableHashIterator<QObject*, Modem::SPtr> j(m_pendingModems);
+        while (j.hasNext())
         {
-            p.beginInsertRows(QModelIndex(), m_modems.size(), m_modems.size() + toAdd.size() - 1);
-            for (const auto& path: toAdd)
+            if (toRemove.contains(j.next().value()->path()))
             {
-                auto modem = std::make_shared<Modem>(path, m_propertyCache->connection(), m_sims);
-                m_objectOwner(modem.get());
-                m_modems << modem;
-                connect(modem.get(), &Modem::simChanged, this, &Priv::simChanged);
+                j.remove();
             }
-            p.endInsertRows();
+        }
+
+        // Modems only get a row once their properties have arrived
+        for (const auto& path: toAdd)
+        {
+            auto modem = std::make_shared<Modem>(path, m_propertyCache->connection(), m_sims);
+            m_objectOwner(modem.get());
+            connect(modem.get(), &Modem::simChanged, this, &Priv::simChanged);
+            connect(modem.get(), &Modem::initialized, this, &Priv::modemInitialized);
+            if (modem->isInitialized())
+            {
+                insertModem(modem);
+            }
+            else
+            {
+                m_pendingModems.insert(modem.get(), modem);
+            }
+        }
+    }
+
+    void insertModem(Modem::SPtr modem)
+    {
+        int row = m_modems.size();
+        p.beginInsertRows(QModelIndex(), row, row);
+        m_modems << modem;
+        m_rows.insert(modem.get(), row);
+        p.endInsertRows();
+    }
+
+    void updateRows()
+    {
+        m_rows.clear();
+        for (int row = 0; row < m_modems.size(); ++row)
+        {
+            m_rows.insert(m_modems.at(row).get(), row);
         }
     }
 
     QModelIndex findModem(QObject* o)
     {
-        auto modem = qobject_cast<Modem*>(o);
-        for (auto i = m_modems.constBegin(); i != m_modems.constEnd(); ++i)
+        auto it = m_rows.constFind(o);
+        if (it == m_rows.constEnd())
         {
-            if (i->get() == modem)
-            {
-                return p.index(std::distance(m_modems.constBegin(), i));
-            }
+            return QModelIndex();
         }
-        return QModelIndex();
+        return p.index(*it);
     }
 
 public Q_SLOTS:
@@ -104,7 +144,19 @@ public Q_SLOTS:
     {
         Q_UNUSED(sim)
         auto idx = findModem(sender());
-        p.dataChanged(idx, idx, {ModemsListModel::Roles::RoleSim});
+        if (idx.isValid())
+        {
+            p.dataChanged(idx, idx, {ModemsListModel::Roles::RoleSim});
+        }
+    }
+
+    void modemInitialized()
+    {
+        auto modem = m_pendingModems.take(sender());
+        if (modem)
+        {
+            insertModem(modem);
+        }
     }
 
     void propertyChanged(const QString& name, const QVariant& value)
@@ -123,6 +175,8 @@ public:
     SimsListModel::SPtr m_sims;
     QList<QDBusObjectPath> m_dbus_paths;
     QList<Modem::SPtr> m_modems;
+    QHash<QObject*, Modem::SPtr> m_pendingModems;
+    QHash<QObject*, int> m_rows;
 
     shared_ptr<ComUbuntuConnectivity1PrivateInterface> m_writeInterface;
     internal::DBusPropertyCache::SPtr m_propertyCache;
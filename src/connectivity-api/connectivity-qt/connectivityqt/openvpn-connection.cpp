@@ -19,6 +19,8 @@
 
 #include <connectivityqt/openvpn-connection.h>
 #include <connectivityqt/internal/dbus-property-cache.h>
+#include <connectivityqt/internal/property-dispatcher.h>
+#include <connectivityqt/internal/vpn-connection-parameters.h>
 #include <dbus-types.h>
 
 #include <OpenVpnConnectionInterface.h>
@@ -50,16 +52,16 @@ void OpenvpnConnection::set##uppername(type value)\
 }
 
 #define DEFINE_PROPERTY_UPDATE(varname, strname, conversion)\
-else if (name == strname)\
+{strname, [](Priv& d, const QVariant& value)\
 {\
-    Q_EMIT p.varname##Changed(value.conversion());\
-}
+    Q_EMIT d.p.varname##Changed(value.conversion());\
+}},
 
 #define DEFINE_PROPERTY_UPDATE_ENUM(varname, strname, type)\
-else if (name == strname)\
+{strname, [](Priv& d, const QVariant& value)\
 {\
-    Q_EMIT p.varname##Changed(static_cast<type>(value.toInt()));\
-}
+    Q_EMIT d.p.varname##Changed(static_cast<type>(value.toInt()));\
+}},
 
 namespace connectivityqt
 {
@@ -77,64 +79,74 @@ public:
 public Q_SLOTS:
     void propertyChanged(const QString& name, const QVariant& value)
     {
-        if (name == "") {}
-
-        // Basic properties
-
-        DEFINE_PROPERTY_UPDATE(ca, "ca", toString)
-        DEFINE_PROPERTY_UPDATE_ENUM(connectionType, "connectionType", ConnectionType)
-        DEFINE_PROPERTY_UPDATE(certPass, "certPass", toString)
-        DEFINE_PROPERTY_UPDATE(cert, "cert", toString)
-        DEFINE_PROPERTY_UPDATE(key, "key", toString)
-        DEFINE_PROPERTY_UPDATE(localIp, "localIp", toString)
-        DEFINE_PROPERTY_UPDATE(password, "password", toString)
-        DEFINE_PROPERTY_UPDATE(remote, "remote", toString)
-        DEFINE_PROPERTY_UPDATE(remoteIp, "remoteIp", toString)
-        DEFINE_PROPERTY_UPDATE(staticKey, "staticKey", toString)
-        DEFINE_PROPERTY_UPDATE_ENUM(staticKeyDirection, "staticKeyDirection", KeyDir)
-        DEFINE_PROPERTY_UPDATE(username, "username", toString)
-
-        // Advanced general properties
-        DEFINE_PROPERTY_UPDATE(port, "port", toInt)
-        DEFINE_PROPERTY_UPDATE(portSet, "portSet", toBool)
-        DEFINE_PROPERTY_UPDATE(renegSeconds, "renegSeconds", toInt)
-        DEFINE_PROPERTY_UPDATE(renegSecondsSet, "renegSecondsSet", toBool)
-        DEFINE_PROPERTY_UPDATE(compLzo, "compLzo", toBool)
-        DEFINE_PROPERTY_UPDATE(protoTcp, "protoTcp", toBool)
-        DEFINE_PROPERTY_UPDATE(dev, "dev", toString)
-        DEFINE_PROPERTY_UPDATE_ENUM(devType, "devType", DevType)
-        DEFINE_PROPERTY_UPDATE(devTypeSet, "devTypeSet", toBool)
-        DEFINE_PROPERTY_UPDATE(tunnelMtu, "tunnelMtu", toInt)
-        DEFINE_PROPERTY_UPDATE(tunnelMtuSet, "tunnelMtuSet", toBool)
-        DEFINE_PROPERTY_UPDATE(fragmentSize, "fragmentSize", toInt)
-        DEFINE_PROPERTY_UPDATE(fragmentSizeSet, "fragmentSizeSet", toBool)
-        DEFINE_PROPERTY_UPDATE(mssFix, "mssFix", toBool)
-        DEFINE_PROPERTY_UPDATE(remoteRandom, "remoteRandom", toBool)
-
-        // Advanced security properties
-
-        DEFINE_PROPERTY_UPDATE_ENUM(cipher, "cipher", Cipher)
-        DEFINE_PROPERTY_UPDATE(keysize, "keysize", toInt)
-        DEFINE_PROPERTY_UPDATE(keysizeSet, "keysizeSet", toBool)
-        DEFINE_PROPERTY_UPDATE_ENUM(auth, "auth", Auth)
-
-        // Advanced TLS auth properties
-
-        DEFINE_PROPERTY_UPDATE(tlsRemote, "tlsRemote", toString)
-        DEFINE_PROPERTY_UPDATE_ENUM(remoteCertTls, "remoteCertTls", TlsType)
-        DEFINE_PROPERTY_UPDATE(remoteCertTlsSet, "remoteCertTlsSet", toBool)
-        DEFINE_PROPERTY_UPDATE(ta, "ta", toString)
-        DEFINE_PROPERTY_UPDATE_ENUM(taDir, "taDir", KeyDir)
-        DEFINE_PROPERTY_UPDATE(taSet, "taSet", toBool)
-
-        // Advanced proxy settings
-
-        DEFINE_PROPERTY_UPDATE_ENUM(proxyType, "proxyType", ProxyType)
-        DEFINE_PROPERTY_UPDATE(proxyServer, "proxyServer", toString)
-        DEFINE_PROPERTY_UPDATE(proxyPort, "proxyPort", toInt)
-        DEFINE_PROPERTY_UPDATE(proxyRetry, "proxyRetry", toBool)
-        DEFINE_PROPERTY_UPDATE(proxyUsername, "proxyUsername", toString)
-        DEFINE_PROPERTY_UPDATE(proxyPassword, "proxyPassword", toString)
+        static const internal::PropertyDispatcher<Priv> DISPATCHER {
+            // Basic properties
+
+            DEFINE_PROPERTY_UPDATE(ca, "ca", toString)
+            DEFINE_PROPERTY_UPDATE_ENUM(connectionType, "connectionType", ConnectionType)
+            DEFINE_PROPERTY_UPDATE(certPass, "certPass", toString)
+            DEFINE_PROPERTY_UPDATE(cert, "cert", toString)
+            DEFINE_PROPERTY_UPDATE(key, "key", toString)
+            DEFINE_PROPERTY_UPDATE(localIp, "localIp", toString)
+            DEFINE_PROPERTY_UPDATE(password, "password", toString)
+            DEFINE_PROPERTY_UPDATE(remote, "remote", toString)
+            DEFINE_PROPERTY_UPDATE(remoteIp, "remoteIp", toString)
+            DEFINE_PROPERTY_UPDATE(staticKey, "staticKey", toString)
+            DEFINE_PROPERTY_UPDATE_ENUM(staticKeyDirection, "staticKeyDirection", KeyDir)
+            DEFINE_PROPERTY_UPDATE(username, "username", toString)
+
+            // Advanced general properties
+            DEFINE_PROPERTY_UPDATE(port, "port", toInt)
+            DEFINE_PROPERTY_UPDATE(portSet, "portSet", toBool)
+            DEFINE_PROPERTY_UPDATE(renegSeconds, "renegSeconds", toInt)
+            DEFINE_PROPERTY_UPDATE(renegSecondsSet, "renegSecondsSet", toBool)
+            DEFINE_PROPERTY_UPDATE(compLzo, "compLzo", toBool)
+            DEFINE_PROPERTY_UPDATE(protoTcp, "protoTcp", toBool)
+            DEFINE_PROPERTY_UPDATE(dev, "dev", toString)
+            DEFINE_PROPERTY_UPDATE_ENUM(devType, "devType", DevType)
+            DEFINE_PROPERTY_UPDATE(devTypeSet, "devTypeSet", toBool)
+            DEFINE_PROPERTY_UPDATE(tunnelMtu, "tunnelMtu", toInt)
+            DEFINE_PROPERTY_UPDATE(tunnelMtuSet, "tunnelMtuSet", toBool)
+            DEFINE_PROPERTY_UPDATE(fragmentSize, "fragmentSize", toInt)
+            DEFINE_PROPERTY_UPDATE(fragmentSizeSet, "fragmentSizeSet", toBool)
+            DEFINE_PROPERTY_UPDATE(mssFix, "mssFix", toBool)
+            DEFINE_PROPERTY_UPDATE(remoteRandom, "remoteRandom", toBool)
+
+            // Advanced security properties
+
+            DEFINE_PROPERTY_UPDATE_ENUM(cipher, "cipher", Cipher)
+            DEFINE_PROPERTY_UPDATE(keysize, "keysize", toInt)
+            DEFINE_PROPERTY_UPDATE(keysizeSet, "keysizeSet", toBool)
+            DEFINE_PROPERTY_UPDATE_ENUM(auth, "auth", Auth)
+
+            // Advanced TLS auth properties
+
+            DEFINE_PROPERTY_UPDATE(tlsRemote, "tlsRemote", toString)
+            DEFINE_PROPERTY_UPDATE_ENUM(remoteCertTls, "remoteCertTls", TlsType)
+            DEFINE_PROPERTY_UPDATE(remoteCertTlsSet, "remoteCertTlsSet", toBool)
+            DEFINE_PROPERTY_UPDATE(ta, "ta", toString)
+            DEFINE_PROPERTY_UPDATE_ENUM(taDir, "taDir", KeyDir)
+            DEFINE_PROPERTY_UPDATE(taSet, "taSet", toBool)
+
+            // Advanced proxy settings
+
+            DEFINE_PROPERTY_UPDATE_ENUM(proxyType, "proxyType", ProxyType)
+            DEFINE_PROPERTY_UPDATE(proxyServer, "proxyServer", toString)
+            DEFINE_PROPERTY_UPDATE(proxyPort, "proxyPort", toInt)
+            DEFINE_PROPERTY_UPDATE(proxyRetry, "proxyRetry", toBool)
+            DEFINE_PROPERTY_UPDATE(proxyUsername, "proxyUsername", toString)
+            DEFINE_PROPERTY_UPDATE(proxyPassword, "proxyPassword", toString)
+        };
+
+        DISPATCHER.dispatch(*this, name, value);
+    }
+
+    void cacheInitialized()
+    {
+        if (p.isInitialized())
+        {
+            Q_EMIT p.initialized();
+        }
     }
 
 public:
@@ -146,22 +158,27 @@ public:
 };
 
 OpenvpnConnection::OpenvpnConnection(const QDBusObjectPath& path, const QDBusConnection& connection) :
-        VpnConnection(path, connection),
+        OpenvpnConnection(internal::VpnConnectionParameters(path, connection))
+{
+}
+
+OpenvpnConnection::OpenvpnConnection(const internal::VpnConnectionParameters& parameters) :
+        VpnConnection(parameters),
         d(new Priv(*this))
 {
     d->m_openvpnInterface = make_unique<
             ComUbuntuConnectivity1VpnVpnConnectionOpenVpnInterface>(
-            DBusTypes::DBUS_NAME, path.path(), connection);
+            DBusTypes::DBUS_NAME, parameters.path.path(), parameters.connection);
 
-    d->m_propertyCache =
-            make_unique<internal::DBusPropertyCache>(
-                    DBusTypes::DBUS_NAME,
-                    ComUbuntuConnectivity1VpnVpnConnectionOpenVpnInterface::staticInterfaceName(),
-                    path.path(), connection);
+    d->m_propertyCache = parameters.propertyCache(
+            ComUbuntuConnectivity1VpnVpnConnectionOpenVpnInterface::staticInterfaceName());
 
     connect(d->m_propertyCache.get(),
                     &internal::DBusPropertyCache::propertyChanged, d.get(),
                     &Priv::propertyChanged);
+    connect(d->m_propertyCache.get(),
+                    &internal::DBusPropertyCache::initialized, d.get(),
+                    &Priv::cacheInitialized);
 }
 
 OpenvpnConnection::~OpenvpnConnection()
@@ -173,6 +190,11 @@ VpnConnection::Type OpenvpnConnection::type() const
     return Type::OPENVPN;
 }
 
+bool OpenvpnConnection::isInitialized() const
+{
+    return VpnConnection::isInitialized() && d->m_propertyCache->isInitialized();
+}
+
 // Basic properties
 
 DEFINE_PROPERTY_GETTER(ca, "ca", QString, toString)
@@ -109,10 +109,14 @@ public:
 
     OpenvpnConnection(const QDBusObjectPath& path, const QDBusConnection& connection);
 
+    OpenvpnConnection(const internal::VpnConnectionParameters& parameters);
+
     virtual ~OpenvpnConnection();
 
     Type type() const override;
 
+    bool isInitialized() const override;
+
     // Basic properties
 
     Q_PROPERTY(QString ca READ ca WRITE setCa NOTIFY caChanged)
@@ -19,6 +19,8 @@
 
 #include <connectivityqt/pptp-connection.h>
 #include <connectivityqt/internal/dbus-property-cache.h>
+#include <connectivityqt/internal/property-dispatcher.h>
+#include <connectivityqt/internal/vpn-connection-parameters.h>
 #include <dbus-types.h>
 
 #include <PptpConnectionInterface.h>
@@ -50,16 +52,16 @@ void PptpConnection::set##uppername(type value)\
 }
 
 #define DEFINE_PROPERTY_UPDATE(varname, strname, conversion)\
-else if (name == strname)\
+{strname, [](Priv& d, const QVariant& value)\
 {\
-    Q_EMIT p.varname##Changed(value.conversion());\
-}
+    Q_EMIT d.p.varname##Changed(value.conversion());\
+}},
 
 #define DEFINE_PROPERTY_UPDATE_ENUM(varname, strname, type)\
-else if (name == strname)\
+{strname, [](Priv& d, const QVariant& value)\
 {\
-    Q_EMIT p.varname##Changed(static_cast<type>(value.toInt()));\
-}
+    Q_EMIT d.p.varname##Changed(static_cast<type>(value.toInt()));\
+}},
 
 namespace connectivityqt
 {
@@ -77,29 +79,39 @@ public:
 public Q_SLOTS:
     void propertyChanged(const QString& name, const QVariant& value)
     {
-        if (name == "") {}
-
-        // Basic properties
-
-        DEFINE_PROPERTY_UPDATE(gateway, "gateway", toString)
-        DEFINE_PROPERTY_UPDATE(user, "user", toString)
-        DEFINE_PROPERTY_UPDATE(password, "password", toString)
-        DEFINE_PROPERTY_UPDATE(domain, "domain", toString)
-
-        // Advanced properties
-
-        DEFINE_PROPERTY_UPDATE(allowPap, "allowPap", toBool)
-        DEFINE_PROPERTY_UPDATE(allowChap, "allowChap", toBool)
-        DEFINE_PROPERTY_UPDATE(allowMschap, "allowMschap", toBool)
-        DEFINE_PROPERTY_UPDATE(allowMschapv2, "allowMschapv2", toBool)
-        DEFINE_PROPERTY_UPDATE(allowEap, "allowEap", toBool)
-        DEFINE_PROPERTY_UPDATE(requireMppe, "requireMppe", toBool)
-        DEFINE_PROPERTY_UPDATE_ENUM(mppeType, "mppeType", MppeType)
-        DEFINE_PROPERTY_UPDATE(mppeStateful, "mppeStateful", toBool)
-        DEFINE_PROPERTY_UPDATE(bsdCompression, "bsdCompression", toBool)
-        DEFINE_PROPERTY_UPDATE(deflateCompression, "deflateCompression", toBool)
-        DEFINE_PROPERTY_UPDATE(tcpHeaderCompression, "tcpHeaderCompression", toBool)
-        DEFINE_PROPERTY_UPDATE(sendPppEchoPackets, "sendPppEchoPackets", toBool)
+        static const internal::PropertyDispatcher<Priv> DISPATCHER {
+            // Basic properties
+
+            DEFINE_PROPERTY_UPDATE(gateway, "gateway", toString)
+            DEFINE_PROPERTY_UPDATE(user, "user", toString)
+            DEFINE_PROPERTY_UPDATE(password, "password", toString)
+            DEFINE_PROPERTY_UPDATE(domain, "domain", toString)
+
+            // Advanced properties
+
+            DEFINE_PROPERTY_UPDATE(allowPap, "allowPap", toBool)
+            DEFINE_PROPERTY_UPDATE(allowChap, "allowChap", toBool)
+            DEFINE_PROPERTY_UPDATE(allowMschap, "allowMschap", toBool)
+            DEFINE_PROPERTY_UPDATE(allowMschapv2, "allowMschapv2", toBool)
+            DEFINE_PROPERTY_UPDATE(allowEap, "allowEap", toBool)
+            DEFINE_PROPERTY_UPDATE(requireMppe, "requireMppe", toBool)
+            DEFINE_PROPERTY_UPDATE_ENUM(mppeType, "mppeType", MppeType)
+            DEFINE_PROPERTY_UPDATE(mppeStateful, "mppeStateful", toBool)
+            DEFINE_PROPERTY_UPDATE(bsdCompression, "bsdCompression", toBool)
+            DEFINE_PROPERTY_UPDATE(deflateCompression, "deflateCompression", toBool)
+            DEFINE_PROPERTY_UPDATE(tcpHeaderCompression, "tcpHeaderCompression", toBool)
+            DEFINE_PROPERTY_UPDATE(sendPppEchoPackets, "sendPppEchoPackets", toBool)
+        };
+
+        DISPATCHER.dispatch(*this, name, value);
+    }
+
+    void cacheInitialized()
+    {
+        if (p.isInitialized())
+        {
+            Q_EMIT p.initialized();
+        }
     }
 
 public:
@@ -111,22 +123,27 @@ public:
 };
 
 PptpConnection::PptpConnection(const QDBusObjectPath& path, const QDBusConnection& connection) :
-        VpnConnection(path, connection),
+        PptpConnection(internal::VpnConnectionParameters(path, connection))
+{
+}
+
+PptpConnection::PptpConnection(const internal::VpnConnectionParameters& parameters) :
+        VpnConnection(parameters),
         d(new Priv(*this))
 {
     d->m_pptpInterface = make_unique<
             ComUbuntuConnectivity1VpnVpnConnectionPptpInterface>(
-            DBusTypes::DBUS_NAME, path.path(), connection);
+            DBusTypes::DBUS_NAME, parameters.path.path(), parameters.connection);
 
-    d->m_propertyCache =
-            make_unique<internal::DBusPropertyCache>(
-                    DBusTypes::DBUS_NAME,
-                    ComUbuntuConnectivity1VpnVpnConnectionPptpInterface::staticInterfaceName(),
-                    path.path(), connection);
+    d->m_propertyCache = parameters.propertyCache(
+            ComUbuntuConnectivity1VpnVpnConnectionPptpInterface::staticInterfaceName());
 
     connect(d->m_propertyCache.get(),
                     &internal::DBusPropertyCache::propertyChanged, d.get(),
                     &Priv::propertyChanged);
+    connect(d->m_propertyCache.get(),
+                    &internal::DBusPropertyCache::initialized, d.get(),
+                    &Priv::cacheInitialized);
 }
 
 PptpConnection::~PptpConnection()
@@ -138,6 +155,11 @@ VpnConnection::Type PptpConnection::type() const
     return Type::PPTP;
 }
 
+bool PptpConnection::isInitialized() const
+{
+    return VpnConnection::isInitialized() && d->m_propertyCache->isInitialized();
+}
+
 // Basic properties
 
 DEFINE_PROPERTY_GETTER(gateway, "gateway", QString, toString)
@@ -41,10 +41,14 @@ public:
 
     PptpConnection(const QDBusObjectPath& path, const QDBusConnection& connection);
 
+    PptpConnection(const internal::VpnConnectionParameters& parameters);
+
     virtual ~PptpConnection();
 
     Type type() const override;
 
+    bool isInitialized() const override;
+
     // Basic properties
 
     Q_PROPERTY(QString gateway READ gateway WRITE setGateway NOTIFY gatewayChanged)
@@ -18,6 +18,7 @@
  */
 
 #include <connectivityqt/internal/dbus-property-cache.h>
+#include <connectivityqt/internal/property-dispatcher.h>
 #include <connectivityqt/sim.h>
 #include <dbus-types.h>
 
@@ -41,25 +42,47 @@ public:
 public Q_SLOTS:
     void propertyChanged(const QString& name, const QVariant& value)
     {
-        if (name == "Locked")
+        static const internal::PropertyDispatcher<Priv> DISPATCHER {
+            {"Locked", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.lockedChanged(value.toBool());
+            }},
+            {"Present", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.presentChanged(value.toBool());
+            }},
+            {"DataRoamingEnabled", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.dataRoamingEnabledChanged(value.toBool());
+            }},
+            {"Imsi", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.imsiChanged(value.toString());
+            }},
+            {"PrimaryPhoneNumber", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.primaryPhoneNumberChanged(value.toString());
+            }},
+            {"Mcc", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.mccChanged(value.toString());
+            }},
+            {"Mnc", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.mncChanged(value.toString());
+            }},
+            {"PreferredLanguages", [](Priv& d, const QVariant&)
+            {
+                Q_EMIT d.p.preferredLanguagesChanged();
+            }},
+            {"Iccid", [](Priv&, const QVariant&)
+            {
+                // Constant, only ever set when the properties are first read
+            }},
+        };
+
+        if (!DISPATCHER.dispatch(*this, name, value))
         {
-            Q_EMIT p.lockedChanged(value.toBool());
-        } else if (name == "Present")
-        {
-            Q_EMIT p.presentChanged(value.toBool());
-        } else if (name == "DataRoamingEnabled")
-        {
-            Q_EMIT p.dataRoamingEnabledChanged(value.toBool());
-        } else if (name == "Imsi")
-        {
-            Q_EMIT p.imsiChanged(value.toString());
-        } else if (name == "PrimaryPhoneNumber")
-        {
-            Q_EMIT p.primaryPhoneNumberChanged(value.toString());
-        } else if (name == "PreferredLanguages")
-        {
-            Q_EMIT p.preferredLanguagesChanged();
-        } else {
             qWarning() << "connectivityqt::Sim::Priv::propertyChanged(): "
                        << "Unexpected property: " << name;
         }
@@ -89,6 +112,9 @@ Sim::Sim(const QDBusObjectPath& path, const QDBusConnection& connection, QObject
     connect(d->m_propertyCache.get(),
                 &internal::DBusPropertyCache::propertyChanged, d.get(),
                 &Priv::propertyChanged);
+    connect(d->m_propertyCache.get(),
+                &internal::DBusPropertyCache::initialized, this,
+                &Sim::initialized);
 }
 
 Sim::~Sim()
@@ -100,6 +126,11 @@ QDBusObjectPath Sim::path() const
     return QDBusObjectPath(d->m_simInterface->path());
 }
 
+bool Sim::isInitialized() const
+{
+    return d->m_propertyCache->isInitialized();
+}
+
 QString Sim::iccid() const
 {
     return d->m_propertyCache->get("Iccid").toString();
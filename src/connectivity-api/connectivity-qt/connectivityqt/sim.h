@@ -70,6 +70,8 @@ public:
     bool dataRoamingEnabled() const;
     void setDataRoamingEnabled(bool value);
 
+    bool isInitialized() const;
+
 public Q_SLOTS:
 
     void unlock();
@@ -83,6 +85,7 @@ Q_SIGNALS:
     void mccChanged(const QString &value);
     void mncChanged(const QString &value);
     void preferredLanguagesChanged();
+    void initialized();
 
 protected:
     class Priv;
@@ -22,6 +22,7 @@
 #include "internal/sims-list-model-parameters.h"
 
 #include <QDebug>
+#include <QHash>
 
 using namespace std;
 
@@ -47,6 +48,10 @@ public:
         {
             current << m->path();
         }
+        for (const auto& m: m_pendingSims)
+        {
+            current << m->path();
+        }
 
         auto toRemove(current);
         toRemove.subtract(paths);
@@ -56,6 +61,7 @@ public:
 
         QMutableListIterator<Sim::SPtr> i(m_sims);
         int idx = 0;
+        bool removed = false;
         while (i.hasNext())
         {
             auto sim(i.next());
@@ -63,92 +69,137 @@ public:
             {
                 p.beginRemoveRows(QModelIndex(), idx, idx);
                 i.remove();
+                m_rows.remove(sim.get());
                 p.endRemoveRows();
+                removed = true;
             }
             else
             {
                 ++idx;
             }
         }
+        if (removed)
+        {
+            updateRows();
+        }
 
-        if (!toAdd.isEmpty())
+        QMutableHashIterator<QObject*, Sim::SPtr> j(m_pendingSims);
+        while (j.hasNext())
         {
-            p.beginInsertRows(QModelIndex(), m_sims.size(), m_sims.size() + toAdd.size() - 1);
-            for (const auto& path: toAdd)
+            if (toRemove.contains(j.next().value()->path()))
             {
-                auto sim = std::make_shared<Sim>(path, m_propertyCache->connection(), nullptr);
-                m_objectOwner(sim.get());
-                m_sims << sim;
-                connect(sim.get(), &Sim::lockedChanged, this, &Priv::lockedChanged);
-                connect(sim.get(), &Sim::presentChanged, this, &Priv::presentChanged);
-                connect(sim.get(), &Sim::dataRoamingEnabledChanged, this, &Priv::dataRoamingEnabledChanged);
-                connect(sim.get(), &Sim::imsiChanged, this, &Priv::imsiChanged);
-                connect(sim.get(), &Sim::primaryPhoneNumberChanged, this, &Priv::primaryPhoneNumberChanged);
-                connect(sim.get(), &Sim::mccChanged, this, &Priv::mccChanged);
-                connect(sim.get(), &Sim::mncChanged, this, &Priv::mncChanged);
-                connect(sim.get(), &Sim::preferredLanguagesChanged, this, &Priv::preferredLanguagesChanged);
+                j.remove();
+            }
+        }
+
+        // SIMs only get a row once their properties have arrived
+        for (const auto& path: toAdd)
+        {
+            auto sim = std::make_shared<Sim>(path, m_propertyCache->connection(), nullptr);
+            m_objectOwner(sim.get());
+            connect(sim.get(), &Sim::lockedChanged, this, &Priv::lockedChanged);
+            connect(sim.get(), &Sim::presentChanged, this, &Priv::presentChanged);
+            connect(sim.get(), &Sim::dataRoamingEnabledChanged, this, &Priv::dataRoamingEnabledChanged);
+            connect(sim.get(), &Sim::imsiChanged, this, &Priv::imsiChanged);
+            connect(sim.get(), &Sim::primaryPhoneNumberChanged, this, &Priv::primaryPhoneNumberChanged);
+            connect(sim.get(), &Sim::mccChanged, this, &Priv::mccChanged);
+            connect(sim.get(), &Sim::mncChanged, this, &Priv::mncChanged);
+            connect(sim.get(), &Sim::preferredLanguagesChanged, this, &Priv::preferredLanguagesChanged);
+            connect(sim.get(), &Sim::initialized, this, &Priv::simInitialized);
+            if (sim->isInitialized())
+            {
+                insertSim(sim);
+            }
+            else
+            {
+                m_pendingSims.insert(sim.get(), sim);
             }
-            p.endInsertRows();
         }
 
         Q_EMIT p.simsUpdated();
     }
 
+    void insertSim(Sim::SPtr sim)
+    {
+        int row = m_sims.size();
+        p.beginInsertRows(QModelIndex(), row, row);
+        m_sims << sim;
+        m_rows.insert(sim.get(), row);
+        p.endInsertRows();
+    }
+
+    void simDataChanged(QObject* o, int role)
+    {
+        auto idx = findSim(o);
+        if (idx.isValid())
+        {
+            p.dataChanged(idx, idx, {role});
+        }
+    }
+
+    void updateRows()
+    {
+        m_rows.clear();
+        for (int row = 0; row < m_sims.size(); ++row)
+        {
+            m_rows.insert(m_sims.at(row).get(), row);
+        }
+    }
+
     QModelIndex findSim(QObject* o)
     {
-        auto sim = qobject_cast<Sim*>(o);
-        for (auto i = m_sims.constBegin(); i != m_sims.constEnd(); ++i)
+        auto it = m_rows.constFind(o);
+        if (it == m_rows.constEnd())
         {
-            if (i->get() == sim)
-            {
-                return p.index(std::distance(m_sims.constBegin(), i));
-            }
+            return QModelIndex();
         }
-        return QModelIndex();
+        return p.index(*it);
     }
 
 public Q_SLOTS:
     void lockedChanged()
     {
-        auto idx = findSim(sender());
-        p.dataChanged(idx, idx, {SimsListModel::Roles::RoleLocked});
+        simDataChanged(sender(), SimsListModel::Roles::RoleLocked);
     }
 
     void presentChanged()
     {
-        auto idx = findSim(sender());
-        p.dataChanged(idx, idx, {SimsListModel::Roles::RolePresent});
+        simDataChanged(sender(), SimsListModel::Roles::RolePresent);
     }
     void dataRoamingEnabledChanged()
     {
-        auto idx = findSim(sender());
-        p.dataChanged(idx, idx, {SimsListModel::Roles::RoleDataRoamingEnabled});
+        simDataChanged(sender(), SimsListModel::Roles::RoleDataRoamingEnabled);
     }
     void imsiChanged()
     {
-        auto idx = findSim(sender());
-        p.dataChanged(idx, idx, {SimsListModel::Roles::RoleImsi});
+        simDataChanged(sender(), SimsListModel::Roles::RoleImsi);
     }
     void primaryPhoneNumberChanged()
     {
-        auto idx = findSim(sender());
-        p.dataChanged(idx, idx, {SimsListModel::Roles::RolePrimaryPhoneNumber});
+        simDataChanged(sender(), SimsListModel::Roles::RolePrimaryPhoneNumber);
     }
     void mccChanged()
     {
-        auto idx = findSim(sender());
-        p.dataChanged(idx, idx, {SimsListModel::Roles::RoleMcc});
+        simDataChanged(sender(), SimsListModel::Roles::RoleMcc);
     }
     void mncChanged()
     {
-        auto idx = findSim(sender());
-        p.dataChanged(idx, idx, {SimsListModel::Roles::RoleMnc});
+        simDataChanged(sender(), SimsListModel::Roles::RoleMnc);
     }
 
     void preferredLanguagesChanged()
     {
-        auto idx = findSim(sender());
-        p.dataChanged(idx, idx, {SimsListModel::Roles::RolePreferredLanguages});
+        simDataChanged(sender(), SimsListModel::Roles::RolePreferredLanguages);
+    }
+
+    void simInitialized()
+    {
+        auto sim = m_pendingSims.take(sender());
+        if (sim)
+        {
+            insertSim(sim);
+            Q_EMIT p.simsUpdated();
+        }
     }
 
     void propertyChanged(const QString& name, const QVariant& value)
@@ -166,6 +217,8 @@ public:
     function<void(QObject*)> m_objectOwner;
     QList<QDBusObjectPath> m_dbus_paths;
     QList<Sim::SPtr> m_sims;
+    QHash<QObject*, Sim::SPtr> m_pendingSims;
+    QHash<QObject*, int> m_rows;
 
     shared_ptr<ComUbuntuConnectivity1PrivateInterface> m_writeInterface;
     internal::DBusPropertyCache::SPtr m_propertyCache;
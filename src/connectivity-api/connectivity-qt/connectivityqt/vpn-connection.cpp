@@ -18,6 +18,8 @@
  */
 
 #include <connectivityqt/internal/dbus-property-cache.h>
+#include <connectivityqt/internal/property-dispatcher.h>
+#include <connectivityqt/internal/vpn-connection-parameters.h>
 #include <connectivityqt/vpn-connection.h>
 #include <dbus-types.h>
 
@@ -41,21 +43,33 @@ public:
 public Q_SLOTS:
     void propertyChanged(const QString& name, const QVariant& value)
     {
-        if (name == "id")
-        {
-            Q_EMIT p.idChanged(value.toString());
-        }
-        else if (name == "neverDefault")
-        {
-            Q_EMIT p.neverDefaultChanged(value.toBool());
-        }
-        else if (name == "active")
-        {
-            Q_EMIT p.activeChanged(value.toBool());
-        }
-        else if (name == "activatable")
+        static const internal::PropertyDispatcher<Priv> DISPATCHER {
+            {"id", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.idChanged(value.toString());
+            }},
+            {"neverDefault", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.neverDefaultChanged(value.toBool());
+            }},
+            {"active", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.activeChanged(value.toBool());
+            }},
+            {"activatable", [](Priv& d, const QVariant& value)
+            {
+                Q_EMIT d.p.activatableChanged(value.toBool());
+            }},
+        };
+
+        DISPATCHER.dispatch(*this, name, value);
+    }
+
+    void cacheInitialized()
+    {
+        if (p.isInitialized())
         {
-            Q_EMIT p.activatableChanged(value.toBool());
+            Q_EMIT p.initialized();
         }
     }
 
@@ -68,21 +82,26 @@ public:
 };
 
 VpnConnection::VpnConnection(const QDBusObjectPath& path, const QDBusConnection& connection, QObject* parent) :
+        VpnConnection(internal::VpnConnectionParameters(path, connection), parent)
+{
+}
+
+VpnConnection::VpnConnection(const internal::VpnConnectionParameters& parameters, QObject* parent) :
         QObject(parent), d(new Priv(*this))
 {
     d->m_vpnInterface = make_unique<
             ComUbuntuConnectivity1VpnVpnConnectionInterface>(
-            DBusTypes::DBUS_NAME, path.path(), connection);
+            DBusTypes::DBUS_NAME, parameters.path.path(), parameters.connection);
 
-    d->m_propertyCache =
-            make_unique<internal::DBusPropertyCache>(
-                    DBusTypes::DBUS_NAME,
-                    ComUbuntuConnectivity1VpnVpnConnectionInterface::staticInterfaceName(),
-                    path.path(), connection);
+    d->m_propertyCache = parameters.propertyCache(
+            ComUbuntuConnectivity1VpnVpnConnectionInterface::staticInterfaceName());
 
     connect(d->m_propertyCache.get(),
                 &internal::DBusPropertyCache::propertyChanged, d.get(),
                 &Priv::propertyChanged);
+    connect(d->m_propertyCache.get(),
+                &internal::DBusPropertyCache::initialized, d.get(),
+                &Priv::cacheInitialized);
 }
 
 VpnConnection::~VpnConnection()
@@ -94,6 +113,11 @@ QDBusObjectPath VpnConnection::path() const
     return QDBusObjectPath(d->m_vpnInterface->path());
 }
 
+bool VpnConnection::isInitialized() const
+{
+    return d->m_propertyCache->isInitialized();
+}
+
 QString VpnConnection::id() const
 {
     return d->m_propertyCache->get("id").toString();
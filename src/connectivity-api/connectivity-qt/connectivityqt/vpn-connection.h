@@ -27,6 +27,10 @@
 
 namespace connectivityqt
 {
+namespace internal
+{
+struct VpnConnectionParameters;
+}
 
 class Q_DECL_EXPORT VpnConnection : public QObject
 {
@@ -45,6 +49,8 @@ public:
 
     VpnConnection(const QDBusObjectPath& path, const QDBusConnection& connection, QObject* parent = 0);
 
+    VpnConnection(const internal::VpnConnectionParameters& parameters, QObject* parent = 0);
+
     virtual ~VpnConnection();
 
     Q_PROPERTY(QDBusObjectPath path READ path)
@@ -65,6 +71,8 @@ public:
     Q_PROPERTY(Type type READ type)
     virtual Type type() const = 0;
 
+    virtual bool isInitialized() const;
+
 public Q_SLOTS:
     void setId(const QString& id) const;
 
@@ -85,6 +93,8 @@ Q_SIGNALS:
 
     void remove() const;
 
+    void initialized();
+
 protected:
     class Priv;
     std::shared_ptr<Priv> d;
@@ -18,17 +18,26 @@
  */
 
 #include <connectivityqt/internal/vpn-connection-list-model-parameters.h>
+#include <connectivityqt/internal/vpn-connection-parameters.h>
 #include <connectivityqt/openvpn-connection.h>
 #include <connectivityqt/pptp-connection.h>
 #include <connectivityqt/vpn-connections-list-model.h>
 
+#include <OpenVpnConnectionInterface.h>
+#include <PptpConnectionInterface.h>
 #include <VpnConnectionInterface.h>
 #include <dbus-types.h>
 
 #include <QDBusArgument>
+#include <QDBusContext>
+#include <QDBusMessage>
 #include <QDBusObjectPath>
 #include <QDebug>
+#include <QHash>
 #include <QList>
+#include <QSet>
+
+#include <algorithm>
 
 using namespace std;
 
@@ -37,7 +46,7 @@ namespace connectivityqt
 
 using namespace internal;
 
-class VpnConnectionsListModel::Priv: public QObject
+class VpnConnectionsListModel::Priv: public QObject, protected QDBusContext
 {
     Q_OBJECT
 
@@ -53,20 +62,27 @@ public:
         qvariant_cast<QDBusArgument>(value) >> tmp;
         auto paths = tmp.toSet();
 
-        QSet<QDBusObjectPath> current;
+        QSet<QDBusObjectPath> current(m_resolving);
         for (const auto& connection: m_vpnConnections)
         {
             current << connection->path();
         }
+        for (const auto& connection: m_pendingVpnConnections)
+        {
+            current << connection->path();
+        }
 
         auto toRemove(current);
         toRemove.subtract(paths);
 
+        // Anything we failed to resolve before is not current, so gets
+        // another go
         auto toAdd(paths);
         toAdd.subtract(current);
 
         QMutableListIterator<VpnConnection::SPtr> i(m_vpnConnections);
         int idx = 0;
+        bool removed = false;
         while (i.hasNext())
         {
             auto vpnConnection(i.next());
@@ -74,59 +90,277 @@ public:
             {
                 p.beginRemoveRows(QModelIndex(), idx, idx);
                 i.remove();
+                m_rows.remove(vpnConnection.get());
                 p.endRemoveRows();
+                removed = true;
             }
             else
             {
                 ++idx;
             }
         }
+        if (removed)
+        {
+            updateRows();
+        }
 
-        if (!toAdd.isEmpty())
+        QMutableHashIterator<QObject*, VpnConnection::SPtr> j(m_pendingVpnConnections);
+        while (j.hasNext())
         {
-            p.beginInsertRows(QModelIndex(), m_vpnConnections.size(), m_vpnConnections.size() + toAdd.size() - 1);
-            for (const auto& path: toAdd)
+            auto path = j.next().value()->path();
+            if (toRemove.contains(path))
             {
-                ComUbuntuConnectivity1VpnVpnConnectionInterface vpnInterface(
-                        DBusTypes::DBUS_NAME, path.path(), m_propertyCache->connection());
+                m_addRequested.remove(path);
+                j.remove();
+            }
+        }
 
-                VpnConnection::SPtr vpnConnection;
-                switch(vpnInterface.type())
-                {
-                    case VpnConnection::Type::OPENVPN:
-                        vpnConnection.reset(new OpenvpnConnection(path, m_propertyCache->connection()),
-                                [](QObject* self){self->deleteLater();});
-                        break;
-                    default:
-                        vpnConnection.reset(new PptpConnection(path, m_propertyCache->connection()),
-                                [](QObject* self){self->deleteLater();});
-                        break;
-                }
-                if (vpnConnection)
+        for (const auto& path: toRemove)
+        {
+            m_resolving.remove(path);
+            m_addRequested.remove(path);
+            m_heldCaches.remove(path.path());
+        }
+
+        if (!toAdd.isEmpty())
+        {
+            resolveTypes(toAdd);
+        }
+    }
+
+    /**
+     * Looks up the type of every new connection with a single call to the
+     * service's object manager, rather than one blocking call per path.
+     * The reply carries every object's properties too, so the connections
+     * are built from it without fetching them again.
+     */
+    void resolveTypes(const QSet<QDBusObjectPath>& paths)
+    {
+        m_resolving.unite(paths);
+
+        // The connections' property caches only start listening once the
+        // reply is in. Until then, hold a match rule for their paths and
+        // keep what it catches, so no change sent after the reply is lost.
+        auto connection = m_propertyCache->connection();
+        for (const auto& path: paths)
+        {
+            m_held.insert(path.path(), {});
+            connection.connect(QString(), path.path(), "org.freedesktop.DBus.Properties",
+                               "PropertiesChanged", this,
+                               SLOT(holdPropertiesChanged(const QString&, const QVariantMap&, const QStringList&)));
+        }
+
+        auto message = QDBusMessage::createMethodCall(
+                DBusTypes::DBUS_NAME, DBusTypes::OBJECT_MANAGER_PATH,
+                "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+        auto watcher = new QDBusPendingCallWatcher(
+                connection.asyncCall(message), this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this,
+                [this, paths](QDBusPendingCallWatcher* call)
                 {
-                    m_objectOwner(vpnConnection.get());
-                    m_vpnConnections << vpnConnection;
-                    connect(vpnConnection.get(), &VpnConnection::idChanged, this, &Priv::connectionIdChanged);
-                    connect(vpnConnection.get(), &VpnConnection::activeChanged, this, &Priv::connectionActiveChanged);
-                    connect(vpnConnection.get(), &VpnConnection::activatableChanged, this, &Priv::connectionActivatableChanged);
-                    connect(vpnConnection.get(), &VpnConnection::remove, this, &Priv::removeRequested);
-                }
+                    typesResolved(paths, call);
+                });
+    }
+
+    void typesResolved(const QSet<QDBusObjectPath>& paths, QDBusPendingCallWatcher* call)
+    {
+        call->deleteLater();
+
+        QDBusPendingReply<QManagedObjectMap> reply = *call;
+        if (reply.isError())
+        {
+            qWarning() << __PRETTY_FUNCTION__ << reply.error().message();
+        }
+        auto objects = reply.isError() ? QManagedObjectMap() : reply.value();
+
+        auto connection = m_propertyCache->connection();
+        for (const auto& path: paths)
+        {
+            auto held = m_held.take(path.path());
+
+            // Dropped again while we were waiting
+            if (!m_resolving.contains(path))
+            {
+                continue;
+            }
+
+            VpnConnectionParameters parameters(path, connection);
+            parameters.owner = reply.reply().service();
+            parameters.interfaces = objects.value(path);
+            parameters.createdCaches = make_shared<QList<QPointer<DBusPropertyCache>>>();
+
+            if (parameters.interfaces.contains(ComUbuntuConnectivity1VpnVpnConnectionOpenVpnInterface::staticInterfaceName()))
+            {
+                addVpnConnection(VpnConnection::Type::OPENVPN, parameters);
+            }
+            else if (parameters.interfaces.contains(ComUbuntuConnectivity1VpnVpnConnectionPptpInterface::staticInterfaceName()))
+            {
+                addVpnConnection(VpnConnection::Type::PPTP, parameters);
+            }
+            else
+            {
+                // Not exported yet, or the call failed, so ask the object
+                resolveType(path);
+                continue;
+            }
+
+            for (const auto& heldSignal: held)
+            {
+                replay(*parameters.createdCaches, heldSignal);
             }
-            p.endInsertRows();
+            m_heldCaches.insert(path.path(), parameters.createdCaches);
+        }
+
+        // The connections have their own match rules now. Signals already
+        // matched to ours still arrive, and go on to the connections.
+        for (const auto& path: paths)
+        {
+            connection.disconnect(QString(), path.path(), "org.freedesktop.DBus.Properties",
+                                  "PropertiesChanged", this,
+                                  SLOT(holdPropertiesChanged(const QString&, const QVariantMap&, const QStringList&)));
         }
     }
 
-    QModelIndex findVpnConnection(QObject* o)
+    struct HeldSignal
+    {
+        QString sender;
+        QString interface;
+        QVariantMap changed;
+        QStringList invalidated;
+    };
+
+    static void replay(const QList<QPointer<DBusPropertyCache>>& caches, const HeldSignal& heldSignal)
+    {
+        for (const auto& cache: caches)
+        {
+            if (cache)
+            {
+                cache->replayPropertiesChanged(heldSignal.sender, heldSignal.interface,
+                                               heldSignal.changed, heldSignal.invalidated);
+            }
+        }
+    }
+
+    void resolveType(const QDBusObjectPath& path)
+    {
+        auto message = QDBusMessage::createMethodCall(
+                DBusTypes::DBUS_NAME, path.path(),
+                "org.freedesktop.DBus.Properties", "Get");
+        message << ComUbuntuConnectivity1VpnVpnConnectionInterface::staticInterfaceName()
+                << QString("type");
+        auto watcher = new QDBusPendingCallWatcher(
+                m_propertyCache->connection().asyncCall(message), this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this,
+                [this, path](QDBusPendingCallWatcher* call)
+                {
+                    typeResolved(path, call);
+                });
+    }
+
+    void typeResolved(const QDBusObjectPath& path, QDBusPendingCallWatcher* call)
     {
-        auto vpnConnection = qobject_cast<VpnConnection*>(o);
-        for (auto i = m_vpnConnections.constBegin(); i != m_vpnConnections.constEnd(); ++i)
+        call->deleteLater();
+
+        if (!m_resolving.contains(path))
+        {
+            return;
+        }
+
+        QDBusPendingReply<QDBusVariant> reply = *call;
+        VpnConnectionParameters parameters(path, m_propertyCache->connection());
+        if (!reply.isError())
         {
-            if (i->get() == vpnConnection)
+            auto type = reply.value().variant().toInt();
+            if (type == VpnConnection::Type::OPENVPN || type == VpnConnection::Type::PPTP)
             {
-                return p.index(std::distance(m_vpnConnections.constBegin(), i));
+                addVpnConnection(static_cast<VpnConnection::Type>(type), parameters);
+                return;
             }
         }
-        return QModelIndex();
+
+        // Try again when the list of connections next changes
+        qWarning() << __PRETTY_FUNCTION__ << "Unknown type for VPN connection:" << path.path()
+                << reply.error().message();
+        m_resolving.remove(path);
+        m_addRequested.remove(path);
+    }
+
+    void addVpnConnection(VpnConnection::Type type, const VpnConnectionParameters& parameters)
+    {
+        m_resolving.remove(parameters.path);
+
+        VpnConnection::SPtr vpnConnection;
+        switch (type)
+        {
+            case VpnConnection::Type::OPENVPN:
+                vpnConnection.reset(new OpenvpnConnection(parameters),
+                        [](QObject* self){self->deleteLater();});
+                break;
+            case VpnConnection::Type::PPTP:
+                vpnConnection.reset(new PptpConnection(parameters),
+                        [](QObject* self){self->deleteLater();});
+                break;
+        }
+
+        m_objectOwner(vpnConnection.get());
+        connect(vpnConnection.get(), &VpnConnection::idChanged, this, &Priv::connectionIdChanged);
+        connect(vpnConnection.get(), &VpnConnection::activeChanged, this, &Priv::connectionActiveChanged);
+        connect(vpnConnection.get(), &VpnConnection::activatableChanged, this, &Priv::connectionActivatableChanged);
+        connect(vpnConnection.get(), &VpnConnection::remove, this, &Priv::removeRequested);
+        connect(vpnConnection.get(), &VpnConnection::initialized, this, &Priv::connectionInitialized);
+
+        // Connections only get a row once their properties have arrived
+        if (vpnConnection->isInitialized())
+        {
+            insertVpnConnection(vpnConnection);
+        }
+        else
+        {
+            m_pendingVpnConnections.insert(vpnConnection.get(), vpnConnection);
+        }
+    }
+
+    void insertVpnConnection(VpnConnection::SPtr vpnConnection)
+    {
+        int row = m_vpnConnections.size();
+        p.beginInsertRows(QModelIndex(), row, row);
+        m_vpnConnections << vpnConnection;
+        m_rows.insert(vpnConnection.get(), row);
+        p.endInsertRows();
+
+        // An add request can complete before the connection's properties do
+        if (m_addRequested.remove(vpnConnection->path()))
+        {
+            Q_EMIT p.addFinished(vpnConnection.get());
+        }
+    }
+
+    void updateRows()
+    {
+        m_rows.clear();
+        for (int row = 0; row < m_vpnConnections.size(); ++row)
+        {
+            m_rows.insert(m_vpnConnections.at(row).get(), row);
+        }
+    }
+
+    void connectionDataChanged(QObject* o, int role)
+    {
+        auto idx = findVpnConnection(o);
+        if (idx.isValid())
+        {
+            p.dataChanged(idx, idx, {role});
+        }
+    }
+
+    QModelIndex findVpnConnection(QObject* o)
+    {
+        auto it = m_rows.constFind(o);
+        if (it == m_rows.constEnd())
+        {
+            return QModelIndex();
+        }
+        return p.index(*it);
     }
 
     void remove(const VpnConnection& connection)
@@ -137,22 +371,45 @@ public:
     }
 
 public Q_SLOTS:
+    void holdPropertiesChanged(const QString& interface, const QVariantMap& changed,
+                               const QStringList& invalidated)
+    {
+        auto path = message().path();
+        HeldSignal heldSignal{message().service(), interface, changed, invalidated};
+
+        auto caches = m_heldCaches.value(path);
+        if (caches)
+        {
+            replay(*caches, heldSignal);
+        }
+        else if (m_held.contains(path))
+        {
+            m_held[path] << heldSignal;
+        }
+    }
+
     void connectionIdChanged(const QString&)
     {
-        auto idx = findVpnConnection(sender());
-        p.dataChanged(idx, idx, {VpnConnectionsListModel::Roles::RoleId});
+        connectionDataChanged(sender(), VpnConnectionsListModel::Roles::RoleId);
     }
 
     void connectionActiveChanged(bool)
     {
-        auto idx = findVpnConnection(sender());
-        p.dataChanged(idx, idx, {VpnConnectionsListModel::Roles::RoleActive});
+        connectionDataChanged(sender(), VpnConnectionsListModel::Roles::RoleActive);
     }
 
     void connectionActivatableChanged(bool)
     {
-        auto idx = findVpnConnection(sender());
-        p.dataChanged(idx, idx, {VpnConnectionsListModel::Roles::RoleActivatable});
+        connectionDataChanged(sender(), VpnConnectionsListModel::Roles::RoleActivatable);
+    }
+
+    void connectionInitialized()
+    {
+        auto vpnConnection = m_pendingVpnConnections.take(sender());
+        if (vpnConnection)
+        {
+            insertVpnConnection(vpnConnection);
+        }
     }
 
     void propertyChanged(const QString& name, const QVariant& value)
@@ -186,6 +443,13 @@ public Q_SLOTS:
             {
                 Q_EMIT p.addFinished(connection.get());
             }
+            else if (m_resolving.contains(path)
+                    || std::any_of(m_pendingVpnConnections.constBegin(),
+                                   m_pendingVpnConnections.constEnd(),
+                                   [&path](const VpnConnection::SPtr& tmp) {return tmp->path() == path;}))
+            {
+                m_addRequested << path;
+            }
             else
             {
                 qWarning() << __PRETTY_FUNCTION__ << "New connection with path:" << path.path() << " could not be found";
@@ -223,6 +487,20 @@ public:
     DBusPropertyCache::SPtr m_propertyCache;
 
     QList<VpnConnection::SPtr> m_vpnConnections;
+
+    QHash<QObject*, int> m_rows;
+
+    QHash<QObject*, VpnConnection::SPtr> m_pendingVpnConnections;
+
+    QSet<QDBusObjectPath> m_resolving;
+
+    QSet<QDBusObjectPath> m_addRequested;
+
+    // Signals caught for paths waiting on GetManagedObjects, by path
+    QHash<QString, QList<HeldSignal>> m_held;
+
+    // Caches built from GetManagedObjects, for signals caught after it
+    QHash<QString, shared_ptr<QList<QPointer<DBusPropertyCache>>>> m_heldCaches;
 };
 
 VpnConnectionsListModel::VpnConnectionsListModel(const internal::VpnConnectionsListModelParameters& parameters) :
@@ -24,10 +24,24 @@
 #include <connectivity-service/dbus-vpn-connection.h>
 #include <connectivity-service/dbus-openvpn-connection.h>
 #include <connectivity-service/dbus-pptp-connection.h>
+#include <nmofono/connectivity-service-settings.h>
+#include <DiagnosticsAdaptor.h>
+#include <ModemAdaptor.h>
 #include <NetworkingStatusAdaptor.h>
 #include <NetworkingStatusPrivateAdaptor.h>
+#include <ObjectManagerAdaptor.h>
+#include <SimAdaptor.h>
 #include <dbus-types.h>
+#include <status-snapshot/writer.h>
 #include <util/dbus-utils.h>
+#include <util/trace.h>
+#include <util/wakeups.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <system_error>
 
 using namespace nmofono;
 using namespace nmofono::vpn;
@@ -36,6 +50,65 @@ using namespace std;
 namespace connectivity_service
 {
 
+namespace
+{
+enum class Property
+{
+    Limitations,
+    Status,
+    WifiEnabled,
+    FlightMode,
+    FlightModeSwitchEnabled,
+    WifiSwitchEnabled,
+    HotspotSwitchEnabled,
+    ModemAvailable,
+    HotspotEnabled,
+    HotspotSsid,
+    HotspotStored,
+    HotspotMode
+};
+
+constexpr DBusUtils::PropertyDescriptor<ConnectivityService> PROPERTIES[] =
+{
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::Limitations, "Limitations", limitations),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::Status, "Status", status),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::WifiEnabled, "WifiEnabled", wifiEnabled),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::FlightMode, "FlightMode", flightMode),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::FlightModeSwitchEnabled, "FlightModeSwitchEnabled", flightModeSwitchEnabled),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::WifiSwitchEnabled, "WifiSwitchEnabled", wifiSwitchEnabled),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::HotspotSwitchEnabled, "HotspotSwitchEnabled", hotspotSwitchEnabled),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::ModemAvailable, "ModemAvailable", modemAvailable),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::HotspotEnabled, "HotspotEnabled", hotspotEnabled),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::HotspotSsid, "HotspotSsid", hotspotSsid),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::HotspotStored, "HotspotStored", hotspotStored),
+    DBUS_UTILS_PROPERTY(ConnectivityService, Property::HotspotMode, "HotspotMode", hotspotMode)
+};
+static_assert(DBusUtils::propertiesInOrder(PROPERTIES), "NetworkingStatus property table out of order");
+
+enum class PrivateProperty
+{
+    HotspotPassword,
+    HotspotAuth,
+    VpnConnections,
+    MobileDataEnabled,
+    SimForMobileData,
+    Modems,
+    Sims
+};
+
+constexpr DBusUtils::PropertyDescriptor<PrivateService> PRIVATE_PROPERTIES[] =
+{
+    DBUS_UTILS_PROPERTY(PrivateService, PrivateProperty::HotspotPassword, "HotspotPassword", hotspotPassword),
+    DBUS_UTILS_PROPERTY(PrivateService, PrivateProperty::HotspotAuth, "HotspotAuth", hotspotAuth),
+    DBUS_UTILS_PROPERTY(PrivateService, PrivateProperty::VpnConnections, "VpnConnections", vpnConnections),
+    DBUS_UTILS_PROPERTY(PrivateService, PrivateProperty::MobileDataEnabled, "MobileDataEnabled", mobileDataEnabled),
+    DBUS_UTILS_PROPERTY(PrivateService, PrivateProperty::SimForMobileData, "SimForMobileData", simForMobileData),
+    DBUS_UTILS_PROPERTY(PrivateService, PrivateProperty::Modems, "Modems", modems),
+    DBUS_UTILS_PROPERTY(PrivateService, PrivateProperty::Sims, "Sims", sims)
+};
+static_assert(DBusUtils::propertiesInOrder(PRIVATE_PROPERTIES), "NetworkingStatus private property table out of order");
+}
+
 class ConnectivityService::Private : public QObject
 {
     Q_OBJECT
@@ -55,26 +128,81 @@ public:
 
     shared_ptr<PrivateService> m_privateService;
 
+    shared_ptr<ObjectManagerService> m_objectManager;
+
+    shared_ptr<DiagnosticsService> m_diagnostics;
+
+    DBusUtils::PropertyNotifier<ConnectivityService> m_properties;
+
+    shared_ptr<DBusUtils::PropertyNotifier<PrivateService>> m_privateProperties;
+
     QStringList m_limitations;
 
     QString m_status;
 
     QMap<QString, QDBusMessage> m_addQueue;
 
+    status_snapshot::Writer::UPtr m_snapshot;
+
     Private(ConnectivityService& parent, const QDBusConnection& connection) :
-        p(parent), m_connection(connection)
+        p(parent), m_connection(connection),
+        m_properties(p, PROPERTIES, m_connection, DBusTypes::SERVICE_PATH,
+                     DBusTypes::SERVICE_INTERFACE)
+    {
+    }
+
+    void notifyProperties(std::initializer_list<Property> properties)
     {
+        m_properties.notify(properties);
+        publishSnapshot();
     }
 
-    void notifyProperties(const QStringList& propertyNames)
+    /**
+     * Applies the given coalescing policy to an interface, unless the
+     * settings override it.
+     */
+    static void setCoalescingPolicy(ConnectivityServiceSettings& settings,
+                                    const QString& interface,
+                                    DBusUtils::CoalescingPolicy policy)
     {
-        DBusUtils::notifyPropertyChanged(
-            m_connection,
-            p,
-            DBusTypes::SERVICE_PATH,
-            DBusTypes::SERVICE_INTERFACE,
-            propertyNames
-        );
+        auto window = settings.coalescingWindow(interface);
+        if (!window.isNull())
+        {
+            policy.window = window.toInt();
+        }
+        auto maxLatency = settings.coalescingMaxLatency(interface);
+        if (!maxLatency.isNull())
+        {
+            policy.maxLatency = maxLatency.toInt();
+        }
+        DBusUtils::setCoalescingPolicy(interface, policy);
+    }
+
+    void publishSnapshot()
+    {
+        if (!m_snapshot)
+        {
+            return;
+        }
+
+        status_snapshot::Status status;
+        switch (m_manager->status())
+        {
+            case Manager::NetworkingStatus::offline:
+                status.connectivity = status_snapshot::Connectivity::offline;
+                break;
+            case Manager::NetworkingStatus::connecting:
+                status.connectivity = status_snapshot::Connectivity::connecting;
+                break;
+            case Manager::NetworkingStatus::online:
+                status.connectivity = status_snapshot::Connectivity::online;
+        }
+        status.bandwidthLimited = !m_limitations.isEmpty();
+        status.flightMode = m_manager->flightMode();
+        status.wifiEnabled = m_manager->wifiEnabled();
+        status.modemAvailable = m_manager->modemAvailable();
+        status.hotspotEnabled = m_manager->hotspotEnabled();
+        m_snapshot->publish(status);
     }
 
     void flushProperties()
@@ -82,40 +210,34 @@ public:
         DBusUtils::flushPropertyChanges();
     }
 
-    void notifyPrivateProperties(const QStringList& propertyNames)
+    void notifyPrivateProperties(std::initializer_list<PrivateProperty> properties)
     {
-        DBusUtils::notifyPropertyChanged(
-            m_connection,
-            *m_privateService,
-            DBusTypes::PRIVATE_PATH,
-            DBusTypes::PRIVATE_INTERFACE,
-            propertyNames
-        );
+        m_privateProperties->notify(properties);
     }
 
 public Q_SLOTS:
     void flightModeUpdated()
     {
         notifyProperties({
-            "FlightMode",
-            "HotspotSwitchEnabled"
+            Property::FlightMode,
+            Property::HotspotSwitchEnabled
         });
     }
 
     void wifiEnabledUpdated()
     {
         notifyProperties({
-            "WifiEnabled",
-            "HotspotSwitchEnabled"
+            Property::WifiEnabled,
+            Property::HotspotSwitchEnabled
         });
     }
 
     void unstoppableOperationHappeningUpdated()
     {
         notifyProperties({
-            "FlightModeSwitchEnabled",
-            "WifiSwitchEnabled",
-            "HotspotSwitchEnabled"
+            Property::FlightModeSwitchEnabled,
+            Property::WifiSwitchEnabled,
+            Property::HotspotSwitchEnabled
         });
         flushProperties();
     }
@@ -123,21 +245,21 @@ public Q_SLOTS:
     void hotspotSsidUpdated()
     {
         notifyProperties({
-            "HotspotSsid"
+            Property::HotspotSsid
         });
     }
 
     void modemAvailableUpdated()
     {
         notifyProperties({
-            "ModemAvailable"
+            Property::ModemAvailable
         });
     }
 
     void hotspotEnabledUpdated()
     {
         notifyProperties({
-            "HotspotEnabled"
+            Property::HotspotEnabled
         });
     }
 
@@ -145,14 +267,14 @@ public Q_SLOTS:
     {
         // Note that this is on the private object
         notifyPrivateProperties({
-            "HotspotPassword"
+            PrivateProperty::HotspotPassword
         });
     }
 
     void hotspotModeUpdated()
     {
         notifyProperties({
-            "HotspotMode"
+            Property::HotspotMode
         });
     }
 
@@ -160,14 +282,14 @@ public Q_SLOTS:
     {
         // Note that this is on the private object
         notifyPrivateProperties({
-            "HotspotAuth"
+            PrivateProperty::HotspotAuth
         });
     }
 
     void hotspotStoredUpdated()
     {
         notifyProperties({
-            "HotspotStored"
+            Property::HotspotStored
         });
     }
 
@@ -175,14 +297,14 @@ public Q_SLOTS:
     {
         Q_UNUSED(value)
         notifyPrivateProperties({
-            "MobileDataEnabled"
+            PrivateProperty::MobileDataEnabled
         });
     }
 
     void simForMobileDataUpdated()
     {
         notifyPrivateProperties({
-            "SimForMobileData"
+            PrivateProperty::SimForMobileData
         });
     }
 
@@ -203,19 +325,21 @@ public Q_SLOTS:
 
         for (auto iccid : toRemove)
         {
-            m_sims.remove(iccid);
+            auto dbussim = m_sims.take(iccid);
+            Q_EMIT m_objectManager->InterfacesRemoved(dbussim->path(), dbussim->interfaces().keys());
         }
 
         for (auto iccid : toAdd)
         {
             DBusSim::SPtr dbussim = make_shared<DBusSim>(sims[iccid], m_connection);
             m_sims[iccid] = dbussim;
+            Q_EMIT m_objectManager->InterfacesAdded(dbussim->path(), dbussim->interfaces());
         }
 
         if (!toRemove.isEmpty() || !toAdd.isEmpty())
         {
             notifyPrivateProperties({
-                "Sims"
+                PrivateProperty::Sims
             });
             flushProperties();
         }
@@ -237,7 +361,8 @@ public Q_SLOTS:
 
         for (auto serial : toRemove)
         {
-            m_modems.remove(serial);
+            auto dbusmodem = m_modems.take(serial);
+            Q_EMIT m_objectManager->InterfacesRemoved(dbusmodem->path(), dbusmodem->interfaces().keys());
         }
 
         for (auto serial : toAdd)
@@ -248,12 +373,13 @@ public Q_SLOTS:
             m_modems[serial] = dbusmodem;
             updateModemSimPath(dbusmodem, m->sim());
             connect(m.get(), &wwan::Modem::simUpdated, this, &Private::modemSimUpdated);
+            Q_EMIT m_objectManager->InterfacesAdded(dbusmodem->path(), dbusmodem->interfaces());
         }
 
         if (!toRemove.isEmpty() || !toAdd.isEmpty())
         {
             notifyPrivateProperties({
-                "Modems"
+                PrivateProperty::Modems
             });
             flushProperties();
         }
@@ -288,8 +414,6 @@ public Q_SLOTS:
 
     void updateNetworkingStatus()
     {
-        QStringList changed;
-
         QStringList old_limitations = m_limitations;
         QString old_status = m_status;
 
@@ -306,7 +430,7 @@ public Q_SLOTS:
         }
         if (old_status != m_status)
         {
-            changed << "Status";
+            notifyProperties({Property::Status});
         }
 
         QStringList limitations;
@@ -320,12 +444,7 @@ public Q_SLOTS:
         m_limitations = limitations;
         if (old_limitations != m_limitations)
         {
-            changed << "Limitations";
-        }
-
-        if (!changed.empty())
-        {
-            notifyProperties(changed);
+            notifyProperties({Property::Limitations});
         }
     }
 
@@ -342,7 +461,8 @@ public Q_SLOTS:
 
         for (const auto& con: toRemove)
         {
-            m_vpnConnections.remove(con);
+            auto vpnConnection = m_vpnConnections.take(con);
+            Q_EMIT m_objectManager->InterfacesRemoved(vpnConnection->path(), vpnConnection->interfaces().keys());
         }
 
         QList<QPair<QDBusMessage, QDBusObjectPath>> addReplies;
@@ -363,6 +483,7 @@ public Q_SLOTS:
             if (vpnConnection)
             {
                 m_vpnConnections[path] = vpnConnection;
+                Q_EMIT m_objectManager->InterfacesAdded(vpnConnection->path(), vpnConnection->interfaces());
             }
 
             QString uuid = vpn->uuid();
@@ -374,7 +495,7 @@ public Q_SLOTS:
 
         if (!toRemove.isEmpty() || !toAdd.isEmpty())
         {
-            notifyPrivateProperties({"VpnConnections"});
+            notifyPrivateProperties({PrivateProperty::VpnConnections});
             flushProperties();
         }
 
@@ -391,9 +512,41 @@ ConnectivityService::ConnectivityService(Manager::Ptr manager,
                                          const QDBusConnection& connection)
     : d{new Private(*this, connection)}
 {
+    {
+        // Batch up the change storms of roaming between cells and access
+        // points, but let clients see connectivity changes straight away
+        ConnectivityServiceSettings settings;
+
+        DBusUtils::CoalescingPolicy status;
+        status.window = 50;
+        status.maxLatency = 250;
+        status.bypass = DBusUtils::propertyMask({Property::Status, Property::FlightMode});
+        Private::setCoalescingPolicy(settings, DBusTypes::SERVICE_INTERFACE, status);
+
+        DBusUtils::CoalescingPolicy wwan;
+        wwan.window = 100;
+        wwan.maxLatency = 250;
+        Private::setCoalescingPolicy(settings, DBusUtils::adaptorInterface<ModemAdaptor>(), wwan);
+        Private::setCoalescingPolicy(settings, DBusUtils::adaptorInterface<SimAdaptor>(), wwan);
+    }
+
     d->m_manager = manager;
     d->m_vpnManager = vpnManager;
     d->m_privateService = make_shared<PrivateService>(*this);
+    d->m_privateProperties = make_shared<DBusUtils::PropertyNotifier<PrivateService>>(
+            *d->m_privateService, PRIVATE_PROPERTIES, d->m_connection,
+            DBusTypes::PRIVATE_PATH, DBusTypes::PRIVATE_INTERFACE);
+    d->m_objectManager = make_shared<ObjectManagerService>(*this);
+    d->m_diagnostics = make_shared<DiagnosticsService>();
+
+    try
+    {
+        d->m_snapshot = make_unique<status_snapshot::Writer>();
+    }
+    catch (system_error& e)
+    {
+        qWarning() << "Unable to publish status snapshot:" << e.what();
+    }
 
     // Memory is managed by Qt parent ownership
     new NetworkingStatusAdaptor(this);
@@ -426,6 +579,7 @@ ConnectivityService::ConnectivityService(Manager::Ptr manager,
     d->updateModems();
     d->updateNetworkingStatus();
     d->updateVpnList();
+    d->publishSnapshot();
 
     if (!d->m_connection.registerObject(DBusTypes::SERVICE_PATH, this))
     {
@@ -437,6 +591,16 @@ ConnectivityService::ConnectivityService(Manager::Ptr manager,
         throw logic_error(
                 "Unable to register NetworkingStatus private object on DBus");
     }
+    if (!d->m_connection.registerObject(DBusTypes::OBJECT_MANAGER_PATH, d->m_objectManager.get()))
+    {
+        throw logic_error(
+                "Unable to register object manager on DBus");
+    }
+    if (!d->m_connection.registerObject(DBusTypes::DIAGNOSTICS_PATH, d->m_diagnostics.get()))
+    {
+        throw logic_error(
+                "Unable to register diagnostics object on DBus");
+    }
     if (!d->m_connection.registerService(DBusTypes::DBUS_NAME))
     {
         throw logic_error(
@@ -510,6 +674,109 @@ bool ConnectivityService::hotspotStored() const
     return d->m_manager->hotspotStored();
 }
 
+ObjectManagerService::ObjectManagerService(ConnectivityService& parent) :
+        p(parent)
+{
+    // Memory is managed by Qt parent ownership
+    new ObjectManagerAdaptor(this);
+}
+
+QManagedObjectMap ObjectManagerService::GetManagedObjects()
+{
+    QManagedObjectMap objects;
+    for (const auto& modem: p.d->m_modems)
+    {
+        objects[modem->path()] = modem->interfaces();
+    }
+    for (const auto& sim: p.d->m_sims)
+    {
+        objects[sim->path()] = sim->interfaces();
+    }
+    for (const auto& vpnConnection: p.d->m_vpnConnections)
+    {
+        objects[vpnConnection->path()] = vpnConnection->interfaces();
+    }
+    return objects;
+}
+
+DiagnosticsService::DiagnosticsService()
+{
+    // Memory is managed by Qt parent ownership
+    new DiagnosticsAdaptor(this);
+}
+
+QString DiagnosticsService::CallStatistics()
+{
+    QJsonArray calls;
+    for (const auto& entry: DBusUtils::callStatistics())
+    {
+        const auto& key = entry.first;
+        const auto& statistics = entry.second;
+
+        QJsonArray buckets;
+        for (auto count: statistics.buckets)
+        {
+            buckets.append(double(count));
+        }
+
+        QJsonObject call;
+        call["interface"] = key.interface;
+        call["member"] = key.member;
+        call["kind"] = key.kind == DBusUtils::CallKind::sync ? "sync" : "async";
+        call["calls"] = double(statistics.calls);
+        call["totalMicroseconds"] = double(statistics.totalMicroseconds);
+        call["maxMicroseconds"] = double(statistics.maxMicroseconds);
+        call["buckets"] = buckets;
+        calls.append(call);
+    }
+    return QString::fromUtf8(QJsonDocument(calls).toJson(QJsonDocument::Compact));
+}
+
+void DiagnosticsService::ResetCallStatistics()
+{
+    DBusUtils::resetCallStatistics();
+}
+
+QString DiagnosticsService::CoalescingStatistics()
+{
+    QJsonArray interfaces;
+    for (const auto& entry: DBusUtils::coalescingStatistics())
+    {
+        const auto& coalescing = entry.second;
+
+        QJsonObject interface;
+        interface["interface"] = entry.first;
+        interface["window"] = coalescing.policy.window;
+        interface["maxLatency"] = coalescing.policy.maxLatency;
+        interface["emitted"] = double(coalescing.statistics.emitted);
+        interface["suppressed"] = double(coalescing.statistics.suppressed);
+        interfaces.append(interface);
+    }
+    return QString::fromUtf8(QJsonDocument(interfaces).toJson(QJsonDocument::Compact));
+}
+
+QString DiagnosticsService::WakeupRates()
+{
+    auto toJson = [](const util::wakeups::Rate& rate)
+    {
+        QJsonObject object;
+        object["source"] = rate.source;
+        object["lastTenSeconds"] = rate.lastTenSeconds;
+        object["lastMinute"] = rate.lastMinute;
+        return object;
+    };
+
+    QJsonArray sources;
+    for (const auto& rate: util::wakeups::rates())
+    {
+        sources.append(toJson(rate));
+    }
+
+    auto rates = toJson(util::wakeups::total());
+    rates["sources"] = sources;
+    return QString::fromUtf8(QJsonDocument(rates).toJson(QJsonDocument::Compact));
+}
+
 PrivateService::PrivateService(ConnectivityService& parent) :
         p(parent)
 {
@@ -615,6 +882,11 @@ void PrivateService::RemoveVpnConnection(const QDBusObjectPath &path)
     }
 }
 
+QString PrivateService::DumpTrace()
+{
+    return QString::fromUtf8(util::trace::chromeTraceJson());
+}
+
 QString PrivateService::hotspotPassword() const
 {
     return p.d->m_manager->hotspotPassword();
@@ -22,6 +22,7 @@
 
 #include <nmofono/manager.h>
 #include <nmofono/vpn/vpn-manager.h>
+#include <dbus-types.h>
 
 #include <QDBusContext>
 #include <QDBusConnection>
@@ -29,10 +30,13 @@
 
 class NetworkingStatusAdaptor;
 class PrivateAdaptor;
+class ObjectManagerAdaptor;
+class DiagnosticsAdaptor;
 
 namespace connectivity_service
 {
 class PrivateService;
+class ObjectManagerService;
 
 class ConnectivityService: public QObject, protected QDBusContext
 {
@@ -40,6 +44,7 @@ class ConnectivityService: public QObject, protected QDBusContext
 
     friend NetworkingStatusAdaptor;
     friend PrivateService;
+    friend ObjectManagerService;
 
 public:
     ConnectivityService(nmofono::Manager::Ptr manager,
@@ -144,6 +149,8 @@ protected Q_SLOTS:
 
     void RemoveVpnConnection(const QDBusObjectPath &path);
 
+    QString DumpTrace();
+
     void setMobileDataEnabled(bool enabled);
 
     void setSimForMobileData(const QDBusObjectPath &path);
@@ -156,4 +163,56 @@ protected:
     ConnectivityService& p;
 };
 
+/**
+ * org.freedesktop.DBus.ObjectManager for the modem, SIM and VPN connection
+ * objects, so clients can fetch all of them and their properties in a
+ * single call and then follow additions and removals.
+ */
+class ObjectManagerService : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+
+    friend ObjectManagerAdaptor;
+
+public:
+    ObjectManagerService(ConnectivityService& parent);
+
+    ~ObjectManagerService() = default;
+
+protected Q_SLOTS:
+    QManagedObjectMap GetManagedObjects();
+
+Q_SIGNALS:
+    void InterfacesAdded(const QDBusObjectPath &path, const QVariantDictMap &interfaces);
+
+    void InterfacesRemoved(const QDBusObjectPath &path, const QStringList &interfaces);
+
+protected:
+    ConnectivityService& p;
+};
+
+/**
+ * Statistics about the service itself, for working out where its time goes.
+ */
+class DiagnosticsService : public QObject
+{
+    Q_OBJECT
+
+    friend DiagnosticsAdaptor;
+
+public:
+    DiagnosticsService();
+
+    ~DiagnosticsService() = default;
+
+protected Q_SLOTS:
+    QString CallStatistics();
+
+    void ResetCallStatistics();
+
+    QString CoalescingStatistics();
+
+    QString WakeupRates();
+};
+
 }
@@ -20,7 +20,6 @@
 #include <connectivity-service/dbus-modem.h>
 #include <ModemAdaptor.h>
 #include <dbus-types.h>
-#include <util/dbus-utils.h>
 
 using namespace std;
 using namespace nmofono::wwan;
@@ -28,13 +27,32 @@ using namespace nmofono::wwan;
 namespace connectivity_service
 {
 
+namespace
+{
+enum class Property
+{
+    Index,
+    Serial,
+    Sim
+};
+
+constexpr DBusUtils::PropertyDescriptor<DBusModem> PROPERTIES[] =
+{
+    DBUS_UTILS_PROPERTY(DBusModem, Property::Index, "Index", index),
+    DBUS_UTILS_PROPERTY(DBusModem, Property::Serial, "Serial", serial),
+    DBUS_UTILS_PROPERTY(DBusModem, Property::Sim, "Sim", sim)
+};
+static_assert(DBusUtils::propertiesInOrder(PROPERTIES), "Modem property table out of order");
+}
+
 DBusModem::DBusModem(Modem::Ptr modem,
                      const QDBusConnection& connection) :
     m_modem(modem),
-    m_connection(connection)
+    m_connection(connection),
+    m_path(DBusTypes::modemPath()),
+    m_properties(*this, PROPERTIES, m_connection, m_path.path(),
+                 DBusUtils::adaptorInterface<ModemAdaptor>())
 {
-    m_path.setPath(DBusTypes::modemPath());
-
     new ModemAdaptor(this);
 
     registerDBusObject();
@@ -52,17 +70,6 @@ void DBusModem::registerDBusObject()
     }
 }
 
-void DBusModem::notifyProperties(const QStringList& propertyNames)
-{
-    DBusUtils::notifyPropertyChanged(
-        m_connection,
-        *this,
-        m_path.path(),
-        ModemAdaptor::staticMetaObject.classInfo(ModemAdaptor::staticMetaObject.indexOfClassInfo("D-Bus Interface")).value(),
-        propertyNames
-    );
-}
-
 QDBusObjectPath DBusModem::sim() const
 {
     return m_simpath;
@@ -75,7 +82,7 @@ void DBusModem::setSim(QDBusObjectPath path)
         return;
     }
     m_simpath = path;
-    notifyProperties({"Sim"});
+    m_properties.notify({Property::Sim});
 }
 
 int DBusModem::index() const
@@ -95,4 +102,10 @@ DBusModem::path() const
     return m_path;
 }
 
+QVariantDictMap
+DBusModem::interfaces() const
+{
+    return {{m_properties.interface(), m_properties.allProperties()}};
+}
+
 }
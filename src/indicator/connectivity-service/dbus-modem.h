@@ -20,6 +20,8 @@
 #pragma once
 
 #include <nmofono/wwan/modem.h>
+#include <util/dbus-utils.h>
+#include <dbus-types.h>
 
 #include <QDBusConnection>
 #include <QDBusContext>
@@ -61,13 +63,12 @@ public:
 
     QDBusObjectPath path() const;
 
+    QVariantDictMap interfaces() const;
+
 Q_SIGNALS:
 
 protected Q_SLOTS:
 
-private:
-    void notifyProperties(const QStringList& propertyNames);
-
 protected:
     void registerDBusObject();
 
@@ -78,6 +79,7 @@ protected:
     QDBusObjectPath m_path;
     QDBusObjectPath m_simpath;
 
+    DBusUtils::PropertyNotifier<DBusModem> m_properties;
 };
 
 }
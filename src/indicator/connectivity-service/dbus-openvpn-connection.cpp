@@ -19,7 +19,6 @@
 
 #include <connectivity-service/dbus-openvpn-connection.h>
 #include <OpenVpnAdaptor.h>
-#include <util/dbus-utils.h>
 
 using namespace std;
 using namespace nmofono::vpn;
@@ -42,31 +41,74 @@ void DBusOpenvpnConnection::set##uppername(int value)\
     m_openvpnConnection->set##uppername(static_cast<OpenvpnConnection::type>(value));\
 }
 
-#define DEFINE_PROPERTY_UPDATER(varname, strname, type)\
-void DBusOpenvpnConnection::varname##Updated(type)\
-{\
-    notifyProperty(strname);\
-}
-
-#define DEFINE_PROPERTY_UPDATER_ENUM(varname, strname, type)\
-void DBusOpenvpnConnection::varname##Updated(OpenvpnConnection::type)\
-{\
-    notifyProperty(strname);\
-}
-
 #define DEFINE_PROPERTY_CONNECTION_FORWARD(uppername)\
 connect(this, &DBusOpenvpnConnection::set##uppername, m_openvpnConnection.get(), &OpenvpnConnection::set##uppername);
 
-#define DEFINE_PROPERTY_CONNECTION_REVERSE(varname)\
-connect(m_openvpnConnection.get(), &OpenvpnConnection::varname##Changed, this, &DBusOpenvpnConnection::varname##Updated);
+#define DEFINE_PROPERTY_DESCRIPTOR(varname)\
+DBUS_UTILS_PROPERTY(DBusOpenvpnConnection, Property::varname, #varname, varname)
 
 namespace connectivity_service
 {
 
+namespace
+{
+typedef OpenvpnConnection::Field Property;
+
+constexpr DBusUtils::PropertyDescriptor<DBusOpenvpnConnection> PROPERTIES[] =
+{
+    DEFINE_PROPERTY_DESCRIPTOR(ca),
+    DEFINE_PROPERTY_DESCRIPTOR(cert),
+    DEFINE_PROPERTY_DESCRIPTOR(certPass),
+    DEFINE_PROPERTY_DESCRIPTOR(connectionType),
+    DEFINE_PROPERTY_DESCRIPTOR(key),
+    DEFINE_PROPERTY_DESCRIPTOR(localIp),
+    DEFINE_PROPERTY_DESCRIPTOR(password),
+    DEFINE_PROPERTY_DESCRIPTOR(remote),
+    DEFINE_PROPERTY_DESCRIPTOR(remoteIp),
+    DEFINE_PROPERTY_DESCRIPTOR(staticKey),
+    DEFINE_PROPERTY_DESCRIPTOR(staticKeyDirection),
+    DEFINE_PROPERTY_DESCRIPTOR(username),
+    DEFINE_PROPERTY_DESCRIPTOR(port),
+    DEFINE_PROPERTY_DESCRIPTOR(portSet),
+    DEFINE_PROPERTY_DESCRIPTOR(renegSeconds),
+    DEFINE_PROPERTY_DESCRIPTOR(renegSecondsSet),
+    DEFINE_PROPERTY_DESCRIPTOR(compLzo),
+    DEFINE_PROPERTY_DESCRIPTOR(protoTcp),
+    DEFINE_PROPERTY_DESCRIPTOR(dev),
+    DEFINE_PROPERTY_DESCRIPTOR(devType),
+    DEFINE_PROPERTY_DESCRIPTOR(devTypeSet),
+    DEFINE_PROPERTY_DESCRIPTOR(tunnelMtu),
+    DEFINE_PROPERTY_DESCRIPTOR(tunnelMtuSet),
+    DEFINE_PROPERTY_DESCRIPTOR(fragmentSize),
+    DEFINE_PROPERTY_DESCRIPTOR(fragmentSizeSet),
+    DEFINE_PROPERTY_DESCRIPTOR(mssFix),
+    DEFINE_PROPERTY_DESCRIPTOR(remoteRandom),
+    DEFINE_PROPERTY_DESCRIPTOR(cipher),
+    DEFINE_PROPERTY_DESCRIPTOR(keysize),
+    DEFINE_PROPERTY_DESCRIPTOR(keysizeSet),
+    DEFINE_PROPERTY_DESCRIPTOR(auth),
+    DEFINE_PROPERTY_DESCRIPTOR(tlsRemote),
+    DEFINE_PROPERTY_DESCRIPTOR(remoteCertTls),
+    DEFINE_PROPERTY_DESCRIPTOR(remoteCertTlsSet),
+    DEFINE_PROPERTY_DESCRIPTOR(ta),
+    DEFINE_PROPERTY_DESCRIPTOR(taDir),
+    DEFINE_PROPERTY_DESCRIPTOR(taSet),
+    DEFINE_PROPERTY_DESCRIPTOR(proxyType),
+    DEFINE_PROPERTY_DESCRIPTOR(proxyServer),
+    DEFINE_PROPERTY_DESCRIPTOR(proxyPort),
+    DEFINE_PROPERTY_DESCRIPTOR(proxyRetry),
+    DEFINE_PROPERTY_DESCRIPTOR(proxyUsername),
+    DEFINE_PROPERTY_DESCRIPTOR(proxyPassword)
+};
+static_assert(DBusUtils::propertiesInOrder(PROPERTIES), "OpenVPN property table out of order");
+}
+
 DBusOpenvpnConnection::DBusOpenvpnConnection(VpnConnection::SPtr vpnConnection,
                                              const QDBusConnection& connection) :
         DBusVpnConnection(vpnConnection, connection),
-        m_openvpnConnection(vpnConnection->openvpnConnection())
+        m_openvpnConnection(vpnConnection->openvpnConnection()),
+        m_properties(*this, PROPERTIES, m_connection, m_path.path(),
+                     DBusUtils::adaptorInterface<OpenVpnAdaptor>())
 {
     new OpenVpnAdaptor(this);
 
@@ -127,65 +169,7 @@ DBusOpenvpnConnection::DBusOpenvpnConnection(VpnConnection::SPtr vpnConnection,
     DEFINE_PROPERTY_CONNECTION_FORWARD(ProxyUsername)
     DEFINE_PROPERTY_CONNECTION_FORWARD(ProxyPassword)
 
-
-
-    // Basic properties
-
-    DEFINE_PROPERTY_CONNECTION_REVERSE(ca)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(cert)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(certPass)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(connectionType)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(key)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(localIp)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(password)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(remote)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(remoteIp)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(staticKey)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(staticKeyDirection)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(username)
-
-    // Advanced general properties
-
-    DEFINE_PROPERTY_CONNECTION_REVERSE(port)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(portSet)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(renegSeconds)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(renegSecondsSet)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(compLzo)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(protoTcp)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(dev)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(devType)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(devTypeSet)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(tunnelMtu)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(tunnelMtuSet)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(fragmentSize)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(fragmentSizeSet)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(mssFix)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(remoteRandom)
-
-    // Advanced security properties
-
-    DEFINE_PROPERTY_CONNECTION_REVERSE(cipher)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(keysize)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(keysizeSet)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(auth)
-
-    // Advanced TLS auth properties
-
-    DEFINE_PROPERTY_CONNECTION_REVERSE(tlsRemote)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(remoteCertTls)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(remoteCertTlsSet)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(ta)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(taDir)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(taSet)
-
-    // Advanced proxy settings
-
-    DEFINE_PROPERTY_CONNECTION_REVERSE(proxyPassword)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(proxyPort)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(proxyRetry)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(proxyServer)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(proxyType)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(proxyUsername)
+    connect(m_openvpnConnection.get(), &OpenvpnConnection::fieldChanged, this, &DBusOpenvpnConnection::fieldUpdated);
 
     registerDBusObject();
 }
@@ -199,6 +183,13 @@ nmofono::vpn::VpnConnection::Type DBusOpenvpnConnection::type() const
     return nmofono::vpn::VpnConnection::Type::openvpn;
 }
 
+QVariantDictMap DBusOpenvpnConnection::interfaces() const
+{
+    auto result = DBusVpnConnection::interfaces();
+    result[m_properties.interface()] = m_properties.allProperties();
+    return result;
+}
+
 // Enum properties
 
 DEFINE_PROPERTY_SETTER_ENUM(ConnectionType, ConnectionType)
@@ -268,73 +259,9 @@ DEFINE_PROPERTY_GETTER(proxyRetry, bool)
 DEFINE_PROPERTY_GETTER(proxyUsername, QString)
 DEFINE_PROPERTY_GETTER(proxyPassword, QString)
 
-void DBusOpenvpnConnection::notifyProperty(const QString& propertyName)
+void DBusOpenvpnConnection::fieldUpdated(OpenvpnConnection::Field field)
 {
-    DBusUtils::notifyPropertyChanged(
-        m_connection,
-        *this,
-        m_path.path(),
-        OpenVpnAdaptor::staticMetaObject.classInfo(OpenVpnAdaptor::staticMetaObject.indexOfClassInfo("D-Bus Interface")).value(),
-        {propertyName}
-    );
+    m_properties.notify({field});
 }
 
-// Basic properties
-
-DEFINE_PROPERTY_UPDATER(ca, "ca", const QString &)
-DEFINE_PROPERTY_UPDATER(cert, "cert", const QString &)
-DEFINE_PROPERTY_UPDATER(certPass, "certPass", const QString &)
-DEFINE_PROPERTY_UPDATER_ENUM(connectionType, "connectionType", ConnectionType)
-DEFINE_PROPERTY_UPDATER(key, "key", const QString &)
-DEFINE_PROPERTY_UPDATER(localIp, "localIp", const QString &)
-DEFINE_PROPERTY_UPDATER(password, "password", const QString &)
-DEFINE_PROPERTY_UPDATER(remote, "remote", const QString &)
-DEFINE_PROPERTY_UPDATER(remoteIp, "remoteIp", const QString &)
-DEFINE_PROPERTY_UPDATER(staticKey, "staticKey", const QString &)
-DEFINE_PROPERTY_UPDATER_ENUM(staticKeyDirection, "staticKeyDirection", KeyDir)
-DEFINE_PROPERTY_UPDATER(username, "username", const QString &)
-
-// Advanced general properties
-
-DEFINE_PROPERTY_UPDATER(port, "port", int)
-DEFINE_PROPERTY_UPDATER(portSet, "portSet", bool)
-DEFINE_PROPERTY_UPDATER(renegSeconds, "renegSeconds", int)
-DEFINE_PROPERTY_UPDATER(renegSecondsSet, "renegSecondsSet", bool)
-DEFINE_PROPERTY_UPDATER(compLzo, "compLzo", bool)
-DEFINE_PROPERTY_UPDATER(protoTcp, "protoTcp", bool)
-DEFINE_PROPERTY_UPDATER(dev, "dev", const QString &)
-DEFINE_PROPERTY_UPDATER_ENUM(devType, "devType", DevType)
-DEFINE_PROPERTY_UPDATER(devTypeSet, "devTypeSet", bool)
-DEFINE_PROPERTY_UPDATER(tunnelMtu, "tunnelMtu", int)
-DEFINE_PROPERTY_UPDATER(tunnelMtuSet, "tunnelMtuSet", bool)
-DEFINE_PROPERTY_UPDATER(fragmentSize, "fragmentSize", int)
-DEFINE_PROPERTY_UPDATER(fragmentSizeSet, "fragmentSizeSet", bool)
-DEFINE_PROPERTY_UPDATER(mssFix, "mssFix", bool)
-DEFINE_PROPERTY_UPDATER(remoteRandom, "remoteRandom", bool)
-
-// Advanced security properties
-
-DEFINE_PROPERTY_UPDATER_ENUM(cipher, "cipher", Cipher)
-DEFINE_PROPERTY_UPDATER(keysize, "keysize", int)
-DEFINE_PROPERTY_UPDATER(keysizeSet, "keysizeSet", bool)
-DEFINE_PROPERTY_UPDATER_ENUM(auth, "auth", Auth)
-
-// Advanced TLS auth properties
-
-DEFINE_PROPERTY_UPDATER(tlsRemote, "tlsRemote", const QString &)
-DEFINE_PROPERTY_UPDATER_ENUM(remoteCertTls, "remoteCertTls", TlsType)
-DEFINE_PROPERTY_UPDATER(remoteCertTlsSet, "remoteCertTlsSet", bool)
-DEFINE_PROPERTY_UPDATER(ta, "ta", const QString &)
-DEFINE_PROPERTY_UPDATER_ENUM(taDir, "taDir", KeyDir)
-DEFINE_PROPERTY_UPDATER(taSet, "taSet", bool)
-
-// Advanced proxy settings
-
-DEFINE_PROPERTY_UPDATER_ENUM(proxyType, "proxyType", ProxyType)
-DEFINE_PROPERTY_UPDATER(proxyServer, "proxyServer", const QString &)
-DEFINE_PROPERTY_UPDATER(proxyPort, "proxyPort", int)
-DEFINE_PROPERTY_UPDATER(proxyRetry, "proxyRetry", bool)
-DEFINE_PROPERTY_UPDATER(proxyUsername, "proxyUsername", const QString &)
-DEFINE_PROPERTY_UPDATER(proxyPassword, "proxyPassword", const QString &)
-
 }
@@ -19,7 +19,6 @@
 
 #include <connectivity-service/dbus-pptp-connection.h>
 #include <PptpAdaptor.h>
-#include <util/dbus-utils.h>
 
 using namespace std;
 using namespace nmofono::vpn;
@@ -42,31 +41,47 @@ void DBusPptpConnection::set##uppername(int value)\
     m_pptpConnection->set##uppername(static_cast<PptpConnection::type>(value));\
 }
 
-#define DEFINE_PROPERTY_UPDATER(varname, strname, type)\
-void DBusPptpConnection::varname##Updated(type)\
-{\
-    notifyProperty(strname);\
-}
-
-#define DEFINE_PROPERTY_UPDATER_ENUM(varname, strname, type)\
-void DBusPptpConnection::varname##Updated(PptpConnection::type)\
-{\
-    notifyProperty(strname);\
-}
-
 #define DEFINE_PROPERTY_CONNECTION_FORWARD(uppername)\
 connect(this, &DBusPptpConnection::set##uppername, m_pptpConnection.get(), &PptpConnection::set##uppername);
 
-#define DEFINE_PROPERTY_CONNECTION_REVERSE(varname)\
-connect(m_pptpConnection.get(), &PptpConnection::varname##Changed, this, &DBusPptpConnection::varname##Updated);
+#define DEFINE_PROPERTY_DESCRIPTOR(varname)\
+DBUS_UTILS_PROPERTY(DBusPptpConnection, Property::varname, #varname, varname)
 
 namespace connectivity_service
 {
 
+namespace
+{
+typedef PptpConnection::Field Property;
+
+constexpr DBusUtils::PropertyDescriptor<DBusPptpConnection> PROPERTIES[] =
+{
+    DEFINE_PROPERTY_DESCRIPTOR(gateway),
+    DEFINE_PROPERTY_DESCRIPTOR(user),
+    DEFINE_PROPERTY_DESCRIPTOR(password),
+    DEFINE_PROPERTY_DESCRIPTOR(domain),
+    DEFINE_PROPERTY_DESCRIPTOR(allowPap),
+    DEFINE_PROPERTY_DESCRIPTOR(allowChap),
+    DEFINE_PROPERTY_DESCRIPTOR(allowMschap),
+    DEFINE_PROPERTY_DESCRIPTOR(allowMschapv2),
+    DEFINE_PROPERTY_DESCRIPTOR(allowEap),
+    DEFINE_PROPERTY_DESCRIPTOR(requireMppe),
+    DEFINE_PROPERTY_DESCRIPTOR(mppeType),
+    DEFINE_PROPERTY_DESCRIPTOR(mppeStateful),
+    DEFINE_PROPERTY_DESCRIPTOR(bsdCompression),
+    DEFINE_PROPERTY_DESCRIPTOR(deflateCompression),
+    DEFINE_PROPERTY_DESCRIPTOR(tcpHeaderCompression),
+    DEFINE_PROPERTY_DESCRIPTOR(sendPppEchoPackets)
+};
+static_assert(DBusUtils::propertiesInOrder(PROPERTIES), "PPTP property table out of order");
+}
+
 DBusPptpConnection::DBusPptpConnection(VpnConnection::SPtr vpnConnection,
                                              const QDBusConnection& connection) :
         DBusVpnConnection(vpnConnection, connection),
-        m_pptpConnection(vpnConnection->pptpConnection())
+        m_pptpConnection(vpnConnection->pptpConnection()),
+        m_properties(*this, PROPERTIES, m_connection, m_path.path(),
+                     DBusUtils::adaptorInterface<PptpAdaptor>())
 {
     new PptpAdaptor(this);
 
@@ -92,32 +107,7 @@ DBusPptpConnection::DBusPptpConnection(VpnConnection::SPtr vpnConnection,
     DEFINE_PROPERTY_CONNECTION_FORWARD(TcpHeaderCompression)
     DEFINE_PROPERTY_CONNECTION_FORWARD(SendPppEchoPackets)
 
-
-
-
-    // Basic properties
-
-    DEFINE_PROPERTY_CONNECTION_REVERSE(gateway)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(user)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(password)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(domain)
-
-    // Advanced properties
-
-    DEFINE_PROPERTY_CONNECTION_REVERSE(allowPap)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(allowChap)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(allowMschap)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(allowMschapv2)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(allowEap)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(requireMppe)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(mppeType)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(mppeStateful)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(bsdCompression)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(deflateCompression)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(tcpHeaderCompression)
-    DEFINE_PROPERTY_CONNECTION_REVERSE(sendPppEchoPackets)
-
-
+    connect(m_pptpConnection.get(), &PptpConnection::fieldChanged, this, &DBusPptpConnection::fieldUpdated);
 
     registerDBusObject();
 }
@@ -131,6 +121,13 @@ nmofono::vpn::VpnConnection::Type DBusPptpConnection::type() const
     return nmofono::vpn::VpnConnection::Type::pptp;
 }
 
+QVariantDictMap DBusPptpConnection::interfaces() const
+{
+    auto result = DBusVpnConnection::interfaces();
+    result[m_properties.interface()] = m_properties.allProperties();
+    return result;
+}
+
 // Enum properties
 
 DEFINE_PROPERTY_SETTER_ENUM(MppeType, MppeType)
@@ -160,39 +157,9 @@ DEFINE_PROPERTY_GETTER(deflateCompression, bool)
 DEFINE_PROPERTY_GETTER(tcpHeaderCompression, bool)
 DEFINE_PROPERTY_GETTER(sendPppEchoPackets, bool)
 
-
-void DBusPptpConnection::notifyProperty(const QString& propertyName)
+void DBusPptpConnection::fieldUpdated(PptpConnection::Field field)
 {
-    DBusUtils::notifyPropertyChanged(
-        m_connection,
-        *this,
-        m_path.path(),
-        PptpAdaptor::staticMetaObject.classInfo(PptpAdaptor::staticMetaObject.indexOfClassInfo("D-Bus Interface")).value(),
-        {propertyName}
-    );
+    m_properties.notify({field});
 }
 
-// Basic properties
-
-DEFINE_PROPERTY_UPDATER(gateway, "gateway", const QString &)
-DEFINE_PROPERTY_UPDATER(user, "user", const QString &)
-DEFINE_PROPERTY_UPDATER(password, "password", const QString &)
-DEFINE_PROPERTY_UPDATER(domain, "domain", const QString &)
-
-// Advanced properties
-
-DEFINE_PROPERTY_UPDATER(allowPap, "allowPap", bool)
-DEFINE_PROPERTY_UPDATER(allowChap, "allowChap", bool)
-DEFINE_PROPERTY_UPDATER(allowMschap, "allowMschap", bool)
-DEFINE_PROPERTY_UPDATER(allowMschapv2, "allowMschapv2", bool)
-DEFINE_PROPERTY_UPDATER(allowEap, "allowEap", bool)
-DEFINE_PROPERTY_UPDATER(requireMppe, "requireMppe", bool)
-DEFINE_PROPERTY_UPDATER_ENUM(mppeType, "mppeType", MppeType)
-DEFINE_PROPERTY_UPDATER(mppeStateful, "mppeStateful", bool)
-DEFINE_PROPERTY_UPDATER(bsdCompression, "bsdCompression", bool)
-DEFINE_PROPERTY_UPDATER(deflateCompression, "deflateCompression", bool)
-DEFINE_PROPERTY_UPDATER(tcpHeaderCompression, "tcpHeaderCompression", bool)
-DEFINE_PROPERTY_UPDATER(sendPppEchoPackets, "sendPppEchoPackets", bool)
-
-
 }
@@ -40,6 +40,8 @@ public:
 
     nmofono::vpn::VpnConnection::Type type() const override;
 
+    QVariantDictMap interfaces() const override;
+
     // Basic properties
 
     Q_PROPERTY(QString gateway READ gateway WRITE setGateway)
@@ -92,48 +94,11 @@ public:
     Q_PROPERTY(bool sendPppEchoPackets READ sendPppEchoPackets WRITE setSendPppEchoPackets)
     bool sendPppEchoPackets() const;
 
-protected:
-    void notifyProperty(const QString& propertyName);
-
 protected Q_SLOTS:
     // Enum properties
     void setMppeType(int value);
 
-    // Basic properties
-
-    void gatewayUpdated(const QString &value);
-
-    void userUpdated(const QString &value);
-
-    void passwordUpdated(const QString &value);
-
-    void domainUpdated(const QString &value);
-
-    // Advanced properties
-
-    void allowPapUpdated(bool value);
-
-    void allowChapUpdated(bool value);
-
-    void allowMschapUpdated(bool value);
-
-    void allowMschapv2Updated(bool value);
-
-    void allowEapUpdated(bool value);
-
-    void requireMppeUpdated(bool value);
-
-    void mppeTypeUpdated(nmofono::vpn::PptpConnection::MppeType value);
-
-    void mppeStatefulUpdated(bool value);
-
-    void bsdCompressionUpdated(bool value);
-
-    void deflateCompressionUpdated(bool value);
-
-    void tcpHeaderCompressionUpdated(bool value);
-
-    void sendPppEchoPacketsUpdated(bool value);
+    void fieldUpdated(nmofono::vpn::PptpConnection::Field field);
 
 Q_SIGNALS:
     // Basic properties
@@ -172,6 +137,9 @@ Q_SIGNALS:
 
 protected:
     nmofono::vpn::PptpConnection::SPtr m_pptpConnection;
+
+private:
+    DBusUtils::PropertyNotifier<DBusPptpConnection> m_properties;
 };
 
 }
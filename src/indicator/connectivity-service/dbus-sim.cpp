@@ -20,7 +20,6 @@
 #include <connectivity-service/dbus-sim.h>
 #include <SimAdaptor.h>
 #include <dbus-types.h>
-#include <util/dbus-utils.h>
 
 #include <QDebug>
 
@@ -30,13 +29,44 @@ using namespace nmofono::wwan;
 namespace connectivity_service
 {
 
+namespace
+{
+enum class Property
+{
+    Iccid,
+    Imsi,
+    PrimaryPhoneNumber,
+    Locked,
+    Present,
+    Mcc,
+    Mnc,
+    PreferredLanguages,
+    DataRoamingEnabled
+};
+
+constexpr DBusUtils::PropertyDescriptor<DBusSim> PROPERTIES[] =
+{
+    DBUS_UTILS_PROPERTY(DBusSim, Property::Iccid, "Iccid", iccid),
+    DBUS_UTILS_PROPERTY(DBusSim, Property::Imsi, "Imsi", imsi),
+    DBUS_UTILS_PROPERTY(DBusSim, Property::PrimaryPhoneNumber, "PrimaryPhoneNumber", primaryPhoneNumber),
+    DBUS_UTILS_PROPERTY(DBusSim, Property::Locked, "Locked", locked),
+    DBUS_UTILS_PROPERTY(DBusSim, Property::Present, "Present", present),
+    DBUS_UTILS_PROPERTY(DBusSim, Property::Mcc, "Mcc", mcc),
+    DBUS_UTILS_PROPERTY(DBusSim, Property::Mnc, "Mnc", mnc),
+    DBUS_UTILS_PROPERTY(DBusSim, Property::PreferredLanguages, "PreferredLanguages", preferredLanguages),
+    DBUS_UTILS_PROPERTY(DBusSim, Property::DataRoamingEnabled, "DataRoamingEnabled", dataRoamingEnabled)
+};
+static_assert(DBusUtils::propertiesInOrder(PROPERTIES), "SIM property table out of order");
+}
+
 DBusSim::DBusSim(Sim::Ptr sim,
                  const QDBusConnection& connection) :
     m_sim(sim),
-    m_connection(connection)
+    m_connection(connection),
+    m_path(DBusTypes::simPath()),
+    m_properties(*this, PROPERTIES, m_connection, m_path.path(),
+                 DBusUtils::adaptorInterface<SimAdaptor>())
 {
-    m_path.setPath(DBusTypes::simPath());
-
     new SimAdaptor(this);
 
     registerDBusObject();
@@ -60,6 +90,11 @@ QDBusObjectPath DBusSim::path() const
     return m_path;
 }
 
+QVariantDictMap DBusSim::interfaces() const
+{
+    return {{m_properties.interface(), m_properties.allProperties()}};
+}
+
 void DBusSim::registerDBusObject()
 {
     if (!m_connection.registerObject(m_path.path(), this))
@@ -68,17 +103,6 @@ void DBusSim::registerDBusObject()
     }
 }
 
-void DBusSim::notifyProperties(const QStringList& propertyNames)
-{
-    DBusUtils::notifyPropertyChanged(
-        m_connection,
-        *this,
-        m_path.path(),
-        SimAdaptor::staticMetaObject.classInfo(SimAdaptor::staticMetaObject.indexOfClassInfo("D-Bus Interface")).value(),
-        propertyNames
-    );
-}
-
 QString DBusSim::iccid() const
 {
     return m_sim->iccid();
@@ -136,42 +160,42 @@ void DBusSim::Unlock()
 
 void DBusSim::lockedChanged()
 {
-    notifyProperties({"Locked"});
+    m_properties.notify({Property::Locked});
 }
 
 void DBusSim::presentChanged()
 {
-    notifyProperties({"Present"});
+    m_properties.notify({Property::Present});
 }
 
 void DBusSim::dataRoamingEnabledChanged()
 {
-    notifyProperties({"DataRoamingEnabled"});
+    m_properties.notify({Property::DataRoamingEnabled});
 }
 
 void DBusSim::imsiChanged()
 {
-    notifyProperties({"Imsi"});
+    m_properties.notify({Property::Imsi});
 }
 
 void DBusSim::primaryPhoneNumberChanged()
 {
-    notifyProperties({"PrimaryPhoneNumber"});
+    m_properties.notify({Property::PrimaryPhoneNumber});
 }
 
 void DBusSim::mccChanged()
 {
-    notifyProperties({"Mcc"});
+    m_properties.notify({Property::Mcc});
 }
 
 void DBusSim::mncChanged()
 {
-    notifyProperties({"Mnc"});
+    m_properties.notify({Property::Mnc});
 }
 
 void DBusSim::preferredLanguagesChanged()
 {
-    notifyProperties({"PreferredLanguages"});
+    m_properties.notify({Property::PreferredLanguages});
 }
 
 nmofono::wwan::Sim::Ptr DBusSim::sim() const
@@ -20,6 +20,8 @@
 #pragma once
 
 #include <nmofono/wwan/sim.h>
+#include <util/dbus-utils.h>
+#include <dbus-types.h>
 
 #include <QDBusConnection>
 #include <QDBusContext>
@@ -78,6 +80,8 @@ public:
 
     QDBusObjectPath path() const;
 
+    QVariantDictMap interfaces() const;
+
     nmofono::wwan::Sim::Ptr sim() const;
 
 Q_SIGNALS:
@@ -95,9 +99,6 @@ protected Q_SLOTS:
     void mncChanged();
     void preferredLanguagesChanged();
 
-private:
-    void notifyProperties(const QStringList& propertyNames);
-
 protected:
     void registerDBusObject();
 
@@ -106,6 +107,8 @@ protected:
     QDBusConnection m_connection;
 
     QDBusObjectPath m_path;
+
+    DBusUtils::PropertyNotifier<DBusSim> m_properties;
 };
 
 }
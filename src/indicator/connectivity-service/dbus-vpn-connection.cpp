@@ -20,7 +20,6 @@
 #include <connectivity-service/dbus-vpn-connection.h>
 #include <VpnConnectionAdaptor.h>
 #include <dbus-types.h>
-#include <util/dbus-utils.h>
 
 using namespace std;
 using namespace nmofono::vpn;
@@ -28,12 +27,35 @@ using namespace nmofono::vpn;
 namespace connectivity_service
 {
 
+namespace
+{
+enum class Property
+{
+    Id,
+    NeverDefault,
+    Active,
+    Activatable,
+    Type
+};
+
+constexpr DBusUtils::PropertyDescriptor<DBusVpnConnection> PROPERTIES[] =
+{
+    DBUS_UTILS_PROPERTY(DBusVpnConnection, Property::Id, "id", id),
+    DBUS_UTILS_PROPERTY(DBusVpnConnection, Property::NeverDefault, "neverDefault", neverDefault),
+    DBUS_UTILS_PROPERTY(DBusVpnConnection, Property::Active, "active", active),
+    DBUS_UTILS_PROPERTY(DBusVpnConnection, Property::Activatable, "activatable", activatable),
+    DBUS_UTILS_PROPERTY(DBusVpnConnection, Property::Type, "type", intType)
+};
+static_assert(DBusUtils::propertiesInOrder(PROPERTIES), "VPN connection property table out of order");
+}
+
 DBusVpnConnection::DBusVpnConnection(VpnConnection::SPtr vpnConnection,
                                      const QDBusConnection& connection) :
-        m_vpnConnection(vpnConnection), m_connection(connection)
+        m_vpnConnection(vpnConnection), m_connection(connection),
+        m_path(DBusTypes::vpnConnectionPath()),
+        m_properties(*this, PROPERTIES, m_connection, m_path.path(),
+                     DBusUtils::adaptorInterface<VpnConnectionAdaptor>())
 {
-    m_path.setPath(DBusTypes::vpnConnectionPath());
-
     new VpnConnectionAdaptor(this);
 
     connect(m_vpnConnection.get(), &VpnConnection::idChanged, this, &DBusVpnConnection::idUpdated);
@@ -61,37 +83,26 @@ void DBusVpnConnection::registerDBusObject()
 
 void DBusVpnConnection::idUpdated(const QString&)
 {
-    notifyProperties({"id"});
+    m_properties.notify({Property::Id});
 }
 
 void DBusVpnConnection::neverDefaultUpdated(bool)
 {
-    notifyProperties({"neverDefault"});
+    m_properties.notify({Property::NeverDefault});
 }
 
 void DBusVpnConnection::activeUpdated(bool)
 {
-    notifyProperties({"active"});
+    m_properties.notify({Property::Active});
     DBusUtils::flushPropertyChanges();
 }
 
 void DBusVpnConnection::activatableUpdated(bool)
 {
-    notifyProperties({"activatable"});
+    m_properties.notify({Property::Activatable});
     DBusUtils::flushPropertyChanges();
 }
 
-void DBusVpnConnection::notifyProperties(const QStringList& propertyNames)
-{
-    DBusUtils::notifyPropertyChanged(
-        m_connection,
-        *this,
-        m_path.path(),
-        VpnConnectionAdaptor::staticMetaObject.classInfo(VpnConnectionAdaptor::staticMetaObject.indexOfClassInfo("D-Bus Interface")).value(),
-        propertyNames
-    );
-}
-
 QString DBusVpnConnection::id() const
 {
     return m_vpnConnection->id();
@@ -117,6 +128,11 @@ QDBusObjectPath DBusVpnConnection::path() const
     return m_path;
 }
 
+QVariantDictMap DBusVpnConnection::interfaces() const
+{
+    return {{m_properties.interface(), m_properties.allProperties()}};
+}
+
 int DBusVpnConnection::intType() const
 {
     return static_cast<int>(type());
@@ -20,6 +20,8 @@
 #pragma once
 
 #include <nmofono/vpn/vpn-connection.h>
+#include <util/dbus-utils.h>
+#include <dbus-types.h>
 
 #include <QDBusConnection>
 #include <QDBusContext>
@@ -63,6 +65,11 @@ public:
 
     QDBusObjectPath path() const;
 
+    virtual QVariantDictMap interfaces() const;
+
+    Q_PROPERTY(int type READ intType)
+    int intType() const;
+
     void remove();
 
 Q_SIGNALS:
@@ -83,20 +90,17 @@ protected Q_SLOTS:
 
     void neverDefaultUpdated(bool neverDefault);
 
-private:
-    void notifyProperties(const QStringList& propertyNames);
-
 protected:
     void registerDBusObject();
 
-    Q_PROPERTY(int type READ intType)
-    int intType() const;
-
     nmofono::vpn::VpnConnection::SPtr m_vpnConnection;
 
     QDBusConnection m_connection;
 
     QDBusObjectPath m_path;
+
+private:
+    DBusUtils::PropertyNotifier<DBusVpnConnection> m_properties;
 };
 
 }
@@ -19,14 +19,18 @@
 
 #include <factory.h>
 #include <util/logging.h>
+#include <util/trace.h>
 #include <util/unix-signal-handler.h>
+#include <util/wakeups.h>
 #include <dbus-types.h>
 
 #include <QCoreApplication>
+#include <QTimer>
 
 #include <libintl.h>
 #include <cstdlib>
 #include <ctime>
+#include <iostream>
 
 #include <glib.h>
 
@@ -42,6 +46,8 @@ main(int argc, char **argv)
     qInstallMessageHandler(util::loggingFunction);
 
     QCoreApplication app(argc, argv);
+    util::trace::traceEventLoop(app.eventDispatcher());
+    util::wakeups::install(&app);
     DBusTypes::registerMetaTypes();
     Variant::registerMetaTypes();
     std::srand(std::time(0));
@@ -61,6 +67,26 @@ main(int argc, char **argv)
         qDebug() << QDBusConnection::systemBus().baseService();
     }
 
+    // The report costs a wakeup of its own each minute
+    QTimer wakeupReport;
+    if (app.arguments().contains("--report-wakeups"))
+    {
+        wakeupReport.setObjectName("wakeup report");
+        wakeupReport.setInterval(60000);
+        wakeupReport.setTimerType(Qt::CoarseTimer);
+        QObject::connect(&wakeupReport, &QTimer::timeout, []()
+        {
+            cout << "Wakeups per second over the last minute: "
+                    << util::wakeups::total().lastMinute << endl;
+            for (const auto& rate: util::wakeups::rates())
+            {
+                cout << "    " << rate.lastMinute << "  "
+                        << rate.source.toStdString() << endl;
+            }
+        });
+        wakeupReport.start();
+    }
+
     Factory factory;
     auto menu = factory.newMenuBuilder();
     auto connectivityService = factory.newConnectivityService();
@@ -18,9 +18,11 @@
 
 #include <nmofono/connection/active-connection-manager.h>
 #include <NetworkManagerInterface.h>
+#include <backend-utils.h>
 #include <util/qhash-sharedptr.h>
 
 #include <NetworkManager.h>
+#include <QHash>
 
 using namespace std;
 
@@ -50,24 +52,129 @@ public:
         auto toAdd(connections);
         toAdd.subtract(current);
 
+        QList<ActiveConnection::SPtr> removed;
         for (const auto& path: toRemove)
         {
-            m_connections.remove(path);
+            auto connection = m_connections.take(path);
+            m_snapshot.remove(connection);
+            removeConnection(connection);
+            removed << connection;
         }
 
+        QList<ActiveConnection::SPtr> added;
         for (const auto& path: toAdd)
         {
-            m_connections[path] = make_shared<ActiveConnection>(path, m_manager->connection());
+            auto connection = make_shared<ActiveConnection>(path, m_manager->connection());
+            m_connections[path] = connection;
+            m_snapshot.insert(connection);
+            addConnection(connection);
+            added << connection;
         }
 
-        if (!toRemove.isEmpty() || !toAdd.isEmpty())
+        if (!added.isEmpty())
         {
-            Q_EMIT p.connectionsChanged(m_connections.values().toSet());
+            Q_EMIT p.connectionsAdded(added);
+        }
+        if (!removed.isEmpty())
+        {
+            Q_EMIT p.connectionsRemoved(removed);
+        }
+        if (!added.isEmpty() || !removed.isEmpty())
+        {
+            Q_EMIT p.connectionsChanged(m_snapshot);
             Q_EMIT p.connectionsUpdated();
         }
     }
 
+    void addConnection(ActiveConnection::SPtr connection)
+    {
+        connect(connection.get(), &ActiveConnection::connectionPathChanged, this, &Priv::connectionPathChanged);
+        connect(connection.get(), &ActiveConnection::stateChanged, this, &Priv::connectionStateChanged);
+        connect(connection.get(), &ActiveConnection::typeChanged, this, &Priv::connectionStateChanged);
+
+        index(connection);
+    }
+
+    void removeConnection(ActiveConnection::SPtr connection)
+    {
+        // Someone else might still hold it, so stop listening explicitly
+        connection->disconnect(this);
+
+        unindex(connection.get());
+    }
+
+    void index(ActiveConnection::SPtr connection)
+    {
+        QString settingsPath = connection->connectionPath().path();
+        m_settingsPaths[connection.get()] = settingsPath;
+        m_bySettingsPath[settingsPath] = connection;
+        notify(settingsPath);
+    }
+
+    void unindex(ActiveConnection* connection)
+    {
+        QString settingsPath = m_settingsPaths.take(connection);
+        auto it = m_bySettingsPath.find(settingsPath);
+        if (it == m_bySettingsPath.end() || it->get() != connection)
+        {
+            return;
+        }
+        m_bySettingsPath.erase(it);
+
+        // Fall back to any other active connection for the same settings,
+        // e.g. a new activation racing the old one's teardown
+        for (const auto& other: m_connections)
+        {
+            if (m_settingsPaths.value(other.get()) == settingsPath)
+            {
+                m_bySettingsPath[settingsPath] = other;
+                break;
+            }
+        }
+
+        notify(settingsPath);
+    }
+
+    void notify(const QString& settingsPath)
+    {
+        auto watcher = m_watchers.value(settingsPath).lock();
+        if (watcher)
+        {
+            Q_EMIT watcher->activeConnectionChanged(m_bySettingsPath.value(settingsPath));
+        }
+    }
+
+    ActiveConnection::SPtr find(ActiveConnection* connection) const
+    {
+        auto it = m_connections.constFind(connection->path());
+        if (it == m_connections.constEnd() || it->get() != connection)
+        {
+            return ActiveConnection::SPtr();
+        }
+        return *it;
+    }
+
 public Q_SLOTS:
+    void connectionPathChanged()
+    {
+        auto connection = find(qobject_cast<ActiveConnection*>(sender()));
+        if (connection)
+        {
+            unindex(connection.get());
+            index(connection);
+        }
+    }
+
+    void connectionStateChanged()
+    {
+        auto connection = qobject_cast<ActiveConnection*>(sender());
+        auto it = m_settingsPaths.constFind(connection);
+        if (it != m_settingsPaths.constEnd() && m_bySettingsPath.value(*it).get() == connection)
+        {
+            notify(*it);
+        }
+    }
+
     void propertiesChanged(const QVariantMap &properties)
     {
         QMapIterator<QString, QVariant> it(properties);
@@ -92,12 +199,26 @@ public:
     shared_ptr<OrgFreedesktopNetworkManagerInterface> m_manager;
 
     QMap<QDBusObjectPath, ActiveConnection::SPtr> m_connections;
+
+    QSet<ActiveConnection::SPtr> m_snapshot;
+
+    // Settings connection path -> the active connection for it
+    QHash<QString, ActiveConnection::SPtr> m_bySettingsPath;
+
+    // Reverse index, so a connection can be found again once its path changes
+    QHash<ActiveConnection*, QString> m_settingsPaths;
+
+    QHash<QString, weak_ptr<ActiveConnectionWatcher>> m_watchers;
 };
 
 ActiveConnectionManager::ActiveConnectionManager(const QDBusConnection& systemConnection) :
         d(new Priv(*this))
 {
-    d->m_manager = make_shared<OrgFreedesktopNetworkManagerInterface>(NM_DBUS_SERVICE, NM_DBUS_PATH, systemConnection);
+    // The deltas can be queued, e.g. by HotspotManager
+    qRegisterMetaType<ActiveConnection::SPtr>("ActiveConnection::SPtr");
+    qRegisterMetaType<QList<ActiveConnection::SPtr>>("QList<ActiveConnection::SPtr>");
+
+    d->m_manager = make_shared<utils::Instrumented<OrgFreedesktopNetworkManagerInterface>>(NM_DBUS_SERVICE, NM_DBUS_PATH, systemConnection);
 
     d->updateConnections(d->m_manager->activeConnections());
 
@@ -106,13 +227,30 @@ ActiveConnectionManager::ActiveConnectionManager(const QDBusConnection& systemCo
 
 QSet<ActiveConnection::SPtr> ActiveConnectionManager::connections() const
 {
-    return d->m_connections.values().toSet();
+    return d->m_snapshot;
+}
+
+ActiveConnection::SPtr ActiveConnectionManager::connection(const QDBusObjectPath& connectionPath) const
+{
+    return d->m_bySettingsPath.value(connectionPath.path());
+}
+
+ActiveConnectionWatcher::SPtr ActiveConnectionManager::watch(const QDBusObjectPath& connectionPath)
+{
+    auto& entry = d->m_watchers[connectionPath.path()];
+    auto watcher = entry.lock();
+    if (!watcher)
+    {
+        watcher = make_shared<ActiveConnectionWatcher>();
+        entry = watcher;
+    }
+    return watcher;
 }
 
 bool ActiveConnectionManager::deactivate(ActiveConnection::SPtr activeConnection)
 {
     auto reply = d->m_manager->DeactivateConnection(activeConnection->path());
-    reply.waitForFinished();
+    utils::waitForFinished(reply, "org.freedesktop.NetworkManager.DeactivateConnection");
     if (reply.isError())
     {
         qWarning() << reply.error().message();
@@ -28,6 +28,30 @@ namespace nmofono
 namespace connection
 {
 
+/**
+ * Follows whichever active connection belongs to one settings connection.
+ * Obtained from ActiveConnectionManager::watch(), so only the watchers of
+ * the affected settings path hear about a change.
+ */
+class ActiveConnectionWatcher: public QObject
+{
+    Q_OBJECT
+
+public:
+    UNITY_DEFINES_PTRS(ActiveConnectionWatcher);
+
+    ActiveConnectionWatcher() = default;
+
+    ~ActiveConnectionWatcher() = default;
+
+Q_SIGNALS:
+    /**
+     * The active connection appeared, went away (null), or changed its
+     * state or type.
+     */
+    void activeConnectionChanged(ActiveConnection::SPtr activeConnection);
+};
+
 class ActiveConnectionManager: public QObject
 {
     Q_OBJECT
@@ -39,11 +63,31 @@ public:
 
     ~ActiveConnectionManager() = default;
 
+    /**
+     * Maintained as connections come and go, so taking a copy is cheap.
+     */
     QSet<ActiveConnection::SPtr> connections() const;
 
+    /**
+     * The active connection for the given settings connection path, if any.
+     */
+    ActiveConnection::SPtr connection(const QDBusObjectPath& connectionPath) const;
+
+    /**
+     * Watchers are shared between everyone watching the same path.
+     */
+    ActiveConnectionWatcher::SPtr watch(const QDBusObjectPath& connectionPath);
+
     bool deactivate(ActiveConnection::SPtr activeConnection);
 
 Q_SIGNALS:
+    /**
+     * Emitted before connectionsRemoved for the same update.
+     */
+    void connectionsAdded(const QList<ActiveConnection::SPtr>& connections);
+
+    void connectionsRemoved(const QList<ActiveConnection::SPtr>& connections);
+
     void connectionsChanged(const QSet<ActiveConnection::SPtr>& connections);
 
     void connectionsUpdated();
@@ -55,3 +99,6 @@ protected:
 
 }
 }
+
+Q_DECLARE_METATYPE(nmofono::connection::ActiveConnection::SPtr)
+Q_DECLARE_METATYPE(QList<nmofono::connection::ActiveConnection::SPtr>)
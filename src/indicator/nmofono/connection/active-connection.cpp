@@ -18,6 +18,7 @@
 
 #include <nmofono/connection/active-connection.h>
 #include <NetworkManagerActiveConnectionInterface.h>
+#include <backend-utils.h>
 
 using namespace std;
 
@@ -140,7 +141,7 @@ public:
 ActiveConnection::ActiveConnection(const QDBusObjectPath& path, const QDBusConnection& systemConnection) :
         d(new Priv(*this))
 {
-    d->m_activeConnection = make_shared<OrgFreedesktopNetworkManagerConnectionActiveInterface>(NM_DBUS_SERVICE, path.path(), systemConnection);
+    d->m_activeConnection = make_shared<utils::Instrumented<OrgFreedesktopNetworkManagerConnectionActiveInterface>>(NM_DBUS_SERVICE, path.path(), systemConnection);
 
     d->setId(d->m_activeConnection->id());
     d->setType(d->m_activeConnection->type());
@@ -19,6 +19,7 @@
 #include <nmofono/connection/active-connection.h>
 #include <nmofono/connection/active-vpn-connection.h>
 #include <NetworkManagerVpnConnectionInterface.h>
+#include <backend-utils.h>
 
 using namespace std;
 
@@ -56,7 +57,7 @@ public:
 ActiveVpnConnection::ActiveVpnConnection(const QDBusObjectPath& path, const QDBusConnection& connection, ActiveConnection& activeConnection) :
         d(new Priv(*this, activeConnection))
 {
-    d->m_interface = make_shared<OrgFreedesktopNetworkManagerVPNConnectionInterface>(NM_DBUS_SERVICE, path.path(), connection);
+    d->m_interface = make_shared<utils::Instrumented<OrgFreedesktopNetworkManagerVPNConnectionInterface>>(NM_DBUS_SERVICE, path.path(), connection);
     connect(d->m_interface.get(), &OrgFreedesktopNetworkManagerVPNConnectionInterface::VpnStateChanged, d.get(), &Priv::vpnStateChanged);
 
     d->vpnStateChanged(d->m_interface->vpnState(), static_cast<int>(Reason::UNKNOWN));
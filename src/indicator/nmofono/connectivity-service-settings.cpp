@@ -110,6 +110,46 @@ void ConnectivityServiceSettings::setKnownSims(const QStringList &list)
     d->m_settings->setValue("KnownSims", QVariant(list));
 }
 
+QVariantMap ConnectivityServiceSettings::modemIndices()
+{
+    return d->m_settings->value("ModemIndices").toMap();
+}
+
+void ConnectivityServiceSettings::setModemIndices(const QVariantMap &indices)
+{
+    d->m_settings->setValue("ModemIndices", indices);
+}
+
+int ConnectivityServiceSettings::modemSession()
+{
+    return d->m_settings->value("ModemSession", 0).toInt();
+}
+
+void ConnectivityServiceSettings::setModemSession(int session)
+{
+    d->m_settings->setValue("ModemSession", session);
+}
+
+QVariantMap ConnectivityServiceSettings::modemsLastSeen()
+{
+    return d->m_settings->value("ModemsLastSeen").toMap();
+}
+
+void ConnectivityServiceSettings::setModemsLastSeen(const QVariantMap &lastSeen)
+{
+    d->m_settings->setValue("ModemsLastSeen", lastSeen);
+}
+
+QVariant ConnectivityServiceSettings::coalescingWindow(const QString &interface)
+{
+    return d->m_settings->value(QString("Coalescing/%1/Window").arg(interface));
+}
+
+QVariant ConnectivityServiceSettings::coalescingMaxLatency(const QString &interface)
+{
+    return d->m_settings->value(QString("Coalescing/%1/MaxLatency").arg(interface));
+}
+
 wwan::Sim::Ptr ConnectivityServiceSettings::createSimFromSettings(const QString &iccid)
 {
     d->m_settings->beginGroup(QString("Sims/%1/").arg(iccid));
@@ -55,6 +55,25 @@ public:
     QStringList knownSims();
     void setKnownSims(const QStringList &list);
 
+    QVariantMap modemIndices();
+    void setModemIndices(const QVariantMap &indices);
+
+    /**
+     * Counts the times the service has started, and the last of those in
+     * which each modem path was seen.
+     */
+    int modemSession();
+    void setModemSession(int session);
+    QVariantMap modemsLastSeen();
+    void setModemsLastSeen(const QVariantMap &lastSeen);
+
+    /**
+     * Overrides for how long PropertiesChanged signals of the given D-Bus
+     * interface may be held back, in milliseconds. Null when not set.
+     */
+    QVariant coalescingWindow(const QString &interface);
+    QVariant coalescingMaxLatency(const QString &interface);
+
     wwan::Sim::Ptr createSimFromSettings(const QString &iccid);
     void saveSimToSettings(wwan::Sim::Ptr sim);
 
@@ -20,6 +20,7 @@
 
 #include <nmofono/hotspot-manager.h>
 #include <qpowerd/qpowerd.h>
+#include <backend-utils.h>
 #include <NetworkManagerActiveConnectionInterface.h>
 #include <NetworkManagerDeviceInterface.h>
 #include <NetworkManagerInterface.h>
@@ -67,7 +68,7 @@ public:
                                                               m_mode, m_auth);
 
         auto add_connection_reply = m_settings->AddConnection(connection);
-        add_connection_reply.waitForFinished();
+        utils::waitForFinished(add_connection_reply, "org.freedesktop.NetworkManager.Settings.AddConnection");
 
         if (add_connection_reply.isError())
         {
@@ -83,7 +84,7 @@ public:
         QDBusObjectPath connectionPath(add_connection_reply);
 
         m_hotspot = make_shared<
-                OrgFreedesktopNetworkManagerSettingsConnectionInterface>(
+                utils::Instrumented<OrgFreedesktopNetworkManagerSettingsConnectionInterface>>(
                 NM_DBUS_SERVICE, connectionPath.path(), m_manager->connection());
 
         setStored(true);
@@ -97,7 +98,7 @@ public:
                                                                 m_password,
                                                                 m_mode, m_auth);
         auto updating = m_hotspot->Update(new_settings);
-        updating.waitForFinished();
+        utils::waitForFinished(updating, "org.freedesktop.NetworkManager.Settings.Connection.Update");
         if (!updating.isValid())
         {
             qCritical()
@@ -111,7 +112,7 @@ public:
         auto reply = m_manager->ActivateConnection(
                         QDBusObjectPath(m_hotspot->path()), device,
                         QDBusObjectPath("/"));
-        reply.waitForFinished();
+        utils::waitForFinished(reply, "org.freedesktop.NetworkManager.ActivateConnection");
         if (reply.isError())
         {
             qCritical() << "Could not activate hotspot connection"
@@ -121,7 +122,7 @@ public:
 
         QDBusObjectPath activeConnectionPath(reply);
 
-        OrgFreedesktopNetworkManagerConnectionActiveInterface activeConnection (
+        utils::Instrumented<OrgFreedesktopNetworkManagerConnectionActiveInterface> activeConnection (
                     NM_DBUS_SERVICE, activeConnectionPath.path (),
                     m_manager->connection());
 
@@ -155,7 +156,7 @@ public:
         {
             // If our connection gets booted, reconnect
             connect(m_activeConnectionManager.get(),
-                    &connection::ActiveConnectionManager::connectionsUpdated, this,
+                    &connection::ActiveConnectionManager::connectionsRemoved, this,
                     &Priv::reactivateConnection,
                     Qt::QueuedConnection);
         }
@@ -167,7 +168,7 @@ public:
     void disable()
     {
         disconnect(m_activeConnectionManager.get(),
-                   &connection::ActiveConnectionManager::connectionsUpdated,
+                   &connection::ActiveConnectionManager::connectionsRemoved,
                    this, &Priv::reactivateConnection);
 
         auto activeConnection = getActiveConnection();
@@ -256,6 +257,7 @@ public:
         QStringList arguments;
         arguments << "wifi.tethering.interface";
 
+        util::trace::Span span("getprop", "process");
         QProcess getprop;
         getprop.start(program, arguments);
 
@@ -310,7 +312,7 @@ public:
         // Iterate in reverse to attempt to minimise dbus calls (new device is likely at the end)
         for (auto path = devices.rbegin(); path != devices.rend(); ++path)
         {
-            OrgFreedesktopNetworkManagerDeviceInterface device(NM_DBUS_SERVICE, path->path(), m_manager->connection());
+            utils::Instrumented<OrgFreedesktopNetworkManagerDeviceInterface> device(NM_DBUS_SERVICE, path->path(), m_manager->connection());
 
             QString interface = device.interface();
 
@@ -429,7 +431,7 @@ public:
      */
     QVariantDictMap getConnectionSettings (OrgFreedesktopNetworkManagerSettingsConnectionInterface& conn) {
         auto connection_settings = conn.GetSettings();
-        connection_settings.waitForFinished();
+        utils::waitForFinished(connection_settings, "org.freedesktop.NetworkManager.Settings.Connection.GetSettings");
         return connection_settings.value();
     }
 
@@ -443,7 +445,7 @@ public:
         const QString key)
     {
         auto connection_secrets = conn.GetSecrets(key);
-        connection_secrets.waitForFinished();
+        utils::waitForFinished(connection_secrets, "org.freedesktop.NetworkManager.Settings.Connection.GetSecrets");
         return connection_secrets.value();
     }
 
@@ -456,11 +458,11 @@ public:
         const char wifi_key[] = "802-11-wireless";
 
         auto listed_connections = m_settings->ListConnections();
-        listed_connections.waitForFinished();
+        utils::waitForFinished(listed_connections, "org.freedesktop.NetworkManager.Settings.ListConnections");
 
         for (const auto &connection : listed_connections.value())
         {
-            auto conn = make_shared<OrgFreedesktopNetworkManagerSettingsConnectionInterface>(
+            auto conn = make_shared<utils::Instrumented<OrgFreedesktopNetworkManagerSettingsConnectionInterface>>(
                     NM_DBUS_SERVICE, connection.path(),
                     m_manager->connection());
 
@@ -489,14 +491,7 @@ public:
 
         if (m_hotspot)
         {
-            for (const auto &active_connection : m_activeConnectionManager->connections())
-            {
-                if (active_connection->connectionPath().path() == m_hotspot->path())
-                {
-                    activeConnection = active_connection;
-                    break;
-                }
-            }
+            activeConnection = m_activeConnectionManager->connection(QDBusObjectPath(m_hotspot->path()));
         }
 
         return activeConnection;
@@ -617,9 +612,9 @@ HotspotManager::HotspotManager(connection::ActiveConnectionManager::SPtr activeC
 {
     d->m_activeConnectionManager = activeConnectionManager;
 
-    d->m_manager = make_unique<OrgFreedesktopNetworkManagerInterface>(
+    d->m_manager = make_unique<utils::Instrumented<OrgFreedesktopNetworkManagerInterface>>(
             NM_DBUS_SERVICE, NM_DBUS_PATH, connection);
-    d->m_settings = make_unique<OrgFreedesktopNetworkManagerSettingsInterface>(
+    d->m_settings = make_unique<utils::Instrumented<OrgFreedesktopNetworkManagerSettingsInterface>>(
             NM_DBUS_SERVICE, NM_DBUS_PATH_SETTINGS, connection);
 
     d->m_powerd = make_unique<QPowerd>(connection);
@@ -94,17 +94,17 @@ public Q_SLOTS:
 
 KillSwitch::KillSwitch(const QDBusConnection& systemBus)
 {
-    auto urfkill = std::make_shared<OrgFreedesktopURfkillInterface>(DBusTypes::URFKILL_BUS_NAME,
+    auto urfkill = std::make_shared<utils::Instrumented<OrgFreedesktopURfkillInterface>>(DBusTypes::URFKILL_BUS_NAME,
                                                                     DBusTypes::URFKILL_OBJ_PATH,
                                                                     systemBus);
 
-    auto killSwitch = std::make_shared<OrgFreedesktopURfkillKillswitchInterface>(DBusTypes::URFKILL_BUS_NAME,
+    auto killSwitch = std::make_shared<utils::Instrumented<OrgFreedesktopURfkillKillswitchInterface>>(DBusTypes::URFKILL_BUS_NAME,
                                                                                  DBusTypes::URFKILL_WIFI_OBJ_PATH,
                                                                                  systemBus);
 
     d = make_unique<Private>(*this, urfkill, killSwitch);
     auto reply = urfkill->IsFlightMode();
-    reply.waitForFinished();
+    utils::waitForFinished(reply, "org.freedesktop.URfkill.IsFlightMode");
     qDebug() << Q_FUNC_INFO << "reply.isValid()" << reply.isValid() << "reply.value()" << reply.value() << "reply.error()" << reply.error();
     d->setFlightMode(reply.isValid() ? reply.value() : false);
     d->stateChanged();
@@ -137,7 +137,7 @@ KillSwitch::setBlock(bool block)
 
     try
     {
-        if (!utils::getOrThrow(d->urfkill->Block(static_cast<uint>(Private::DeviceType::wlan), block)))
+        if (!utils::getOrThrow(d->urfkill->Block(static_cast<uint>(Private::DeviceType::wlan), block), "org.freedesktop.URfkill.Block"))
         {
             throw std::runtime_error("Failed to block killswitch");
         }
@@ -162,7 +162,7 @@ bool KillSwitch::flightMode(bool enable)
 
     try
     {
-        return utils::getOrThrow(d->urfkill->FlightMode(enable));
+        return utils::getOrThrow(d->urfkill->FlightMode(enable), "org.freedesktop.URfkill.FlightMode");
     }
     catch (std::runtime_error& e)
     {
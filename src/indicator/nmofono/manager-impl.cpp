@@ -21,12 +21,14 @@
 #include <nmofono/manager-impl.h>
 #include <nmofono/connectivity-service-settings.h>
 #include <nmofono/wifi/wifi-link-impl.h>
+#include <nmofono/wwan/ofono-proxy-registry.h>
 #include <nmofono/wwan/sim-manager.h>
 #include <NetworkManagerActiveConnectionInterface.h>
 #include <NetworkManagerDeviceInterface.h>
 #include <NetworkManagerInterface.h>
 #include <NetworkManagerSettingsInterface.h>
 #include <NetworkManagerSettingsConnectionInterface.h>
+#include <backend-utils.h>
 
 #define slots
 #include <qofono-qt5/qofonomanager.h>
@@ -38,7 +40,9 @@
 #include <notify-cpp/snapdecision/sim-unlock.h>
 #include <sim-unlock-dialog.h>
 #include <util/qhash-sharedptr.h>
+#include <util/logging.h>
 
+#include <QHash>
 #include <QMap>
 #include <QList>
 #include <QRegularExpression>
@@ -60,6 +64,7 @@ public:
 
     shared_ptr<OrgFreedesktopNetworkManagerInterface> nm;
     shared_ptr<QOfonoManager> m_ofono;
+    wwan::OfonoProxyRegistry::Ptr m_ofonoProxies;
 
     bool m_flightMode = true;
     bool m_unstoppableOperationHappening = false;
@@ -88,11 +93,19 @@ public:
 
     QList<wwan::Modem::Ptr> m_modems;
     QList<wwan::Sim::Ptr> m_sims;
+    QHash<QString, wwan::Sim::Ptr> m_simsByIccid;
+    QHash<QString, wwan::Sim::Ptr> m_simsByOfonoPath;
+    QHash<wwan::Sim::Ptr, QString> m_ofonoPathBySim;
 
     wwan::SimManager::Ptr m_simManager;
 
     ConnectivityServiceSettings::Ptr m_settings;
 
+    // How many sessions a modem's index outlives its last sighting
+    static constexpr int MODEM_INDEX_SESSIONS = 10;
+
+    int m_modemSession = 0;
+
     QTimer m_checkSimForMobileDataTimer;
 
     Private(Manager& parent) :
@@ -137,41 +150,89 @@ public Q_SLOTS:
         }
     }
 
-    void matchModemsAndSims()
+    void registerSim(wwan::Sim::Ptr sim)
     {
-        for (wwan::Modem::Ptr modem: m_ofonoLinks)
+        m_sims.append(sim);
+        m_simsByIccid[sim->iccid()] = sim;
+        connect(sim.get(), &wwan::Sim::presentChanged, this, &Private::simPresentChanged);
+        connect(sim.get(), &wwan::Sim::presentChanged, this, &Private::startCheckSimForMobileDataTimer);
+        connect(sim.get(), &wwan::Sim::initialDataOnSet, this, &Private::initialDataOnSet);
+        updateSimOfonoPath(sim);
+
+        // It may have taken its initial state from a shared proxy already
+        if (sim->initialDataOn())
         {
-            bool match = false;
-            for(wwan::Sim::Ptr sim : m_sims)
-            {
-                if (sim->ofonoPath() == modem->ofonoPath())
-                {
-                    match = true;
-                    modem->setSim(sim);
-
-                    if (m_mobileDataEnabledPending || m_simForMobileDataPending)
-                    {
-                        connect(modem->sim().get(), &wwan::Sim::initialDataOnSet, this, &Private::initialDataOnSet);
-                        if (modem->sim()->initialDataOn())
-                        {
-                            modem->sim()->initialDataOnSet();
-                        }
-                    }
-                    break;
-                }
-            }
-            if (!match)
+            applyInitialDataOn(sim);
+        }
+    }
+
+    /**
+     * Re-index the SIM by its current oFono path and re-match only the
+     * modems it moved between.
+     */
+    void updateSimOfonoPath(wwan::Sim::Ptr sim)
+    {
+        QString oldPath = m_ofonoPathBySim.value(sim);
+        QString newPath = sim->ofonoPath();
+        if (oldPath == newPath)
+        {
+            return;
+        }
+
+        if (!oldPath.isEmpty())
+        {
+            if (m_simsByOfonoPath.value(oldPath) == sim)
             {
-                modem->setSim(wwan::Sim::Ptr());
+                m_simsByOfonoPath.remove(oldPath);
             }
+            m_ofonoPathBySim.remove(sim);
+        }
+        if (!newPath.isEmpty())
+        {
+            m_simsByOfonoPath[newPath] = sim;
+            m_ofonoPathBySim[sim] = newPath;
+        }
+
+        matchModem(oldPath);
+        matchModem(newPath);
+    }
+
+    void matchModem(const QString& ofonoPath)
+    {
+        if (ofonoPath.isEmpty())
+        {
+            return;
+        }
+
+        auto modem = m_ofonoLinks.value(ofonoPath);
+        if (!modem)
+        {
+            return;
+        }
+
+        auto sim = m_simsByOfonoPath.value(ofonoPath);
+        modem->setSim(sim);
+
+        if (sim && sim->initialDataOn())
+        {
+            applyInitialDataOn(sim);
+        }
+    }
+
+    void simPresentChanged()
+    {
+        wwan::Sim *sim_raw = qobject_cast<wwan::Sim*>(sender());
+        if (!sim_raw)
+        {
+            Q_ASSERT(0);
+            return;
         }
+        updateSimOfonoPath(sim_raw->shared_from_this());
     }
 
     void simAdded(wwan::Sim::Ptr sim)
     {
-        m_sims.append(sim);
-        connect(sim.get(), &wwan::Sim::presentChanged, this, &Private::matchModemsAndSims);
-        connect(sim.get(), &wwan::Sim::presentChanged, this, &Private::startCheckSimForMobileDataTimer);
+        registerSim(sim);
         Q_EMIT p.simsChanged();
 
         QString iccid = m_settings->simForMobileData().toString();
@@ -182,7 +243,6 @@ public Q_SLOTS:
             }
         }
 
-        matchModemsAndSims();
         m_checkSimForMobileDataTimer.start();
     }
 
@@ -194,8 +254,11 @@ public Q_SLOTS:
             Q_ASSERT(0);
             return;
         }
-        wwan::Sim::Ptr sim = sim_raw->shared_from_this();
+        applyInitialDataOn(sim_raw->shared_from_this());
+    }
 
+    void applyInitialDataOn(wwan::Sim::Ptr sim)
+    {
         if (!m_mobileDataEnabledPending && !m_simForMobileDataPending)
         {
             return;
@@ -219,7 +282,7 @@ public Q_SLOTS:
         auto modem = m_ofonoLinks[modem_raw->name()];
         if (!modem->sim())
         {
-            matchModemsAndSims();
+            matchModem(modem->ofonoPath());
         }
 
         m_modems.append(modem);
@@ -270,16 +333,7 @@ public Q_SLOTS:
         }
         else
         {
-            QString iccid = ret.toString();
-            wwan::Sim::Ptr sim;
-            for(auto i = m_sims.begin(); i != m_sims.end(); i++)
-            {
-                if ((*i)->iccid() == iccid) {
-                    sim = *i;
-                    break;
-                }
-            }
-            setSimForMobileData(sim);
+            setSimForMobileData(m_simsByIccid.value(ret.toString()));
         }
     }
 
@@ -362,6 +416,86 @@ public Q_SLOTS:
         }
     }
 
+    /**
+     * Starts counting another session, and forgets the indices of modems
+     * that have not been seen for MODEM_INDEX_SESSIONS sessions, so paths
+     * that come and go don't pile up in the settings.
+     */
+    void startModemSession()
+    {
+        m_modemSession = m_settings->modemSession() + 1;
+        m_settings->setModemSession(m_modemSession);
+
+        auto indices = m_settings->modemIndices();
+        auto lastSeen = m_settings->modemsLastSeen();
+        QVariantMap keptIndices;
+        QVariantMap keptLastSeen;
+        for (auto it = indices.cbegin(); it != indices.cend(); ++it)
+        {
+            // Indices saved before sessions were counted start from this one
+            auto seen = lastSeen.value(it.key(), m_modemSession).toInt();
+            if (m_modemSession - seen <= MODEM_INDEX_SESSIONS)
+            {
+                keptIndices[it.key()] = it.value();
+                keptLastSeen[it.key()] = seen;
+            }
+            else
+            {
+                qCDebug(lcModem) << "Forgetting index of modem" << it.key();
+            }
+        }
+        m_settings->setModemIndices(keptIndices);
+        m_settings->setModemsLastSeen(keptLastSeen);
+    }
+
+    /**
+     * Modem indices are persisted per oFono path so a modem keeps its
+     * index (and SIM identifier) across restarts. A path ending in "_N"
+     * prefers index N+1, which keeps the "/ril_0" -> "SIM 1" convention.
+     */
+    int modemIndex(const QString& path)
+    {
+        auto lastSeen = m_settings->modemsLastSeen();
+        if (lastSeen.value(path).toInt() != m_modemSession)
+        {
+            lastSeen[path] = m_modemSession;
+            m_settings->setModemsLastSeen(lastSeen);
+        }
+
+        auto indices = m_settings->modemIndices();
+        auto it = indices.constFind(path);
+        if (it != indices.cend())
+        {
+            return it->toInt();
+        }
+
+        QSet<int> taken;
+        for (const auto& index : indices)
+        {
+            taken.insert(index.toInt());
+        }
+
+        int index = -1;
+        static const QRegularExpression suffix("_(\\d+)$");
+        auto match = suffix.match(path);
+        if (match.hasMatch())
+        {
+            index = match.captured(1).toInt() + 1;
+        }
+        if (index < 1 || taken.contains(index))
+        {
+            index = 1;
+            while (taken.contains(index))
+            {
+                ++index;
+            }
+        }
+
+        indices[path] = index;
+        m_settings->setModemIndices(indices);
+        return index;
+    }
+
     void modems_changed(const QStringList& value)
     {
         QSet<QString> modemPaths(value.toSet());
@@ -374,7 +508,7 @@ public Q_SLOTS:
         toAdd.subtract(currentModemPaths);
 
         if (!toRemove.isEmpty()) {
-            qDebug() << "Removing modems" << toRemove;
+            qCDebug(lcModem) << "Removing modems" << toRemove;
         }
         for (const auto& path : toRemove)
         {
@@ -390,14 +524,13 @@ public Q_SLOTS:
         }
 
         if (!toAdd.isEmpty()) {
-            qDebug() << "Adding modems" << toAdd;
+            qCDebug(lcModem) << "Adding modems" << toAdd;
         }
         for (const auto& path : toAdd)
         {
-            auto modemInterface = make_shared<QOfonoModem>();
-            modemInterface->setModemPath(path);
-
-            auto modem = make_shared<wwan::Modem>(modemInterface);
+            auto modem = make_shared<wwan::Modem>(m_ofonoProxies->modem(path),
+                                                  m_ofonoProxies,
+                                                  modemIndex(path));
             m_ofonoLinks[path] = modem;
             connect(modem.get(), &wwan::Modem::readyToUnlock, this, &Private::modemReadyToUnlock);
             connect(modem.get(), &wwan::Modem::ready, this, &Private::modemReady);
@@ -511,21 +644,22 @@ ManagerImpl::ManagerImpl(notify::NotificationManager::SPtr notificationManager,
                          const QDBusConnection& systemConnection) :
         d(new ManagerImpl::Private(*this))
 {
-    d->nm = make_shared<OrgFreedesktopNetworkManagerInterface>(NM_DBUS_SERVICE, NM_DBUS_PATH, systemConnection);
+    d->nm = make_shared<utils::Instrumented<OrgFreedesktopNetworkManagerInterface>>(NM_DBUS_SERVICE, NM_DBUS_PATH, systemConnection);
 
     d->m_unlockDialog = make_shared<SimUnlockDialog>(notificationManager);
     connect(d->m_unlockDialog.get(), &SimUnlockDialog::ready, d.get(), &Private::sim_unlock_ready);
 
     d->m_ofono = make_shared<QOfonoManager>();
+    d->m_ofonoProxies = make_shared<wwan::OfonoProxyRegistry>();
 
     // Load the SIM manager before we connect to the signals
     d->m_settings = make_shared<ConnectivityServiceSettings>();
-    d->m_simManager = make_shared<wwan::SimManager>(d->m_ofono, d->m_settings);
+    d->startModemSession();
+    d->m_simManager = make_shared<wwan::SimManager>(d->m_ofono, d->m_ofonoProxies, d->m_settings);
     connect(d->m_simManager.get(), &wwan::SimManager::simAdded, d.get(), &Private::simAdded);
-    d->m_sims = d->m_simManager->knownSims();
-    for (auto sim : d->m_sims)
+    for (auto sim : d->m_simManager->knownSims())
     {
-        connect(sim.get(), &wwan::Sim::presentChanged, d.get(), &Private::matchModemsAndSims);
+        d->registerSim(sim);
     }
 
     connect(d->m_ofono.get(), &QOfonoManager::modemsChanged, d.get(), &Private::modems_changed);
@@ -564,12 +698,10 @@ ManagerImpl::ManagerImpl(notify::NotificationManager::SPtr notificationManager,
 
     d->updateHasWifi();
 
+    d->m_checkSimForMobileDataTimer.setObjectName("check SIM for mobile data");
     d->m_checkSimForMobileDataTimer.setInterval(5000);
     d->m_checkSimForMobileDataTimer.setSingleShot(true);
     connect(&d->m_checkSimForMobileDataTimer, &QTimer::timeout, d.get(), &Private::checkSimForMobileData);
-    for(auto sim : d->m_sims) {
-        connect(sim.get(), &wwan::Sim::presentChanged, d.get(), &Private::startCheckSimForMobileDataTimer);
-    }
     d->m_checkSimForMobileDataTimer.start();
 }
 
@@ -693,7 +825,7 @@ ManagerImpl::nm_properties_changed(const QVariantMap &properties)
 void
 ManagerImpl::device_removed(const QDBusObjectPath &path)
 {
-    qDebug() << "Device Removed:" << path.path();
+    qCDebug(lcDevices) << "Device Removed:" << path.path();
     Link::Ptr toRemove;
     for (auto dev : d->m_nmLinks)
     {
@@ -715,7 +847,7 @@ ManagerImpl::device_removed(const QDBusObjectPath &path)
 void
 ManagerImpl::device_added(const QDBusObjectPath &path)
 {
-    qDebug() << "Device Added:" << path.path();
+    qCDebug(lcDevices) << "Device Added:" << path.path();
     for (const auto &dev : d->m_nmLinks)
     {
         auto wifiLink = dynamic_pointer_cast<wifi::WifiLinkImpl>(dev);
@@ -727,7 +859,7 @@ ManagerImpl::device_added(const QDBusObjectPath &path)
 
     Link::Ptr link;
     try {
-        auto dev = make_shared<OrgFreedesktopNetworkManagerDeviceInterface>(
+        auto dev = make_shared<utils::Instrumented<OrgFreedesktopNetworkManagerDeviceInterface>>(
             NM_DBUS_SERVICE, path.path(), d->nm->connection());
         if (dev->deviceType() == NM_DEVICE_TYPE_WIFI) {
             wifi::WifiLink::Ptr tmp = make_shared<wifi::WifiLinkImpl>(dev,
@@ -745,9 +877,9 @@ ManagerImpl::device_added(const QDBusObjectPath &path)
             }
         }
     } catch (const exception &e) {
-        qDebug() << ": failed to create Device proxy for "<< path.path() << ": ";
-        qDebug() << "\t" << e.what();
-        qDebug() << "\tIgnoring.";
+        qCDebug(lcDevices) << ": failed to create Device proxy for "<< path.path() << ": ";
+        qCDebug(lcDevices) << "\t" << e.what();
+        qCDebug(lcDevices) << "\tIgnoring.";
         return;
     }
 
@@ -816,7 +948,7 @@ ManagerImpl::unlockModem(wwan::Modem::Ptr modem)
                 || d->m_unlockDialog->modem() == modem
                 || count(d->m_pendingUnlocks.begin(), d->m_pendingUnlocks.end(), modem) != 0)
         {
-            qDebug() << "Didn't unlock modem because it's already being unlocked or is queued for unlock" << modem->simIdentifier();
+            qCDebug(lcModem) << "Didn't unlock modem because it's already being unlocked or is queued for unlock" << modem->simIdentifier();
             return;
         }
 
@@ -825,18 +957,18 @@ ManagerImpl::unlockModem(wwan::Modem::Ptr modem)
         {
             if (modem->isReadyToUnlock())
             {
-                qDebug() << "Unlocking modem" << modem->simIdentifier();
+                qCDebug(lcModem) << "Unlocking modem" << modem->simIdentifier();
                 d->m_unlockDialog->unlock(modem);
             }
             else
             {
-                qDebug() << "Waiting for modem to be ready" << modem->simIdentifier();
+                qCDebug(lcModem) << "Waiting for modem to be ready" << modem->simIdentifier();
                 modem->notifyWhenReadyToUnlock();
             }
         }
         else
         {
-            qDebug() << "Queueing modem for unlock" << modem->simIdentifier();
+            qCDebug(lcModem) << "Queueing modem for unlock" << modem->simIdentifier();
             d->m_pendingUnlocks.push_back(modem);
         }
     } catch(const exception &e) {
@@ -851,7 +983,7 @@ ManagerImpl::unlockModem(wwan::Modem::Ptr modem)
 void
 ManagerImpl::unlockAllModems()
 {
-    qDebug() << "Unlock all modems";
+    qCDebug(lcModem) << "Unlock all modems";
     for (auto& m : d->m_ofonoLinks)
     {
         unlockModem(m);
@@ -861,7 +993,7 @@ ManagerImpl::unlockAllModems()
 void
 ManagerImpl::unlockModemByName(const QString &name)
 {
-    qDebug() << "Unlock modem:" << name;
+    qCDebug(lcModem) << "Unlock modem:" << name;
     auto it = d->m_ofonoLinks.find(name);
     if (it != d->m_ofonoLinks.cend())
     {
@@ -18,90 +18,22 @@
  */
 
 #include <nmofono/vpn/openvpn-connection.h>
+#include <nmofono/vpn/vpn-settings-codec.h>
 
 #include <NetworkManagerSettingsConnectionInterface.h>
 
 using namespace std;
 
-#define DEFINE_UPDATE_SETTER(name, uppername, type)\
-void set##uppername(type value)\
-{\
-    if (m_data.m_##name == value)\
-    {\
-        return;\
-    }\
-    m_data.m_##name = value;\
-    Q_EMIT p.name##Changed(m_data.m_##name);\
-}
-
-#define DEFINE_UPDATE_PROPERTY_STRING(name, uppername, strname) \
-void update##uppername(const QStringMap& data)\
-{\
-    set##uppername(data.value(strname));\
-}\
-\
-DEFINE_UPDATE_SETTER(name, uppername, const QString &)
-
-#define DEFINE_UPDATE_PROPERTY_BOOL(name, uppername, strname) \
-void update##uppername(const QStringMap& data)\
-{\
-    set##uppername(data.value(strname) == "yes");\
-}\
-\
-DEFINE_UPDATE_SETTER(name, uppername, bool)
-
-#define DEFINE_UPDATE_PROPERTY_PAIR(name, uppername, strname, type, conversion)\
-void update##uppername(const QStringMap& data)\
-{\
-    auto it = data.constFind(strname);\
-    bool found = (it != data.constEnd());\
-    set##uppername##Set(found);\
-    if (found)\
-    {\
-        set##uppername(it->conversion);\
-    }\
-}\
-\
-DEFINE_UPDATE_SETTER(name, uppername, type)\
-\
-DEFINE_UPDATE_SETTER(name##Set, uppername##Set, bool)\
-
 #define DEFINE_PROPERTY_GETTER(name,type) \
 type OpenvpnConnection::name() const\
 {\
-    return d->m_data.m_##name;\
+    return d->m_settings.data().m_##name;\
 }\
 
 #define DEFINE_PROPERTY_SETTER(varname, uppername, type) \
 void OpenvpnConnection::set##uppername(type value)\
 {\
-    if (d->m_data.m_##varname == value)\
-    {\
-        return;\
-    }\
-    if (!d->m_dirty)\
-    {\
-        d->m_pendingData = d->m_data;\
-    }\
-    d->m_dirty = true;\
-    d->m_pendingData.m_##varname = value;\
-    Q_EMIT updateVpnData(d->m_pendingData.buildData());\
-}
-
-#define DEFINE_SECRET_PROPERTY_SETTER(varname, uppername, type) \
-void OpenvpnConnection::set##uppername(type value)\
-{\
-    if (d->m_data.m_##varname == value)\
-    {\
-        return;\
-    }\
-    if (!d->m_dirty)\
-    {\
-        d->m_pendingData = d->m_data;\
-    }\
-    d->m_dirty = true;\
-    d->m_pendingData.m_##varname = value;\
-    Q_EMIT updateVpnSecrets(d->m_pendingData.buildSecrets());\
+    d->m_settings.set(Field::varname, &OpenvpnData::m_##varname, value);\
 }
 
 namespace nmofono
@@ -109,731 +41,627 @@ namespace nmofono
 namespace vpn
 {
 
-class OpenvpnConnection::Priv
+namespace
 {
 
-public:
-    struct Data
-    {
-        Data()
-        {
-        }
-
-        Data(const Data& other) = delete;
-
-        Data& operator=(const Data& other)
-        {
-            // Basic properties
-
-            m_ca = other.m_ca;
-            m_cert = other.m_cert;
-            m_certPass = other.m_certPass;
-            m_connectionType = other.m_connectionType;
-            m_key = other.m_key;
-            m_localIp = other.m_localIp;
-            m_password = other.m_password;
-            m_remote = other.m_remote;
-            m_remoteIp = other.m_remoteIp;
-            m_staticKey = other.m_staticKey;
-            m_staticKeyDirection = other.m_staticKeyDirection;
-            m_username = other.m_username;
-
-            // Advanced general properties
-
-            m_port = other.m_port;
-            m_portSet = other.m_portSet;
-            m_renegSeconds = other.m_renegSeconds;
-            m_renegSecondsSet = other.m_renegSecondsSet;
-            m_compLzo = other.m_compLzo;
-            m_protoTcp = other.m_protoTcp;
-            m_dev = other.m_dev;
-            m_devType = other.m_devType;
-            m_devTypeSet = other.m_devTypeSet;
-            m_tunnelMtu = other.m_tunnelMtu;
-            m_tunnelMtuSet = other.m_tunnelMtuSet;
-            m_fragmentSize = other.m_fragmentSize;
-            m_fragmentSizeSet = other.m_fragmentSizeSet;
-            m_mssFix = other.m_mssFix;
-            m_remoteRandom = other.m_remoteRandom;
-
-            // Advanced security properties
-
-            m_cipher = other.m_cipher;
-            m_keysize = other.m_keysize;
-            m_keysizeSet = other.m_keysizeSet;
-            m_auth = other.m_auth;
-
-            // Advanced TLS auth properties
-
-            m_tlsRemote = other.m_tlsRemote;
-            m_remoteCertTls = other.m_remoteCertTls;
-            m_remoteCertTlsSet = other.m_remoteCertTlsSet;
-            m_ta = other.m_ta;
-            m_taDir = other.m_taDir;
-            m_taSet = other.m_taSet;
-
-            // Advanced proxy settings
-
-            m_proxyType = other.m_proxyType;
-            m_proxyServer = other.m_proxyServer;
-            m_proxyPort = other.m_proxyPort;
-            m_proxyRetry = other.m_proxyRetry;
-            m_proxyUsername = other.m_proxyUsername;
-            m_proxyPassword = other.m_proxyPassword;
-
-            return *this;
-        }
-
-        QStringMap buildSecrets()
-        {
-            QStringMap secrets;
-
-            switch(m_connectionType)
-            {
-               case ConnectionType::TLS:
-                   secrets["cert-pass"] = m_certPass;
-                   break;
-               case ConnectionType::PASSWORD:
-                   secrets["password"] = m_password;
-                   break;
-               case ConnectionType::PASSWORD_TLS:
-                   secrets["cert-pass"] = m_certPass;
-                   secrets["password"] = m_password;
-                   break;
-               case ConnectionType::STATIC_KEY:
-                   break;
-            }
-
-            if (!m_proxyPassword.isEmpty())
-            {
-                switch (m_proxyType)
-                {
-                    case ProxyType::NOT_REQUIRED:
-                        break;
-                    case ProxyType::HTTP:
-                        secrets["http-proxy-password"] = m_proxyPassword;
-                        break;
-                    case ProxyType::SOCKS:
-                        secrets["socks-proxy-password"] = m_proxyPassword;
-                        break;
-                }
-            }
-
-            return secrets;
-        }
-
-        QStringMap buildData()
-        {
-            QStringMap data;
-
-            static const QMap<KeyDir, QString> keyDirMap
-            {
-                {ZERO, "0"},
-                {ONE, "1"}
-            };
-
-            // Basic properties
-
-            static const QMap<ConnectionType, QString> connectionTypeMap
-            {
-                {ConnectionType::TLS, "tls"},
-                {ConnectionType::PASSWORD, "password"},
-                {ConnectionType::PASSWORD_TLS, "password-tls"},
-                {ConnectionType::STATIC_KEY, "static-key"}
-            };
-            data["connection-type"] = connectionTypeMap[m_connectionType];
-
-            switch (m_connectionType)
-            {
-                case ConnectionType::TLS:
-                    data["ca"] = m_ca;
-                    data["cert"] = m_cert;
-                    data["cert-pass-flags"] = "1";
-                    data["key"] = m_key;
-                    data["remote"] = m_remote;
-                    break;
-                case ConnectionType::PASSWORD:
-                    data["ca"] = m_ca;
-                    data["username"] = m_username;
-                    data["password-flags"] = "1";
-                    data["remote"] = m_remote;
-                    break;
-                case ConnectionType::PASSWORD_TLS:
-                    data["ca"] = m_ca;
-                    data["cert"] = m_cert;
-                    data["cert-pass-flags"] = "1";
-                    data["key"] = m_key;
-                    data["username"] = m_username;
-                    data["password-flags"] = "1";
-                    data["remote"] = m_remote;
-                    break;
-                case ConnectionType::STATIC_KEY:
-                    data["ca"] = m_ca;
-                    data["local-ip"] = m_localIp;
-                    data["remote"] = m_remote;
-                    data["remote-ip"] = m_remoteIp;
-                    data["static-key"] = m_staticKey;
-                    if (m_staticKeyDirection != KeyDir::KEY_NONE)
-                    {
-                        data["static-key-direction"] = keyDirMap[m_staticKeyDirection];
-                    }
-                    break;
-            }
-
-            // Advanced general properties
-
-            if (m_portSet)
-            {
-                data["port"] = QString::number(m_port);
-            }
-            if (m_renegSecondsSet)
-            {
-                data["reneg-seconds"] = QString::number(m_renegSeconds);
-            }
-            if (m_compLzo)
-            {
-                data["comp-lzo"] = "yes";
-            }
-            if (m_protoTcp)
-            {
-                data["proto-tcp"] = "yes";
-            }
-            static const QMap<DevType, QString> devTypeMap
-            {
-                {DevType::TUN, "tun"},
-                {DevType::TAP, "tap"}
-            };
-            if (m_devTypeSet)
-            {
-                data["dev-type"] = devTypeMap[m_devType];
-                if (!m_dev.isEmpty())
-                {
-                    data["dev"] = m_dev;
-                }
-            }
-            if (m_tunnelMtuSet)
-            {
-                data["tunnel-mtu"] = QString::number(m_tunnelMtu);
-            }
-            if (m_fragmentSizeSet)
-            {
-                data["fragment-size"] = QString::number(m_fragmentSize);
-            }
-            if (m_mssFix)
-            {
-                data["mssfix"] = "yes";
-            }
-            if (m_remoteRandom)
-            {
-                data["remote-random"] = "yes";
-            }
-
-            // Advanced security properties
-
-            static const QMap<Cipher, QString> cipherMap
-            {
-                {Cipher::DES_CBC, "DES-CBC"},
-                {Cipher::RC2_CBC, "RC2-CBC"},
-                {Cipher::DES_EDE_CBC, "DES-EDE-CBC"},
-                {Cipher::DES_EDE3_CBC, "DES-EDE3-CBC"},
-                {Cipher::DESX_CBC, "DESX-CBC"},
-                {Cipher::RC2_40_CBC, "RC2-40-CBC"},
-                {Cipher::CAST5_CBC, "CAST5-CBC"},
-                {Cipher::AES_128_CBC, "AES-128-CBC"},
-                {Cipher::AES_192_CBC, "AES-192-CBC"},
-                {Cipher::AES_256_CBC, "AES-256-CBC"},
-                {Cipher::CAMELLIA_128_CBC, "CAMELLIA-128-CBC"},
-                {Cipher::CAMELLIA_192_CBC, "CAMELLIA-192-CBC"},
-                {Cipher::CAMELLIA_256_CBC, "CAMELLIA-256-CBC",},
-                {Cipher::SEED_CBC, "SEED-CBC"},
-                {Cipher::AES_128_CBC_HMAC_SHA1, "AES-128-CBC-HMAC-SHA1"},
-                {Cipher::AES_256_CBC_HMAC_SHA1, "AES-256-CBC-HMAC-SHA1"}
-            };
-            if (m_cipher != Cipher::DEFAULT_CIPHER)
-            {
-                data["cipher"] = cipherMap[m_cipher];
-            }
-            if (m_keysizeSet)
-            {
-                data["keysize"] = QString::number(m_keysize);
-            }
-            static const QMap<Auth, QString> authMap
-            {
-                {NONE, "none"},
-                {RSA_MD4, "RSA-MD4"},
-                {MD5, "MD5"},
-                {SHA1, "SHA1"},
-                {SHA224, "SHA224"},
-                {SHA256, "SHA256"},
-                {SHA384, "SHA384"},
-                {SHA512, "SHA512"},
-                {RIPEMD160, "RIPEMD160"}
-            };
-            if (m_auth != Auth::DEFAULT_AUTH)
-            {
-                data["auth"] = authMap[m_auth];
-            }
-
-            // Advanced TLS auth properties
-
-            if (m_connectionType != ConnectionType::STATIC_KEY)
-            {
-                if (!m_tlsRemote.isEmpty())
-                {
-                    data["tls-remote"] = m_tlsRemote;
-                }
-                static const QMap<TlsType, QString> remoteCertTlsMap
-                {
-                    {SERVER, "server"},
-                    {CLIENT, "client"}
-                };
-                if (m_remoteCertTlsSet)
-                {
-                    data["remote-cert-tls"] = remoteCertTlsMap[m_remoteCertTls];
-                }
-
-                if (m_taSet)
-                {
-                    if (m_taDir != KeyDir::KEY_NONE)
-                    {
-                        data["ta-dir"] = keyDirMap[m_taDir];
-                    }
-                    data["ta"] = (m_ta.isEmpty() ? "/" : m_ta);
-                }
-            }
-
-            // Advanced proxy settings
-
-            static const QMap<ProxyType, QString> proxyTypeMap
-            {
-                {HTTP, "http"},
-                {SOCKS, "socks"}
-            };
-            if (m_proxyType != ProxyType::NOT_REQUIRED)
-            {
-                data["proxy-type"] = proxyTypeMap[m_proxyType];
-                data["proxy-server"] = m_proxyServer;
-                data["proxy-port"] = QString::number(m_proxyPort);
-                if (m_proxyRetry)
-                {
-                    data["proxy-retry"] = "yes";
-                }
-                if (!m_proxyUsername.isEmpty())
-                {
-                    switch (m_proxyType)
-                    {
-                        case ProxyType::NOT_REQUIRED:
-                            break;
-                        case ProxyType::HTTP:
-                            data["http-proxy-username"] = m_proxyUsername;
-                            break;
-                        case ProxyType::SOCKS:
-                            data["socks-proxy-username"] = m_proxyUsername;
-                            break;
-                    }
-                }
-            }
-
-            return data;
-        }
-
-        // Basic properties
-
-        QString m_ca;
-        QString m_cert;
-        QString m_certPass;
-        ConnectionType m_connectionType = ConnectionType::TLS;
-        QString m_key;
-        QString m_localIp;
-        QString m_password;
-        QString m_remote;
-        QString m_remoteIp;
-        QString m_staticKey;
-        KeyDir m_staticKeyDirection = KeyDir::KEY_NONE;
-        QString m_username;
-
-        // Advanced general properties
-
-        int m_port = 1194;
-        bool m_portSet = false;
-        int m_renegSeconds = 0;
-        bool m_renegSecondsSet = false;
-        bool m_compLzo = false;
-        bool m_protoTcp = false;
-        QString m_dev;
-        DevType m_devType = DevType::TUN;
-        bool m_devTypeSet = false;
-        int m_tunnelMtu = 1500;
-        bool m_tunnelMtuSet = false;
-        int m_fragmentSize = 1300;
-        bool m_fragmentSizeSet = false;
-        bool m_mssFix = false;
-        bool m_remoteRandom = false;
-
-        // Advanced security properties
-
-        Cipher m_cipher = Cipher::DEFAULT_CIPHER;
-        int m_keysize = 128;
-        bool m_keysizeSet = false;
-        Auth m_auth = Auth::DEFAULT_AUTH;
-
-        // Advanced TLS auth properties
-
-        QString m_tlsRemote;
-        TlsType m_remoteCertTls = TlsType::SERVER;
-        bool m_remoteCertTlsSet = false;
-        QString m_ta;
-        KeyDir m_taDir = KeyDir::KEY_NONE;
-        bool m_taSet = false;
-
-        // Advanced proxy settings
-
-        ProxyType m_proxyType = ProxyType::NOT_REQUIRED;
-        QString m_proxyServer;
-        int m_proxyPort = 80;
-        bool m_proxyRetry = false;
-        QString m_proxyUsername;
-        QString m_proxyPassword;
-    };
-
-    Priv(OpenvpnConnection& parent) :
-        p(parent)
-    {
-    }
+typedef OpenvpnConnection::Field F;
 
+struct OpenvpnData
+{
     // Basic properties
 
-    DEFINE_UPDATE_PROPERTY_STRING(ca, Ca, "ca")
-    DEFINE_UPDATE_PROPERTY_STRING(cert, Cert, "cert")
-    DEFINE_UPDATE_PROPERTY_STRING(certPass, CertPass, "cert-pass")
+    QString m_ca;
+    QString m_cert;
+    QString m_certPass;
+    OpenvpnConnection::ConnectionType m_connectionType = OpenvpnConnection::ConnectionType::TLS;
+    QString m_key;
+    QString m_localIp;
+    QString m_password;
+    QString m_remote;
+    QString m_remoteIp;
+    QString m_staticKey;
+    OpenvpnConnection::KeyDir m_staticKeyDirection = OpenvpnConnection::KeyDir::KEY_NONE;
+    QString m_username;
 
-    void updateConnectionType(const QStringMap& data)
-    {
-        static const QMap<QString, ConnectionType> typeMap
-        {
-            {"tls", ConnectionType::TLS},
-            {"password", ConnectionType::PASSWORD},
-            {"password-tls", ConnectionType::PASSWORD_TLS},
-            {"static-key", ConnectionType::STATIC_KEY}
-        };
-
-        setConnectionType(typeMap.value(data["connection-type"], ConnectionType::TLS));
-    }
-    DEFINE_UPDATE_SETTER(connectionType, ConnectionType, OpenvpnConnection::ConnectionType)
+    // Advanced general properties
 
-    DEFINE_UPDATE_PROPERTY_STRING(key, Key, "key")
-    DEFINE_UPDATE_PROPERTY_STRING(localIp, LocalIp, "local-ip")
-    DEFINE_UPDATE_PROPERTY_STRING(password, Password, "password")
-    DEFINE_UPDATE_PROPERTY_STRING(remote, Remote, "remote")
-    DEFINE_UPDATE_PROPERTY_STRING(remoteIp, RemoteIp, "remote-ip")
-    DEFINE_UPDATE_PROPERTY_STRING(staticKey, StaticKey, "static-key")
+    int m_port = 1194;
+    bool m_portSet = false;
+    int m_renegSeconds = 0;
+    bool m_renegSecondsSet = false;
+    bool m_compLzo = false;
+    bool m_protoTcp = false;
+    QString m_dev;
+    OpenvpnConnection::DevType m_devType = OpenvpnConnection::DevType::TUN;
+    bool m_devTypeSet = false;
+    int m_tunnelMtu = 1500;
+    bool m_tunnelMtuSet = false;
+    int m_fragmentSize = 1300;
+    bool m_fragmentSizeSet = false;
+    bool m_mssFix = false;
+    bool m_remoteRandom = false;
 
-    void updateStaticKeyDirection(const QStringMap& data)
-    {
-        static const QMap<QString, KeyDir> typeMap
-        {
-            {"0", KeyDir::ZERO},
-            {"1", KeyDir::ONE}
-        };
-
-        auto it = data.constFind("static-key-direction");
-        if (it != data.constEnd())
-        {
-            setStaticKeyDirection(typeMap.value(*it, KeyDir::KEY_NONE));
-        }
-        else
-        {
-            setStaticKeyDirection(KeyDir::KEY_NONE);
-        }
-    }
-    DEFINE_UPDATE_SETTER(staticKeyDirection, StaticKeyDirection, OpenvpnConnection::KeyDir)
+    // Advanced security properties
 
-    DEFINE_UPDATE_PROPERTY_STRING(username, Username, "username")
+    OpenvpnConnection::Cipher m_cipher = OpenvpnConnection::Cipher::DEFAULT_CIPHER;
+    int m_keysize = 128;
+    bool m_keysizeSet = false;
+    OpenvpnConnection::Auth m_auth = OpenvpnConnection::Auth::DEFAULT_AUTH;
 
-    // Advanced general properties
+    // Advanced TLS auth properties
 
-    DEFINE_UPDATE_PROPERTY_PAIR(port, Port, "port", int, toInt())
-    DEFINE_UPDATE_PROPERTY_PAIR(renegSeconds, RenegSeconds, "reneg-seconds", int, toInt())
-    DEFINE_UPDATE_PROPERTY_BOOL(compLzo, CompLzo, "comp-lzo")
-    DEFINE_UPDATE_PROPERTY_BOOL(protoTcp, ProtoTcp, "proto-tcp")
+    QString m_tlsRemote;
+    OpenvpnConnection::TlsType m_remoteCertTls = OpenvpnConnection::TlsType::SERVER;
+    bool m_remoteCertTlsSet = false;
+    QString m_ta;
+    OpenvpnConnection::KeyDir m_taDir = OpenvpnConnection::KeyDir::KEY_NONE;
+    bool m_taSet = false;
 
-    void updateDevType(const QStringMap& data)
-    {
-        static const QMap<QString, DevType> typeMap
-        {
-            {"tun", DevType::TUN},
-            {"tap", DevType::TAP}
-        };
-
-        auto it = data.constFind("dev-type");
-        bool found = (it != data.constEnd());
-        setDevTypeSet(found);
-        if (found)
-        {
-            setDevType(typeMap.value(*it, DevType::TUN));
-            setDev(data.value("dev", QString()));
-        }
-    }
-    DEFINE_UPDATE_SETTER(dev, Dev, const QString &)
-    DEFINE_UPDATE_SETTER(devType, DevType, OpenvpnConnection::DevType)
-    DEFINE_UPDATE_SETTER(devTypeSet, DevTypeSet, bool)
+    // Advanced proxy settings
 
-    DEFINE_UPDATE_PROPERTY_PAIR(tunnelMtu, TunnelMtu, "tunnel-mtu", int, toInt())
-    DEFINE_UPDATE_PROPERTY_PAIR(fragmentSize, FragmentSize, "fragment-size", int, toInt())
-    DEFINE_UPDATE_PROPERTY_BOOL(mssFix, MssFix, "mssfix")
-    DEFINE_UPDATE_PROPERTY_BOOL(remoteRandom, RemoteRandom, "remote-random")
+    OpenvpnConnection::ProxyType m_proxyType = OpenvpnConnection::ProxyType::NOT_REQUIRED;
+    QString m_proxyServer;
+    int m_proxyPort = 80;
+    bool m_proxyRetry = false;
+    QString m_proxyUsername;
+    QString m_proxyPassword;
+};
 
-    // Advanced security properties
+using namespace codec;
 
-    void updateCipher(const QStringMap& data)
-    {
-        static const QMap<QString, Cipher> typeMap
-        {
-            {"DES-CBC", Cipher::DES_CBC},
-            {"RC2-CBC", Cipher::RC2_CBC},
-            {"DES-EDE-CBC", Cipher::DES_EDE_CBC},
-            {"DES-EDE3-CBC", Cipher::DES_EDE3_CBC},
-            {"DESX-CBC", Cipher::DESX_CBC},
-            {"RC2-40-CBC", Cipher::RC2_40_CBC},
-            {"CAST5-CBC", Cipher::CAST5_CBC},
-            {"AES-128-CBC", Cipher::AES_128_CBC},
-            {"AES-192-CBC", Cipher::AES_192_CBC},
-            {"AES-256-CBC", Cipher::AES_256_CBC},
-            {"CAMELLIA-128-CBC", Cipher::CAMELLIA_128_CBC},
-            {"CAMELLIA-192-CBC", Cipher::CAMELLIA_192_CBC},
-            {"CAMELLIA-256-CBC", Cipher::CAMELLIA_256_CBC},
-            {"SEED-CBC", Cipher::SEED_CBC},
-            {"AES-128-CBC-HMAC-SHA1", Cipher::AES_128_CBC_HMAC_SHA1},
-            {"AES-256-CBC-HMAC-SHA1", Cipher::AES_256_CBC_HMAC_SHA1}
-        };
-
-        auto it = data.constFind("cipher");
-        bool found = (it != data.constEnd());
-        if (found)
-        {
-            setCipher(typeMap.value(*it, Cipher::DEFAULT_CIPHER));
-        }
-        else
-        {
-            setCipher(Cipher::DEFAULT_CIPHER);
-        }
-    }
-    DEFINE_UPDATE_SETTER(cipher, Cipher, OpenvpnConnection::Cipher)
+// Names used in the plugin's data map
+
+constexpr EnumName<OpenvpnConnection::ConnectionType> CONNECTION_TYPES[] =
+{
+    {OpenvpnConnection::ConnectionType::TLS, "tls"},
+    {OpenvpnConnection::ConnectionType::PASSWORD, "password"},
+    {OpenvpnConnection::ConnectionType::PASSWORD_TLS, "password-tls"},
+    {OpenvpnConnection::ConnectionType::STATIC_KEY, "static-key"}
+};
+
+constexpr EnumName<OpenvpnConnection::KeyDir> KEY_DIRECTIONS[] =
+{
+    {OpenvpnConnection::ZERO, "0"},
+    {OpenvpnConnection::ONE, "1"}
+};
+
+constexpr EnumName<OpenvpnConnection::DevType> DEV_TYPES[] =
+{
+    {OpenvpnConnection::TUN, "tun"},
+    {OpenvpnConnection::TAP, "tap"}
+};
+
+constexpr EnumName<OpenvpnConnection::Cipher> CIPHERS[] =
+{
+    {OpenvpnConnection::DES_CBC, "DES-CBC"},
+    {OpenvpnConnection::RC2_CBC, "RC2-CBC"},
+    {OpenvpnConnection::DES_EDE_CBC, "DES-EDE-CBC"},
+    {OpenvpnConnection::DES_EDE3_CBC, "DES-EDE3-CBC"},
+    {OpenvpnConnection::DESX_CBC, "DESX-CBC"},
+    {OpenvpnConnection::RC2_40_CBC, "RC2-40-CBC"},
+    {OpenvpnConnection::CAST5_CBC, "CAST5-CBC"},
+    {OpenvpnConnection::AES_128_CBC, "AES-128-CBC"},
+    {OpenvpnConnection::AES_192_CBC, "AES-192-CBC"},
+    {OpenvpnConnection::AES_256_CBC, "AES-256-CBC"},
+    {OpenvpnConnection::CAMELLIA_128_CBC, "CAMELLIA-128-CBC"},
+    {OpenvpnConnection::CAMELLIA_192_CBC, "CAMELLIA-192-CBC"},
+    {OpenvpnConnection::CAMELLIA_256_CBC, "CAMELLIA-256-CBC"},
+    {OpenvpnConnection::SEED_CBC, "SEED-CBC"},
+    {OpenvpnConnection::AES_128_CBC_HMAC_SHA1, "AES-128-CBC-HMAC-SHA1"},
+    {OpenvpnConnection::AES_256_CBC_HMAC_SHA1, "AES-256-CBC-HMAC-SHA1"}
+};
+
+constexpr EnumName<OpenvpnConnection::Auth> AUTHS[] =
+{
+    {OpenvpnConnection::NONE, "none"},
+    {OpenvpnConnection::RSA_MD4, "RSA-MD4"},
+    {OpenvpnConnection::MD5, "MD5"},
+    {OpenvpnConnection::SHA1, "SHA1"},
+    {OpenvpnConnection::SHA224, "SHA224"},
+    {OpenvpnConnection::SHA256, "SHA256"},
+    {OpenvpnConnection::SHA384, "SHA384"},
+    {OpenvpnConnection::SHA512, "SHA512"},
+    {OpenvpnConnection::RIPEMD160, "RIPEMD160"}
+};
+
+constexpr EnumName<OpenvpnConnection::TlsType> TLS_TYPES[] =
+{
+    {OpenvpnConnection::SERVER, "server"},
+    {OpenvpnConnection::CLIENT, "client"}
+};
+
+constexpr EnumName<OpenvpnConnection::ProxyType> PROXY_TYPES[] =
+{
+    {OpenvpnConnection::HTTP, "http"},
+    {OpenvpnConnection::SOCKS, "socks"}
+};
+
+// Parsers for the fields that don't map onto a single key
+
+bool parseConnectionType(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    return assign(data.m_connectionType, enumFromString(CONNECTION_TYPES, map.value(key), OpenvpnConnection::ConnectionType::TLS));
+}
+
+bool parseStaticKeyDirection(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    return assign(data.m_staticKeyDirection, enumFromString(KEY_DIRECTIONS, map.value(key), OpenvpnConnection::KEY_NONE));
+}
+
+bool parseDev(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    return map.contains("dev-type") && assign(data.m_dev, map.value(key, QString()));
+}
+
+bool parseDevType(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    auto it = map.constFind(key);
+    return it != map.constEnd() && assign(data.m_devType, enumFromString(DEV_TYPES, *it, OpenvpnConnection::TUN));
+}
+
+bool parseCipher(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    return assign(data.m_cipher, enumFromString(CIPHERS, map.value(key), OpenvpnConnection::DEFAULT_CIPHER));
+}
+
+bool parseAuth(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    return assign(data.m_auth, enumFromString(AUTHS, map.value(key), OpenvpnConnection::DEFAULT_AUTH));
+}
+
+bool parseRemoteCertTls(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    auto it = map.constFind(key);
+    return it != map.constEnd() && assign(data.m_remoteCertTls, enumFromString(TLS_TYPES, *it, OpenvpnConnection::SERVER));
+}
 
-    DEFINE_UPDATE_PROPERTY_PAIR(keysize, Keysize, "keysize", int, toInt())
+bool parseTa(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    auto it = map.constFind(key);
+    return it != map.constEnd() && assign(data.m_ta, *it);
+}
 
-    void updateAuth(const QStringMap& data)
+bool parseTaDir(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    return map.contains("ta") && assign(data.m_taDir, enumFromString(KEY_DIRECTIONS, map.value(key), OpenvpnConnection::KEY_NONE));
+}
+
+bool parseProxyType(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    return assign(data.m_proxyType, enumFromString(PROXY_TYPES, map.value(key), OpenvpnConnection::NOT_REQUIRED));
+}
+
+// The remaining proxy settings are only read when a proxy type is given
+
+bool parseProxyServer(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    return map.contains("proxy-type") && assign(data.m_proxyServer, map.value(key));
+}
+
+bool parseProxyPort(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    return map.contains("proxy-type") && assign(data.m_proxyPort, map.value(key, "0").toInt());
+}
+
+bool parseProxyRetry(OpenvpnData& data, const QStringMap& map, const char* key)
+{
+    return map.contains("proxy-type") && assign(data.m_proxyRetry, map.value(key) == "yes");
+}
+
+const char* proxyKey(OpenvpnConnection::ProxyType type, const char* http, const char* socks)
+{
+    switch (type)
     {
-        static const QMap<QString, Auth> typeMap
-        {
-            {"none", NONE},
-            {"RSA-MD4", RSA_MD4},
-            {"MD5", MD5},
-            {"SHA1", SHA1},
-            {"SHA224", SHA224},
-            {"SHA256", SHA256},
-            {"SHA384", SHA384},
-            {"SHA512", SHA512},
-            {"RIPEMD160", RIPEMD160}
-        };
-
-        auto it = data.constFind("auth");
-        bool found = (it != data.constEnd());
-        if (found)
-        {
-            setAuth(typeMap.value(*it, Auth::DEFAULT_AUTH));
-        }
-        else
-        {
-            setAuth(Auth::DEFAULT_AUTH);
-        }
+        case OpenvpnConnection::HTTP:
+            return http;
+        case OpenvpnConnection::SOCKS:
+            return socks;
+        case OpenvpnConnection::NOT_REQUIRED:
+            break;
     }
-    DEFINE_UPDATE_SETTER(auth, Auth, OpenvpnConnection::Auth)
+    return nullptr;
+}
+
+bool parseProxyUsername(OpenvpnData& data, const QStringMap& map, const char*)
+{
+    auto key = proxyKey(data.m_proxyType, "http-proxy-username", "socks-proxy-username");
+    return map.contains("proxy-type") && key && assign(data.m_proxyUsername, map.value(key));
+}
+
+bool parseProxyPassword(OpenvpnData& data, const QStringMap& map, const char*)
+{
+    auto key = proxyKey(data.m_proxyType, "http-proxy-password", "socks-proxy-password");
+    return key && assign(data.m_proxyPassword, map.value(key));
+}
+
+#define FIELD(Id, Key, Secret, Parse) \
+    VPN_CODEC_FIELD(OpenvpnConnection, OpenvpnData, Id, Key, Secret, Parse, m_##Id, Id##Changed)
+
+constexpr Field<OpenvpnConnection, OpenvpnData> FIELDS[] =
+{
+    // Basic properties
+
+    FIELD(ca, "ca", false, (parseString<OpenvpnData, &OpenvpnData::m_ca>)),
+    FIELD(cert, "cert", false, (parseString<OpenvpnData, &OpenvpnData::m_cert>)),
+    FIELD(certPass, "cert-pass", true, (parseString<OpenvpnData, &OpenvpnData::m_certPass>)),
+    FIELD(connectionType, "connection-type", false, parseConnectionType),
+    FIELD(key, "key", false, (parseString<OpenvpnData, &OpenvpnData::m_key>)),
+    FIELD(localIp, "local-ip", false, (parseString<OpenvpnData, &OpenvpnData::m_localIp>)),
+    FIELD(password, "password", true, (parseString<OpenvpnData, &OpenvpnData::m_password>)),
+    FIELD(remote, "remote", false, (parseString<OpenvpnData, &OpenvpnData::m_remote>)),
+    FIELD(remoteIp, "remote-ip", false, (parseString<OpenvpnData, &OpenvpnData::m_remoteIp>)),
+    FIELD(staticKey, "static-key", false, (parseString<OpenvpnData, &OpenvpnData::m_staticKey>)),
+    FIELD(staticKeyDirection, "static-key-direction", false, parseStaticKeyDirection),
+    FIELD(username, "username", false, (parseString<OpenvpnData, &OpenvpnData::m_username>)),
+
+    // Advanced general properties
+
+    FIELD(port, "port", false, (parseOptionalInt<OpenvpnData, &OpenvpnData::m_port>)),
+    FIELD(portSet, "port", false, (parsePresent<OpenvpnData, &OpenvpnData::m_portSet>)),
+    FIELD(renegSeconds, "reneg-seconds", false, (parseOptionalInt<OpenvpnData, &OpenvpnData::m_renegSeconds>)),
+    FIELD(renegSecondsSet, "reneg-seconds", false, (parsePresent<OpenvpnData, &OpenvpnData::m_renegSecondsSet>)),
+    FIELD(compLzo, "comp-lzo", false, (parseYes<OpenvpnData, &OpenvpnData::m_compLzo>)),
+    FIELD(protoTcp, "proto-tcp", false, (parseYes<OpenvpnData, &OpenvpnData::m_protoTcp>)),
+    FIELD(dev, "dev", false, parseDev),
+    FIELD(devType, "dev-type", false, parseDevType),
+    FIELD(devTypeSet, "dev-type", false, (parsePresent<OpenvpnData, &OpenvpnData::m_devTypeSet>)),
+    FIELD(tunnelMtu, "tunnel-mtu", false, (parseOptionalInt<OpenvpnData, &OpenvpnData::m_tunnelMtu>)),
+    FIELD(tunnelMtuSet, "tunnel-mtu", false, (parsePresent<OpenvpnData, &OpenvpnData::m_tunnelMtuSet>)),
+    FIELD(fragmentSize, "fragment-size", false, (parseOptionalInt<OpenvpnData, &OpenvpnData::m_fragmentSize>)),
+    FIELD(fragmentSizeSet, "fragment-size", false, (parsePresent<OpenvpnData, &OpenvpnData::m_fragmentSizeSet>)),
+    FIELD(mssFix, "mssfix", false, (parseYes<OpenvpnData, &OpenvpnData::m_mssFix>)),
+    FIELD(remoteRandom, "remote-random", false, (parseYes<OpenvpnData, &OpenvpnData::m_remoteRandom>)),
+
+    // Advanced security properties
+
+    FIELD(cipher, "cipher", false, parseCipher),
+    FIELD(keysize, "keysize", false, (parseOptionalInt<OpenvpnData, &OpenvpnData::m_keysize>)),
+    FIELD(keysizeSet, "keysize", false, (parsePresent<OpenvpnData, &OpenvpnData::m_keysizeSet>)),
+    FIELD(auth, "auth", false, parseAuth),
 
     // Advanced TLS auth properties
 
-    DEFINE_UPDATE_PROPERTY_STRING(tlsRemote, TlsRemote, "tls-remote")
+    FIELD(tlsRemote, "tls-remote", false, (parseString<OpenvpnData, &OpenvpnData::m_tlsRemote>)),
+    FIELD(remoteCertTls, "remote-cert-tls", false, parseRemoteCertTls),
+    FIELD(remoteCertTlsSet, "remote-cert-tls", false, (parsePresent<OpenvpnData, &OpenvpnData::m_remoteCertTlsSet>)),
+    FIELD(ta, "ta", false, parseTa),
+    FIELD(taDir, "ta-dir", false, parseTaDir),
+    FIELD(taSet, "ta", false, (parsePresent<OpenvpnData, &OpenvpnData::m_taSet>)),
+
+    // Advanced proxy settings, proxyType first as the others depend on it
+
+    FIELD(proxyType, "proxy-type", false, parseProxyType),
+    FIELD(proxyServer, "proxy-server", false, parseProxyServer),
+    FIELD(proxyPort, "proxy-port", false, parseProxyPort),
+    FIELD(proxyRetry, "proxy-retry", false, parseProxyRetry),
+    FIELD(proxyUsername, "proxy-username", false, parseProxyUsername),
+    FIELD(proxyPassword, "proxy-password", true, parseProxyPassword)
+};
+static_assert(fieldsInOrder(FIELDS), "OpenVPN field table out of order");
 
-    void updateRemoteCertTls(const QStringMap& data)
-    {
-        static const QMap<QString, TlsType> typeMap
-        {
-            {"server", TlsType::SERVER},
-            {"client", TlsType::CLIENT}
-        };
-
-        auto it = data.constFind("remote-cert-tls");
-        bool found = (it != data.constEnd());
-        setRemoteCertTlsSet(found);
-        if (found)
-        {
-            setRemoteCertTls(typeMap.value(*it, TlsType::SERVER));
-        }
-    }
-    DEFINE_UPDATE_SETTER(remoteCertTls, RemoteCertTls, OpenvpnConnection::TlsType)
-    DEFINE_UPDATE_SETTER(remoteCertTlsSet, RemoteCertTlsSet, bool)
+#undef FIELD
 
-    void updateTa(const QStringMap& data)
-    {
-        static const QMap<QString, KeyDir> typeMap
-        {
-            {"0", KeyDir::ZERO},
-            {"1", KeyDir::ONE}
-        };
-
-        auto it = data.constFind("ta");
-        bool found = (it != data.constEnd());
-        setTaSet(found);
-        if (found)
-        {
-            setTa(*it);
-            setTaDir(typeMap.value(data.value("ta-dir"), KeyDir::KEY_NONE));
-        }
-    }
-    DEFINE_UPDATE_SETTER(ta, Ta, const QString &)
-    DEFINE_UPDATE_SETTER(taDir, TaDir, OpenvpnConnection::KeyDir)
-    DEFINE_UPDATE_SETTER(taSet, TaSet, bool)
+// Builders for the keys of the data and secrets maps
 
-    // Advanced proxy settings
+bool usesTls(const OpenvpnData& data)
+{
+    return data.m_connectionType == OpenvpnConnection::ConnectionType::TLS
+            || data.m_connectionType == OpenvpnConnection::ConnectionType::PASSWORD_TLS;
+}
 
-    void updateProxy(const QStringMap& data)
-    {
-        static const QMap<QString, ProxyType> typeMap
-        {
-            {"http", ProxyType::HTTP},
-            {"socks", ProxyType::SOCKS}
-        };
-
-        auto it = data.constFind("proxy-type");
-        bool found = (it != data.constEnd());
-        if (found)
-        {
-            setProxyType(typeMap.value(*it, ProxyType::NOT_REQUIRED));
-            updateProxyServer(data);
-            auto portIt = data.constFind("proxy-port");
-            if (portIt != data.constEnd())
-            {
-                setProxyPort(portIt->toInt());
-            }
-            else
-            {
-               setProxyPort(0);
-            }
-            updateProxyRetry(data);
-
-            switch (m_data.m_proxyType)
-            {
-                case ProxyType::NOT_REQUIRED:
-                    break;
-                case ProxyType::HTTP:
-                    setProxyUsername(data.value("http-proxy-username"));
-                    break;
-                case ProxyType::SOCKS:
-                    setProxyUsername(data.value("socks-proxy-username"));
-                    break;
-            }
-        }
-        else
-        {
-            setProxyType(ProxyType::NOT_REQUIRED);
-        }
-    }
-    DEFINE_UPDATE_SETTER(proxyType, ProxyType, OpenvpnConnection::ProxyType)
-    DEFINE_UPDATE_PROPERTY_STRING(proxyServer, ProxyServer, "proxy-server")
-    DEFINE_UPDATE_SETTER(proxyPort, ProxyPort, int)
-    DEFINE_UPDATE_PROPERTY_BOOL(proxyRetry, ProxyRetry, "proxy-retry")
-    DEFINE_UPDATE_SETTER(proxyUsername, ProxyUsername, const QString &)
-    DEFINE_UPDATE_SETTER(proxyPassword, ProxyPassword, const QString &)
-
-    void updateProxySecrets(const QStringMap& data)
+bool usesPassword(const OpenvpnData& data)
+{
+    return data.m_connectionType == OpenvpnConnection::ConnectionType::PASSWORD
+            || data.m_connectionType == OpenvpnConnection::ConnectionType::PASSWORD_TLS;
+}
+
+bool usesStaticKey(const OpenvpnData& data)
+{
+    return data.m_connectionType == OpenvpnConnection::ConnectionType::STATIC_KEY;
+}
+
+bool put(QString& value, const QString& v, bool present = true)
+{
+    if (present)
     {
-        switch (m_data.m_proxyType)
-        {
-            case ProxyType::NOT_REQUIRED:
-                break;
-            case ProxyType::HTTP:
-                setProxyPassword(data.value("http-proxy-password"));
-                break;
-            case ProxyType::SOCKS:
-                setProxyPassword(data.value("socks-proxy-password"));
-                break;
-        }
+        value = v;
     }
+    return present;
+}
 
-public:
+bool buildConnectionType(const OpenvpnData& d, QString& v)
+{
+    return put(v, enumToString(CONNECTION_TYPES, d.m_connectionType));
+}
 
-    OpenvpnConnection& p;
+bool buildCa(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_ca);
+}
 
-    Data m_data;
+bool buildCert(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_cert, usesTls(d));
+}
 
-    Data m_pendingData;
+bool buildCertPassFlags(const OpenvpnData& d, QString& v)
+{
+    return put(v, "1", usesTls(d));
+}
 
-    bool m_dirty = false;
-};
+bool buildKey(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_key, usesTls(d));
+}
 
-OpenvpnConnection::OpenvpnConnection() :
-        d(new Priv(*this))
+bool buildRemote(const OpenvpnData& d, QString& v)
 {
+    return put(v, d.m_remote);
 }
 
-OpenvpnConnection::~OpenvpnConnection()
+bool buildUsername(const OpenvpnData& d, QString& v)
 {
+    return put(v, d.m_username, usesPassword(d));
 }
 
-void OpenvpnConnection::updateData(const QStringMap& data)
+bool buildPasswordFlags(const OpenvpnData& d, QString& v)
+{
+    return put(v, "1", usesPassword(d));
+}
+
+bool buildLocalIp(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_localIp, usesStaticKey(d));
+}
+
+bool buildRemoteIp(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_remoteIp, usesStaticKey(d));
+}
+
+bool buildStaticKey(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_staticKey, usesStaticKey(d));
+}
+
+bool buildStaticKeyDirection(const OpenvpnData& d, QString& v)
+{
+    return put(v, enumToString(KEY_DIRECTIONS, d.m_staticKeyDirection),
+               usesStaticKey(d) && d.m_staticKeyDirection != OpenvpnConnection::KEY_NONE);
+}
+
+bool buildPort(const OpenvpnData& d, QString& v)
+{
+    return put(v, QString::number(d.m_port), d.m_portSet);
+}
+
+bool buildRenegSeconds(const OpenvpnData& d, QString& v)
+{
+    return put(v, QString::number(d.m_renegSeconds), d.m_renegSecondsSet);
+}
+
+bool buildCompLzo(const OpenvpnData& d, QString& v)
+{
+    return put(v, "yes", d.m_compLzo);
+}
+
+bool buildProtoTcp(const OpenvpnData& d, QString& v)
+{
+    return put(v, "yes", d.m_protoTcp);
+}
+
+bool buildDevType(const OpenvpnData& d, QString& v)
+{
+    return put(v, enumToString(DEV_TYPES, d.m_devType), d.m_devTypeSet);
+}
+
+bool buildDev(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_dev, d.m_devTypeSet && !d.m_dev.isEmpty());
+}
+
+bool buildTunnelMtu(const OpenvpnData& d, QString& v)
+{
+    return put(v, QString::number(d.m_tunnelMtu), d.m_tunnelMtuSet);
+}
+
+bool buildFragmentSize(const OpenvpnData& d, QString& v)
+{
+    return put(v, QString::number(d.m_fragmentSize), d.m_fragmentSizeSet);
+}
+
+bool buildMssFix(const OpenvpnData& d, QString& v)
+{
+    return put(v, "yes", d.m_mssFix);
+}
+
+bool buildRemoteRandom(const OpenvpnData& d, QString& v)
+{
+    return put(v, "yes", d.m_remoteRandom);
+}
+
+bool buildCipher(const OpenvpnData& d, QString& v)
+{
+    return put(v, enumToString(CIPHERS, d.m_cipher), d.m_cipher != OpenvpnConnection::DEFAULT_CIPHER);
+}
+
+bool buildKeysize(const OpenvpnData& d, QString& v)
+{
+    return put(v, QString::number(d.m_keysize), d.m_keysizeSet);
+}
+
+bool buildAuth(const OpenvpnData& d, QString& v)
+{
+    return put(v, enumToString(AUTHS, d.m_auth), d.m_auth != OpenvpnConnection::DEFAULT_AUTH);
+}
+
+// TLS authentication doesn't apply to static keys
+
+bool buildTlsRemote(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_tlsRemote, !usesStaticKey(d) && !d.m_tlsRemote.isEmpty());
+}
+
+bool buildRemoteCertTls(const OpenvpnData& d, QString& v)
+{
+    return put(v, enumToString(TLS_TYPES, d.m_remoteCertTls), !usesStaticKey(d) && d.m_remoteCertTlsSet);
+}
+
+bool buildTaDir(const OpenvpnData& d, QString& v)
+{
+    return put(v, enumToString(KEY_DIRECTIONS, d.m_taDir),
+               !usesStaticKey(d) && d.m_taSet && d.m_taDir != OpenvpnConnection::KEY_NONE);
+}
+
+bool buildTa(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_ta.isEmpty() ? "/" : d.m_ta, !usesStaticKey(d) && d.m_taSet);
+}
+
+bool usesProxy(const OpenvpnData& d)
+{
+    return d.m_proxyType != OpenvpnConnection::NOT_REQUIRED;
+}
+
+bool buildProxyType(const OpenvpnData& d, QString& v)
+{
+    return put(v, enumToString(PROXY_TYPES, d.m_proxyType), usesProxy(d));
+}
+
+bool buildProxyServer(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_proxyServer, usesProxy(d));
+}
+
+bool buildProxyPort(const OpenvpnData& d, QString& v)
+{
+    return put(v, QString::number(d.m_proxyPort), usesProxy(d));
+}
+
+bool buildProxyRetry(const OpenvpnData& d, QString& v)
+{
+    return put(v, "yes", usesProxy(d) && d.m_proxyRetry);
+}
+
+template<OpenvpnConnection::ProxyType Type>
+bool buildProxyUsername(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_proxyUsername, d.m_proxyType == Type && !d.m_proxyUsername.isEmpty());
+}
+
+// Secrets
+
+bool buildCertPass(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_certPass, usesTls(d));
+}
+
+bool buildPassword(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_password, usesPassword(d));
+}
+
+template<OpenvpnConnection::ProxyType Type>
+bool buildProxyPassword(const OpenvpnData& d, QString& v)
+{
+    return put(v, d.m_proxyPassword, d.m_proxyType == Type && !d.m_proxyPassword.isEmpty());
+}
+
+constexpr Key<OpenvpnData> KEYS[] =
 {
     // Basic properties
 
-    d->updateCa(data);
-    d->updateCert(data);
-    d->updateConnectionType(data);
-    d->updateKey(data);
-    d->updateLocalIp(data);
-    d->updateRemote(data);
-    d->updateRemoteIp(data);
-    d->updateStaticKey(data);
-    d->updateStaticKeyDirection(data);
-    d->updateUsername(data);
+    {"connection-type", false, mask({F::connectionType}), buildConnectionType},
+    {"ca", false, mask({F::ca}), buildCa},
+    {"cert", false, mask({F::connectionType, F::cert}), buildCert},
+    {"cert-pass-flags", false, mask({F::connectionType}), buildCertPassFlags},
+    {"key", false, mask({F::connectionType, F::key}), buildKey},
+    {"remote", false, mask({F::remote}), buildRemote},
+    {"username", false, mask({F::connectionType, F::username}), buildUsername},
+    {"password-flags", false, mask({F::connectionType}), buildPasswordFlags},
+    {"local-ip", false, mask({F::connectionType, F::localIp}), buildLocalIp},
+    {"remote-ip", false, mask({F::connectionType, F::remoteIp}), buildRemoteIp},
+    {"static-key", false, mask({F::connectionType, F::staticKey}), buildStaticKey},
+    {"static-key-direction", false, mask({F::connectionType, F::staticKeyDirection}), buildStaticKeyDirection},
 
     // Advanced general properties
 
-    d->updatePort(data);
-    d->updateRenegSeconds(data);
-    d->updateCompLzo(data);
-    d->updateProtoTcp(data);
-    d->updateDevType(data);
-    d->updateTunnelMtu(data);
-    d->updateFragmentSize(data);
-    d->updateMssFix(data);
-    d->updateRemoteRandom(data);
+    {"port", false, mask({F::port, F::portSet}), buildPort},
+    {"reneg-seconds", false, mask({F::renegSeconds, F::renegSecondsSet}), buildRenegSeconds},
+    {"comp-lzo", false, mask({F::compLzo}), buildCompLzo},
+    {"proto-tcp", false, mask({F::protoTcp}), buildProtoTcp},
+    {"dev-type", false, mask({F::devType, F::devTypeSet}), buildDevType},
+    {"dev", false, mask({F::dev, F::devTypeSet}), buildDev},
+    {"tunnel-mtu", false, mask({F::tunnelMtu, F::tunnelMtuSet}), buildTunnelMtu},
+    {"fragment-size", false, mask({F::fragmentSize, F::fragmentSizeSet}), buildFragmentSize},
+    {"mssfix", false, mask({F::mssFix}), buildMssFix},
+    {"remote-random", false, mask({F::remoteRandom}), buildRemoteRandom},
 
     // Advanced security properties
 
-    d->updateCipher(data);
-    d->updateKeysize(data);
-    d->updateAuth(data);
+    {"cipher", false, mask({F::cipher}), buildCipher},
+    {"keysize", false, mask({F::keysize, F::keysizeSet}), buildKeysize},
+    {"auth", false, mask({F::auth}), buildAuth},
 
     // Advanced TLS auth properties
 
-    d->updateTlsRemote(data);
-    d->updateRemoteCertTls(data);
-    d->updateTa(data);
+    {"tls-remote", false, mask({F::connectionType, F::tlsRemote}), buildTlsRemote},
+    {"remote-cert-tls", false, mask({F::connectionType, F::remoteCertTls, F::remoteCertTlsSet}), buildRemoteCertTls},
+    {"ta-dir", false, mask({F::connectionType, F::taDir, F::taSet}), buildTaDir},
+    {"ta", false, mask({F::connectionType, F::ta, F::taSet}), buildTa},
 
     // Advanced proxy settings
 
-    d->updateProxy(data);
+    {"proxy-type", false, mask({F::proxyType}), buildProxyType},
+    {"proxy-server", false, mask({F::proxyType, F::proxyServer}), buildProxyServer},
+    {"proxy-port", false, mask({F::proxyType, F::proxyPort}), buildProxyPort},
+    {"proxy-retry", false, mask({F::proxyType, F::proxyRetry}), buildProxyRetry},
+    {"http-proxy-username", false, mask({F::proxyType, F::proxyUsername}), buildProxyUsername<OpenvpnConnection::HTTP>},
+    {"socks-proxy-username", false, mask({F::proxyType, F::proxyUsername}), buildProxyUsername<OpenvpnConnection::SOCKS>},
+
+    // Secrets
+
+    {"cert-pass", true, mask({F::connectionType, F::certPass}), buildCertPass},
+    {"password", true, mask({F::connectionType, F::password}), buildPassword},
+    {"http-proxy-password", true, mask({F::proxyType, F::proxyPassword}), buildProxyPassword<OpenvpnConnection::HTTP>},
+    {"socks-proxy-password", true, mask({F::proxyType, F::proxyPassword}), buildProxyPassword<OpenvpnConnection::SOCKS>}
+};
+
+}
+
+class OpenvpnConnection::Priv
+{
+public:
+    Priv(OpenvpnConnection& parent) :
+        m_settings(parent, FIELDS, KEYS)
+    {
+    }
+
+    codec::Settings<OpenvpnConnection, OpenvpnData> m_settings;
+};
+
+OpenvpnConnection::OpenvpnConnection() :
+        d(new Priv(*this))
+{
+}
+
+OpenvpnConnection::~OpenvpnConnection()
+{
+}
+
+void OpenvpnConnection::updateData(const QStringMap& data)
+{
+    d->m_settings.update(data, false);
 }
 
 void OpenvpnConnection::updateSecrets(const QStringMap& secrets)
 {
-    d->updateCertPass(secrets);
-    d->updatePassword(secrets);
-    d->updateProxySecrets(secrets);
+    d->m_settings.update(secrets, true);
 }
 
 void OpenvpnConnection::markClean()
 {
-    d->m_dirty = false;
+    d->m_settings.markClean();
 }
 
 // Basic properties
@@ -894,18 +722,15 @@ DEFINE_PROPERTY_GETTER(proxyRetry, bool)
 DEFINE_PROPERTY_GETTER(proxyUsername, QString)
 DEFINE_PROPERTY_GETTER(proxyPassword, QString)
 
-
-
-
 // Basic properties
 
 DEFINE_PROPERTY_SETTER(ca, Ca, const QString &)
 DEFINE_PROPERTY_SETTER(cert, Cert, const QString &)
-DEFINE_SECRET_PROPERTY_SETTER(certPass, CertPass, const QString &)
+DEFINE_PROPERTY_SETTER(certPass, CertPass, const QString &)
 DEFINE_PROPERTY_SETTER(connectionType, ConnectionType, ConnectionType)
 DEFINE_PROPERTY_SETTER(key, Key, const QString &)
 DEFINE_PROPERTY_SETTER(localIp, LocalIp, const QString &)
-DEFINE_SECRET_PROPERTY_SETTER(password, Password, const QString &)
+DEFINE_PROPERTY_SETTER(password, Password, const QString &)
 DEFINE_PROPERTY_SETTER(remote, Remote, const QString &)
 DEFINE_PROPERTY_SETTER(remoteIp, RemoteIp, const QString &)
 DEFINE_PROPERTY_SETTER(staticKey, StaticKey, const QString &)
@@ -953,7 +778,7 @@ DEFINE_PROPERTY_SETTER(proxyServer, ProxyServer, const QString &)
 DEFINE_PROPERTY_SETTER(proxyPort, ProxyPort, int)
 DEFINE_PROPERTY_SETTER(proxyRetry, ProxyRetry, bool)
 DEFINE_PROPERTY_SETTER(proxyUsername, ProxyUsername, const QString &)
-DEFINE_SECRET_PROPERTY_SETTER(proxyPassword, ProxyPassword, const QString &)
+DEFINE_PROPERTY_SETTER(proxyPassword, ProxyPassword, const QString &)
 
 }
 }
@@ -107,6 +107,56 @@ public:
         SOCKS
     };
 
+    /**
+     * Identifies each property below, in declaration order.
+     */
+    enum class Field
+    {
+        ca,
+        cert,
+        certPass,
+        connectionType,
+        key,
+        localIp,
+        password,
+        remote,
+        remoteIp,
+        staticKey,
+        staticKeyDirection,
+        username,
+        port,
+        portSet,
+        renegSeconds,
+        renegSecondsSet,
+        compLzo,
+        protoTcp,
+        dev,
+        devType,
+        devTypeSet,
+        tunnelMtu,
+        tunnelMtuSet,
+        fragmentSize,
+        fragmentSizeSet,
+        mssFix,
+        remoteRandom,
+        cipher,
+        keysize,
+        keysizeSet,
+        auth,
+        tlsRemote,
+        remoteCertTls,
+        remoteCertTlsSet,
+        ta,
+        taDir,
+        taSet,
+        proxyType,
+        proxyServer,
+        proxyPort,
+        proxyRetry,
+        proxyUsername,
+        proxyPassword
+    };
+
     OpenvpnConnection();
 
     ~OpenvpnConnection();
@@ -358,6 +408,11 @@ Q_SIGNALS:
 
     void updateVpnSecrets(const QMap<QString, QString>& vpnSecrets);
 
+    /**
+     * Emitted alongside each of the typed change signals below.
+     */
+    void fieldChanged(Field field);
+
     // Basic properties
 
     void caChanged(const QString &value);
@@ -18,90 +18,22 @@
  */
 
 #include <nmofono/vpn/pptp-connection.h>
+#include <nmofono/vpn/vpn-settings-codec.h>
 
 #include <NetworkManagerSettingsConnectionInterface.h>
 
 using namespace std;
 
-#define DEFINE_UPDATE_SETTER(name, uppername, type)\
-void set##uppername(type value)\
-{\
-    if (m_data.m_##name == value)\
-    {\
-        return;\
-    }\
-    m_data.m_##name = value;\
-    Q_EMIT p.name##Changed(m_data.m_##name);\
-}
-
-#define DEFINE_UPDATE_PROPERTY_STRING(name, uppername, strname) \
-void update##uppername(const QStringMap& data)\
-{\
-    set##uppername(data.value(strname));\
-}\
-\
-DEFINE_UPDATE_SETTER(name, uppername, const QString &)
-
-#define DEFINE_UPDATE_PROPERTY_ANTIBOOL(name, uppername, strname) \
-void update##uppername(const QStringMap& data)\
-{\
-    set##uppername(data.value(strname) != "yes");\
-}\
-\
-DEFINE_UPDATE_SETTER(name, uppername, bool)
-
-#define DEFINE_UPDATE_PROPERTY_PAIR(name, uppername, strname, type, conversion)\
-void update##uppername(const QStringMap& data)\
-{\
-    auto it = data.constFind(strname);\
-    bool found = (it != data.constEnd());\
-    set##uppername##Set(found);\
-    if (found)\
-    {\
-        set##uppername(it->conversion);\
-    }\
-}\
-\
-DEFINE_UPDATE_SETTER(name, uppername, type)\
-\
-DEFINE_UPDATE_SETTER(name##Set, uppername##Set, bool)\
-
 #define DEFINE_PROPERTY_GETTER(name,type) \
 type PptpConnection::name() const\
 {\
-    return d->m_data.m_##name;\
+    return d->m_settings.data().m_##name;\
 }\
 
 #define DEFINE_PROPERTY_SETTER(varname, uppername, type) \
 void PptpConnection::set##uppername(type value)\
 {\
-    if (d->m_data.m_##varname == value)\
-    {\
-        return;\
-    }\
-    if (!d->m_dirty)\
-    {\
-        d->m_pendingData = d->m_data;\
-    }\
-    d->m_dirty = true;\
-    d->m_pendingData.m_##varname = value;\
-    Q_EMIT updateVpnData(d->m_pendingData.buildData());\
-}
-
-#define DEFINE_SECRET_PROPERTY_SETTER(varname, uppername, type) \
-void PptpConnection::set##uppername(type value)\
-{\
-    if (d->m_data.m_##varname == value)\
-    {\
-        return;\
-    }\
-    if (!d->m_dirty)\
-    {\
-        d->m_pendingData = d->m_data;\
-    }\
-    d->m_dirty = true;\
-    d->m_pendingData.m_##varname = value;\
-    Q_EMIT updateVpnSecrets(d->m_pendingData.buildSecrets());\
+    d->m_settings.set(Field::varname, &PptpData::m_##varname, value);\
 }
 
 namespace nmofono
@@ -109,281 +41,250 @@ namespace nmofono
 namespace vpn
 {
 
-class PptpConnection::Priv
+namespace
 {
-public:
-    struct Data
-    {
-        Data()
-        {
-        }
 
-        Data(const Data& other) = delete;
+typedef PptpConnection::Field F;
 
-        Data& operator=(const Data& other)
-        {
-            // Basic properties
-
-            m_gateway = other.m_gateway;
-            m_user = other.m_user;
-            m_password = other.m_password;
-            m_domain = other.m_domain;
-
-            // Advanced properties
-
-            m_allowPap = other.m_allowPap;
-            m_allowChap = other.m_allowChap;
-            m_allowMschap = other.m_allowMschap;
-            m_allowMschapv2 = other.m_allowMschapv2;
-            m_allowEap = other.m_allowEap;
-            m_requireMppe = other.m_requireMppe;
-            m_mppeType = other.m_mppeType;
-            m_mppeStateful = other.m_mppeStateful;
-            m_bsdCompression = other.m_bsdCompression;
-            m_deflateCompression = other.m_deflateCompression;
-            m_tcpHeaderCompression = other.m_tcpHeaderCompression;
-            m_sendPppEchoPackets = other.m_sendPppEchoPackets;
-
-            return *this;
-        }
+struct PptpData
+{
+    // Basic properties
 
-        QStringMap buildSecrets()
-        {
-            QStringMap secrets;
+    QString m_gateway;
+    QString m_user;
+    QString m_password;
+    QString m_domain;
 
-            if (!m_password.isEmpty())
-            {
-                secrets["password"] = m_password;
-            }
+    // Advanced properties
 
-            return secrets;
-        }
+    bool m_allowPap = true;
+    bool m_allowChap = true;
+    bool m_allowMschap = true;
+    bool m_allowMschapv2 = true;
+    bool m_allowEap = true;
+    bool m_requireMppe = false;
+    PptpConnection::MppeType m_mppeType = PptpConnection::MppeType::MPPE_ALL;
+    bool m_mppeStateful = false;
+    bool m_bsdCompression = true;
+    bool m_deflateCompression = true;
+    bool m_tcpHeaderCompression = true;
+    bool m_sendPppEchoPackets = false;
+};
 
-        QStringMap buildData()
-        {
-            QStringMap data;
-
-            // Basic properties
-
-            data["gateway"] = m_gateway;
-            data["user"] = m_user;
-            if (!m_domain.isEmpty())
-            {
-                data["domain"] = m_domain;
-            }
-
-            data["password-flags"] = "1";
-
-            // Advanced properties
-
-            static const QMap<MppeType, QString> mppeTypeMap
-            {
-                {MppeType::MPPE_ALL, "require-mppe"},
-                {MppeType::MPPE_128, "require-mppe-128"},
-                {MppeType::MPPE_40, "require-mppe-40"},
-            };
-
-            if (!m_requireMppe)
-            {
-                if (!m_allowPap)
-                {
-                    data["refuse-pap"] = "yes";
-                }
-                if (!m_allowChap)
-                {
-                    data["refuse-chap"] = "yes";
-                }
-            }
-            if (!m_allowMschap)
-            {
-                data["refuse-mschap"] = "yes";
-            }
-            if (!m_allowMschapv2)
-            {
-                data["refuse-mschapv2"] = "yes";
-            }
-            if (!m_requireMppe)
-            {
-                if (!m_allowEap)
-                {
-                    data["refuse-eap"] = "yes";
-                }
-            }
-
-            if ((m_allowMschap || m_allowMschapv2) && m_requireMppe)
-            {
-                data[mppeTypeMap[m_mppeType]] = "yes";
-                if (m_mppeStateful)
-                {
-                    data["mppe-stateful"] = "yes";
-                }
-            }
-
-            if (!m_bsdCompression)
-            {
-                data["nobsdcomp"] = "yes";
-            }
-            if (!m_deflateCompression)
-            {
-                data["nodeflate"] = "yes";
-            }
-            if (!m_tcpHeaderCompression)
-            {
-                data["no-vj-comp"] = "yes";
-            }
-
-            if (m_sendPppEchoPackets)
-            {
-                data["lcp-echo-interval"] = "30";
-                data["lcp-echo-failure"] = "5";
-            }
-
-            return data;
-        }
+using namespace codec;
 
-        // Basic properties
-
-        QString m_gateway;
-        QString m_user;
-        QString m_password;
-        QString m_domain;
-
-        // Advanced properties
-
-        bool m_allowPap = true;
-        bool m_allowChap = true;
-        bool m_allowMschap = true;
-        bool m_allowMschapv2 = true;
-        bool m_allowEap = true;
-        bool m_requireMppe = false;
-        MppeType m_mppeType = MppeType::MPPE_ALL;
-        bool m_mppeStateful = false;
-        bool m_bsdCompression = true;
-        bool m_deflateCompression = true;
-        bool m_tcpHeaderCompression = true;
-        bool m_sendPppEchoPackets = false;
-    };
+// Each MPPE type has its own "yes" key
 
-    Priv(PptpConnection& parent) :
-        p(parent)
+constexpr EnumName<PptpConnection::MppeType> MPPE_TYPES[] =
+{
+    {PptpConnection::MppeType::MPPE_ALL, "require-mppe"},
+    {PptpConnection::MppeType::MPPE_128, "require-mppe-128"},
+    {PptpConnection::MppeType::MPPE_40, "require-mppe-40"}
+};
+
+const char* requiredMppeKey(const QStringMap& map)
+{
+    for (const auto& entry: MPPE_TYPES)
     {
+        if (map.value(entry.name) == "yes")
+        {
+            return entry.name;
+        }
     }
+    return nullptr;
+}
+
+bool parseRequireMppe(PptpData& data, const QStringMap& map, const char*)
+{
+    return assign(data.m_requireMppe, requiredMppeKey(map) != nullptr);
+}
+
+bool parseMppeType(PptpData& data, const QStringMap& map, const char*)
+{
+    auto key = requiredMppeKey(map);
+    return key && assign(data.m_mppeType, enumFromString(MPPE_TYPES, key, PptpConnection::MppeType::MPPE_ALL));
+}
 
+bool parseSendPppEchoPackets(PptpData& data, const QStringMap& map, const char* key)
+{
+    return assign(data.m_sendPppEchoPackets, map.contains(key) || map.contains("lcp-echo-failure"));
+}
+
+#define FIELD(Id, Key, Secret, Parse) \
+    VPN_CODEC_FIELD(PptpConnection, PptpData, Id, Key, Secret, Parse, m_##Id, Id##Changed)
+
+constexpr Field<PptpConnection, PptpData> FIELDS[] =
+{
     // Basic properties
 
-    DEFINE_UPDATE_PROPERTY_STRING(gateway, Gateway, "gateway")
-    DEFINE_UPDATE_PROPERTY_STRING(user, User, "user")
-    DEFINE_UPDATE_PROPERTY_STRING(password, Password, "password")
-    DEFINE_UPDATE_PROPERTY_STRING(domain, Domain, "domain")
+    FIELD(gateway, "gateway", false, (parseString<PptpData, &PptpData::m_gateway>)),
+    FIELD(user, "user", false, (parseString<PptpData, &PptpData::m_user>)),
+    FIELD(password, "password", true, (parseString<PptpData, &PptpData::m_password>)),
+    FIELD(domain, "domain", false, (parseString<PptpData, &PptpData::m_domain>)),
 
     // Advanced properties
 
-    DEFINE_UPDATE_PROPERTY_ANTIBOOL(allowPap, AllowPap, "refuse-pap")
-    DEFINE_UPDATE_PROPERTY_ANTIBOOL(allowChap, AllowChap, "refuse-chap")
-    DEFINE_UPDATE_PROPERTY_ANTIBOOL(allowMschap, AllowMschap, "refuse-mschap")
-    DEFINE_UPDATE_PROPERTY_ANTIBOOL(allowMschapv2, AllowMschapv2, "refuse-mschapv2")
-    DEFINE_UPDATE_PROPERTY_ANTIBOOL(allowEap, AllowEap, "refuse-eap")
+    FIELD(allowPap, "refuse-pap", false, (parseNotYes<PptpData, &PptpData::m_allowPap>)),
+    FIELD(allowChap, "refuse-chap", false, (parseNotYes<PptpData, &PptpData::m_allowChap>)),
+    FIELD(allowMschap, "refuse-mschap", false, (parseNotYes<PptpData, &PptpData::m_allowMschap>)),
+    FIELD(allowMschapv2, "refuse-mschapv2", false, (parseNotYes<PptpData, &PptpData::m_allowMschapv2>)),
+    FIELD(allowEap, "refuse-eap", false, (parseNotYes<PptpData, &PptpData::m_allowEap>)),
+    FIELD(requireMppe, "require-mppe", false, parseRequireMppe),
+    FIELD(mppeType, "require-mppe", false, parseMppeType),
+    FIELD(mppeStateful, "mppe-stateful", false, (parseYes<PptpData, &PptpData::m_mppeStateful>)),
+    FIELD(bsdCompression, "nobsdcomp", false, (parseNotYes<PptpData, &PptpData::m_bsdCompression>)),
+    FIELD(deflateCompression, "nodeflate", false, (parseNotYes<PptpData, &PptpData::m_deflateCompression>)),
+    FIELD(tcpHeaderCompression, "no-vj-comp", false, (parseNotYes<PptpData, &PptpData::m_tcpHeaderCompression>)),
+    FIELD(sendPppEchoPackets, "lcp-echo-interval", false, parseSendPppEchoPackets)
+};
+static_assert(fieldsInOrder(FIELDS), "PPTP field table out of order");
+
+#undef FIELD
 
-    void updateMppe(const QStringMap& data)
+bool put(QString& value, const QString& v, bool present = true)
+{
+    if (present)
     {
-        bool requireMppe = false;
-        MppeType mppeType = MppeType::MPPE_ALL;
+        value = v;
+    }
+    return present;
+}
 
-        QString tmp = data.value("require-mppe");
-        if (tmp == "yes")
-        {
-            requireMppe = true;
-            mppeType = MppeType::MPPE_ALL;
-        }
-        else
-        {
-            tmp = data.value("require-mppe-128");
-            if (tmp == "yes")
-            {
-                requireMppe = true;
-                mppeType = MppeType::MPPE_128;
-            }
-            else
-            {
-                tmp = data.value("require-mppe-40");
-                if (tmp == "yes")
-                {
-                    requireMppe = true;
-                    mppeType = MppeType::MPPE_40;
-                }
-            }
-        }
+bool buildGateway(const PptpData& d, QString& v)
+{
+    return put(v, d.m_gateway);
+}
 
-        setRequireMppe(requireMppe);
-        if (requireMppe)
-        {
-            setMppeType(mppeType);
-        }
-        setMppeStateful(data.value("mppe-stateful") == "yes");
-    }
-    DEFINE_UPDATE_SETTER(requireMppe, RequireMppe, bool)
-    DEFINE_UPDATE_SETTER(mppeType, MppeType, PptpConnection::MppeType)
-    DEFINE_UPDATE_SETTER(mppeStateful, MppeStateful, bool)
+bool buildUser(const PptpData& d, QString& v)
+{
+    return put(v, d.m_user);
+}
 
-    DEFINE_UPDATE_PROPERTY_ANTIBOOL(bsdCompression, BsdCompression, "nobsdcomp")
-    DEFINE_UPDATE_PROPERTY_ANTIBOOL(deflateCompression, DeflateCompression, "nodeflate")
-    DEFINE_UPDATE_PROPERTY_ANTIBOOL(tcpHeaderCompression, TcpHeaderCompression, "no-vj-comp")
+bool buildDomain(const PptpData& d, QString& v)
+{
+    return put(v, d.m_domain, !d.m_domain.isEmpty());
+}
 
-    void updateSendPppEchoPackets(const QStringMap& data)
-    {
-        setSendPppEchoPackets(data.contains("lcp-echo-interval") || data.contains("lcp-echo-failure"));
-    }
-    DEFINE_UPDATE_SETTER(sendPppEchoPackets, SendPppEchoPackets, bool)
+bool buildPasswordFlags(const PptpData&, QString& v)
+{
+    return put(v, "1");
+}
+
+// PAP, CHAP and EAP can't do MPPE, so they are only refused without it
+
+template<bool PptpData::*Allow>
+bool buildRefuseWithoutMppe(const PptpData& d, QString& v)
+{
+    return put(v, "yes", !d.m_requireMppe && !(d.*Allow));
+}
 
-    PptpConnection& p;
+template<bool PptpData::*Allow>
+bool buildRefuse(const PptpData& d, QString& v)
+{
+    return put(v, "yes", !(d.*Allow));
+}
 
-    Data m_data;
+bool usesMppe(const PptpData& d)
+{
+    return (d.m_allowMschap || d.m_allowMschapv2) && d.m_requireMppe;
+}
 
-    Data m_pendingData;
+template<PptpConnection::MppeType Type>
+bool buildRequireMppe(const PptpData& d, QString& v)
+{
+    return put(v, "yes", usesMppe(d) && d.m_mppeType == Type);
+}
 
-    bool m_dirty = false;
-};
+bool buildMppeStateful(const PptpData& d, QString& v)
+{
+    return put(v, "yes", usesMppe(d) && d.m_mppeStateful);
+}
 
-PptpConnection::PptpConnection() :
-        d(new Priv(*this))
+bool buildLcpEchoInterval(const PptpData& d, QString& v)
 {
+    return put(v, "30", d.m_sendPppEchoPackets);
 }
 
-PptpConnection::~PptpConnection()
+bool buildLcpEchoFailure(const PptpData& d, QString& v)
 {
+    return put(v, "5", d.m_sendPppEchoPackets);
 }
 
-void PptpConnection::updateData(const QStringMap& data)
+// Secrets
+
+bool buildPassword(const PptpData& d, QString& v)
+{
+    return put(v, d.m_password, !d.m_password.isEmpty());
+}
+
+constexpr quint64 MPPE_DEPENDENCIES = mask({F::allowMschap, F::allowMschapv2, F::requireMppe, F::mppeType});
+
+constexpr Key<PptpData> KEYS[] =
 {
     // Basic properties
 
-    d->updateGateway(data);
-    d->updateUser(data);
-    d->updateDomain(data);
+    {"gateway", false, mask({F::gateway}), buildGateway},
+    {"user", false, mask({F::user}), buildUser},
+    {"domain", false, mask({F::domain}), buildDomain},
+    {"password-flags", false, 0, buildPasswordFlags},
 
     // Advanced properties
 
-    d->updateAllowPap(data);
-    d->updateAllowChap(data);
-    d->updateAllowMschap(data);
-    d->updateAllowMschapv2(data);
-    d->updateAllowEap(data);
-    d->updateMppe(data);
-    d->updateBsdCompression(data);
-    d->updateDeflateCompression(data);
-    d->updateTcpHeaderCompression(data);
-    d->updateSendPppEchoPackets(data);
+    {"refuse-pap", false, mask({F::requireMppe, F::allowPap}), buildRefuseWithoutMppe<&PptpData::m_allowPap>},
+    {"refuse-chap", false, mask({F::requireMppe, F::allowChap}), buildRefuseWithoutMppe<&PptpData::m_allowChap>},
+    {"refuse-mschap", false, mask({F::allowMschap}), buildRefuse<&PptpData::m_allowMschap>},
+    {"refuse-mschapv2", false, mask({F::allowMschapv2}), buildRefuse<&PptpData::m_allowMschapv2>},
+    {"refuse-eap", false, mask({F::requireMppe, F::allowEap}), buildRefuseWithoutMppe<&PptpData::m_allowEap>},
+    {"require-mppe", false, MPPE_DEPENDENCIES, buildRequireMppe<PptpConnection::MppeType::MPPE_ALL>},
+    {"require-mppe-128", false, MPPE_DEPENDENCIES, buildRequireMppe<PptpConnection::MppeType::MPPE_128>},
+    {"require-mppe-40", false, MPPE_DEPENDENCIES, buildRequireMppe<PptpConnection::MppeType::MPPE_40>},
+    {"mppe-stateful", false, MPPE_DEPENDENCIES | mask({F::mppeStateful}), buildMppeStateful},
+    {"nobsdcomp", false, mask({F::bsdCompression}), buildRefuse<&PptpData::m_bsdCompression>},
+    {"nodeflate", false, mask({F::deflateCompression}), buildRefuse<&PptpData::m_deflateCompression>},
+    {"no-vj-comp", false, mask({F::tcpHeaderCompression}), buildRefuse<&PptpData::m_tcpHeaderCompression>},
+    {"lcp-echo-interval", false, mask({F::sendPppEchoPackets}), buildLcpEchoInterval},
+    {"lcp-echo-failure", false, mask({F::sendPppEchoPackets}), buildLcpEchoFailure},
+
+    // Secrets
+
+    {"password", true, mask({F::password}), buildPassword}
+};
 
 }
 
+class PptpConnection::Priv
+{
+public:
+    Priv(PptpConnection& parent) :
+        m_settings(parent, FIELDS, KEYS)
+    {
+    }
+
+    codec::Settings<PptpConnection, PptpData> m_settings;
+};
+
+PptpConnection::PptpConnection() :
+        d(new Priv(*this))
+{
+}
+
+PptpConnection::~PptpConnection()
+{
+}
+
+void PptpConnection::updateData(const QStringMap& data)
+{
+    d->m_settings.update(data, false);
+}
+
 void PptpConnection::updateSecrets(const QStringMap& secrets)
 {
-    d->updatePassword(secrets);
+    d->m_settings.update(secrets, true);
 }
 
 void PptpConnection::markClean()
 {
-    d->m_dirty = false;
+    d->m_settings.markClean();
 }
 
 // Basic properties
@@ -408,13 +309,11 @@ DEFINE_PROPERTY_GETTER(deflateCompression, bool)
 DEFINE_PROPERTY_GETTER(tcpHeaderCompression, bool)
 DEFINE_PROPERTY_GETTER(sendPppEchoPackets, bool)
 
-
-
 // Basic properties
 
 DEFINE_PROPERTY_SETTER(gateway, Gateway, const QString &)
 DEFINE_PROPERTY_SETTER(user, User, const QString &)
-DEFINE_SECRET_PROPERTY_SETTER(password, Password, const QString &)
+DEFINE_PROPERTY_SETTER(password, Password, const QString &)
 DEFINE_PROPERTY_SETTER(domain, Domain, const QString &)
 
 // Advanced properties
@@ -45,6 +45,29 @@ public:
         MPPE_40
     };
 
+    /**
+     * Identifies each property below, in declaration order.
+     */
+    enum class Field
+    {
+        gateway,
+        user,
+        password,
+        domain,
+        allowPap,
+        allowChap,
+        allowMschap,
+        allowMschapv2,
+        allowEap,
+        requireMppe,
+        mppeType,
+        mppeStateful,
+        bsdCompression,
+        deflateCompression,
+        tcpHeaderCompression,
+        sendPppEchoPackets
+    };
+
     PptpConnection();
 
     ~PptpConnection();
@@ -149,6 +172,11 @@ Q_SIGNALS:
 
     void updateVpnSecrets(const QMap<QString, QString>& vpnSecrets);
 
+    /**
+     * Emitted alongside each of the typed change signals below.
+     */
+    void fieldChanged(Field field);
+
     // Basic properties
 
     void gatewayChanged(const QString &value);
@@ -21,6 +21,7 @@
 
 #include <nmofono/vpn/vpn-connection.h>
 #include <NetworkManagerSettingsConnectionInterface.h>
+#include <backend-utils.h>
 
 using namespace std;
 
@@ -164,10 +165,16 @@ public:
 
     void updateActivatable()
     {
-        QString otherPath = m_otherActiveConnectionPath.path();
+        if (!m_activationState)
+        {
+            setActivatable(true);
+            return;
+        }
+
+        QString otherPath = m_activationState->activeConnectionPath.path();
 
         // If no connection is busy and there is an active connection and this is the active connection
-        setActivatable(!m_otherConnectionIsBusy && (otherPath.isEmpty() || (otherPath == m_connection->path())));
+        setActivatable(!m_activationState->busy && (otherPath.isEmpty() || (otherPath == m_connection->path())));
     }
 
     void setActivatable(bool activatable)
@@ -189,11 +196,70 @@ public:
         }
 
         m_dirty = true;
-        m_pendingSettings = m_settings;
+
+        // While an update is in flight, keep building on what was sent, as
+        // m_settings won't catch up until NetworkManager tells us it changed
+        if (!m_updateInFlight)
+        {
+            m_pendingSettings = m_settings;
+        }
 
         m_dispatchPendingSettingsTimer.start();
     }
 
+    /**
+     * NetworkManager now holds what we sent, so take it on straight away.
+     * The refresh its Updated signal starts may not be back before the
+     * next edit, which has to build on this update rather than revert it.
+     */
+    void sentSettingsApplied()
+    {
+        auto settings = m_sentSettings;
+        QVariant secrets;
+        if (settings.contains("vpn"))
+        {
+            // GetSettings never carries the secrets, so neither does m_settings
+            secrets = settings["vpn"].take("secrets");
+        }
+
+        applySettings(settings);
+
+        if (m_valid && secrets.isValid())
+        {
+            Q_EMIT updateSecrets(secrets.value<QStringMap>());
+        }
+    }
+
+    void applySettings(const QVariantDictMap& settings)
+    {
+        m_settings = settings;
+
+        QStringMap vpnData;
+        auto v = m_settings.value("vpn").value("data");
+        if (v.userType() == qMetaTypeId<QStringMap>())
+        {
+            // Settings we sent ourselves
+            vpnData = v.value<QStringMap>();
+        }
+        else if (v.isValid())
+        {
+            // Encourage Qt to decode the nested map
+            auto dbusArgument = qvariant_cast<QDBusArgument>(v);
+            dbusArgument >> vpnData;
+            m_settings["vpn"]["data"] = QVariant::fromValue(vpnData);
+        }
+
+        updateId();
+        updateNeverDefault();
+        updateValid();
+        updateType();
+
+        if (m_valid)
+        {
+            Q_EMIT updateData(vpnData);
+        }
+    }
+
 Q_SIGNALS:
     void updateData(const QStringMap& data);
     void updateSecrets(const QStringMap& secrets);
@@ -202,16 +268,48 @@ Q_SIGNALS:
 public Q_SLOTS:
     void dispatchPendingSettings()
     {
-        auto reply = m_connection->Update(m_pendingSettings);
-        reply.waitForFinished();
-        if (reply.isError())
+        // Only one update at a time; edits made meanwhile go out when it finishes
+        if (m_updateInFlight || !m_dirty)
         {
-            qWarning() << reply.error().message() << m_pendingSettings;
+            return;
         }
 
         m_dirty = false;
+        m_updateInFlight = true;
+        m_sentSettings = m_pendingSettings;
 
-        Q_EMIT settingsDispatched();
+        // Anything fetched before this update lands is out of date
+        ++m_settingsGeneration;
+
+        auto reply = m_connection->Update(m_sentSettings);
+        auto watcher(utils::watch(reply, "org.freedesktop.NetworkManager.Settings.Connection.Update", this));
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &Priv::updateFinished);
+    }
+
+    void updateFinished(QDBusPendingCallWatcher *call)
+    {
+        QDBusPendingReply<> reply = *call;
+        if (reply.isError())
+        {
+            qWarning() << reply.error().message() << m_sentSettings;
+        }
+        else
+        {
+            sentSettingsApplied();
+        }
+        call->deleteLater();
+
+        m_updateInFlight = false;
+        m_sentSettings.clear();
+
+        if (!m_dirty)
+        {
+            Q_EMIT settingsDispatched();
+        }
+        else if (!m_dispatchPendingSettingsTimer.isActive())
+        {
+            dispatchPendingSettings();
+        }
     }
 
     void updateVpnData(const QStringMap &vpnData)
@@ -233,8 +331,21 @@ public Q_SLOTS:
             return;
         }
 
+        auto generation = ++m_secretsGeneration;
         auto reply = m_connection->GetSecrets("vpn");
-        reply.waitForFinished();
+        auto watcher(utils::watch(reply, "org.freedesktop.NetworkManager.Settings.Connection.GetSecrets", this));
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation](QDBusPendingCallWatcher* call)
+        {
+            call->deleteLater();
+            if (generation == m_secretsGeneration)
+            {
+                secretsFetched(*call);
+            }
+        });
+    }
+
+    void secretsFetched(const QDBusPendingReply<QVariantDictMap>& reply)
+    {
         if (reply.isError())
         {
             qWarning() << reply.error().message();
@@ -256,59 +367,32 @@ public Q_SLOTS:
 
     void settingsUpdated()
     {
+        auto generation = ++m_settingsGeneration;
         auto reply = m_connection->GetSettings();
-
-        reply.waitForFinished();
-        if (reply.isError())
+        auto watcher(utils::watch(reply, "org.freedesktop.NetworkManager.Settings.Connection.GetSettings", this));
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation](QDBusPendingCallWatcher* call)
         {
-            qWarning() << reply.error().message();
-            return;
-        }
+            call->deleteLater();
 
-        m_settings = reply;
-
-        QStringMap vpnData;
-        // Encourage Qt to decode the nested map
-        auto v = m_settings.value("vpn").value("data");
-        if (v.isValid())
-        {
-            auto dbusArgument = qvariant_cast<QDBusArgument>(v);
-            dbusArgument >> vpnData;
-            m_settings["vpn"]["data"] = QVariant::fromValue(vpnData);
-        }
+            // A newer fetch or one of our own updates has overtaken this one
+            if (generation != m_settingsGeneration)
+            {
+                return;
+            }
 
-        updateId();
-        updateNeverDefault();
-        updateValid();
-        updateType();
+            QDBusPendingReply<QVariantDictMap> reply = *call;
+            if (reply.isError())
+            {
+                qWarning() << reply.error().message();
+                return;
+            }
 
-        if (m_valid)
-        {
-            Q_EMIT updateData(vpnData);
-        }
+            applySettings(reply);
+        });
     }
 
-    void activeConnectionsUpdated(const QSet<connection::ActiveConnection::SPtr>& activeConnections)
+    void activeConnectionChanged(connection::ActiveConnection::SPtr activeConnection)
     {
-        connection::ActiveConnection::SPtr activeConnection;
-
-        QDBusObjectPath path(m_connection->path());
-
-        // Search for the active connection
-        for (const auto& con : activeConnections)
-        {
-            // Connection to all signals on all active connections
-            connect(con.get(), &connection::ActiveConnection::connectionPathChanged, this, &Priv::connectionUpdated);
-            connect(con.get(), &connection::ActiveConnection::stateChanged, this, &Priv::connectionUpdated);
-            connect(con.get(), &connection::ActiveConnection::typeChanged, this, &Priv::connectionUpdated);
-
-            if (con->connectionPath() == path)
-            {
-                activeConnection = con;
-                break;
-            }
-        }
-
         if (activeConnection)
         {
             _connectionUpdated(*activeConnection);
@@ -321,12 +405,6 @@ public Q_SLOTS:
         }
     }
 
-    void connectionUpdated()
-    {
-        auto activeConnection = qobject_cast<connection::ActiveConnection*>(sender());
-        _connectionUpdated(*activeConnection);
-    }
-
 public:
     VpnConnection& p;
 
@@ -334,12 +412,23 @@ public:
 
     connection::ActiveConnectionManager::SPtr m_activeConnectionManager;
 
+    connection::ActiveConnectionWatcher::SPtr m_activeConnectionWatcher;
+
     QVariantDictMap m_settings;
 
     bool m_dirty = false;
 
+    bool m_updateInFlight = false;
+
+    quint64 m_settingsGeneration = 0;
+
+    quint64 m_secretsGeneration = 0;
+
     QVariantDictMap m_pendingSettings;
 
+    // What the update in flight sent
+    QVariantDictMap m_sentSettings;
+
     QTimer m_dispatchPendingSettingsTimer;
 
     QString m_uuid;
@@ -360,9 +449,7 @@ public:
 
     QDBusObjectPath m_activeConnectionPath;
 
-    bool m_otherConnectionIsBusy = false;
-
-    QDBusObjectPath m_otherActiveConnectionPath;
+    ActivationState::SCPtr m_activationState;
 
     OpenvpnConnection::SPtr m_openvpnConnection;
 
@@ -375,16 +462,30 @@ VpnConnection::VpnConnection(
         const QDBusConnection& systemConnection) :
         d(new Priv(*this))
 {
+    d->m_dispatchPendingSettingsTimer.setObjectName("VPN settings dispatch");
     d->m_dispatchPendingSettingsTimer.setSingleShot(true);
     d->m_dispatchPendingSettingsTimer.setInterval(200);
     d->m_dispatchPendingSettingsTimer.setTimerType(Qt::CoarseTimer);
     connect(&d->m_dispatchPendingSettingsTimer, &QTimer::timeout, d.get(), &Priv::dispatchPendingSettings);
 
-    d->m_connection = make_shared<OrgFreedesktopNetworkManagerSettingsConnectionInterface>(NM_DBUS_SERVICE, path.path(), systemConnection);
+    d->m_connection = make_shared<utils::Instrumented<OrgFreedesktopNetworkManagerSettingsConnectionInterface>>(NM_DBUS_SERVICE, path.path(), systemConnection);
 
     d->m_activeConnectionManager = activeConnectionManager;
 
-    d->settingsUpdated();
+    // Validity and type decide what gets built below, so the first fetch
+    // has to complete here; later refreshes are asynchronous
+    {
+        auto reply = d->m_connection->GetSettings();
+        utils::waitForFinished(reply, "org.freedesktop.NetworkManager.Settings.Connection.GetSettings");
+        if (reply.isError())
+        {
+            qWarning() << reply.error().message();
+        }
+        else
+        {
+            d->applySettings(reply);
+        }
+    }
     d->updateUuid();
     connect(d->m_connection.get(), &OrgFreedesktopNetworkManagerSettingsConnectionInterface::Updated, d.get(), &Priv::settingsUpdated);
 
@@ -393,8 +494,9 @@ VpnConnection::VpnConnection(
         return;
     }
 
-    d->activeConnectionsUpdated(d->m_activeConnectionManager->connections());
-    connect(d->m_activeConnectionManager.get(), &connection::ActiveConnectionManager::connectionsChanged, d.get(), &Priv::activeConnectionsUpdated);
+    d->m_activeConnectionWatcher = d->m_activeConnectionManager->watch(path);
+    connect(d->m_activeConnectionWatcher.get(), &connection::ActiveConnectionWatcher::activeConnectionChanged, d.get(), &Priv::activeConnectionChanged);
+    d->activeConnectionChanged(d->m_activeConnectionManager->connection(path));
 
     switch (d->m_type)
     {
@@ -484,15 +586,14 @@ void VpnConnection::setNeverDefault(bool neverDefault)
     d->m_pendingSettings["ipv6"]["never-default"] = neverDefault;
 }
 
-void VpnConnection::setOtherConnectionIsBusy(bool otherConnectionIsBusy)
+void VpnConnection::setActivationState(ActivationState::SCPtr activationState)
 {
-    d->m_otherConnectionIsBusy = otherConnectionIsBusy;
+    d->m_activationState = activationState;
     d->updateActivatable();
 }
 
-void VpnConnection::setActiveConnectionPath(const QDBusObjectPath& path)
+void VpnConnection::updateActivatable()
 {
-    d->m_otherActiveConnectionPath = path;
     d->updateActivatable();
 }
 
@@ -36,6 +36,22 @@ namespace nmofono
 namespace vpn
 {
 
+/**
+ * What a connection needs to know about the others to decide whether it can
+ * be activated. Kept up to date by the VpnManager, which tells the
+ * connections affected by a change to look at it again.
+ */
+struct ActivationState
+{
+    UNITY_DEFINES_PTRS(ActivationState);
+
+    // Whether any connection is activating or deactivating
+    bool busy = false;
+
+    // Settings path of the active connection, if any
+    QDBusObjectPath activeConnectionPath;
+};
+
 class VpnConnection: public QObject
 {
     Q_OBJECT
@@ -82,9 +98,9 @@ public Q_SLOTS:
 
     void setNeverDefault(bool neverDefault);
 
-    void setOtherConnectionIsBusy(bool otherConnectionIsBusy);
+    void setActivationState(ActivationState::SCPtr activationState);
 
-    void setActiveConnectionPath(const QDBusObjectPath& path);
+    void updateActivatable();
 
     void updateSecrets();
 
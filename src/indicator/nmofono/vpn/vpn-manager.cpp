@@ -24,6 +24,7 @@
 
 #include <NetworkManagerInterface.h>
 #include <NetworkManagerSettingsInterface.h>
+#include <backend-utils.h>
 
 using namespace std;
 
@@ -42,24 +43,35 @@ public:
     {
     }
 
-    void _newConnection(const QDBusObjectPath &path, bool shouldUpdateActiveAndBusy)
+    void _newConnection(const QDBusObjectPath &path, bool shouldUpdateActivationState)
     {
         auto connection = make_shared<VpnConnection>(path, m_activeConnectionManager, m_settingsInterface->connection());
         if (connection->isValid())
         {
             m_connections[path] = connection;
-            connection->setOtherConnectionIsBusy(m_busy);
-            connection->setActiveConnectionPath(m_activeConnectionPath);
             connect(connection.get(), &VpnConnection::activateConnection, this, &Priv::activateConnection);
-            connect(connection.get(), &VpnConnection::deactivateConnection, m_nmInterface.get(), &OrgFreedesktopNetworkManagerInterface::DeactivateConnection);
-            connect(connection.get(), &VpnConnection::activeChanged, this, &Priv::updateActiveAndBusy);
-            connect(connection.get(), &VpnConnection::busyChanged, this, &Priv::updateActiveAndBusy);
-            connect(this, &Priv::busyChanged, connection.get(), &VpnConnection::setOtherConnectionIsBusy);
-            connect(this, &Priv::activeConnectionPathChanged, connection.get(), &VpnConnection::setActiveConnectionPath);
+            connect(connection.get(), &VpnConnection::deactivateConnection, this, &Priv::deactivateConnection);
+            connect(connection.get(), &VpnConnection::activeChanged, this, [this, path](bool active)
+            {
+                connectionActiveChanged(path, active);
+            });
+            connect(connection.get(), &VpnConnection::busyChanged, this, [this, path](bool busy)
+            {
+                connectionBusyChanged(path, busy);
+            });
+            if (connection->isActive())
+            {
+                m_activeConnections << path;
+            }
+            if (connection->isBusy())
+            {
+                m_busyConnections << path;
+            }
+            connection->setActivationState(m_activationState);
             Q_EMIT p.connectionsChanged();
-            if (shouldUpdateActiveAndBusy)
+            if (shouldUpdateActivationState)
             {
-                updateActiveAndBusy();
+                updateActivationState();
             }
         }
     }
@@ -89,10 +101,81 @@ public:
         return name;
     }
 
-Q_SIGNALS:
-    void busyChanged(bool busy);
+    void connectionActiveChanged(const QDBusObjectPath& path, bool active)
+    {
+        if (active)
+        {
+            m_activeConnections << path;
+        }
+        else
+        {
+            m_activeConnections.remove(path);
+        }
+        updateActivationState();
+    }
+
+    void connectionBusyChanged(const QDBusObjectPath& path, bool busy)
+    {
+        if (busy)
+        {
+            m_busyConnections << path;
+        }
+        else
+        {
+            m_busyConnections.remove(path);
+        }
+        updateActivationState();
+    }
+
+    /**
+     * Derives the shared state from the busy and active sets, then asks the
+     * connections it could have changed the answer for to look again.
+     *
+     * Only a change of busy, or of whether anything is active at all, can
+     * affect every connection. Moving from one active connection to another
+     * only affects those two.
+     */
+    void updateActivationState()
+    {
+        bool busy = !m_busyConnections.isEmpty();
+
+        // Stick with the current active connection while it stays active
+        QDBusObjectPath activeConnectionPath = m_activationState->activeConnectionPath;
+        if (!m_activeConnections.contains(activeConnectionPath))
+        {
+            activeConnectionPath = m_activeConnections.isEmpty() ? QDBusObjectPath() : *m_activeConnections.constBegin();
+        }
+
+        auto previousActiveConnectionPath = m_activationState->activeConnectionPath;
+        bool everyConnection = busy != m_activationState->busy
+                || activeConnectionPath.path().isEmpty() != previousActiveConnectionPath.path().isEmpty();
+        if (!everyConnection && activeConnectionPath == previousActiveConnectionPath)
+        {
+            return;
+        }
 
-    void activeConnectionPathChanged(const QDBusObjectPath& path);
+        m_activationState->busy = busy;
+        m_activationState->activeConnectionPath = activeConnectionPath;
+
+        if (everyConnection)
+        {
+            for (const auto& connection: m_connections)
+            {
+                connection->updateActivatable();
+            }
+        }
+        else
+        {
+            for (const auto& path: {previousActiveConnectionPath, activeConnectionPath})
+            {
+                auto connection = m_connections.value(path);
+                if (connection)
+                {
+                    connection->updateActivatable();
+                }
+            }
+        }
+    }
 
 public Q_SLOTS:
     void connectionRemoved(const QDBusObjectPath &path)
@@ -100,8 +183,10 @@ public Q_SLOTS:
         auto connection = m_connections.take(path);
         if (connection)
         {
+            m_activeConnections.remove(path);
+            m_busyConnections.remove(path);
             Q_EMIT p.connectionsChanged();
-            updateActiveAndBusy();
+            updateActivationState();
         }
     }
 
@@ -113,7 +198,7 @@ public Q_SLOTS:
     void activateConnection(const QDBusObjectPath& connection)
     {
         auto reply = m_nmInterface->ActivateConnection(connection, QDBusObjectPath("/"), QDBusObjectPath("/"));
-        auto watcher(new QDBusPendingCallWatcher(reply, this));
+        auto watcher(utils::watch(reply, "org.freedesktop.NetworkManager.ActivateConnection", this));
         connect(watcher, &QDBusPendingCallWatcher::finished, this, &Priv::activateConnectionFinished);
     }
 
@@ -127,51 +212,21 @@ public Q_SLOTS:
         call->deleteLater();
     }
 
-    void updateActiveAndBusy()
-    {
-        bool busy = false;
-        for (const auto& connection: m_connections)
-        {
-            if (connection->isBusy())
-            {
-                busy = true;
-                break;
-            }
-        }
-        setBusy(busy);
-
-        QDBusObjectPath activeConnectionPath;
-        for (const auto& connection: m_connections)
-        {
-            if (connection->isActive())
-            {
-                activeConnectionPath = connection->path();
-                break;
-            }
-        }
-        setActiveConnectionPath(activeConnectionPath);
-    }
-
-    void setBusy(bool busy)
+    void deactivateConnection(const QDBusObjectPath& activeConnection)
     {
-        if (m_busy == busy)
-        {
-            return;
-        }
-
-        m_busy = busy;
-        Q_EMIT busyChanged(m_busy);
+        auto reply = m_nmInterface->DeactivateConnection(activeConnection);
+        auto watcher(utils::watch(reply, "org.freedesktop.NetworkManager.DeactivateConnection", this));
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &Priv::deactivateConnectionFinished);
     }
 
-    void setActiveConnectionPath(const QDBusObjectPath& activeConnectionPath)
+    void deactivateConnectionFinished(QDBusPendingCallWatcher *call)
     {
-        if (m_activeConnectionPath == activeConnectionPath)
+        QDBusPendingReply<> reply = *call;
+        if (reply.isError())
         {
-            return;
+            qWarning() << reply.error().message();
         }
-
-        m_activeConnectionPath = activeConnectionPath;
-        Q_EMIT activeConnectionPathChanged(m_activeConnectionPath);
+        call->deleteLater();
     }
 
 public:
@@ -185,25 +240,27 @@ public:
 
     QMap<QDBusObjectPath, VpnConnection::SPtr> m_connections;
 
-    bool m_busy = false;
+    QSet<QDBusObjectPath> m_activeConnections;
+
+    QSet<QDBusObjectPath> m_busyConnections;
 
-    QDBusObjectPath m_activeConnectionPath;
+    ActivationState::SPtr m_activationState = make_shared<ActivationState>();
 };
 
 VpnManager::VpnManager(connection::ActiveConnectionManager::SPtr activeConnectionManager, const QDBusConnection& systemConnection) :
         d(new Priv(*this))
 {
     d->m_activeConnectionManager = activeConnectionManager;
-    d->m_nmInterface = make_shared<OrgFreedesktopNetworkManagerInterface>(
+    d->m_nmInterface = make_shared<utils::Instrumented<OrgFreedesktopNetworkManagerInterface>>(
                 NM_DBUS_SERVICE, NM_DBUS_PATH, systemConnection);
-    d->m_settingsInterface = make_shared<OrgFreedesktopNetworkManagerSettingsInterface>(
+    d->m_settingsInterface = make_shared<utils::Instrumented<OrgFreedesktopNetworkManagerSettingsInterface>>(
                 NM_DBUS_SERVICE, NM_DBUS_PATH_SETTINGS, systemConnection);
 
     for (const auto& path : d->m_settingsInterface->connections())
     {
         d->_newConnection(path, false);
     }
-    d->updateActiveAndBusy();
+    d->updateActivationState();
     connect(d->m_settingsInterface.get(), &OrgFreedesktopNetworkManagerSettingsInterface::NewConnection, d.get(), &Priv::newConnection);
     connect(d->m_settingsInterface.get(), &OrgFreedesktopNetworkManagerSettingsInterface::ConnectionRemoved, d.get(), &Priv::connectionRemoved);
 }
@@ -269,7 +326,7 @@ QString VpnManager::addConnection(VpnConnection::Type type)
     };
 
     auto reply = d->m_settingsInterface->AddConnection(connection);
-    reply.waitForFinished();
+    utils::waitForFinished(reply, "org.freedesktop.NetworkManager.Settings.AddConnection");
     if (reply.isError())
     {
         throw domain_error(reply.error().message().toStdString());
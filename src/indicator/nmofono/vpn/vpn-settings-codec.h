@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <dbus-types.h>
+
+#include <QVector>
+
+#include <cstddef>
+#include <initializer_list>
+
+namespace nmofono
+{
+namespace vpn
+{
+namespace codec
+{
+
+/**
+ * A typed setting of a VPN plugin, exposed as a property of its owner.
+ *
+ * parse() reads the setting out of the plugin's data (or secrets) map and
+ * returns whether it changed; notify() emits the owner's change signal.
+ */
+template<typename Owner, typename Data>
+struct Field
+{
+    typename Owner::Field id;
+
+    const char* key;
+
+    bool secret;
+
+    bool (*parse)(Data& data, const QStringMap& map, const char* key);
+
+    void (*notify)(Owner& owner, const Data& data);
+};
+
+/**
+ * One key of the plugin's data (or secrets) map. build() returns false to
+ * leave the key out. dependencies has a bit set for every field the value
+ * is built from, so changing a field only rebuilds the keys it affects.
+ */
+template<typename Data>
+struct Key
+{
+    const char* key;
+
+    bool secret;
+
+    quint64 dependencies;
+
+    bool (*build)(const Data& data, QString& value);
+};
+
+template<typename T>
+struct EnumName
+{
+    T value;
+
+    const char* name;
+};
+
+template<typename Id>
+constexpr quint64 mask(std::initializer_list<Id> ids)
+{
+    quint64 bits = 0;
+    for (auto id: ids)
+    {
+        bits |= quint64(1) << static_cast<int>(id);
+    }
+    return bits;
+}
+
+/**
+ * Fields are looked up by id, so each must sit at the index of its id.
+ */
+template<typename Owner, typename Data, std::size_t N>
+constexpr bool fieldsInOrder(const Field<Owner, Data> (&fields)[N])
+{
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        if (static_cast<std::size_t>(fields[i].id) != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T, std::size_t N>
+T enumFromString(const EnumName<T> (&names)[N], const QString& name, T fallback)
+{
+    for (const auto& entry: names)
+    {
+        if (name == QLatin1String(entry.name))
+        {
+            return entry.value;
+        }
+    }
+    return fallback;
+}
+
+template<typename T, std::size_t N>
+QString enumToString(const EnumName<T> (&names)[N], T value)
+{
+    for (const auto& entry: names)
+    {
+        if (entry.value == value)
+        {
+            return QString::fromLatin1(entry.name);
+        }
+    }
+    return QString();
+}
+
+template<typename T>
+bool assign(T& member, const T& value)
+{
+    if (member == value)
+    {
+        return false;
+    }
+    member = value;
+    return true;
+}
+
+// Field parsers for the common cases
+
+template<typename Data, QString Data::*Member>
+bool parseString(Data& data, const QStringMap& map, const char* key)
+{
+    return assign(data.*Member, map.value(QLatin1String(key)));
+}
+
+template<typename Data, bool Data::*Member>
+bool parseYes(Data& data, const QStringMap& map, const char* key)
+{
+    return assign(data.*Member, map.value(QLatin1String(key)) == "yes");
+}
+
+template<typename Data, bool Data::*Member>
+bool parseNotYes(Data& data, const QStringMap& map, const char* key)
+{
+    return assign(data.*Member, map.value(QLatin1String(key)) != "yes");
+}
+
+template<typename Data, bool Data::*Member>
+bool parsePresent(Data& data, const QStringMap& map, const char* key)
+{
+    return assign(data.*Member, map.contains(QLatin1String(key)));
+}
+
+// Keeps the last value when the key is absent; the matching parsePresent
+// field records whether it was there
+template<typename Data, int Data::*Member>
+bool parseOptionalInt(Data& data, const QStringMap& map, const char* key)
+{
+    auto it = map.constFind(QLatin1String(key));
+    return it != map.constEnd() && assign(data.*Member, it->toInt());
+}
+
+template<typename Owner, typename Data, typename T, T Data::*Member, typename Signal, Signal signal>
+void notifyField(Owner& owner, const Data& data)
+{
+    Q_EMIT (owner.*signal)(data.*Member);
+}
+
+/**
+ * Keeps the typed settings of a VPN plugin in step with its data and
+ * secrets maps.
+ *
+ * Incoming maps are parsed field by field, announcing only what changed.
+ * Local edits go to a pending copy whose maps are built once per editing
+ * session and then patched key by key, so an edit costs work in
+ * proportion to the keys it affects rather than the whole profile.
+ *
+ * Owner must provide updateVpnData, updateVpnSecrets and fieldChanged
+ * signals, and a Field enum the tables are indexed by.
+ */
+template<typename Owner, typename Data>
+class Settings
+{
+public:
+    template<std::size_t F, std::size_t K>
+    Settings(Owner& owner, const Field<Owner, Data> (&fields)[F], const Key<Data> (&keys)[K]) :
+        m_owner(owner),
+        m_fields(fields),
+        m_fieldCount(F),
+        m_keys(keys),
+        m_keyCount(K),
+        m_dependents(F)
+    {
+        static_assert(F <= 64, "Too many fields for the dependency mask");
+
+        for (std::size_t k = 0; k < K; ++k)
+        {
+            for (std::size_t f = 0; f < F; ++f)
+            {
+                if (keys[k].dependencies & (quint64(1) << static_cast<int>(fields[f].id)))
+                {
+                    m_dependents[static_cast<int>(fields[f].id)] << int(k);
+                }
+            }
+        }
+    }
+
+    const Data& data() const
+    {
+        return m_data;
+    }
+
+    void update(const QStringMap& map, bool secret)
+    {
+        for (std::size_t i = 0; i < m_fieldCount; ++i)
+        {
+            const auto& field = m_fields[i];
+            if (field.secret == secret && field.parse(m_data, map, field.key))
+            {
+                field.notify(m_owner, m_data);
+                Q_EMIT m_owner.fieldChanged(field.id);
+            }
+        }
+    }
+
+    template<typename T, typename V>
+    void set(typename Owner::Field id, T Data::*member, const V& value)
+    {
+        if (m_data.*member == value)
+        {
+            return;
+        }
+
+        if (!m_dirty)
+        {
+            m_pending = m_data;
+            m_pendingData = build(false);
+            m_pendingSecrets = build(true);
+            m_dirty = true;
+        }
+
+        m_pending.*member = value;
+        patch(id);
+
+        if (m_fields[static_cast<int>(id)].secret)
+        {
+            Q_EMIT m_owner.updateVpnSecrets(m_pendingSecrets);
+        }
+        else
+        {
+            Q_EMIT m_owner.updateVpnData(m_pendingData);
+        }
+    }
+
+    void markClean()
+    {
+        m_dirty = false;
+    }
+
+protected:
+    QStringMap build(bool secret) const
+    {
+        QStringMap map;
+        for (std::size_t i = 0; i < m_keyCount; ++i)
+        {
+            const auto& key = m_keys[i];
+            QString value;
+            if (key.secret == secret && key.build(m_pending, value))
+            {
+                map.insert(QLatin1String(key.key), value);
+            }
+        }
+        return map;
+    }
+
+    void patch(typename Owner::Field id)
+    {
+        for (int i: m_dependents.at(static_cast<int>(id)))
+        {
+            const auto& key = m_keys[i];
+            auto& map = key.secret ? m_pendingSecrets : m_pendingData;
+            QString value;
+            if (key.build(m_pending, value))
+            {
+                map.insert(QLatin1String(key.key), value);
+            }
+            else
+            {
+                map.remove(QLatin1String(key.key));
+            }
+        }
+    }
+
+    Owner& m_owner;
+
+    const Field<Owner, Data>* m_fields;
+
+    std::size_t m_fieldCount;
+
+    const Key<Data>* m_keys;
+
+    std::size_t m_keyCount;
+
+    // Field id -> indexes of the keys built from it
+    QVector<QVector<int>> m_dependents;
+
+    Data m_data;
+
+    Data m_pending;
+
+    QStringMap m_pendingData;
+
+    QStringMap m_pendingSecrets;
+
+    bool m_dirty = false;
+};
+
+}
+}
+}
+
+#define VPN_CODEC_FIELD(Owner, Data, Id, Key, Secret, Parse, Member, Signal) \
+    { Owner::Field::Id, Key, Secret, Parse, \
+      &nmofono::vpn::codec::notifyField<Owner, Data, decltype(Data::Member), &Data::Member, decltype(&Owner::Signal), &Owner::Signal> }
@@ -21,11 +21,13 @@
 #include <nmofono/wifi/access-point-impl.h>
 #include <nmofono/wifi/grouped-access-point.h>
 #include <url-dispatcher-cpp/url-dispatcher.h>
+#include <util/logging.h>
 #include <cassert>
 
 #include <NetworkManagerActiveConnectionInterface.h>
 #include <NetworkManagerDeviceWirelessInterface.h>
 #include <NetworkManagerSettingsConnectionInterface.h>
+#include <backend-utils.h>
 
 #include <NetworkManager.h>
 #include <iostream>
@@ -67,7 +69,7 @@ public:
     Signal m_signal = Signal::disconnected;
 
     shared_ptr<OrgFreedesktopNetworkManagerDeviceInterface> m_dev;
-    OrgFreedesktopNetworkManagerDeviceWirelessInterface m_wireless;
+    utils::Instrumented<OrgFreedesktopNetworkManagerDeviceWirelessInterface> m_wireless;
     shared_ptr<OrgFreedesktopNetworkManagerInterface> m_nm;
 
     KillSwitch::Ptr m_killSwitch;
@@ -91,6 +93,16 @@ public:
         Q_EMIT p.statusUpdated(m_status);
     }
 
+    void deactivateConnectionFinished(QDBusPendingCallWatcher* call)
+    {
+        QDBusPendingReply<> reply = *call;
+        if (reply.isError())
+        {
+            qWarning() << reply.error().message();
+        }
+        call->deleteLater();
+    }
+
     void updateDeviceState(uint new_state)
     {
         m_lastState = new_state;
@@ -187,7 +199,7 @@ public:
 
         try {
             m_activeConnection = make_shared<
-                    OrgFreedesktopNetworkManagerConnectionActiveInterface>(
+                    utils::Instrumented<OrgFreedesktopNetworkManagerConnectionActiveInterface>>(
                     NM_DBUS_SERVICE, path.path(), m_dev->connection());
             uint state = m_activeConnection->state();
             switch (state) {
@@ -238,7 +250,7 @@ public Q_SLOTS:
             AccessPointImpl::Ptr shap;
             try {
                 auto ap = make_shared<
-                        OrgFreedesktopNetworkManagerAccessPointInterface>(
+                        utils::Instrumented<OrgFreedesktopNetworkManagerAccessPointInterface>>(
                         NM_DBUS_SERVICE, path.path(), m_dev->connection());
                 shap = make_shared<AccessPointImpl>(ap);
             } catch(const exception &e) {
@@ -449,7 +461,7 @@ WifiLinkImpl::accessPoints() const {
 void
 WifiLinkImpl::connect_to(AccessPoint::Ptr accessPoint)
 {
-    qDebug() << "Connecting to:" << accessPoint->ssid();
+    qCDebug(lcWifi) << "Connecting to:" << accessPoint->ssid();
 
     try {
         d->m_connecting = true;
@@ -458,7 +470,7 @@ WifiLinkImpl::connect_to(AccessPoint::Ptr accessPoint)
         shared_ptr<OrgFreedesktopNetworkManagerSettingsConnectionInterface> found;
         QList<QDBusObjectPath> connections = d->m_dev->availableConnections();
         for (auto &path : connections) {
-            auto con = make_shared<OrgFreedesktopNetworkManagerSettingsConnectionInterface>(
+            auto con = make_shared<utils::Instrumented<OrgFreedesktopNetworkManagerSettingsConnectionInterface>>(
                     NM_DBUS_SERVICE, path.path(), d->m_dev->connection());
             QVariantDictMap settings = con->GetSettings();
             auto wirelessIt = settings.find("802-11-wireless");
@@ -481,13 +493,13 @@ WifiLinkImpl::connect_to(AccessPoint::Ptr accessPoint)
 
         QDBusObjectPath ac("/");
         if (found) {
-            qDebug() << "Connecting to known access point";
+            qCDebug(lcWifi) << "Connecting to known access point";
             ac = d->m_nm->ActivateConnection(QDBusObjectPath(found->path()),
                                            QDBusObjectPath(d->m_dev->path()),
                                            accessPoint->object_path());
         } else {
             if (accessPoint->enterprise()) {
-                qDebug() << "New connection to enterprise access point";
+                qCDebug(lcWifi) << "New connection to enterprise access point";
                 // activate system settings URI
                 QUrlQuery q;
                 q.addQueryItem("ssid", accessPoint->raw_ssid());
@@ -500,7 +512,7 @@ WifiLinkImpl::connect_to(AccessPoint::Ptr accessPoint)
                     }
                 });
             } else {
-                qDebug() << "New connection to regular access point";
+                qCDebug(lcWifi) << "New connection to regular access point";
                 QVariantDictMap conf;
 
                 /// @todo getting the ssid multiple times over dbus is stupid.
@@ -511,7 +523,7 @@ WifiLinkImpl::connect_to(AccessPoint::Ptr accessPoint)
                 conf["802-11-wireless"] = wireless_conf;
                 auto ret = d->m_nm->AddAndActivateConnection(
                         conf, QDBusObjectPath(d->m_dev->path()), accessPoint->object_path());
-                ret.waitForFinished();
+                utils::waitForFinished(ret, "org.freedesktop.NetworkManager.AddAndActivateConnection");
                 ac = ret.argumentAt<1>();
             }
         }
@@ -552,8 +564,10 @@ WifiLinkImpl::setDisconnectWifi(bool disconnect)
     if (disconnect && d->m_activeConnection)
     {
         // Disconnect from the current network
-        d->m_nm->DeactivateConnection(
+        auto reply = d->m_nm->DeactivateConnection(
                 QDBusObjectPath(d->m_activeConnection->path()));
+        auto watcher(utils::watch(reply, "org.freedesktop.NetworkManager.DeactivateConnection", d.get()));
+        connect(watcher, &QDBusPendingCallWatcher::finished, d.get(), &Private::deactivateConnectionFinished);
     }
 
     d->update_grouped_access_points();
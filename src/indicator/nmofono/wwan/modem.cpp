@@ -20,6 +20,7 @@
 #include <nmofono/wwan/modem.h>
 
 #include <ofono/dbus.h>
+#include <util/logging.h>
 #include <QDebug>
 
 #define slots
@@ -89,6 +90,7 @@ public:
     bool m_online;
 
     shared_ptr<QOfonoModem> m_ofonoModem;
+    OfonoProxyRegistry::Ptr m_proxies;
     Modem::SimStatus m_simStatus;
     Modem::PinType m_requiredPin;
     RetriesType m_retries;
@@ -125,8 +127,8 @@ public:
 
     bool m_shouldTriggerUnlock = false;
 
-    Private(Modem& parent, shared_ptr<QOfonoModem> ofonoModem)
-        : p(parent), m_ofonoModem{ofonoModem}
+    Private(Modem& parent, shared_ptr<QOfonoModem> ofonoModem, OfonoProxyRegistry::Ptr proxies, int index)
+        : p(parent), m_ofonoModem{ofonoModem}, m_proxies{proxies}, m_index{index}
     {
         connect(m_ofonoModem.get(), &QOfonoModem::onlineChanged, this, &Private::update);
         setOnline(m_ofonoModem->online());
@@ -139,18 +141,10 @@ public:
 
         /// @todo hook up with system-settings to allow changing the identifier.
         ///       for now just provide the defaults
-        auto path = m_ofonoModem->modemPath();
-        if (path.endsWith("_0")) {
-            setSimIdentifier("SIM 1");
-            m_index = 1;
-        } else if (path.endsWith("_1")) {
-            setSimIdentifier("SIM 2");
-            m_index = 2;
-        } else {
-            setSimIdentifier(path);
-        }
+        setSimIdentifier(QString("SIM %1").arg(m_index));
 
         // Throttle the updates using a timer
+        m_updatedTimer.setObjectName("modem update");
         m_updatedTimer.setInterval(0);
         m_updatedTimer.setSingleShot(true);
         connect(&m_updatedTimer, &QTimer::timeout, this, &Private::fireUpdate);
@@ -164,7 +158,7 @@ public Q_SLOTS:
         if (p.isReadyToUnlock() && m_shouldTriggerUnlock)
         {
 
-            qDebug() << "SIM ready to unlock:" << p.simIdentifier();
+            qCDebug(lcModem) << "SIM ready to unlock:" << p.simIdentifier();
             m_shouldTriggerUnlock = false;
             Q_EMIT p.readyToUnlock(p.name());
         }
@@ -212,6 +206,12 @@ public Q_SLOTS:
             return;
         }
 
+        // The proxy is shared, so it might outlive our interest in it
+        if (m_connectionManager)
+        {
+            m_connectionManager->disconnect(this);
+        }
+
         m_connectionManager = conmgr;
         if (m_connectionManager)
         {
@@ -234,6 +234,11 @@ public Q_SLOTS:
             return;
         }
 
+        if (m_networkRegistration)
+        {
+            m_networkRegistration->disconnect(this);
+        }
+
         m_networkRegistration = netreg;
         if (m_networkRegistration)
         {
@@ -264,6 +269,11 @@ public Q_SLOTS:
             return;
         }
 
+        if (m_simManager)
+        {
+            m_simManager->disconnect(this);
+        }
+
         m_simManager = simmgr;
         if (m_simManager)
         {
@@ -290,6 +300,14 @@ public Q_SLOTS:
             connect(m_simManager.get(),
                     &QOfonoSimManager::presenceChanged, this,
                     &Private::presentChanged);
+
+            // A shared proxy that has already fetched its properties won't
+            // announce them again
+            if (m_simManager->isValid())
+            {
+                m_presentSet = true;
+                m_present = m_simManager->present();
+            }
         }
 
         update();
@@ -594,28 +612,25 @@ public Q_SLOTS:
         {
             if (interface == OFONO_CONNECTION_MANAGER_INTERFACE)
             {
-                auto connmgr = make_shared<QOfonoConnectionManager>();
-                connmgr->setModemPath(m_ofonoModem->modemPath());
-                connectionManagerChanged(connmgr);
+                connectionManagerChanged(
+                        m_proxies->connectionManager(m_ofonoModem->modemPath()));
             }
             else if (interface == OFONO_NETWORK_REGISTRATION_INTERFACE)
             {
-                auto netreg = make_shared<QOfonoNetworkRegistration>();
-                netreg->setModemPath(m_ofonoModem->modemPath());
-                networkRegistrationChanged(netreg);
+                networkRegistrationChanged(
+                        m_proxies->networkRegistration(m_ofonoModem->modemPath()));
             }
             else if (interface == OFONO_SIM_MANAGER_INTERFACE)
             {
-                auto simmgr = make_shared<QOfonoSimManager>();
-                simmgr->setModemPath(m_ofonoModem->modemPath());
-                simManagerChanged(simmgr);
+                simManagerChanged(
+                        m_proxies->simManager(m_ofonoModem->modemPath()));
             }
         }
     }
 };
 
-Modem::Modem(shared_ptr<QOfonoModem> ofonoModem)
-    : d{new Private(*this, ofonoModem)}
+Modem::Modem(shared_ptr<QOfonoModem> ofonoModem, OfonoProxyRegistry::Ptr proxies, int index)
+    : d{new Private(*this, ofonoModem, proxies, index)}
 {
 }
 
@@ -801,7 +816,7 @@ Modem::isReadyToUnlock() const
 void
 Modem::notifyWhenReadyToUnlock()
 {
-    qDebug() << "Notify when ready to unlock" << simIdentifier();
+    qCDebug(lcModem) << "Notify when ready to unlock" << simIdentifier();
     d->m_shouldTriggerUnlock = true;
 }
 
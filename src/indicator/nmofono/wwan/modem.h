@@ -21,6 +21,7 @@
 
 #include <nmofono/wwan/wwan-link.h>
 
+#include <nmofono/wwan/ofono-proxy-registry.h>
 #include <nmofono/wwan/sim.h>
 
 #include <map>
@@ -86,7 +87,7 @@ public:
 
     Modem() = delete;
 
-    explicit Modem(std::shared_ptr<QOfonoModem> ofonoModem);
+    Modem(std::shared_ptr<QOfonoModem> ofonoModem, OfonoProxyRegistry::Ptr proxies, int index);
 
     virtual ~Modem();
 
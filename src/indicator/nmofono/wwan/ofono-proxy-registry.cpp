@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nmofono/wwan/ofono-proxy-registry.h>
+
+#include <QHash>
+
+#define slots
+#include <qofono-qt5/qofonomodem.h>
+#include <qofono-qt5/qofonosimmanager.h>
+#include <qofono-qt5/qofononetworkregistration.h>
+#include <qofono-qt5/qofonoconnectionmanager.h>
+#undef slots
+
+using namespace std;
+
+namespace nmofono
+{
+namespace wwan
+{
+namespace
+{
+
+template<typename T>
+shared_ptr<T> acquire(QHash<QString, weak_ptr<T>>& proxies, const QString& path)
+{
+    auto it = proxies.find(path);
+    if (it != proxies.end())
+    {
+        if (auto proxy = it->lock())
+        {
+            return proxy;
+        }
+    }
+
+    // Drop any proxies nobody is interested in any more
+    for (auto i = proxies.begin(); i != proxies.end();)
+    {
+        if (i->expired())
+        {
+            i = proxies.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    auto proxy = make_shared<T>();
+    proxy->setModemPath(path);
+    proxies[path] = proxy;
+    return proxy;
+}
+
+}
+
+class OfonoProxyRegistry::Private
+{
+public:
+    QHash<QString, weak_ptr<QOfonoModem>> m_modems;
+    QHash<QString, weak_ptr<QOfonoSimManager>> m_simManagers;
+    QHash<QString, weak_ptr<QOfonoConnectionManager>> m_connectionManagers;
+    QHash<QString, weak_ptr<QOfonoNetworkRegistration>> m_networkRegistrations;
+};
+
+OfonoProxyRegistry::OfonoProxyRegistry()
+    : d{new Private}
+{
+}
+
+OfonoProxyRegistry::~OfonoProxyRegistry()
+{
+}
+
+shared_ptr<QOfonoModem>
+OfonoProxyRegistry::modem(const QString& path)
+{
+    return acquire(d->m_modems, path);
+}
+
+shared_ptr<QOfonoSimManager>
+OfonoProxyRegistry::simManager(const QString& path)
+{
+    return acquire(d->m_simManagers, path);
+}
+
+shared_ptr<QOfonoConnectionManager>
+OfonoProxyRegistry::connectionManager(const QString& path)
+{
+    return acquire(d->m_connectionManagers, path);
+}
+
+shared_ptr<QOfonoNetworkRegistration>
+OfonoProxyRegistry::networkRegistration(const QString& path)
+{
+    return acquire(d->m_networkRegistrations, path);
+}
+
+}
+}
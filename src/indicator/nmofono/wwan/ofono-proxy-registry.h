@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+
+#include <memory>
+
+class QOfonoModem;
+class QOfonoSimManager;
+class QOfonoConnectionManager;
+class QOfonoNetworkRegistration;
+
+namespace nmofono
+{
+namespace wwan
+{
+
+/**
+ * Hands out one set of oFono proxies per modem path.
+ *
+ * The registry only keeps weak references, so a proxy lives exactly as long
+ * as somebody is holding on to it. Every consumer asking for the same
+ * interface on the same modem path while the proxy is alive gets the same
+ * instance, so its signal subscriptions and property fetches are shared.
+ *
+ * As a proxy can outlive the interest of any single consumer, consumers
+ * must disconnect from a proxy when they let go of it.
+ */
+class OfonoProxyRegistry
+{
+    class Private;
+    std::shared_ptr<Private> d;
+
+public:
+    typedef std::shared_ptr<OfonoProxyRegistry> Ptr;
+    typedef std::weak_ptr<OfonoProxyRegistry> WeakPtr;
+
+    OfonoProxyRegistry();
+
+    ~OfonoProxyRegistry();
+
+    std::shared_ptr<QOfonoModem> modem(const QString& path);
+
+    std::shared_ptr<QOfonoSimManager> simManager(const QString& path);
+
+    std::shared_ptr<QOfonoConnectionManager> connectionManager(const QString& path);
+
+    std::shared_ptr<QOfonoNetworkRegistration> networkRegistration(const QString& path);
+};
+
+}
+}
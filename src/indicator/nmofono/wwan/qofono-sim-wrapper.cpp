@@ -40,6 +40,7 @@ public:
 
     QOfonoSimWrapper& p;
     shared_ptr<QOfonoSimManager> m_simManager;
+    shared_ptr<QOfonoConnectionManager> m_connManager;
 
     QString m_iccid;
 
@@ -48,8 +49,9 @@ public:
     bool m_iccidSet = false;
 
 
-    Private(QOfonoSimWrapper& parent, shared_ptr<QOfonoSimManager> simmgr)
-        : p(parent), m_simManager{simmgr}
+    Private(QOfonoSimWrapper& parent, shared_ptr<QOfonoSimManager> simmgr,
+            shared_ptr<QOfonoConnectionManager> connmgr)
+        : p(parent), m_simManager{simmgr}, m_connManager{connmgr}
     {
         connect(simmgr.get(), &QOfonoSimManager::presenceChanged, this, &Private::presentChanged);
         connect(simmgr.get(), &QOfonoSimManager::cardIdentifierChanged, this, &Private::iccidChanged);
@@ -95,8 +97,9 @@ public Q_SLOTS:
 
 
 
-QOfonoSimWrapper::QOfonoSimWrapper(std::shared_ptr<QOfonoSimManager> simmgr)
-    : d{new Private(*this, simmgr)}
+QOfonoSimWrapper::QOfonoSimWrapper(std::shared_ptr<QOfonoSimManager> simmgr,
+                                   std::shared_ptr<QOfonoConnectionManager> connmgr)
+    : d{new Private(*this, simmgr, connmgr)}
 {
 }
 
@@ -123,6 +126,11 @@ std::shared_ptr<QOfonoSimManager> QOfonoSimWrapper::ofonoSimManager() const
     return d->m_simManager;
 }
 
+std::shared_ptr<QOfonoConnectionManager> QOfonoSimWrapper::ofonoConnectionManager() const
+{
+    return d->m_connManager;
+}
+
 
 }
 }
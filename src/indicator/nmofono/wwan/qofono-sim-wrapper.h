@@ -27,6 +27,7 @@
 #define slots
 #include <qofono-qt5/qofonomodem.h>
 #include <qofono-qt5/qofonosimmanager.h>
+#include <qofono-qt5/qofonoconnectionmanager.h>
 #undef slots
 
 class QOfonoModem;
@@ -53,7 +54,8 @@ public:
     QOfonoSimWrapper() = delete;
 
 
-    QOfonoSimWrapper(std::shared_ptr<QOfonoSimManager> simmgr);
+    QOfonoSimWrapper(std::shared_ptr<QOfonoSimManager> simmgr,
+                     std::shared_ptr<QOfonoConnectionManager> connmgr);
     ~QOfonoSimWrapper();
 
     QString iccid() const;
@@ -61,6 +63,7 @@ public:
     bool ready() const;
 
     std::shared_ptr<QOfonoSimManager> ofonoSimManager() const;
+    std::shared_ptr<QOfonoConnectionManager> ofonoConnectionManager() const;
 
 
 Q_SIGNALS:
@@ -50,6 +50,7 @@ public:
     QMap<QString, Sim::Ptr> m_knownSims;
 
     shared_ptr<QOfonoManager> m_ofono;
+    OfonoProxyRegistry::Ptr m_proxies;
     QMap<QString, shared_ptr<QOfonoModem>> m_ofonoModems;
     QMap<QString, QOfonoSimWrapper::Ptr> m_wrappers;
 
@@ -81,13 +82,16 @@ public Q_SLOTS:
                 continue;
             }
             auto modem = m_ofonoModems.take(path);
+            // The modem proxy is shared with the rest of the service
+            modem->disconnect(this);
             if (m_wrappers.contains(path))
             {
                 auto wrapper = m_wrappers[path];
                 if (m_knownSims.contains(wrapper->iccid()))
                 {
                     auto sim = m_knownSims[wrapper->iccid()];
-                    sim->setOfonoSimManager(std::shared_ptr<QOfonoSimManager>());
+                    sim->setOfonoSimManager(std::shared_ptr<QOfonoSimManager>(),
+                                            std::shared_ptr<QOfonoConnectionManager>());
                 }
                 m_wrappers.remove(path);
             }
@@ -95,18 +99,17 @@ public Q_SLOTS:
 
         for (const auto& path : toAdd)
         {
-            auto modem = make_shared<QOfonoModem>();
-            modem->setModemPath(path);
-
             if (m_ofonoModems.contains(path))
             {
                 qWarning() << __PRETTY_FUNCTION__ << ": trying to add already existing modem: " << path;
                 continue;
             }
+
+            auto modem = m_proxies->modem(path);
             m_ofonoModems[path] = modem;
 
             connect(modem.get(), &QOfonoModem::interfacesChanged, this, &Private::modemInterfacesChanged);
-            modem->interfacesChanged(modem->interfaces());
+            updateModemInterfaces(modem.get());
         }
     }
 
@@ -118,15 +121,19 @@ public Q_SLOTS:
             return;
         }
 
+        updateModemInterfaces(modem);
+    }
+
+    void updateModemInterfaces(QOfonoModem *modem)
+    {
         QSet<QString> interfaces(modem->interfaces().toSet());
         if (interfaces.contains(OFONO_SIM_MANAGER_INTERFACE))
         {
             if (!m_wrappers.contains(modem->modemPath()))
             {
-                auto simmgr = make_shared<QOfonoSimManager>();
-                simmgr->setModemPath(modem->modemPath());
-
-                auto wrapper = make_shared<wwan::QOfonoSimWrapper>(simmgr);
+                auto wrapper = make_shared<wwan::QOfonoSimWrapper>(
+                        m_proxies->simManager(modem->modemPath()),
+                        m_proxies->connectionManager(modem->modemPath()));
 
                 connect(wrapper.get(), &wwan::QOfonoSimWrapper::presentChanged, this, &Private::ofonoSimPresentChanged);
                 connect(wrapper.get(), &wwan::QOfonoSimWrapper::readyChanged, this, &Private::ofonoSimReady);
@@ -141,7 +148,8 @@ public Q_SLOTS:
                 if (m_knownSims.contains(wrapper->iccid()))
                 {
                     auto sim = m_knownSims[wrapper->iccid()];
-                    sim->setOfonoSimManager(std::shared_ptr<QOfonoSimManager>());
+                    sim->setOfonoSimManager(std::shared_ptr<QOfonoSimManager>(),
+                                            std::shared_ptr<QOfonoConnectionManager>());
                 }
                 m_wrappers.remove(modem->modemPath());
             }
@@ -162,7 +170,8 @@ public Q_SLOTS:
             if (m_knownSims.contains(wrapper->iccid()))
             {
                 auto sim = m_knownSims[wrapper->iccid()];
-                sim->setOfonoSimManager(std::shared_ptr<QOfonoSimManager>());
+                sim->setOfonoSimManager(std::shared_ptr<QOfonoSimManager>(),
+                                        std::shared_ptr<QOfonoConnectionManager>());
             }
         }
     }
@@ -188,7 +197,8 @@ public Q_SLOTS:
             if (wrapper->iccid() == i->iccid())
             {
                 found = true;
-                i->setOfonoSimManager(wrapper->ofonoSimManager());
+                i->setOfonoSimManager(wrapper->ofonoSimManager(),
+                                      wrapper->ofonoConnectionManager());
                 break;
             }
         }
@@ -225,10 +235,13 @@ public Q_SLOTS:
 
 
 
-SimManager::SimManager(shared_ptr<QOfonoManager> ofono, ConnectivityServiceSettings::Ptr settings)
+SimManager::SimManager(shared_ptr<QOfonoManager> ofono,
+                       OfonoProxyRegistry::Ptr proxies,
+                       ConnectivityServiceSettings::Ptr settings)
     : d{new Private(*this)}
 {
     d->m_ofono = ofono;
+    d->m_proxies = proxies;
     d->m_settings = settings;
 
     QStringList iccids = d->m_settings->knownSims();
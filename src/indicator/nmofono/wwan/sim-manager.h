@@ -25,6 +25,7 @@
 #include <memory>
 
 #include "sim.h"
+#include <nmofono/wwan/ofono-proxy-registry.h>
 #include <nmofono/connectivity-service-settings.h>
 
 class QOfonoManager;
@@ -46,7 +47,9 @@ public:
     typedef std::shared_ptr<SimManager> Ptr;
     typedef std::weak_ptr<SimManager> WeakPtr;
 
-    SimManager(std::shared_ptr<QOfonoManager> ofono, ConnectivityServiceSettings::Ptr settings);
+    SimManager(std::shared_ptr<QOfonoManager> ofono,
+               OfonoProxyRegistry::Ptr proxies,
+               ConnectivityServiceSettings::Ptr settings);
     ~SimManager();
 
     QList<Sim::Ptr> knownSims() const;
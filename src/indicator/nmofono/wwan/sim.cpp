@@ -45,7 +45,8 @@ Sim::Ptr Sim::fromQOfonoSimWrapper(const QOfonoSimWrapper *wrapper)
                                 "",
                                 {},
                                 false));
-    sim->setOfonoSimManager(wrapper->ofonoSimManager());
+    sim->setOfonoSimManager(wrapper->ofonoSimManager(),
+                            wrapper->ofonoConnectionManager());
     return sim;
 }
 
@@ -109,6 +110,12 @@ public Q_SLOTS:
             return;
         }
 
+        // The proxy is shared with the modem, so it might outlive our interest in it
+        if (m_simManager)
+        {
+            m_simManager->disconnect(this);
+        }
+
         m_simManager = simmgr;
 
         if (simmgr)
@@ -203,6 +210,11 @@ public Q_SLOTS:
             return;
         }
 
+        if (m_connManager)
+        {
+            m_connManager->disconnect(this);
+        }
+
         m_connManager = connmgr;
         if (m_connManager)
         {
@@ -213,6 +225,13 @@ public Q_SLOTS:
                     &QOfonoConnectionManager::roamingAllowedChanged, this,
                     &Private::update);
 
+            // A shared proxy that has already fetched its properties won't
+            // announce them again, so take its current state now
+            if (m_connManager->isValid())
+            {
+                poweredChanged();
+            }
+
             m_connManager->setPowered(m_mobileDataEnabled);
             m_connManager->setRoamingAllowed(m_dataRoamingEnabled);
         }
@@ -257,14 +276,13 @@ public Q_SLOTS:
         Q_EMIT p.simIdentifierUpdated(m_simIdentifier);
     }
 
-    void setOfono(shared_ptr<QOfonoSimManager> simmgr)
+    void setOfono(shared_ptr<QOfonoSimManager> simmgr,
+                  shared_ptr<QOfonoConnectionManager> connmgr)
     {
         simManagerChanged(simmgr);
         if (simmgr)
         {
-            auto connManager = make_shared<QOfonoConnectionManager>(this);
-            connManager->setModemPath(simmgr->modemPath());
-            setConnManager(connManager);
+            setConnManager(connmgr);
         }
         else
         {
@@ -394,9 +412,10 @@ QString Sim::ofonoPath() const
     return QString();
 }
 
-void Sim::setOfonoSimManager(std::shared_ptr<QOfonoSimManager> simmgr)
+void Sim::setOfonoSimManager(std::shared_ptr<QOfonoSimManager> simmgr,
+                             std::shared_ptr<QOfonoConnectionManager> connmgr)
 {
-    d->setOfono(simmgr);
+    d->setOfono(simmgr, connmgr);
 }
 
 bool Sim::initialDataOn() const
@@ -27,6 +27,7 @@
 #define slots
 #include <qofono-qt5/qofonomodem.h>
 #include <qofono-qt5/qofonosimmanager.h>
+#include <qofono-qt5/qofonoconnectionmanager.h>
 #undef slots
 
 #include <nmofono/wwan/qofono-sim-wrapper.h>
@@ -70,7 +71,8 @@ private:
 
 public:
     ~Sim();
-    void setOfonoSimManager(std::shared_ptr<QOfonoSimManager> simmgr);
+    void setOfonoSimManager(std::shared_ptr<QOfonoSimManager> simmgr,
+                            std::shared_ptr<QOfonoConnectionManager> connmgr);
 
     Q_PROPERTY(QString simIdentifier READ simIdentifier NOTIFY simIdentifierUpdated)
     const QString &simIdentifier() const;
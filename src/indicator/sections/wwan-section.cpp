@@ -59,6 +59,8 @@ public:
     TextItem::Ptr m_openCellularSettings;
 
     QMap<wwan::Modem::Ptr, WwanLinkItem::Ptr> m_items;
+    QMap<int, WwanLinkItem::Ptr> m_sortedItems;
+    bool m_showSimIdentifier = false;
 
     Private() = delete;
     Private(Manager::Ptr modemManager, SwitchItem::Ptr mobileDataSwitch ,SwitchItem::Ptr hotspotSwitch);
@@ -66,6 +68,8 @@ public:
 public Q_SLOTS:
     void modemsChanged();
 
+    void hotspotStoredChanged();
+
     void openCellularSettings()
     {
         UrlDispatcher::send("settings:///system/cellular", [](string url, bool success)
@@ -104,7 +108,7 @@ WwanSection::Private::Private(Manager::Ptr modemManager, SwitchItem::Ptr mobileD
     m_actionGroupMerger->add(m_openCellularSettings->actionGroup());
 
     connect(m_manager.get(), &Manager::linksUpdated, this, &Private::modemsChanged);
-    connect(m_manager.get(), &Manager::hotspotStoredChanged, this, &Private::modemsChanged);
+    connect(m_manager.get(), &Manager::hotspotStoredChanged, this, &Private::hotspotStoredChanged);
     modemsChanged();
 }
 
@@ -120,34 +124,42 @@ WwanSection::Private::modemsChanged()
     auto added(modems);
     added.subtract(current);
 
+    if (removed.isEmpty() && added.isEmpty())
+    {
+        return;
+    }
+
+    bool showSimIdentifier = (modems.size() > 1);
+
     for (auto modem : removed)
     {
-        m_linkMenuMerger->remove(m_items[modem]->menuModel());
-        m_actionGroupMerger->remove(m_items[modem]->actionGroup());
-        m_items.remove(modem);
+        auto item = m_items.take(modem);
+        m_linkMenuMerger->remove(item->menuModel());
+        m_actionGroupMerger->remove(item->actionGroup());
+        m_sortedItems.remove(modem->index());
     }
 
     for (auto modem : added)
     {
         auto item = make_shared<WwanLinkItem>(modem, m_manager);
+        item->showSimIdentifier(showSimIdentifier);
         m_items[modem] = item;
         m_actionGroupMerger->add(item->actionGroup());
-    }
-
-    // for now just throw everything away and rebuild
-    /// @todo add MenuMerger::insert() and ::find()
-    m_linkMenuMerger->clear();
 
-    multimap<int, WwanLinkItem::Ptr, wwan::Modem::Compare> sorted;
-    QMapIterator<wwan::Modem::Ptr, WwanLinkItem::Ptr> it(m_items);
-    while (it.hasNext())
-    {
-        it.next();
-        sorted.insert(make_pair(it.key()->index(), it.value()));
+        // Modem indices are unique, so the position in the sorted map is
+        // the position in the merged menu.
+        auto it = m_sortedItems.insert(modem->index(), item);
+        m_linkMenuMerger->insert(item->menuModel(),
+                                 distance(m_sortedItems.begin(), it));
     }
-    for (auto pair : sorted)
+
+    if (showSimIdentifier != m_showSimIdentifier)
     {
-        m_linkMenuMerger->append(pair.second->menuModel());
+        m_showSimIdentifier = showSimIdentifier;
+        for (auto item : m_items)
+        {
+            item->showSimIdentifier(m_showSimIdentifier);
+        }
     }
 
     if (modems.size() == 0)
@@ -164,36 +176,41 @@ WwanSection::Private::modemsChanged()
             m_upperMenu->insert(m_mobileDataSwitch->menuItem(), m_upperMenu->begin());
         }
 
-        // Add the hotspot button if we have configuration stored
-        if (m_manager->hotspotStored())
-        {
-            // Check if the switch is already present
-            if (m_bottomMenu->find(m_hotspotSwitch->menuItem()) == m_bottomMenu->end())
-            {
-                // If not, add it
-                m_bottomMenu->insert(m_hotspotSwitch->menuItem(), m_bottomMenu->begin());
-            }
-        }
-        else
-        {
-            // Check if the switch is already present
-            if (m_bottomMenu->find(m_hotspotSwitch->menuItem()) == m_bottomMenu->end())
-            {
-                // If so, remove it
-                m_bottomMenu->removeAll(m_hotspotSwitch->menuItem());
-            }
-        }
+        hotspotStoredChanged();
 
         if (m_bottomMenu->find(m_openCellularSettings->menuItem()) == m_bottomMenu->end())
         {
             m_bottomMenu->append(m_openCellularSettings->menuItem());
         }
     }
+}
 
-    bool showSimIdentifier = (m_items.size() > 1);
-    for(auto item: m_items.values())
+void
+WwanSection::Private::hotspotStoredChanged()
+{
+    if (m_items.isEmpty())
     {
-        item->showSimIdentifier(showSimIdentifier);
+        return;
+    }
+
+    // Add the hotspot button if we have configuration stored
+    if (m_manager->hotspotStored())
+    {
+        // Check if the switch is already present
+        if (m_bottomMenu->find(m_hotspotSwitch->menuItem()) == m_bottomMenu->end())
+        {
+            // If not, add it
+            m_bottomMenu->insert(m_hotspotSwitch->menuItem(), m_bottomMenu->begin());
+        }
+    }
+    else
+    {
+        // Check if the switch is already present
+        if (m_bottomMenu->find(m_hotspotSwitch->menuItem()) != m_bottomMenu->end())
+        {
+            // If so, remove it
+            m_bottomMenu->removeAll(m_hotspotSwitch->menuItem());
+        }
     }
 }
 
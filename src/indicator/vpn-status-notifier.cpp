@@ -32,7 +32,7 @@ class VpnStatusNotifier::Priv: public QObject
     Q_OBJECT
 
 public Q_SLOTS:
-    void connectionsChanged(const QSet<ActiveConnection::SPtr>& connections)
+    void connectionsAdded(const QList<ActiveConnection::SPtr>& connections)
     {
         for (const auto& connection: connections)
         {
@@ -81,9 +81,9 @@ VpnStatusNotifier::VpnStatusNotifier(ActiveConnectionManager::SPtr activeConnect
     d->m_activeConnectionManager = activeConnectionManager;
     d->m_notificationManager = notificationManager;
 
-    QObject::connect(activeConnectionManager.get(), &ActiveConnectionManager::connectionsChanged, d.get(), &Priv::connectionsChanged);
+    QObject::connect(activeConnectionManager.get(), &ActiveConnectionManager::connectionsAdded, d.get(), &Priv::connectionsAdded);
 
-    d->connectionsChanged(d->m_activeConnectionManager->connections());
+    d->connectionsAdded(d->m_activeConnectionManager->connections().toList());
 }
 
 VpnStatusNotifier::~VpnStatusNotifier()
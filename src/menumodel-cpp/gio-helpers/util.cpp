@@ -20,15 +20,17 @@
 #include "util.h"
 
 #include <unity/util/ResourcePtr.h>
+#include <util/wakeups.h>
 #include <glib.h>
 
+#include <QString>
+
 using namespace std;
-namespace util = unity::util;
 
 void runGMainloop(guint ms)
 {
     shared_ptr<GMainLoop> loop(g_main_loop_new(nullptr, false), &g_main_loop_unref);
-    util::ResourcePtr<guint, function<void(guint)>> timer(g_timeout_add(ms,
+    unity::util::ResourcePtr<guint, function<void(guint)>> timer(g_timeout_add(ms,
         [](gpointer user_data) -> gboolean
         {
             g_main_loop_quit((GMainLoop *)user_data);
@@ -38,3 +40,23 @@ void runGMainloop(guint ms)
         &g_source_remove);
     g_main_loop_run(loop.get());
 }
+
+GDBusMessage *
+SessionBus::messageFilter(GDBusConnection *,
+                          GDBusMessage *message,
+                          gboolean incoming,
+                          gpointer)
+{
+    if (!incoming)
+        return message;
+
+    // The exported menus and actions handle method calls on the main loop,
+    // which is all GDBus tells us about what woke it
+    if (g_dbus_message_get_message_type(message) == G_DBUS_MESSAGE_TYPE_METHOD_CALL) {
+        util::wakeups::expect(QString("glib %1.%2 %3").arg(
+                QString::fromUtf8(g_dbus_message_get_interface(message)),
+                QString::fromUtf8(g_dbus_message_get_member(message)),
+                QString::fromUtf8(g_dbus_message_get_path(message))));
+    }
+    return message;
+}
@@ -85,6 +85,13 @@ inline int append_item_to_gmenu(GMenu *menu, GMenuItem *item)
 class SessionBus
 {
     std::shared_ptr<GDBusConnection> m_bus;
+    guint m_filterId = 0;
+
+    // Runs on the GDBus worker thread, for each message sent or received
+    static GDBusMessage *messageFilter(GDBusConnection *connection,
+                                       GDBusMessage *message,
+                                       gboolean incoming,
+                                       gpointer user_data);
 
 public:
     typedef std::shared_ptr<SessionBus> Ptr;
@@ -132,6 +139,15 @@ public:
         }
 
         g_dbus_connection_set_exit_on_close(m_bus.get(), FALSE);
+
+        m_filterId = g_dbus_connection_add_filter(m_bus.get(), messageFilter,
+                                                  nullptr, nullptr);
+    }
+
+    ~SessionBus()
+    {
+        if (m_filterId)
+            g_dbus_connection_remove_filter(m_bus.get(), m_filterId);
     }
 
     std::shared_ptr<GDBusConnection> bus() const
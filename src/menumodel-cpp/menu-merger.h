@@ -96,20 +96,29 @@ public:
 
     void append(MenuModel::Ptr menu)
     {
+        insert(menu, m_menus.size());
+    }
+
+    void insert(MenuModel::Ptr menu, std::size_t position)
+    {
+        position = std::min(position, m_menus.size());
+
         // calculate the start position for the items for the new menu
         int start_position;
-        if (m_menus.empty()) {
+        if (position < m_menus.size()) {
+            start_position = m_startPositions[*m_menus[position]];
+        } else if (m_menus.empty()) {
             start_position = 0;
         } else {
             start_position = m_startPositions[*m_menus.back()];
             start_position += g_menu_model_get_n_items(*m_menus.back());
         }
 
-        m_menus.push_back(menu);
+        m_menus.insert(m_menus.begin() + position, menu);
         m_gmodelToMenu[*menu] = menu;
         m_startPositions[*menu] = start_position;
 
-        // add all items
+        // add all items, shifting the menus that follow
         itemsChanged(*menu, 0, 0, g_menu_model_get_n_items(*menu));
         m_handlerId[*menu] = g_signal_connect(menu->operator GMenuModel *(),
                                               "items-changed",
@@ -117,6 +126,21 @@ public:
                                               this);
     }
 
+    std::vector<MenuModel::Ptr>::const_iterator find(MenuModel::Ptr menu) const
+    {
+        return std::find(m_menus.cbegin(), m_menus.cend(), menu);
+    }
+
+    std::vector<MenuModel::Ptr>::const_iterator begin() const
+    {
+        return m_menus.cbegin();
+    }
+
+    std::vector<MenuModel::Ptr>::const_iterator end() const
+    {
+        return m_menus.cend();
+    }
+
     void remove(MenuModel::Ptr menu)
     {
         /// @todo menu might have been added multiple times
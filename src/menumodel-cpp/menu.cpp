@@ -19,6 +19,8 @@
 
 #include "menu.h"
 
+#include <util/trace.h>
+
 Menu::Menu()
 {
     m_gmenu = make_gmenu_ptr();
@@ -157,6 +159,7 @@ void Menu::clear()
 
 void Menu::itemChanged()
 {
+    util::trace::Span span("menu item update", "menu");
     auto item = qobject_cast<MenuItem*>(sender());
 
     int index = 0;
@@ -19,7 +19,12 @@
 
 #include <notification-manager.h>
 #include <NotificationsInterface.h>
+#include <backend-utils.h>
 #include <QDebug>
+#include <QDBusPendingCallWatcher>
+#include <QHash>
+#include <QPointer>
+#include <QQueue>
 
 using namespace std;
 
@@ -32,6 +37,16 @@ public:
     QString m_appName;
 
     shared_ptr<OrgFreedesktopNotificationsInterface> m_notificationInterface;
+
+    // Live notifications by their server id, so each signal only reaches
+    // the notification it is for
+    QHash<uint, Notification*> m_notifications;
+
+    // Notify calls whose notification has gone, waiting for their id
+    int m_pendingCloses = 0;
+
+    // Held back until the pending closes have gone out
+    QQueue<QPair<QPointer<QObject>, function<void()>>> m_heldBack;
 };
 
 NotificationManager::NotificationManager(const QString &appName,
@@ -40,19 +55,46 @@ NotificationManager::NotificationManager(const QString &appName,
 {
     d->m_appName = appName;
     d->m_notificationInterface = make_shared<
-            OrgFreedesktopNotificationsInterface>(DBusTypes::NOTIFY_DBUS_NAME,
+            utils::Instrumented<OrgFreedesktopNotificationsInterface>>(DBusTypes::NOTIFY_DBUS_NAME,
                                                   DBusTypes::NOTIFY_DBUS_PATH,
                                                   sessionConnection);
 
-    d->m_notificationInterface->GetServerInformation();
+    // Starts the notification server, without waiting for it
+    auto watcher = utils::watch(
+            d->m_notificationInterface->GetServerInformation(),
+            "org.freedesktop.Notifications.GetServerInformation", this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [](QDBusPendingCallWatcher* watcher)
+            {
+                watcher->deleteLater();
+                if (watcher->isError())
+                {
+                    qWarning() << "Notification server unavailable:"
+                            << watcher->error().message();
+                }
+            });
 
     connect(d->m_notificationInterface.get(),
             &OrgFreedesktopNotificationsInterface::ActionInvoked, this,
-            &NotificationManager::actionInvoked);
+            [this](uint id, const QString& actionKey)
+            {
+                if (auto notification = d->m_notifications.value(id))
+                {
+                    notification->serverActionInvoked(actionKey);
+                }
+                Q_EMIT actionInvoked(id, actionKey);
+            });
 
     connect(d->m_notificationInterface.get(),
             &OrgFreedesktopNotificationsInterface::NotificationClosed, this,
-            &NotificationManager::notificationClosed);
+            [this](uint id, uint reason)
+            {
+                if (auto notification = d->m_notifications.value(id))
+                {
+                    notification->serverClosed(reason);
+                }
+                Q_EMIT notificationClosed(id, reason);
+            });
 
     connect(d->m_notificationInterface.get(),
             &OrgFreedesktopNotificationsInterface::dataChanged, this,
@@ -70,7 +112,81 @@ NotificationManager::notify(const QString &summary, const QString &body,
 {
     return make_unique<Notification>(d->m_appName, summary, body, icon, actions,
                                      hints, expireTimeout,
-                                     d->m_notificationInterface);
+                                     d->m_notificationInterface, this);
+}
+
+void
+NotificationManager::registerNotification(uint id, Notification* notification)
+{
+    if (id > 0)
+    {
+        d->m_notifications[id] = notification;
+    }
+}
+
+void
+NotificationManager::unregisterNotification(uint id, Notification* notification)
+{
+    auto it = d->m_notifications.find(id);
+    if (it != d->m_notifications.end() && it.value() == notification)
+    {
+        d->m_notifications.erase(it);
+    }
+}
+
+void
+NotificationManager::closeWhenNotified(const QDBusPendingReply<uint>& notify)
+{
+    ++d->m_pendingCloses;
+
+    // Memory is managed by Qt parent ownership
+    auto watcher = new QDBusPendingCallWatcher(notify, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this](QDBusPendingCallWatcher* watcher)
+            {
+                watcher->deleteLater();
+
+                QDBusPendingReply<uint> reply(*watcher);
+                if (reply.isError())
+                {
+                    qCritical() << reply.error().message();
+                }
+                else
+                {
+                    qDebug() << "Closing notification:" << reply.value();
+                    auto closing = utils::watch(
+                            d->m_notificationInterface->CloseNotification(reply.value()),
+                            "org.freedesktop.Notifications.CloseNotification", this);
+                    connect(closing, &QDBusPendingCallWatcher::finished,
+                            closing, &QObject::deleteLater);
+                }
+
+                if (--d->m_pendingCloses > 0)
+                {
+                    return;
+                }
+                while (!d->m_heldBack.isEmpty() && d->m_pendingCloses == 0)
+                {
+                    auto heldBack = d->m_heldBack.dequeue();
+                    if (heldBack.first)
+                    {
+                        heldBack.second();
+                    }
+                }
+            });
+}
+
+void
+NotificationManager::afterPendingCloses(QObject* context, function<void()> send)
+{
+    if (d->m_pendingCloses == 0)
+    {
+        send();
+    }
+    else
+    {
+        d->m_heldBack.enqueue(qMakePair(QPointer<QObject>(context), send));
+    }
 }
 
 }
@@ -19,8 +19,10 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <QDBusConnection>
+#include <QDBusPendingReply>
 #include <QObject>
 #include <QString>
 #include <QStringList>
@@ -60,6 +62,26 @@ Q_SIGNALS:
     void dataChanged(uint id);
 
 protected:
+    friend Notification;
+
+    void registerNotification(uint id, Notification* notification);
+
+    void unregisterNotification(uint id, Notification* notification);
+
+    /**
+     * Closes a notification that has gone away while its Notify call was
+     * still in flight, as soon as the call tells us its id.
+     */
+    void closeWhenNotified(const QDBusPendingReply<uint>& notify);
+
+    /**
+     * Runs send straight away, or once every close handed to
+     * closeWhenNotified() has gone out, so a notification shown after
+     * another has gone away never appears before the old one closes.
+     * Dropped if context is destroyed first.
+     */
+    void afterPendingCloses(QObject* context, std::function<void()> send);
+
     class Priv;
     std::shared_ptr<Priv> d;
 };
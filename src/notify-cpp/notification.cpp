@@ -18,9 +18,13 @@
  */
 
 #include "notification.h"
+#include "notification-manager.h"
 #include <NotificationsInterface.h>
+#include <backend-utils.h>
 
 #include <QDebug>
+#include <QDBusPendingCallWatcher>
+#include <QPointer>
 
 using namespace notify;
 using namespace std;
@@ -48,24 +52,113 @@ public:
 
     shared_ptr<OrgFreedesktopNotificationsInterface> m_notificationsInterface;
 
+    QPointer<NotificationManager> m_notificationManager;
+
     bool m_open = false;
     bool m_dirty = false;
 
-public Q_SLOTS:
-    void notificationClosed(uint id, uint reason)
+    // The Notify call in flight, and what was asked for while waiting on it
+    QDBusPendingReply<uint> m_pendingNotify;
+    bool m_notifyPending = false;
+    bool m_notifySent = false;
+    bool m_showQueued = false;
+    bool m_closeQueued = false;
+
+    void notify()
     {
-        if (id == m_id)
+        m_notifyPending = true;
+        m_notifySent = false;
+        m_dirty = false;
+
+        if (m_notificationManager)
         {
-            m_open = false;
-            Q_EMIT p.closed(reason);
+            m_notificationManager->afterPendingCloses(this, [this]()
+            {
+                sendNotify();
+            });
         }
+        else
+        {
+            sendNotify();
+        }
+    }
+
+    void sendNotify()
+    {
+        m_pendingNotify = m_notificationsInterface->Notify(m_appName, m_id,
+                                                           m_icon, m_summary,
+                                                           m_body, m_actions,
+                                                           m_hints,
+                                                           m_expireTimeout);
+        m_notifySent = true;
+
+        auto watcher = utils::watch(m_pendingNotify, "org.freedesktop.Notifications.Notify", this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &Private::notifyFinished);
     }
 
-    void actionInvoked(uint id, const QString& name)
+    void closeNotification()
+    {
+        auto reply = m_notificationsInterface->CloseNotification(m_id);
+        m_open = false;
+
+        auto watcher = utils::watch(reply, "org.freedesktop.Notifications.CloseNotification", this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &Private::closeFinished);
+    }
+
+    void setId(uint id)
     {
         if (id == m_id)
         {
-            Q_EMIT p.actionInvoked(name);
+            return;
+        }
+
+        if (m_notificationManager)
+        {
+            m_notificationManager->unregisterNotification(m_id, &p);
+            m_notificationManager->registerNotification(id, &p);
+        }
+        m_id = id;
+    }
+
+public Q_SLOTS:
+    void notifyFinished(QDBusPendingCallWatcher* watcher)
+    {
+        watcher->deleteLater();
+        m_notifyPending = false;
+        m_notifySent = false;
+
+        QDBusPendingReply<uint> reply(*watcher);
+        if (reply.isError())
+        {
+            qCritical() << reply.error().message();
+            m_dirty = true;
+        }
+        else
+        {
+            setId(reply);
+            m_open = true;
+        }
+
+        if (m_showQueued)
+        {
+            m_showQueued = false;
+            p.show();
+        }
+        else if (m_closeQueued)
+        {
+            m_closeQueued = false;
+            p.close();
+        }
+    }
+
+    void closeFinished(QDBusPendingCallWatcher* watcher)
+    {
+        watcher->deleteLater();
+
+        QDBusPendingReply<> reply(*watcher);
+        if (reply.isError())
+        {
+            qCritical() << reply.error().message();
         }
     }
 };
@@ -74,7 +167,8 @@ Notification::Notification(
         const QString& appName, const QString &summary, const QString &body,
         const QString &icon, const QStringList &actions,
         const QVariantMap &hints, int expireTimeout,
-        shared_ptr<OrgFreedesktopNotificationsInterface> notificationsInterface)
+        shared_ptr<OrgFreedesktopNotificationsInterface> notificationsInterface,
+        NotificationManager* notificationManager)
 {
     d.reset(new Private(*this));
     d->m_appName = appName;
@@ -85,24 +179,44 @@ Notification::Notification(
     d->m_hints = hints;
     d->m_expireTimeout = expireTimeout;
     d->m_notificationsInterface = notificationsInterface;
-
-    connect(d->m_notificationsInterface.get(), &OrgFreedesktopNotificationsInterface::NotificationClosed, d.get(), &Private::notificationClosed);
-
-    connect(d->m_notificationsInterface.get(), &OrgFreedesktopNotificationsInterface::ActionInvoked, d.get(), &Private::actionInvoked);
+    d->m_notificationManager = notificationManager;
 }
 
 Notification::~Notification()
 {
-    if (d->m_id > 0 && d->m_open && d->m_expireTimeout <= 0)
+    if (d->m_notificationManager)
     {
-        qDebug() << "Closing notification:" << d->m_id;
-        auto reply = d->m_notificationsInterface->CloseNotification(d->m_id);
-        reply.waitForFinished();
-        if (reply.isError())
+        d->m_notificationManager->unregisterNotification(d->m_id, this);
+    }
+
+    if (d->m_notifyPending)
+    {
+        // A Notify that is still held back never goes out. One that is on
+        // its way is closed by the manager once its id arrives, and the
+        // manager holds back anything shown after us until then.
+        if (d->m_notifySent && (d->m_expireTimeout <= 0 || d->m_closeQueued))
         {
-            qCritical() << reply.error().message();
+            if (d->m_notificationManager)
+            {
+                d->m_notificationManager->closeWhenNotified(d->m_pendingNotify);
+            }
+            else
+            {
+                qWarning() << "Notification manager gone, cannot close notification";
+            }
         }
     }
+    else if (d->m_id > 0 && d->m_open && d->m_expireTimeout <= 0)
+    {
+        qDebug() << "Closing notification:" << d->m_id;
+        // We are going away, so the proxy owns the watcher
+        auto closing = utils::watch(
+                d->m_notificationsInterface->CloseNotification(d->m_id),
+                "org.freedesktop.Notifications.CloseNotification",
+                d->m_notificationsInterface.get());
+        QObject::connect(closing, &QDBusPendingCallWatcher::finished,
+                         closing, &QObject::deleteLater);
+    }
 }
 
 QString
@@ -208,45 +322,46 @@ Notification::setIcon(const QString& icon)
     Q_EMIT iconUpdated(d->m_icon);
 }
 
+void
+Notification::serverClosed(uint reason)
+{
+    d->m_open = false;
+    Q_EMIT closed(reason);
+}
+
+void
+Notification::serverActionInvoked(const QString& name)
+{
+    Q_EMIT actionInvoked(name);
+}
+
 void
 Notification::show()
 {
-    if (d->m_dirty || !d->m_open)
+    d->m_closeQueued = false;
+
+    if (d->m_notifyPending)
     {
-        auto reply = d->m_notificationsInterface->Notify(d->m_appName, d->m_id,
-                                                     d->m_icon, d->m_summary,
-                                                     d->m_body, d->m_actions,
-                                                     d->m_hints,
-                                                     d->m_expireTimeout);
-        reply.waitForFinished();
-        if (reply.isError())
-        {
-            qCritical() << reply.error().message();
-        }
-        else
-        {
-            d->m_id = reply;
-            d->m_dirty = false;
-            d->m_open = true;
-        }
+        d->m_showQueued = true;
+    }
+    else if (d->m_dirty || !d->m_open)
+    {
+        d->notify();
     }
 }
 
 void
 Notification::close()
 {
-    if (d->m_id > 0)
+    d->m_showQueued = false;
+
+    if (d->m_notifyPending)
     {
-        auto reply = d->m_notificationsInterface->CloseNotification(d->m_id);
-        reply.waitForFinished();
-        if (reply.isError())
-        {
-            qCritical() << reply.error().message();
-        }
-        else
-        {
-            d->m_open = false;
-        }
+        d->m_closeQueued = true;
+    }
+    else if (d->m_id > 0)
+    {
+        d->closeNotification();
     }
 }
 
@@ -36,6 +36,8 @@ class Notification: public QObject
 {
     Q_OBJECT
 
+    friend NotificationManager;
+
     class Private;
     std::unique_ptr<Private> d;
 
@@ -64,6 +66,11 @@ public:
     Q_PROPERTY(QVariantMap hints READ hints WRITE setHints NOTIFY hintsUpdated)
     QVariantMap hints() const;
 
+    /**
+     * Neither show() nor close() wait for the notification server. Until
+     * the server has handed out the id of the notification, they are
+     * queued, and any number of updates are sent as a single one.
+     */
     void show();
     void close();
 
@@ -95,11 +102,18 @@ Q_SIGNALS:
 
     void actionInvoked(const QString& name);
 
+protected:
+    // Called by the NotificationManager for signals carrying our id
+    void serverClosed(uint reason);
+
+    void serverActionInvoked(const QString& name);
+
 public:
     Notification(const QString& appName,
                  const QString &summary, const QString &body,
                  const QString &icon, const QStringList &actions,
                  const QVariantMap &hints, int expireTimeout,
-                 std::shared_ptr<OrgFreedesktopNotificationsInterface> notificationsInterface);
+                 std::shared_ptr<OrgFreedesktopNotificationsInterface> notificationsInterface,
+                 NotificationManager* notificationManager);
 };
 }
@@ -19,15 +19,101 @@
 
 #pragma once
 
+#include <util/dbus-utils.h>
+#include <util/trace.h>
+#include <util/wakeups.h>
+
+#include <QDBusAbstractInterface>
+#include <QDBusPendingCallWatcher>
 #include <QDBusPendingReply>
 
 namespace utils
 {
 
+/**
+ * Blocks until the call has finished, recording the time spent waiting as
+ * a span named after the call, and in the call statistics. The name must
+ * be a string literal of the interface and member, such as
+ * "org.freedesktop.NetworkManager.Settings.AddConnection".
+ */
+inline void waitForFinished(QDBusPendingCall& pendingCall, const char* name)
+{
+    auto start = util::trace::now();
+    pendingCall.waitForFinished();
+    auto duration = util::trace::now() - start;
+
+    util::trace::record(name, "dbus", start, duration);
+    DBusUtils::recordCall(name, DBusUtils::CallKind::sync, duration);
+}
+
+/**
+ * Watches a call made without waiting for it, recording how long the reply
+ * took to arrive in the call statistics. Named as for waitForFinished().
+ */
+inline QDBusPendingCallWatcher* watch(const QDBusPendingCall& pendingCall,
+                                      const char* name, QObject* parent)
+{
+    auto start = util::trace::now();
+    auto watcher = new QDBusPendingCallWatcher(pendingCall, parent);
+    QObject::connect(watcher, &QDBusPendingCallWatcher::finished, [name, start]()
+    {
+        DBusUtils::recordCall(name, DBusUtils::CallKind::async,
+                              util::trace::now() - start);
+    });
+    return watcher;
+}
+
+/**
+ * A generated proxy that adds its property reads and writes to the call
+ * statistics. Each of them is a blocking call to
+ * org.freedesktop.DBus.Properties.
+ *
+ * D-Bus signals arriving at the proxy claim the main loop wakeup they are
+ * delivered in.
+ */
+template<typename Proxy>
+class Instrumented: public Proxy
+{
+public:
+    using Proxy::Proxy;
+
+    int qt_metacall(QMetaObject::Call call, int id, void** arguments) override
+    {
+        // QtDBus delivers signals by invoking the proxy's own signal
+        if (call == QMetaObject::InvokeMetaMethod
+                && id >= Proxy::staticMetaObject.methodOffset()
+                && util::wakeups::unclaimed())
+        {
+            auto method = Proxy::staticMetaObject.method(id);
+            if (method.methodType() == QMetaMethod::Signal)
+            {
+                util::wakeups::claim(QString("signal %1.%2 %3").arg(
+                        QString::fromLatin1(Proxy::staticInterfaceName()),
+                        QString::fromLatin1(method.name()),
+                        this->QDBusAbstractInterface::path()));
+            }
+        }
+
+        if ((call != QMetaObject::ReadProperty && call != QMetaObject::WriteProperty)
+                || id < Proxy::staticMetaObject.propertyOffset())
+        {
+            return Proxy::qt_metacall(call, id, arguments);
+        }
+
+        auto start = util::trace::now();
+        int result = Proxy::qt_metacall(call, id, arguments);
+        // Some proxies have an "Interface" property that hides interface()
+        DBusUtils::recordCall(QString::fromLatin1(Proxy::staticInterfaceName()),
+                              QString::fromLatin1(Proxy::staticMetaObject.property(id).name()),
+                              DBusUtils::CallKind::sync, util::trace::now() - start);
+        return result;
+    }
+};
+
 template <typename T>
-T getOrThrow(QDBusPendingReply<T> const& pendingReply)
+T getOrThrow(QDBusPendingReply<T> const& pendingReply, const char* name)
 {
-    const_cast<QDBusPendingReply<T>&>(pendingReply).waitForFinished();
+    waitForFinished(const_cast<QDBusPendingReply<T>&>(pendingReply), name);
     if (pendingReply.isError())
     {
         auto errorMessage = pendingReply.error().name() + ": " + pendingReply.error().message();
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <QDBusMetaType>
+#include <QDBusObjectPath>
 #include <QtCore>
 #include <QString>
 #include <QVariantMap>
@@ -29,15 +30,20 @@ Q_DECLARE_METATYPE(QVariantDictMap)
 typedef QMap<QString, QString> QStringMap;
 Q_DECLARE_METATYPE(QStringMap)
 
+typedef QMap<QDBusObjectPath, QVariantDictMap> QManagedObjectMap;
+Q_DECLARE_METATYPE(QManagedObjectMap)
+
 namespace DBusTypes
 {
     inline void registerMetaTypes()
     {
         qRegisterMetaType<QVariantDictMap>("QVariantDictMap");
         qRegisterMetaType<QStringMap>("QStringMap");
+        qRegisterMetaType<QManagedObjectMap>("QManagedObjectMap");
 
         qDBusRegisterMetaType<QVariantDictMap>();
         qDBusRegisterMetaType<QStringMap>();
+        qDBusRegisterMetaType<QManagedObjectMap>();
     }
 
     inline QString vpnConnectionPath()
@@ -80,10 +86,16 @@ namespace DBusTypes
 
     static constexpr char const* PRIVATE_INTERFACE = "com.ubuntu.connectivity1.Private";
 
+    static constexpr char const* DIAGNOSTICS_INTERFACE = "com.ubuntu.connectivity1.Diagnostics";
+
     static constexpr char const* SERVICE_PATH = "/com/ubuntu/connectivity1/NetworkingStatus";
 
     static constexpr char const* PRIVATE_PATH = "/com/ubuntu/connectivity1/Private";
 
+    static constexpr char const* OBJECT_MANAGER_PATH = "/com/ubuntu/connectivity1";
+
+    static constexpr char const* DIAGNOSTICS_PATH = "/com/ubuntu/connectivity1/Diagnostics";
+
     static constexpr char const* URFKILL_BUS_NAME = "org.freedesktop.URfkill";
 
     static constexpr char const* URFKILL_OBJ_PATH = "/org/freedesktop/URfkill";
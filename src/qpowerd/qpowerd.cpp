@@ -20,39 +20,125 @@
 #include <qpowerd/qpowerd.h>
 #include <dbus-types.h>
 #include <PowerdInterface.h>
+#include <backend-utils.h>
+
+#include <QDBusPendingCallWatcher>
+#include <QMap>
 
 using namespace std;
 
 class QPowerd::Priv
 {
 public:
+    // All the requests for one state share a single powerd cookie
+    struct SysStateLock
+    {
+        int m_refCount = 0;
+
+        bool m_pending = false;
+
+        QString m_cookie;
+    };
+
     shared_ptr<ComCanonicalPowerdInterface> m_powerd;
+
+    QMap<SysPowerState, SysStateLock> m_locks;
+
+    void acquire(const QString& name, SysPowerState state)
+    {
+        auto& lock = m_locks[state];
+        ++lock.m_refCount;
+        // Holding the cookie or waiting for it. After a failed request we
+        // have neither, so the next acquire asks powerd again.
+        if (lock.m_pending || !lock.m_cookie.isEmpty())
+        {
+            return;
+        }
+
+        // The watchers belong to the interface, which we own, so they never
+        // outlive us
+        lock.m_pending = true;
+        auto watcher = utils::watch(
+                m_powerd->requestSysState(name, static_cast<int>(state)),
+                "com.canonical.powerd.requestSysState", m_powerd.get());
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished,
+                         [this, state](QDBusPendingCallWatcher* watcher)
+        {
+            watcher->deleteLater();
+            QDBusPendingReply<QString> reply(*watcher);
+
+            auto& lock = m_locks[state];
+            lock.m_pending = false;
+            if (reply.isError())
+            {
+                qWarning() << reply.error().message();
+                return;
+            }
+
+            lock.m_cookie = reply;
+            // Everyone let go while we were waiting for the cookie
+            if (lock.m_refCount == 0)
+            {
+                clear(lock);
+            }
+        });
+    }
+
+    void release(SysPowerState state)
+    {
+        auto& lock = m_locks[state];
+        if (--lock.m_refCount == 0 && !lock.m_pending)
+        {
+            clear(lock);
+        }
+    }
+
+    void clear(SysStateLock& lock)
+    {
+        if (lock.m_cookie.isEmpty())
+        {
+            return;
+        }
+
+        auto watcher = utils::watch(
+                m_powerd->clearSysState(lock.m_cookie),
+                "com.canonical.powerd.clearSysState", m_powerd.get());
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished,
+                         [](QDBusPendingCallWatcher* watcher)
+        {
+            watcher->deleteLater();
+            if (watcher->isError())
+            {
+                qWarning() << watcher->error().message();
+            }
+        });
+        lock.m_cookie.clear();
+    }
 };
 
 class QPowerd::QSysStateRequest
 {
 public:
-    QSysStateRequest(QPowerd& parent, const QString& cookie)
-            : m_parent(parent), m_cookie(cookie)
+    QSysStateRequest(shared_ptr<QPowerd::Priv> parent, SysPowerState state)
+            : m_parent(parent), m_state(state)
     {
-
     }
 
     ~QSysStateRequest()
     {
-        m_parent.d->m_powerd->clearSysState(m_cookie);
+        m_parent->release(m_state);
     }
 
 protected:
-    QPowerd m_parent;
+    shared_ptr<QPowerd::Priv> m_parent;
 
-    QString m_cookie;
+    SysPowerState m_state;
 };
 
 QPowerd::QPowerd(const QDBusConnection& connection) :
         d(new Priv)
 {
-    d->m_powerd = make_shared<ComCanonicalPowerdInterface>(
+    d->m_powerd = make_shared<utils::Instrumented<ComCanonicalPowerdInterface>>(
                 DBusTypes::POWERD_DBUS_NAME, DBusTypes::POWERD_DBUS_PATH,
                 connection);
 }
@@ -63,17 +149,6 @@ QPowerd::~QPowerd()
 
 QPowerd::RequestSPtr QPowerd::requestSysState(const QString& name, SysPowerState state)
 {
-    auto reply = d->m_powerd->requestSysState(name, static_cast<int>(state));
-    QString cookie;
-    reply.waitForFinished();
-    if (reply.isError())
-    {
-        qWarning() << reply.error().message();
-    }
-    else
-    {
-        cookie = reply;
-    }
-    return make_shared<QSysStateRequest>(*this, cookie);
+    d->acquire(name, state);
+    return make_shared<QSysStateRequest>(d, state);
 }
-
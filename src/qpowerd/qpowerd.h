@@ -46,6 +46,12 @@ public:
 
     ~QPowerd();
 
+    /**
+     * Holds the system in the given state for as long as the returned
+     * request lives. Doesn't wait for powerd, the state is taken once powerd
+     * replies. Requests for the same state share one powerd cookie, which
+     * is cleared when the last of them goes away.
+     */
     RequestSPtr requestSysState(const QString &name, SysPowerState state);
 
 protected:
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <status-snapshot/reader.h>
+#include <status-snapshot/region.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace status_snapshot
+{
+
+using namespace internal;
+
+namespace
+{
+
+// An update is a handful of stores, so a writer that stays in the middle of
+// one for this long has most likely died there
+static constexpr int MAX_ATTEMPTS = 10000;
+
+}
+
+Reader::Reader(const string& path) :
+        m_path(path)
+{
+}
+
+Reader::~Reader()
+{
+    unmap();
+}
+
+bool Reader::map()
+{
+    unmap();
+
+    int fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= off_t(sizeof(Region)))
+    {
+        mapped = mmap(nullptr, sizeof(Region), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+
+    auto region = static_cast<const Region*>(mapped);
+    if (region->magic != Region::MAGIC || region->version != Region::VERSION)
+    {
+        munmap(mapped, sizeof(Region));
+        return false;
+    }
+
+    m_region = region;
+    return true;
+}
+
+void Reader::unmap()
+{
+    if (m_region)
+    {
+        munmap(const_cast<Region*>(m_region), sizeof(Region));
+        m_region = nullptr;
+    }
+}
+
+bool Reader::read(Status& status)
+{
+    if (!m_region || m_region->retired.load(memory_order_acquire))
+    {
+        if (!map())
+        {
+            return false;
+        }
+    }
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt)
+    {
+        auto before = m_region->sequence.load(memory_order_acquire);
+        if (before & 1)
+        {
+            continue;
+        }
+
+        auto connectivity = m_region->connectivity.load(memory_order_relaxed);
+        auto flags = m_region->flags.load(memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (m_region->sequence.load(memory_order_relaxed) == before)
+        {
+            status = fromFields(connectivity, flags);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
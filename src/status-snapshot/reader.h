@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <status-snapshot/status-snapshot.h>
+
+#include <memory>
+#include <string>
+
+namespace status_snapshot
+{
+namespace internal
+{
+struct Region;
+}
+
+/**
+ * Reads the status snapshot published by the connectivity service.
+ *
+ * Once the file is mapped, read() makes no system calls. The file is
+ * mapped on the first read, and again if its writer has gone away.
+ *
+ * A reader must only be used from one thread at a time.
+ */
+class Reader
+{
+public:
+    typedef std::unique_ptr<Reader> UPtr;
+
+    explicit Reader(const std::string& path = defaultPath());
+
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+
+    Reader& operator=(const Reader&) = delete;
+
+    /**
+     * Copies a consistent snapshot into status. Returns false if nothing is
+     * being published, or if the writer stayed in the middle of an update
+     * for too long.
+     */
+    bool read(Status& status);
+
+protected:
+    bool map();
+
+    void unmap();
+
+    std::string m_path;
+
+    const internal::Region* m_region = nullptr;
+};
+
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <status-snapshot/status-snapshot.h>
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace status_snapshot
+{
+namespace internal
+{
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+              "The shared region needs address-free atomics");
+
+/**
+ * Layout of the mapped file, shared between one writer and any number of
+ * readers in other processes.
+ *
+ * The payload is guarded by a seqlock: the writer makes the sequence odd,
+ * updates the payload and makes it even again. A reader that saw the same
+ * even sequence before and after copying the payload has a consistent copy.
+ *
+ * A writer that goes away sets retired, telling readers to map the file
+ * again the next time they read.
+ */
+struct Region
+{
+    static constexpr std::uint32_t MAGIC = 0x534e4e49; // "INNS"
+
+    static constexpr std::uint32_t VERSION = 1;
+
+    static constexpr std::uint32_t BANDWIDTH_LIMITED = 1 << 0;
+
+    static constexpr std::uint32_t FLIGHT_MODE = 1 << 1;
+
+    static constexpr std::uint32_t WIFI_ENABLED = 1 << 2;
+
+    static constexpr std::uint32_t MODEM_AVAILABLE = 1 << 3;
+
+    static constexpr std::uint32_t HOTSPOT_ENABLED = 1 << 4;
+
+    std::uint32_t magic;
+
+    std::uint32_t version;
+
+    std::atomic<std::uint32_t> retired;
+
+    std::uint32_t reserved;
+
+    std::atomic<std::uint64_t> sequence;
+
+    // Payload, only accessed under the seqlock
+
+    std::atomic<std::uint32_t> connectivity;
+
+    std::atomic<std::uint32_t> flags;
+};
+
+static_assert(std::is_standard_layout<Region>::value, "Region must have a fixed layout");
+
+inline std::uint32_t toFlags(const Status& status)
+{
+    return (status.bandwidthLimited ? Region::BANDWIDTH_LIMITED : 0u)
+            | (status.flightMode ? Region::FLIGHT_MODE : 0u)
+            | (status.wifiEnabled ? Region::WIFI_ENABLED : 0u)
+            | (status.modemAvailable ? Region::MODEM_AVAILABLE : 0u)
+            | (status.hotspotEnabled ? Region::HOTSPOT_ENABLED : 0u);
+}
+
+inline Status fromFields(std::uint32_t connectivity, std::uint32_t flags)
+{
+    Status status;
+    status.connectivity = static_cast<Connectivity>(connectivity);
+    status.bandwidthLimited = flags & Region::BANDWIDTH_LIMITED;
+    status.flightMode = flags & Region::FLIGHT_MODE;
+    status.wifiEnabled = flags & Region::WIFI_ENABLED;
+    status.modemAvailable = flags & Region::MODEM_AVAILABLE;
+    status.hotspotEnabled = flags & Region::HOTSPOT_ENABLED;
+    return status;
+}
+
+}
+}
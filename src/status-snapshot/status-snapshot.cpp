@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <status-snapshot/status-snapshot.h>
+
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace std;
+
+namespace status_snapshot
+{
+
+bool operator==(const Status& a, const Status& b)
+{
+    return a.connectivity == b.connectivity
+            && a.bandwidthLimited == b.bandwidthLimited
+            && a.flightMode == b.flightMode
+            && a.wifiEnabled == b.wifiEnabled
+            && a.modemAvailable == b.modemAvailable
+            && a.hotspotEnabled == b.hotspotEnabled;
+}
+
+bool operator!=(const Status& a, const Status& b)
+{
+    return !(a == b);
+}
+
+string defaultPath()
+{
+    if (const char* path = getenv("INDICATOR_NETWORK_STATUS_SNAPSHOT_PATH"))
+    {
+        // For testing only
+        return path;
+    }
+
+    string runtimeDir;
+    if (const char* dir = getenv("XDG_RUNTIME_DIR"))
+    {
+        runtimeDir = dir;
+    }
+    else
+    {
+        runtimeDir = "/run/user/" + to_string(getuid());
+    }
+    return runtimeDir + "/indicator-network/status";
+}
+
+}
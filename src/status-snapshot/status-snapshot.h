@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace status_snapshot
+{
+
+enum class Connectivity : std::uint32_t
+{
+    offline = 0,
+    connecting,
+    online
+};
+
+/**
+ * The core com.ubuntu.connectivity1.NetworkingStatus fields, as published
+ * by the connectivity service for local readers.
+ */
+struct Status
+{
+    Connectivity connectivity = Connectivity::offline;
+
+    bool bandwidthLimited = false;
+
+    bool flightMode = false;
+
+    bool wifiEnabled = false;
+
+    bool modemAvailable = false;
+
+    bool hotspotEnabled = false;
+};
+
+bool operator==(const Status& a, const Status& b);
+
+bool operator!=(const Status& a, const Status& b);
+
+/**
+ * The file the connectivity service publishes its snapshot to, which is
+ * $XDG_RUNTIME_DIR/indicator-network/status unless overridden with
+ * $INDICATOR_NETWORK_STATUS_SNAPSHOT_PATH.
+ */
+std::string defaultPath();
+
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <status-snapshot/writer.h>
+#include <status-snapshot/region.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace status_snapshot
+{
+
+using namespace internal;
+
+namespace
+{
+
+[[noreturn]] void throwErrno(const string& what)
+{
+    throw system_error(errno, generic_category(), what);
+}
+
+void retire(const string& path)
+{
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= off_t(sizeof(Region)))
+    {
+        void* mapped = mmap(nullptr, sizeof(Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            static_cast<Region*>(mapped)->retired.store(1, memory_order_release);
+            munmap(mapped, sizeof(Region));
+        }
+    }
+    ::close(fd);
+}
+
+}
+
+Writer::Writer(const string& path) :
+        m_path(path)
+{
+    auto slash = m_path.rfind('/');
+    if (slash != string::npos && slash > 0)
+    {
+        auto dir = m_path.substr(0, slash);
+        if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST)
+        {
+            throwErrno("Unable to create " + dir);
+        }
+    }
+
+    // Readers still holding a region from a previous writer (which might
+    // have crashed before retiring it) need to move on to ours
+    retire(m_path);
+
+    string tmp = m_path + ".XXXXXX";
+    int fd = mkostemp(&tmp[0], O_CLOEXEC);
+    if (fd < 0)
+    {
+        throwErrno("Unable to create " + tmp);
+    }
+
+    if (fchmod(fd, 0644) != 0 || ftruncate(fd, sizeof(Region)) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        unlink(tmp.c_str());
+        errno = error;
+        throwErrno("Unable to size " + tmp);
+    }
+
+    void* mapped = mmap(nullptr, sizeof(Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        int error = errno;
+        unlink(tmp.c_str());
+        errno = error;
+        throwErrno("Unable to map " + tmp);
+    }
+
+    // The file starts out zero-filled, so only the header needs writing
+    m_region = static_cast<Region*>(mapped);
+    m_region->magic = Region::MAGIC;
+    m_region->version = Region::VERSION;
+
+    // Only make the file visible once it is complete
+    if (rename(tmp.c_str(), m_path.c_str()) != 0)
+    {
+        int error = errno;
+        munmap(m_region, sizeof(Region));
+        m_region = nullptr;
+        unlink(tmp.c_str());
+        errno = error;
+        throwErrno("Unable to publish " + m_path);
+    }
+}
+
+Writer::~Writer()
+{
+    if (m_region)
+    {
+        unlink(m_path.c_str());
+        m_region->retired.store(1, memory_order_release);
+        munmap(m_region, sizeof(Region));
+    }
+}
+
+void Writer::publish(const Status& status)
+{
+    auto sequence = m_region->sequence.load(memory_order_relaxed);
+
+    m_region->sequence.store(sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    m_region->connectivity.store(static_cast<uint32_t>(status.connectivity), memory_order_relaxed);
+    m_region->flags.store(toFlags(status), memory_order_relaxed);
+
+    m_region->sequence.store(sequence + 2, memory_order_release);
+}
+
+const string& Writer::path() const
+{
+    return m_path;
+}
+
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <status-snapshot/status-snapshot.h>
+
+#include <memory>
+#include <string>
+
+namespace status_snapshot
+{
+namespace internal
+{
+struct Region;
+}
+
+/**
+ * Publishes the status snapshot. There must only be one writer per file.
+ *
+ * Construction replaces any existing file atomically, after telling the
+ * readers of the old one to move over. Throws std::system_error if the
+ * file cannot be created.
+ */
+class Writer
+{
+public:
+    typedef std::unique_ptr<Writer> UPtr;
+
+    explicit Writer(const std::string& path = defaultPath());
+
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+
+    Writer& operator=(const Writer&) = delete;
+
+    void publish(const Status& status);
+
+    const std::string& path() const;
+
+protected:
+    std::string m_path;
+
+    internal::Region* m_region = nullptr;
+};
+
+}
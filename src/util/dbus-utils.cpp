@@ -17,92 +17,319 @@
  */
 
 #include <util/dbus-utils.h>
+#include <util/trace.h>
 
-#include <QDBusConnection>
 #include <QDBusMessage>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QStringList>
 #include <QTimer>
-#include <QVariantMap>
+#include <QVector>
+
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 namespace DBusUtils
 {
 
-namespace
+/**
+ * All change sets with a signal waiting, and the one timer that wakes up
+ * for whichever of them is due first.
+ */
+class PendingPropertyChanges
 {
-typedef QPair<QString, QString> QStringPair;
-typedef QPair<QDBusConnection, QVariantMap> ConnectionValues;
-typedef QMap<QStringPair, ConnectionValues> PropertyChangeQueue;
+public:
+    static PendingPropertyChanges& instance()
+    {
+        static PendingPropertyChanges pending;
+        return pending;
+    }
+
+    std::shared_ptr<Coalescing> coalescing(const QString& interface)
+    {
+        auto& coalescing = m_coalescing[interface];
+        if (!coalescing)
+        {
+            coalescing = std::make_shared<Coalescing>();
+        }
+        return coalescing;
+    }
+
+    QHash<QString, std::shared_ptr<Coalescing>> allCoalescing() const
+    {
+        return m_coalescing;
+    }
+
+    qint64 now() const
+    {
+        return m_clock.elapsed();
+    }
+
+    void add(PropertyChangeSet* changeSet)
+    {
+        m_pending.append(changeSet);
+    }
+
+    void remove(PropertyChangeSet* changeSet)
+    {
+        m_pending.removeOne(changeSet);
+    }
+
+    void schedule()
+    {
+        if (m_pending.isEmpty())
+        {
+            m_timer.stop();
+            return;
+        }
+
+        qint64 deadline = std::numeric_limits<qint64>::max();
+        for (auto changeSet: m_pending)
+        {
+            deadline = std::min(deadline, changeSet->m_deadline);
+        }
+
+        int interval = int(std::max<qint64>(0, deadline - now()));
+        if (!m_timer.isActive() || m_timer.remainingTime() > interval)
+        {
+            m_timer.start(interval);
+        }
+    }
 
-static std::shared_ptr<QTimer> propertyChangeTimer;
+    void flushDue()
+    {
+        util::trace::Span span("property flush", "dbus");
+        auto time = now();
+
+        QVector<PropertyChangeSet*> due;
+        for (auto it = m_pending.begin(); it != m_pending.end();)
+        {
+            if ((*it)->m_deadline <= time)
+            {
+                due.append(*it);
+                it = m_pending.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        for (auto changeSet: due)
+        {
+            changeSet->flush();
+        }
+
+        schedule();
+    }
+
+    void flushAll()
+    {
+        util::trace::Span span("property flush", "dbus");
+        m_timer.stop();
+
+        QVector<PropertyChangeSet*> pending;
+        pending.swap(m_pending);
+
+        for (auto changeSet: pending)
+        {
+            changeSet->flush();
+        }
+    }
+
+protected:
+    PendingPropertyChanges()
+    {
+        m_clock.start();
+        m_timer.setObjectName("property change coalescing");
+        m_timer.setSingleShot(true);
+        m_timer.setTimerType(Qt::CoarseTimer);
+        QObject::connect(&m_timer, &QTimer::timeout, [this]()
+        {
+            flushDue();
+        });
+    }
 
-static PropertyChangeQueue propertyChangeQueue;
+    QElapsedTimer m_clock;
+
+    QTimer m_timer;
+
+    QVector<PropertyChangeSet*> m_pending;
+
+    QHash<QString, std::shared_ptr<Coalescing>> m_coalescing;
+};
+
+void setCoalescingPolicy(const QString& interface, const CoalescingPolicy& policy)
+{
+    PendingPropertyChanges::instance().coalescing(interface)->policy = policy;
 }
 
-void flushPropertyChanges()
+CoalescingStatistics coalescingStatistics(const QString& interface)
 {
-    if (!propertyChangeTimer)
+    return PendingPropertyChanges::instance().coalescing(interface)->statistics;
+}
+
+QList<QPair<QString, Coalescing>> coalescingStatistics()
+{
+    QList<QPair<QString, Coalescing>> result;
+    auto coalescing = PendingPropertyChanges::instance().allCoalescing();
+    for (auto it = coalescing.cbegin(); it != coalescing.cend(); ++it)
     {
-        return;
+        result << qMakePair(it.key(), *it.value());
     }
+    return result;
+}
+
+void flushPropertyChanges()
+{
+    PendingPropertyChanges::instance().flushAll();
+}
+
+static uint qHash(CallKind kind, uint seed = 0)
+{
+    return ::qHash(static_cast<int>(kind), seed);
+}
+
+namespace
+{
+
+typedef QPair<QPair<QString, QString>, CallKind> CallId;
+
+QHash<CallId, CallStatistics>& calls()
+{
+    static QHash<CallId, CallStatistics> calls;
+    return calls;
+}
 
-    if (propertyChangeTimer->isActive())
+}
+
+void recordCall(const QString& interface, const QString& member,
+                CallKind kind, qint64 nanoseconds)
+{
+    auto& statistics = calls()[qMakePair(qMakePair(interface, member), kind)];
+    quint64 microseconds = std::max<qint64>(0, nanoseconds / 1000);
+
+    int bucket = 0;
+    while (bucket < CallStatistics::BUCKETS - 1 && (microseconds >> bucket))
     {
-        propertyChangeTimer->stop();
+        ++bucket;
     }
 
-    QMapIterator<QStringPair, ConnectionValues> it(propertyChangeQueue);
-    while (it.hasNext())
+    ++statistics.calls;
+    statistics.totalMicroseconds += microseconds;
+    statistics.maxMicroseconds = std::max(statistics.maxMicroseconds, microseconds);
+    ++statistics.buckets[bucket];
+}
+
+void recordCall(const char* name, CallKind kind, qint64 nanoseconds)
+{
+    QString qualified = QString::fromLatin1(name);
+    int dot = qualified.lastIndexOf('.');
+    recordCall(qualified.left(dot), qualified.mid(dot + 1), kind, nanoseconds);
+}
+
+QList<QPair<CallKey, CallStatistics>> callStatistics()
+{
+    QList<QPair<CallKey, CallStatistics>> result;
+    for (auto it = calls().cbegin(); it != calls().cend(); ++it)
     {
-        it.next();
+        const auto& id = it.key();
+        result.append(qMakePair(CallKey{id.first.first, id.first.second, id.second}, it.value()));
+    }
+    return result;
+}
 
-        QDBusMessage signal = QDBusMessage::createSignal(
-              it.key().first, // Path
-              "org.freedesktop.DBus.Properties",
-              "PropertiesChanged");
+void resetCallStatistics()
+{
+    calls().clear();
+}
 
-        // Interface
-        signal << it.key().second;
-        // Changed properties (name, value)
-        signal << it.value().second;
-        signal << QStringList();
-        // Connection
-        it.value().first.send(signal);
+PropertyChangeSet::PropertyChangeSet(const QDBusConnection& connection,
+                                     const QString& path,
+                                     const QString& interface) :
+        m_connection(connection),
+        m_path(path),
+        m_interface(interface),
+        m_coalescing(PendingPropertyChanges::instance().coalescing(interface))
+{
+}
+
+PropertyChangeSet::~PropertyChangeSet()
+{
+    if (m_changed)
+    {
+        PendingPropertyChanges::instance().remove(this);
     }
+}
 
-    propertyChangeQueue.clear();
+const QString& PropertyChangeSet::interface() const
+{
+    return m_interface;
 }
 
-void notifyPropertyChanged(
-        const QDBusConnection& connection,
-        const QObject& o,
-        const QString& path,
-        const QString& interface,
-        const QStringList& propertyNames)
+void PropertyChangeSet::markChanged(quint64 bits)
 {
-    if (!propertyChangeTimer)
+    if (!bits)
     {
-        propertyChangeTimer = std::make_shared<QTimer>();
-        propertyChangeTimer->setInterval(0);
-        propertyChangeTimer->setSingleShot(true);
-        propertyChangeTimer->setTimerType(Qt::CoarseTimer);
+        return;
+    }
+
+    auto& pending = PendingPropertyChanges::instance();
+    const auto& policy = m_coalescing->policy;
+    auto time = pending.now();
 
-        QObject::connect(propertyChangeTimer.get(), &QTimer::timeout, &flushPropertyChanges);
+    bool first = !m_changed;
+    if (first)
+    {
+        m_firstChange = time;
+        pending.add(this);
+    }
+    else
+    {
+        ++m_coalescing->statistics.suppressed;
+    }
+    m_changed |= bits;
+
+    qint64 deadline = time;
+    if (!(bits & policy.bypass))
+    {
+        // Wait for the burst to end, but no longer than the maximum latency
+        deadline = std::min(time + policy.window,
+                            m_firstChange + std::max(policy.window, policy.maxLatency));
     }
 
-    QStringPair key(path, interface);
-    auto it = propertyChangeQueue.find(key);
-    if (it == propertyChangeQueue.end())
+    // Anything already due stays due
+    if (first || m_deadline > time)
     {
-        it = propertyChangeQueue.insert(key, ConnectionValues(connection, QVariantMap()));
+        m_deadline = deadline;
     }
 
-    for (const auto& propertyName: propertyNames)
+    pending.schedule();
+}
+
+void PropertyChangeSet::flush()
+{
+    if (!m_changed)
     {
-        it->second.insert(propertyName, o.property(qPrintable(propertyName)));
+        return;
     }
 
-    propertyChangeTimer->start();
+    quint64 changed = m_changed;
+    m_changed = 0;
+
+    QDBusMessage signal = QDBusMessage::createSignal(
+          m_path,
+          "org.freedesktop.DBus.Properties",
+          "PropertiesChanged");
+
+    signal << m_interface;
+    // Changed properties (name, value)
+    signal << changedProperties(changed);
+    signal << QStringList();
+    m_connection.send(signal);
+
+    ++m_coalescing->statistics.emitted;
 }
 
 }
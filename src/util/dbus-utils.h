@@ -19,16 +19,284 @@
 #pragma once
 
 #include <QDBusConnection>
-#include <QObject>
-#include <QStringList>
+#include <QList>
+#include <QMetaClassInfo>
+#include <QMetaObject>
+#include <QPair>
+#include <QString>
+#include <QVariantMap>
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <utility>
 
 namespace DBusUtils
 {
 
-void notifyPropertyChanged(const QDBusConnection& connection, const QObject& o,
-                           const QString& path, const QString& interface,
-                           const QStringList& propertyNames);
+/**
+ * How long PropertiesChanged signals for one D-Bus interface may be held
+ * back, so that a burst of changes goes out as a single signal.
+ *
+ * A change waits until no further change has arrived for window
+ * milliseconds, but never longer than maxLatency milliseconds after the
+ * first change it was merged with. Changes to any property in the bypass
+ * mask are sent on the next main loop turn, along with whatever else is
+ * already waiting for the same object.
+ *
+ * The default policy sends every change on the next main loop turn.
+ */
+struct CoalescingPolicy
+{
+    int window = 0;
+
+    int maxLatency = 0;
+
+    quint64 bypass = 0;
+};
+
+struct CoalescingStatistics
+{
+    // PropertiesChanged signals sent
+    quint64 emitted = 0;
+
+    // Changes merged into a signal that was already waiting
+    quint64 suppressed = 0;
+};
+
+void setCoalescingPolicy(const QString& interface, const CoalescingPolicy& policy);
+
+CoalescingStatistics coalescingStatistics(const QString& interface);
+
+struct Coalescing
+{
+    CoalescingPolicy policy;
+
+    CoalescingStatistics statistics;
+};
+
+/**
+ * The policy and statistics of every interface that has sent or configured
+ * property changes.
+ */
+QList<QPair<QString, Coalescing>> coalescingStatistics();
 
+/**
+ * Sends every waiting PropertiesChanged signal now, whatever its policy.
+ */
 void flushPropertyChanges();
 
+enum class CallKind
+{
+    // We blocked until the reply arrived
+    sync,
+    // The reply was handled whenever it arrived
+    async
+};
+
+/**
+ * Round trip times of the calls made to one member of a remote interface.
+ *
+ * Bucket i counts the calls that took less than 2^i microseconds but no
+ * less than half that, and the last bucket counts everything slower.
+ */
+struct CallStatistics
+{
+    static constexpr int BUCKETS = 24;
+
+    quint64 calls = 0;
+
+    quint64 totalMicroseconds = 0;
+
+    quint64 maxMicroseconds = 0;
+
+    quint64 buckets[BUCKETS] = {};
+};
+
+struct CallKey
+{
+    QString interface;
+
+    QString member;
+
+    CallKind kind;
+};
+
+/**
+ * Records a call made from the main thread, and the time it took.
+ */
+void recordCall(const QString& interface, const QString& member,
+                CallKind kind, qint64 nanoseconds);
+
+/**
+ * As above, with the interface and member given as one qualified name,
+ * such as "org.freedesktop.NetworkManager.Settings.AddConnection".
+ */
+void recordCall(const char* name, CallKind kind, qint64 nanoseconds);
+
+QList<QPair<CallKey, CallStatistics>> callStatistics();
+
+void resetCallStatistics();
+
+template<typename Id>
+quint64 propertyMask(std::initializer_list<Id> ids)
+{
+    quint64 bits = 0;
+    for (auto id: ids)
+    {
+        bits |= quint64(1) << static_cast<int>(id);
+    }
+    return bits;
 }
+
+/**
+ * A PropertiesChanged signal waiting to be sent for one interface on one
+ * object path.
+ *
+ * Changed properties are recorded as bits in a mask. The first change after
+ * a flush queues the set, which is then sent when the coalescing policy for
+ * its interface says so, or earlier by calling flushPropertyChanges().
+ */
+class PropertyChangeSet
+{
+public:
+    PropertyChangeSet(const QDBusConnection& connection, const QString& path,
+                      const QString& interface);
+
+    virtual ~PropertyChangeSet();
+
+    PropertyChangeSet(const PropertyChangeSet&) = delete;
+
+    PropertyChangeSet& operator=(const PropertyChangeSet&) = delete;
+
+    const QString& interface() const;
+
+protected:
+    void markChanged(quint64 bits);
+
+    virtual QVariantMap changedProperties(quint64 bits) const = 0;
+
+private:
+    friend class PendingPropertyChanges;
+
+    void flush();
+
+    QDBusConnection m_connection;
+
+    QString m_path;
+
+    QString m_interface;
+
+    std::shared_ptr<Coalescing> m_coalescing;
+
+    quint64 m_changed = 0;
+
+    qint64 m_firstChange = 0;
+
+    qint64 m_deadline = 0;
+};
+
+template<typename T>
+struct PropertyDescriptor
+{
+    int id;
+
+    const char* name;
+
+    QVariant (*read)(const T&);
+};
+
+template<typename T, typename R, R (T::*Getter)() const>
+QVariant readProperty(const T& o)
+{
+    return QVariant::fromValue((o.*Getter)());
+}
+
+/**
+ * Checks that every entry of a descriptor table sits at the index given by
+ * its id, so the ids can be used directly as bit positions.
+ */
+template<typename T, std::size_t N>
+constexpr bool propertiesInOrder(const PropertyDescriptor<T> (&properties)[N])
+{
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        if (properties[i].id != static_cast<int>(i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Sends PropertiesChanged for an object using a static table of property
+ * descriptors, so notifying a change only sets a bit and flushing it calls
+ * the getters directly without any meta-object lookups.
+ */
+template<typename T>
+class PropertyNotifier: public PropertyChangeSet
+{
+public:
+    template<std::size_t N>
+    PropertyNotifier(const T& object,
+                     const PropertyDescriptor<T> (&properties)[N],
+                     const QDBusConnection& connection, const QString& path,
+                     const QString& interface) :
+        PropertyChangeSet(connection, path, interface),
+        m_object(object),
+        m_properties(properties),
+        m_count(N)
+    {
+        static_assert(N <= 64, "Too many properties for the change mask");
+    }
+
+    QVariantMap allProperties() const
+    {
+        return changedProperties(~quint64(0));
+    }
+
+    template<typename Id>
+    void notify(std::initializer_list<Id> ids)
+    {
+        markChanged(propertyMask(ids));
+    }
+
+protected:
+    QVariantMap changedProperties(quint64 bits) const override
+    {
+        QVariantMap result;
+        for (std::size_t i = 0; i < m_count; ++i)
+        {
+            if (bits & (quint64(1) << i))
+            {
+                const auto& property = m_properties[i];
+                result.insert(QLatin1String(property.name), property.read(m_object));
+            }
+        }
+        return result;
+    }
+
+    const T& m_object;
+
+    const PropertyDescriptor<T>* m_properties;
+
+    std::size_t m_count;
+};
+
+/**
+ * The D-Bus interface name of a generated adaptor, looked up once.
+ */
+template<typename Adaptor>
+const QString& adaptorInterface()
+{
+    static const QString interface = QString::fromLatin1(
+        Adaptor::staticMetaObject.classInfo(
+            Adaptor::staticMetaObject.indexOfClassInfo("D-Bus Interface")).value());
+    return interface;
+}
+
+}
+
+#define DBUS_UTILS_PROPERTY(Class, Id, Name, Getter) \
+    { static_cast<int>(Id), Name, &DBusUtils::readProperty<Class, decltype(std::declval<const Class&>().Getter()), &Class::Getter> }
@@ -18,42 +18,453 @@
 
 #include <logging.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+Q_LOGGING_CATEGORY(lcDevices, "indicator.network.devices")
+Q_LOGGING_CATEGORY(lcWifi, "indicator.network.wifi")
+Q_LOGGING_CATEGORY(lcModem, "indicator.network.modem")
+
 namespace util
 {
+namespace
+{
+    // Must be a power of two
+    constexpr size_t SLOT_COUNT = 1024;
+
+    // How long buffered debug output waits for the writer
+    constexpr chrono::milliseconds WRITER_INTERVAL(100);
+
+    struct Message
+    {
+        QtMsgType type;
+        unsigned line;
+        char category[64];
+        char file[128];
+        char function[256];
+        char text[512];
+    };
+
+    // Copies as much of src as fits, always terminating dest
+    template<size_t N>
     void
-    loggingFunction (QtMsgType type, const QMessageLogContext &context,
-                     const QString &msg)
+    copyString (char (&dest)[N], const char* src, size_t length)
+    {
+        length = min (length, N - 1);
+        memcpy (dest, src, length);
+        dest[length] = '\0';
+    }
+
+    template<size_t N>
+    void
+    copyString (char (&dest)[N], const char* src)
     {
-        QByteArray localMsg = msg.toLocal8Bit ();
-        switch (type)
+        copyString (dest, src ? src : "", src ? strlen (src) : 0);
+    }
+
+    // Long messages are truncated, this is all the work a logging thread does
+    void
+    fillMessage (Message& message, QtMsgType type,
+                 const QMessageLogContext &context, const QString &msg)
+    {
+        message.type = type;
+        message.line = context.line;
+        copyString (message.category, context.category);
+        copyString (message.file, context.file);
+        copyString (message.function, context.function);
+        QByteArray text = msg.toLocal8Bit ();
+        copyString (message.text, text.constData (), text.size ());
+    }
+
+    string
+    formatMessage (const Message& message)
+    {
+        const char* prefix = "Debug";
+        switch (message.type)
         {
             case QtMsgType::QtDebugMsg:
-                fprintf (stderr, "Debug: %s (%s:%u, %s)\n",
-                         localMsg.constData (), context.file, context.line,
-                         context.function);
                 break;
 #if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
             case QtMsgType::QtInfoMsg:
-                fprintf (stderr, "Info: %s (%s:%u, %s)\n",
-                         localMsg.constData (), context.file, context.line,
-                         context.function);
+                prefix = "Info";
                 break;
 #endif
             case QtMsgType::QtWarningMsg:
-                fprintf (stderr, "Warning: %s (%s:%u, %s)\n",
-                         localMsg.constData (), context.file, context.line,
-                         context.function);
+                prefix = "Warning";
                 break;
             case QtMsgType::QtCriticalMsg:
-                fprintf (stderr, "Critical: %s (%s:%u, %s)\n",
-                         localMsg.constData (), context.file, context.line,
-                         context.function);
+                prefix = "Critical";
                 break;
             case QtMsgType::QtFatalMsg:
-                fprintf (stderr, "Fatal: %s (%s:%u, %s)\n",
-                         localMsg.constData (), context.file, context.line,
-                         context.function);
-                abort ();
+                prefix = "Fatal";
+                break;
+        }
+
+        string line (prefix);
+        line += ": ";
+        if (strcmp (message.category, "default") != 0)
+        {
+            line += '[';
+            line += message.category;
+            line += "] ";
+        }
+        line += message.text;
+        line += " (";
+        line += message.file;
+        line += ':';
+        line += to_string (message.line);
+        line += ", ";
+        line += message.function;
+        line += ")\n";
+        return line;
+    }
+
+    /**
+     * Hands messages from the logging threads to a writer thread.
+     *
+     * The messages go through a bounded ring buffer that any number of
+     * threads can push to without taking a lock. Each slot carries a
+     * sequence number that says whether it is free or holds a message.
+     * When the buffer is full, messages are dropped and counted rather than
+     * making the caller wait.
+     *
+     * The writer collapses runs of identical messages into a count.
+     */
+    class AsyncLog
+    {
+    public:
+        AsyncLog ()
+        {
+            for (size_t i = 0; i < SLOT_COUNT; ++i)
+            {
+                m_slots[i].sequence.store (i, memory_order_relaxed);
+            }
+            m_writer = thread (&AsyncLog::run, this);
+        }
+
+        bool
+        push (QtMsgType type, const QMessageLogContext &context,
+              const QString &msg)
+        {
+            if (m_stopped.load (memory_order_acquire))
+            {
+                return false;
+            }
+
+            size_t position = m_enqueuePosition.load (memory_order_relaxed);
+            Slot* slot;
+            for (;;)
+            {
+                slot = &m_slots[position & (SLOT_COUNT - 1)];
+                size_t sequence = slot->sequence.load (memory_order_acquire);
+                auto difference = static_cast<intptr_t> (sequence)
+                        - static_cast<intptr_t> (position);
+                if (difference == 0)
+                {
+                    if (m_enqueuePosition.compare_exchange_weak (
+                            position, position + 1, memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    m_dropped.fetch_add (1, memory_order_relaxed);
+                    wake ();
+                    return true;
+                }
+                else
+                {
+                    position = m_enqueuePosition.load (memory_order_relaxed);
+                }
+            }
+
+            fillMessage (slot->message, type, context, msg);
+            slot->sequence.store (position + 1, memory_order_release);
+
+            // Debug messages wait for the writer's next round, unless they
+            // are coming in fast enough to fill the buffer. Anything more
+            // serious goes out straight away.
+            if (type != QtMsgType::QtDebugMsg
+                    || (position & (SLOT_COUNT / 2 - 1)) == 0)
+            {
+                wake ();
+            }
+            else
+            {
+                // Pairs with the fence in run (), so either the writer sees
+                // this message or we see that it is idle
+                atomic_thread_fence (memory_order_seq_cst);
+                if (m_idle.load (memory_order_relaxed)
+                        && m_idle.exchange (false, memory_order_acq_rel))
+                {
+                    notify ();
+                }
+            }
+            return true;
+        }
+
+        // Returns once everything pushed so far has been written
+        void
+        flush ()
+        {
+            unique_lock<mutex> lock (m_mutex);
+            if (m_stopped.load (memory_order_acquire))
+            {
+                return;
+            }
+            auto target = ++m_flushRequested;
+            m_wake.notify_one ();
+            m_flushed.wait (lock, [this, target] {
+                return m_flushCompleted >= target;
+            });
+        }
+
+        void
+        stop ()
+        {
+            {
+                lock_guard<mutex> lock (m_mutex);
+                if (m_stopped.exchange (true))
+                {
+                    return;
+                }
+                m_wake.notify_one ();
+            }
+            m_writer.join ();
         }
+
+    protected:
+        struct Slot
+        {
+            atomic<size_t> sequence;
+
+            Message message;
+        };
+
+        void
+        wake ()
+        {
+            if (!m_wakePending.exchange (true, memory_order_acq_rel))
+            {
+                notify ();
+            }
+        }
+
+        // The writer checks what it waits for under the mutex, so taking it
+        // here means a notification can't fall between its check and wait
+        void
+        notify ()
+        {
+            lock_guard<mutex> lock (m_mutex);
+            m_wake.notify_one ();
+        }
+
+        // Only ever called from the writer thread
+        bool
+        pending ()
+        {
+            auto& slot = m_slots[m_dequeuePosition & (SLOT_COUNT - 1)];
+            return slot.sequence.load (memory_order_acquire)
+                    == m_dequeuePosition + 1;
+        }
+
+        // Only ever called from the writer thread
+        bool
+        pop (Message& message)
+        {
+            auto& slot = m_slots[m_dequeuePosition & (SLOT_COUNT - 1)];
+            if (slot.sequence.load (memory_order_acquire)
+                    != m_dequeuePosition + 1)
+            {
+                return false;
+            }
+            message = slot.message;
+            slot.sequence.store (m_dequeuePosition + SLOT_COUNT,
+                                 memory_order_release);
+            ++m_dequeuePosition;
+            return true;
+        }
+
+        void
+        write (const string& line)
+        {
+            if (line == m_lastLine)
+            {
+                ++m_repeats;
+                return;
+            }
+            writeRepeats ();
+            fputs (line.c_str (), stderr);
+            m_lastLine = line;
+        }
+
+        void
+        writeRepeats ()
+        {
+            if (m_repeats > 0)
+            {
+                fprintf (stderr, "Previous message repeated %zu times\n",
+                         m_repeats);
+                m_repeats = 0;
+            }
+        }
+
+        void
+        drain ()
+        {
+            Message message;
+            while (pop (message))
+            {
+                write (formatMessage (message));
+            }
+
+            auto dropped = m_dropped.exchange (0, memory_order_relaxed);
+            if (dropped > 0)
+            {
+                writeRepeats ();
+                fprintf (stderr, "Warning: dropped %zu log messages\n",
+                         dropped);
+                m_lastLine.clear ();
+            }
+
+            // The run is over once the buffer is empty
+            writeRepeats ();
+            fflush (stderr);
+        }
+
+        void
+        run ()
+        {
+            unique_lock<mutex> lock (m_mutex);
+            for (;;)
+            {
+                m_wakePending.store (false, memory_order_release);
+                auto flushRequested = m_flushRequested;
+                bool stopped = m_stopped.load (memory_order_acquire);
+
+                lock.unlock ();
+                drain ();
+                lock.lock ();
+
+                m_flushCompleted = flushRequested;
+                m_flushed.notify_all ();
+                if (stopped)
+                {
+                    break;
+                }
+
+                auto urgent = [this] {
+                    return m_stopped.load (memory_order_acquire)
+                            || m_flushRequested != m_flushCompleted
+                            || m_wakePending.load (memory_order_acquire);
+                };
+
+                // With nothing buffered, sleep until the next message
+                m_idle.store (true, memory_order_relaxed);
+                atomic_thread_fence (memory_order_seq_cst);
+                if (!pending ())
+                {
+                    m_wake.wait (lock, [this, &urgent] {
+                        return urgent ()
+                                || !m_idle.load (memory_order_acquire);
+                    });
+                }
+                m_idle.store (false, memory_order_relaxed);
+
+                // Buffered debug output waits for the rest of the round
+                m_wake.wait_for (lock, WRITER_INTERVAL, urgent);
+            }
+        }
+
+        Slot m_slots[SLOT_COUNT];
+
+        atomic<size_t> m_enqueuePosition
+        { 0 };
+
+        size_t m_dequeuePosition = 0;
+
+        atomic<size_t> m_dropped
+        { 0 };
+
+        atomic<bool> m_wakePending
+        { false };
+
+        atomic<bool> m_stopped
+        { false };
+
+        // The writer is asleep with nothing buffered
+        atomic<bool> m_idle
+        { false };
+
+        mutex m_mutex;
+
+        condition_variable m_wake;
+
+        condition_variable m_flushed;
+
+        uint64_t m_flushRequested = 0;
+
+        uint64_t m_flushCompleted = 0;
+
+        string m_lastLine;
+
+        size_t m_repeats = 0;
+
+        thread m_writer;
+    };
+
+    // Never destroyed, as messages can be logged while the process exits.
+    // The writer is stopped at exit instead, after which everything is
+    // written directly.
+    AsyncLog&
+    asyncLog ()
+    {
+        static AsyncLog* log = []
+        {
+            auto log = new AsyncLog;
+            atexit ([]{ asyncLog ().stop (); });
+            return log;
+        }();
+        return *log;
+    }
+}
+
+    void
+    loggingFunction (QtMsgType type, const QMessageLogContext &context,
+                     const QString &msg)
+    {
+        if (type != QtMsgType::QtFatalMsg
+                && asyncLog ().push (type, context, msg))
+        {
+            return;
+        }
+
+        // Fatal messages, and anything logged after the writer has stopped
+        asyncLog ().flush ();
+        Message message;
+        fillMessage (message, type, context, msg);
+        fputs (formatMessage (message).c_str (), stderr);
+
+        if (type == QtMsgType::QtFatalMsg)
+        {
+            abort ();
+        }
+    }
+
+    void
+    flushLogging ()
+    {
+        asyncLog ().flush ();
     }
 }
@@ -18,12 +18,34 @@
 
 #pragma once
 
+#include <QLoggingCategory>
 #include <QMessageLogContext>
 #include <QString>
 
+// Categories for the chattier code paths. Their levels can be set at run
+// time, e.g. QT_LOGGING_RULES="indicator.network.wifi.debug=false"
+Q_DECLARE_LOGGING_CATEGORY(lcDevices)
+Q_DECLARE_LOGGING_CATEGORY(lcWifi)
+Q_DECLARE_LOGGING_CATEGORY(lcModem)
+
 namespace util
 {
+    /**
+     * Message handler that leaves the writing to a background thread.
+     *
+     * The calling thread only copies the message into a ring buffer.
+     * Messages are dropped, and the number dropped reported, if the buffer
+     * fills up. Fatal messages are written after everything before them,
+     * and before aborting.
+     */
     void
     loggingFunction (QtMsgType type, const QMessageLogContext &context,
                      const QString &msg);
+
+    /**
+     * Waits until every message handed to loggingFunction() so far has
+     * been written.
+     */
+    void
+    flushLogging ();
 }
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <util/trace.h>
+
+#include <QAbstractEventDispatcher>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace util
+{
+namespace trace
+{
+
+namespace
+{
+
+// Must be a power of two
+constexpr quint64 EVENT_COUNT = 8192;
+
+// Shorter iterations of the event loop aren't worth the room
+constexpr qint64 ITERATION_THRESHOLD = 1000000;
+
+struct Event
+{
+    // Number of the record that filled the slot, plus one. Written last,
+    // so a reader can tell a finished event from one being overwritten.
+    atomic<quint64> sequence;
+
+    atomic<const char*> name;
+
+    atomic<const char*> category;
+
+    atomic<qint64> start;
+
+    atomic<qint64> duration;
+
+    atomic<pid_t> thread;
+};
+
+Event s_events[EVENT_COUNT];
+
+atomic<quint64> s_next(0);
+
+pid_t currentThread()
+{
+    static thread_local pid_t thread = pid_t(syscall(SYS_gettid));
+    return thread;
+}
+
+void appendString(QByteArray& json, const char* string)
+{
+    json.append('"');
+    for (auto c = string; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            json.append('\\');
+        }
+        json.append(*c);
+    }
+    json.append('"');
+}
+
+}
+
+Span::Span(const char* name, const char* category) :
+        m_name(name),
+        m_category(category),
+        m_start(now())
+{
+}
+
+Span::~Span()
+{
+    record(m_name, m_category, m_start, now() - m_start);
+}
+
+qint64 now()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void record(const char* name, const char* category, qint64 start, qint64 duration)
+{
+    auto index = s_next.fetch_add(1, memory_order_relaxed);
+    auto& event = s_events[index & (EVENT_COUNT - 1)];
+
+    event.sequence.store(0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    event.name.store(name, memory_order_relaxed);
+    event.category.store(category, memory_order_relaxed);
+    event.start.store(start, memory_order_relaxed);
+    event.duration.store(duration, memory_order_relaxed);
+    event.thread.store(currentThread(), memory_order_relaxed);
+    event.sequence.store(index + 1, memory_order_release);
+}
+
+void traceEventLoop(QAbstractEventDispatcher* dispatcher)
+{
+    // The dispatcher is awake from the end of one wait to the start of the
+    // next, which is all the time spent handling events
+    auto awake = make_shared<qint64>(now());
+    QObject::connect(dispatcher, &QAbstractEventDispatcher::awake, [awake]()
+    {
+        *awake = now();
+    });
+    QObject::connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, [awake]()
+    {
+        auto duration = now() - *awake;
+        if (duration >= ITERATION_THRESHOLD)
+        {
+            record("main loop iteration", "loop", *awake, duration);
+        }
+    });
+}
+
+QByteArray chromeTraceJson()
+{
+    auto pid = QByteArray::number(qint64(getpid()));
+    auto end = s_next.load(memory_order_acquire);
+    auto begin = end > EVENT_COUNT ? end - EVENT_COUNT : 0;
+
+    QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    for (auto index = begin; index < end; ++index)
+    {
+        auto& event = s_events[index & (EVENT_COUNT - 1)];
+        if (event.sequence.load(memory_order_acquire) != index + 1)
+        {
+            continue;
+        }
+
+        auto name = event.name.load(memory_order_relaxed);
+        auto category = event.category.load(memory_order_relaxed);
+        auto start = event.start.load(memory_order_relaxed);
+        auto duration = event.duration.load(memory_order_relaxed);
+        auto thread = event.thread.load(memory_order_relaxed);
+
+        // Overwritten while we were reading it
+        atomic_thread_fence(memory_order_acquire);
+        if (event.sequence.load(memory_order_relaxed) != index + 1)
+        {
+            continue;
+        }
+
+        if (!first)
+        {
+            json.append(',');
+        }
+        first = false;
+
+        // Trace viewers work in microseconds
+        json.append("{\"name\":");
+        appendString(json, name);
+        json.append(",\"cat\":");
+        appendString(json, category);
+        json.append(",\"ph\":\"X\",\"ts\":");
+        json.append(QByteArray::number(double(start) / 1000.0, 'f', 3));
+        json.append(",\"dur\":");
+        json.append(QByteArray::number(double(duration) / 1000.0, 'f', 3));
+        json.append(",\"pid\":");
+        json.append(pid);
+        json.append(",\"tid\":");
+        json.append(QByteArray::number(qint64(thread)));
+        json.append('}');
+    }
+    json.append("]}");
+    return json;
+}
+
+}
+}
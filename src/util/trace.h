@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QtGlobal>
+
+class QAbstractEventDispatcher;
+
+namespace util
+{
+namespace trace
+{
+
+/**
+ * Times the scope it lives in, and records it in the trace buffer.
+ *
+ * The name and category are kept by pointer, so they must be string
+ * literals.
+ */
+class Span
+{
+public:
+    explicit Span(const char* name, const char* category = "app");
+
+    ~Span();
+
+    Span(const Span&) = delete;
+
+    Span& operator=(const Span&) = delete;
+
+protected:
+    const char* m_name;
+
+    const char* m_category;
+
+    qint64 m_start;
+};
+
+/**
+ * Nanoseconds on the clock the trace is recorded against.
+ */
+qint64 now();
+
+/**
+ * Adds a finished span to the buffer, which only holds the most recent
+ * few thousand.
+ */
+void record(const char* name, const char* category, qint64 start, qint64 duration);
+
+/**
+ * Records every iteration of the dispatcher's event loop that keeps it
+ * busy for a millisecond or more.
+ */
+void traceEventLoop(QAbstractEventDispatcher* dispatcher);
+
+/**
+ * The buffer in the Chrome trace event format, ready for a trace viewer.
+ */
+QByteArray chromeTraceJson();
+
+}
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <util/wakeups.h>
+#include <util/trace.h>
+
+#include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QHash>
+#include <QPointer>
+#include <QQueue>
+#include <QTimer>
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+
+using namespace std;
+
+namespace util
+{
+namespace wakeups
+{
+
+namespace
+{
+
+// The longest rate we report, in seconds
+constexpr int WINDOW = 60;
+
+constexpr int SHORT_WINDOW = 10;
+
+// Work handed over by other threads that no wakeup has been put down to
+constexpr int MAX_EXPECTED = 16;
+
+/**
+ * Counts per second, for the current second and the whole window before
+ * it.
+ */
+class Counter
+{
+public:
+    Counter()
+    {
+        fill(begin(m_seconds), end(m_seconds), -1);
+    }
+
+    void add(qint64 second)
+    {
+        auto slot = second % SLOTS;
+        if (m_seconds[slot] != second)
+        {
+            m_seconds[slot] = second;
+            m_counts[slot] = 0;
+        }
+        ++m_counts[slot];
+    }
+
+    // Only whole seconds count, so the one still going is left out
+    double rate(qint64 second, int span) const
+    {
+        quint64 count = 0;
+        for (int slot = 0; slot < SLOTS; ++slot)
+        {
+            if (m_seconds[slot] >= second - span && m_seconds[slot] < second)
+            {
+                count += m_counts[slot];
+            }
+        }
+        return double(count) / span;
+    }
+
+    bool idle(qint64 second) const
+    {
+        return none_of(begin(m_seconds), end(m_seconds), [second](qint64 seen)
+        {
+            return seen >= second - WINDOW;
+        });
+    }
+
+protected:
+    static constexpr int SLOTS = WINDOW + 1;
+
+    qint64 m_seconds[SLOTS];
+
+    quint32 m_counts[SLOTS] = {};
+};
+
+class WakeupFilter;
+
+struct State
+{
+    QPointer<WakeupFilter> filter;
+
+    QMetaObject::Connection aboutToBlock;
+
+    function<qint64()> clock;
+
+    // Whether the loop has blocked yet. Each time it blocks from then on,
+    // it has been through one wakeup since it last blocked.
+    bool started = false;
+
+    QString claimed;
+
+    QString fallback;
+
+    QHash<QString, Counter> counters;
+
+    // The second idle counters were last dropped in
+    qint64 pruned = 0;
+
+    Counter total;
+
+    mutex expectedMutex;
+
+    QQueue<QString> expected;
+};
+
+State& state()
+{
+    static State state;
+    return state;
+}
+
+qint64 currentSecond()
+{
+    const auto& clock = state().clock;
+    return (clock ? clock() : trace::now()) / 1000000000;
+}
+
+QString className(QObject* object)
+{
+    return QString::fromLatin1(object->metaObject()->className());
+}
+
+QString timerName(QObject* receiver)
+{
+    if (!receiver->objectName().isEmpty())
+    {
+        return receiver->objectName();
+    }
+    // A bare QTimer says nothing, the object that owns it might
+    if (qobject_cast<QTimer*>(receiver) && receiver->parent())
+    {
+        return className(receiver->parent());
+    }
+    return className(receiver);
+}
+
+// Sources such as signals from one access point come and go, so their
+// counters must not outlive them
+void pruneIdle(qint64 second)
+{
+    auto& s = state();
+    if (s.pruned == second)
+    {
+        return;
+    }
+    s.pruned = second;
+
+    for (auto it = s.counters.begin(); it != s.counters.end();)
+    {
+        if (it->idle(second))
+        {
+            it = s.counters.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void finishWakeup()
+{
+    auto& s = state();
+
+    QString source = s.claimed;
+    if (source.isNull())
+    {
+        source = s.fallback;
+    }
+    if (source.isNull())
+    {
+        lock_guard<mutex> lock(s.expectedMutex);
+        if (!s.expected.isEmpty())
+        {
+            source = s.expected.dequeue();
+        }
+    }
+    if (source.isNull())
+    {
+        source = "unknown";
+    }
+
+    auto second = currentSecond();
+    pruneIdle(second);
+    s.counters[source].add(second);
+    s.total.add(second);
+
+    s.claimed = QString();
+    s.fallback = QString();
+}
+
+class WakeupFilter: public QObject
+{
+public:
+    explicit WakeupFilter(QObject* parent) :
+            QObject(parent)
+    {
+    }
+
+    bool eventFilter(QObject* watched, QEvent* event) override
+    {
+        auto& s = state();
+        if (!s.started || !s.claimed.isNull())
+        {
+            return false;
+        }
+
+        switch (event->type())
+        {
+            case QEvent::Timer:
+                s.claimed = "timer " + timerName(watched);
+                break;
+            // D-Bus replies and signals, queued connections and sockets
+            case QEvent::MetaCall:
+            case QEvent::SockAct:
+            case QEvent::SockClose:
+                if (s.fallback.isNull())
+                {
+                    s.fallback = "event to " + className(watched);
+                }
+                break;
+            default:
+                break;
+        }
+        return false;
+    }
+};
+
+}
+
+void install(QCoreApplication* application, function<qint64()> clock)
+{
+    auto& s = state();
+    s.clock = clock;
+
+    // Memory is managed by Qt parent ownership
+    s.filter = new WakeupFilter(application);
+    application->installEventFilter(s.filter);
+
+    s.aboutToBlock = QObject::connect(application->eventDispatcher(),
+                                      &QAbstractEventDispatcher::aboutToBlock, []()
+    {
+        auto& s = state();
+        if (s.started)
+        {
+            finishWakeup();
+        }
+        s.started = true;
+    });
+}
+
+void uninstall()
+{
+    auto& s = state();
+    QObject::disconnect(s.aboutToBlock);
+    delete s.filter;
+
+    s.clock = function<qint64()>();
+    s.started = false;
+    s.claimed = QString();
+    s.fallback = QString();
+    s.counters.clear();
+    s.pruned = 0;
+    s.total = Counter();
+
+    lock_guard<mutex> lock(s.expectedMutex);
+    s.expected.clear();
+}
+
+bool unclaimed()
+{
+    auto& s = state();
+    return s.started && s.claimed.isNull();
+}
+
+void claim(const QString& source)
+{
+    if (unclaimed())
+    {
+        state().claimed = source;
+    }
+}
+
+void expect(const QString& source)
+{
+    auto& s = state();
+    lock_guard<mutex> lock(s.expectedMutex);
+    if (s.expected.size() == MAX_EXPECTED)
+    {
+        s.expected.dequeue();
+    }
+    s.expected.enqueue(source);
+}
+
+QList<Rate> rates()
+{
+    auto second = currentSecond();
+    pruneIdle(second);
+
+    QList<Rate> result;
+    const auto& counters = state().counters;
+    for (auto it = counters.cbegin(); it != counters.cend(); ++it)
+    {
+        Rate rate;
+        rate.source = it.key();
+        rate.lastTenSeconds = it->rate(second, SHORT_WINDOW);
+        rate.lastMinute = it->rate(second, WINDOW);
+        result << rate;
+    }
+
+    sort(result.begin(), result.end(), [](const Rate& a, const Rate& b)
+    {
+        return a.lastMinute > b.lastMinute;
+    });
+    return result;
+}
+
+Rate total()
+{
+    auto second = currentSecond();
+
+    Rate rate;
+    rate.source = "total";
+    rate.lastTenSeconds = state().total.rate(second, SHORT_WINDOW);
+    rate.lastMinute = state().total.rate(second, WINDOW);
+    return rate;
+}
+
+}
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QList>
+#include <QString>
+
+#include <functional>
+
+class QCoreApplication;
+
+namespace util
+{
+namespace wakeups
+{
+
+/**
+ * Starts counting the times the main loop wakes up, and attributing each
+ * wakeup to what caused it.
+ *
+ * Timers claim the wakeups they cause, named after the timer's object
+ * name, or its parent's class if it has none. Anything else that delivers
+ * events claims them by the class it delivers to, unless something more
+ * specific has called claim() by the time the loop blocks again.
+ *
+ * Seconds are taken from the monotonic trace clock, unless another clock
+ * returning nanoseconds is given.
+ */
+void install(QCoreApplication* application,
+             std::function<qint64()> clock = std::function<qint64()>());
+
+/**
+ * Stops counting, and forgets everything counted so far.
+ */
+void uninstall();
+
+/**
+ * Whether the current wakeup is still waiting for a source. Check it
+ * before building a name for claim().
+ */
+bool unclaimed();
+
+/**
+ * Attributes the current wakeup to source, if nothing else has claimed it
+ * yet. Only call from the main thread.
+ */
+void claim(const QString& source);
+
+/**
+ * Notes that another thread has handed work to the main loop, for when the
+ * wakeup it causes has nothing more specific to go on.
+ */
+void expect(const QString& source);
+
+struct Rate
+{
+    QString source;
+
+    double lastTenSeconds = 0.0;
+
+    double lastMinute = 0.0;
+};
+
+/**
+ * Wakeups per second over the last complete ten seconds and minute, for
+ * every source seen in the last minute, busiest first.
+ */
+QList<Rate> rates();
+
+/**
+ * As above, across all sources.
+ */
+Rate total();
+
+}
+}
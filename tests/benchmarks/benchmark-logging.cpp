@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// We measure debug messages, so keep them even in release builds
+#undef QT_NO_DEBUG_OUTPUT
+
+#include <util/logging.h>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QString>
+#include <gtest/gtest.h>
+
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace testing;
+
+namespace
+{
+
+class BenchmarkLogging: public Test
+{
+protected:
+    // Rounds are kept small enough for the ring buffer, so we measure the
+    // cost of logging rather than of dropping messages
+    static constexpr int MESSAGES = 500;
+
+    static constexpr int ROUNDS = 200;
+
+    void SetUp() override
+    {
+        // The messages themselves are of no interest
+        cerr.flush();
+        m_stderr = dup(STDERR_FILENO);
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDERR_FILENO);
+        close(null);
+    }
+
+    void TearDown() override
+    {
+        qInstallMessageHandler(util::loggingFunction);
+        util::flushLogging();
+
+        dup2(m_stderr, STDERR_FILENO);
+        close(m_stderr);
+    }
+
+    // Mean time the calling thread spends in each qDebug() call
+    static double nanosecondsPerCall()
+    {
+        QString path("/org/freedesktop/NetworkManager/Devices/3");
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < MESSAGES; ++i)
+        {
+            qDebug() << "Device Added:" << path << i;
+        }
+        return double(timer.nsecsElapsed()) / MESSAGES;
+    }
+
+    int m_stderr = -1;
+};
+
+TEST_F(BenchmarkLogging, AsyncHandlerAgainstQtDefault)
+{
+    double qtDefault = 0.0;
+    double async = 0.0;
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        qInstallMessageHandler(nullptr);
+        qtDefault += nanosecondsPerCall();
+
+        qInstallMessageHandler(util::loggingFunction);
+        async += nanosecondsPerCall();
+        util::flushLogging();
+    }
+    qtDefault /= ROUNDS;
+    async /= ROUNDS;
+
+    cout << "per-call cost, Qt default handler:    " << qtDefault << " ns" << endl;
+    cout << "per-call cost, util::loggingFunction: " << async << " ns" << endl;
+
+    RecordProperty("QtDefaultNs", int(qtDefault));
+    RecordProperty("LoggingFunctionNs", int(async));
+}
+
+}
@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <menumodel-cpp/action.h>
+#include <menumodel-cpp/action-group.h>
+#include <menumodel-cpp/action-group-merger.h>
+#include <menumodel-cpp/menu.h>
+#include <menumodel-cpp/menu-exporter.h>
+#include <menumodel-cpp/menu-merger.h>
+
+#include <libqtdbustest/DBusTestRunner.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <time.h>
+
+using namespace std;
+using namespace testing;
+
+namespace
+{
+
+const vector<int> SIZES {10, 100, 1000};
+
+double
+cpuNanoseconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+vector<MenuItem::Ptr>
+makeItems(int count)
+{
+    vector<MenuItem::Ptr> items;
+    for (int i = 0; i < count; ++i)
+    {
+        items.push_back(make_shared<MenuItem>(QString("Item %1").arg(i),
+                                              QString("indicator.item%1").arg(i)));
+    }
+    return items;
+}
+
+Menu::Ptr
+makeMenu(const vector<MenuItem::Ptr>& items)
+{
+    auto menu = make_shared<Menu>();
+    for (const auto& item : items)
+    {
+        menu->append(item);
+    }
+    return menu;
+}
+
+vector<ActionGroup::Ptr>
+makeActionGroups()
+{
+    vector<ActionGroup::Ptr> groups;
+    for (int i = 0; i < 10; ++i)
+    {
+        auto group = make_shared<ActionGroup>();
+        for (int j = 0; j < 10; ++j)
+        {
+            group->add(make_shared< ::Action>(QString("group%1.action%2").arg(i).arg(j)));
+        }
+        groups.push_back(group);
+    }
+    return groups;
+}
+
+// Dictionaries of lists of dictionaries, and so on, five wide
+Variant
+makeNested(int depth)
+{
+    if (depth == 0)
+    {
+        return TypedVariant<string>("value");
+    }
+
+    map<string, Variant> dictionary;
+    vector<Variant> list;
+    for (int i = 0; i < 5; ++i)
+    {
+        dictionary["key" + to_string(i)] = makeNested(depth - 1);
+        list.push_back(TypedVariant<int32_t>(i));
+    }
+    dictionary["list"] = TypedVariant<vector<Variant>>(list);
+    return TypedVariant<map<string, Variant>>(dictionary);
+}
+
+// Runs the default main context until done() or a ten second timeout
+bool
+waitFor(const function<bool()>& done)
+{
+    // Makes sure the blocking iterations come back to check the clock
+    auto heartbeat = g_timeout_add(100, [](gpointer) -> gboolean
+    {
+        return G_SOURCE_CONTINUE;
+    }, nullptr);
+
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+    while (!done() && chrono::steady_clock::now() < deadline)
+    {
+        g_main_context_iteration(nullptr, TRUE);
+    }
+    g_source_remove(heartbeat);
+    return done();
+}
+
+class BenchmarkMenuModel: public Test
+{
+protected:
+    static constexpr int ITERATIONS = 50;
+
+    static void SetUpTestCase()
+    {
+        Variant::registerMetaTypes();
+    }
+
+    /*
+     * prepare() does the untimed set up for one iteration, and returns the
+     * timed part, which carries out the given number of operations. Whatever
+     * it holds on to is torn down after the clock has stopped. The mean
+     * cost of one operation is printed and recorded as a test property.
+     */
+    void measure(const string& name, int operations,
+                 const function<function<void()>()>& prepare,
+                 int iterations = ITERATIONS)
+    {
+        double real = 0.0;
+        double cpu = 0.0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto body = prepare();
+
+            auto realStart = chrono::steady_clock::now();
+            auto cpuStart = cpuNanoseconds();
+            body();
+            cpu += cpuNanoseconds() - cpuStart;
+            real += chrono::duration<double, nano>(
+                    chrono::steady_clock::now() - realStart).count();
+        }
+
+        double total = double(operations) * iterations;
+        cout << "per-operation cost, " << name << ": " << real / total
+                << " ns (" << cpu / total << " ns CPU)" << endl;
+
+        RecordProperty(name + "Ns", int(real / total));
+        RecordProperty(name + "CpuNs", int(cpu / total));
+    }
+};
+
+TEST_F(BenchmarkMenuModel, Menu)
+{
+    for (int size : SIZES)
+    {
+        auto suffix = to_string(size);
+
+        measure("MenuAppend" + suffix, size, [size]
+        {
+            auto menu = make_shared<Menu>();
+            auto items = makeItems(size);
+            return [menu, items]
+            {
+                for (const auto& item : items)
+                {
+                    menu->append(item);
+                }
+            };
+        });
+
+        // Sorted, as the access point list is
+        measure("MenuInsert" + suffix, size, [size]
+        {
+            auto menu = make_shared<Menu>();
+            auto items = makeItems(size);
+            shuffle(items.begin(), items.end(), mt19937(size));
+            return [menu, items]
+            {
+                for (const auto& item : items)
+                {
+                    menu->insert(item, [](MenuItem::Ptr a, MenuItem::Ptr b)
+                    {
+                        return a->label() < b->label();
+                    });
+                }
+            };
+        });
+
+        measure("MenuRemoveAll" + suffix, size, [size]
+        {
+            auto items = makeItems(size);
+            auto menu = makeMenu(items);
+            return [menu, items]
+            {
+                for (const auto& item : items)
+                {
+                    menu->removeAll(item);
+                }
+            };
+        });
+
+        measure("MenuItemChanged" + suffix, size, [size]
+        {
+            auto items = makeItems(size);
+            auto menu = makeMenu(items);
+            return [menu, items]
+            {
+                for (const auto& item : items)
+                {
+                    item->setLabel("Changed");
+                }
+            };
+        });
+    }
+}
+
+// A change to a menu nested inside depth mergers, each with a sibling menu
+TEST_F(BenchmarkMenuModel, MenuMerger)
+{
+    const int CHANGES = 100;
+
+    for (int depth = 1; depth <= 4; ++depth)
+    {
+        measure("MenuMergerDepth" + to_string(depth), CHANGES, [depth]
+        {
+            auto leaf = makeMenu(makeItems(10));
+            vector<MenuModel::Ptr> models {leaf};
+            for (int i = 0; i < depth; ++i)
+            {
+                auto merger = make_shared<MenuMerger>();
+                merger->append(models.back());
+                merger->append(makeMenu(makeItems(10)));
+                models.push_back(merger);
+            }
+
+            auto item = make_shared<MenuItem>("Added", "indicator.added");
+            return [leaf, models, item]
+            {
+                for (int i = 0; i < CHANGES / 2; ++i)
+                {
+                    leaf->append(item);
+                    leaf->removeAll(item);
+                }
+            };
+        });
+    }
+}
+
+TEST_F(BenchmarkMenuModel, ActionGroupMerger)
+{
+    measure("ActionGroupMergerAdd", 10, []
+    {
+        auto merger = make_shared<ActionGroupMerger>();
+        auto groups = makeActionGroups();
+        return [merger, groups]
+        {
+            for (const auto& group : groups)
+            {
+                merger->add(group);
+            }
+        };
+    });
+
+    measure("ActionGroupMergerRemove", 10, []
+    {
+        auto merger = make_shared<ActionGroupMerger>();
+        auto groups = makeActionGroups();
+        for (const auto& group : groups)
+        {
+            merger->add(group);
+        }
+        return [merger, groups]
+        {
+            for (const auto& group : groups)
+            {
+                merger->remove(group);
+            }
+        };
+    });
+}
+
+TEST_F(BenchmarkMenuModel, VariantEquality)
+{
+    const int COMPARISONS = 100;
+
+    for (int depth = 0; depth <= 3; ++depth)
+    {
+        // Equal, but not the same GVariant
+        auto a = makeNested(depth);
+        auto b = makeNested(depth);
+        ASSERT_FALSE(a != b);
+
+        measure("VariantEqualityDepth" + to_string(depth), COMPARISONS, [a, b]
+        {
+            return [a, b]
+            {
+                for (int i = 0; i < COMPARISONS; ++i)
+                {
+                    if (a != b)
+                    {
+                        abort();
+                    }
+                }
+            };
+        });
+    }
+}
+
+/*
+ * From appending items to a menu, to a client on another connection seeing
+ * all of them. The client subscribes before the clock starts.
+ */
+TEST_F(BenchmarkMenuModel, MenuExporter)
+{
+    // A private session bus
+    QtDBusTest::DBusTestRunner dbus;
+
+    auto server = make_shared<SessionBus>();
+    auto client = make_shared<SessionBus>();
+    int exports = 0;
+
+    for (int size : SIZES)
+    {
+        measure("MenuExporterAppend" + to_string(size), size, [=, &exports]
+        {
+            auto path = "/com/canonical/benchmark/menu" + to_string(++exports);
+            auto menu = makeMenu(makeItems(1));
+            auto exporter = make_shared<MenuExporter>(server, path, menu);
+
+            shared_ptr<GMenuModel> model(
+                    G_MENU_MODEL(g_dbus_menu_model_get(client->bus().get(),
+                                                       server->address().c_str(),
+                                                       path.c_str())),
+                    GObjectDeleter());
+            // Asking for the items is what subscribes to the menu
+            EXPECT_TRUE(waitFor([model] { return g_menu_model_get_n_items(model.get()) == 1; }))
+                    << "Menu export never reached the client";
+
+            auto items = makeItems(size);
+            return [menu, exporter, model, items]
+            {
+                for (const auto& item : items)
+                {
+                    menu->append(item);
+                }
+                int expected = int(items.size()) + 1;
+                EXPECT_TRUE(waitFor([model, expected] { return g_menu_model_get_n_items(model.get()) == expected; }))
+                        << "Menu changes never reached the client";
+            };
+        }, ITERATIONS / 10);
+    }
+}
+
+}
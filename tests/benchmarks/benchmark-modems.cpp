@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <connectivityqt/modems-list-model.h>
+#include <indicator-network-test-base.h>
+
+#include <QElapsedTimer>
+
+#include <iostream>
+
+using namespace std;
+using namespace testing;
+using namespace connectivityqt;
+
+namespace
+{
+
+class ActionsChangedSpy: public QObject
+{
+    Q_OBJECT
+
+public:
+    ActionsChangedSpy(const QDBusConnection& connection)
+    {
+        connection.connect(DBusTypes::DBUS_NAME,
+                           "/com/canonical/indicator/network",
+                           "org.gtk.Actions",
+                           "Changed",
+                           this,
+                           SLOT(changed()));
+    }
+
+    bool waitForChange(int timeout = 5000)
+    {
+        QSignalSpy spy(this, SIGNAL(received()));
+        return spy.wait(timeout);
+    }
+
+public Q_SLOTS:
+    void changed()
+    {
+        Q_EMIT received();
+    }
+
+Q_SIGNALS:
+    void received();
+};
+
+class BenchmarkModems: public IndicatorNetworkTestBase
+{
+protected:
+    static constexpr int EVENTS = 100;
+
+    static void SetUpTestCase()
+    {
+        Connectivity::registerMetaTypes();
+    }
+
+    /**
+     * Flips the signal strength of the given modem between two icon
+     * buckets and returns the mean time in microseconds from the oFono
+     * property change to the indicator publishing the new action state.
+     */
+    double perEventCost(const QString& modemPath)
+    {
+        ActionsChangedSpy spy(dbusTestRunner.sessionConnection());
+
+        QElapsedTimer timer;
+        qint64 total = 0;
+        for (int i = 0; i < EVENTS; ++i)
+        {
+            uchar strength = (i % 2) ? 10 : 90;
+            timer.start();
+            setNetworkRegistrationProperty(modemPath, "Strength", QVariant::fromValue(strength));
+            EXPECT_TRUE(spy.waitForChange()) << "No action change for event " << i;
+            total += timer.nsecsElapsed();
+        }
+
+        return double(total) / EVENTS / 1000.0;
+    }
+};
+
+TEST_F(BenchmarkModems, PerEventCostIsFlatWithEightModems)
+{
+    setGlobalConnectedState(NM_STATE_CONNECTED_GLOBAL);
+    ASSERT_NO_THROW(startIndicator());
+
+    auto connectivity(newConnectivity());
+    auto modems = getSortedModems(*connectivity);
+    QSignalSpy rowsInsertedSpy(modems.get(), SIGNAL(rowsInserted(const QModelIndex &, int, int)));
+    WAIT_FOR_ROW_COUNT(rowsInsertedSpy, modems, 1)
+
+    double single = perEventCost(firstModem());
+
+    QStringList paths;
+    for (int i = 1; i < 8; ++i)
+    {
+        paths << createModem(QString("ril_%1").arg(i));
+    }
+    WAIT_FOR_ROW_COUNT(rowsInsertedSpy, modems, 8)
+
+    for (int i = 0; i < modems->rowCount(); ++i)
+    {
+        EXPECT_EQ(i + 1, modems->data(modems->index(i, 0), ModemsListModel::RoleIndex).toInt());
+    }
+
+    double firstOfEight = perEventCost(firstModem());
+    double lastOfEight = perEventCost(paths.last());
+
+    cout << "per-event cost, 1 modem:             " << single << " us" << endl;
+    cout << "per-event cost, 8 modems (first):    " << firstOfEight << " us" << endl;
+    cout << "per-event cost, 8 modems (last):     " << lastOfEight << " us" << endl;
+
+    RecordProperty("SingleModemUs", int(single));
+    RecordProperty("EightModemsFirstUs", int(firstOfEight));
+    RecordProperty("EightModemsLastUs", int(lastOfEight));
+}
+
+}
+
+#include "benchmark-modems.moc"
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <connectivityqt/internal/dbus-property-cache.h>
+#include <connectivityqt/internal/vpn-connection-parameters.h>
+#include <connectivityqt/openvpn-connection.h>
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <gtest/gtest.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace testing;
+using namespace connectivityqt;
+using namespace connectivityqt::internal;
+
+namespace
+{
+
+static const QString OWNER(":1.1");
+
+static const QString VPN_INTERFACE("com.ubuntu.connectivity1.vpn.VpnConnection");
+
+static const QString OPENVPN_INTERFACE("com.ubuntu.connectivity1.vpn.VpnConnection.OpenVpn");
+
+// Every property OpenvpnConnection dispatches on
+static const QStringList OPENVPN_NAMES {
+    "ca", "connectionType", "certPass", "cert", "key", "localIp",
+    "password", "remote", "remoteIp", "staticKey", "staticKeyDirection",
+    "username", "port", "portSet", "renegSeconds", "renegSecondsSet",
+    "compLzo", "protoTcp", "dev", "devType", "devTypeSet", "tunnelMtu",
+    "tunnelMtuSet", "fragmentSize", "fragmentSizeSet", "mssFix",
+    "remoteRandom", "cipher", "keysize", "keysizeSet", "auth", "tlsRemote",
+    "remoteCertTls", "remoteCertTlsSet", "ta", "taDir", "taSet",
+    "proxyType", "proxyServer", "proxyPort", "proxyRetry", "proxyUsername",
+    "proxyPassword"
+};
+
+class BenchmarkPropertyDispatch: public Test
+{
+protected:
+    static constexpr int EVENTS = 200000;
+
+    BenchmarkPropertyDispatch() :
+        m_connection("benchmark-property-dispatch")
+    {
+    }
+
+    /**
+     * Builds a stream of single property changes the way they arrive off
+     * the bus: each name a separately allocated string, cycling through
+     * every name, each value different from the last one for its name.
+     */
+    static QVector<QVariantMap> stream()
+    {
+        // Whole passes through the names
+        int events = EVENTS / OPENVPN_NAMES.size() * OPENVPN_NAMES.size();
+
+        QVector<QVariantMap> result;
+        result.reserve(events);
+        for (int i = 0; i < events; ++i)
+        {
+            const auto& name = OPENVPN_NAMES.at(i % OPENVPN_NAMES.size());
+            int value = (i / OPENVPN_NAMES.size()) % 2 == 0 ? 1 : 0;
+            result << QVariantMap{{QString(name.unicode(), name.size()), value}};
+        }
+        return result;
+    }
+
+    static QVariantMap initialProperties()
+    {
+        QVariantMap properties;
+        for (const auto& name: OPENVPN_NAMES)
+        {
+            properties[name] = 0;
+        }
+        return properties;
+    }
+
+    /**
+     * Mean cost in nanoseconds of one property change going through the
+     * cache and whatever is connected to it.
+     */
+    static double replay(DBusPropertyCache& cache, const QVector<QVariantMap>& events)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (const auto& event: events)
+        {
+            cache.replayPropertiesChanged(OWNER, OPENVPN_INTERFACE, event, {});
+        }
+        return double(timer.nsecsElapsed()) / events.size();
+    }
+
+    // Never connected, nothing here goes near a bus
+    QDBusConnection m_connection;
+};
+
+TEST_F(BenchmarkPropertyDispatch, OpenvpnPropertyStream)
+{
+    auto events = stream();
+
+    // What the connections did before the dispatch tables: compare each
+    // change against every name in turn
+    DBusPropertyCache chainCache(DBusTypes::DBUS_NAME, OPENVPN_INTERFACE, "/vpn/1",
+                                 m_connection, OWNER, initialProperties());
+    int chainHandled = 0;
+    QObject::connect(&chainCache, &DBusPropertyCache::propertyChanged,
+            [&chainHandled](const QString& name, const QVariant&)
+            {
+                for (const auto& candidate: OPENVPN_NAMES)
+                {
+                    if (name == candidate)
+                    {
+                        ++chainHandled;
+                        break;
+                    }
+                }
+            });
+    double chain = replay(chainCache, events);
+
+    // The real thing
+    VpnConnectionParameters parameters(QDBusObjectPath("/vpn/2"), m_connection);
+    parameters.owner = OWNER;
+    parameters.interfaces[OPENVPN_INTERFACE] = initialProperties();
+    parameters.interfaces[VPN_INTERFACE] = QVariantMap();
+    parameters.createdCaches = make_shared<QList<QPointer<DBusPropertyCache>>>();
+    OpenvpnConnection connection(parameters);
+
+    DBusPropertyCache* dispatchCache = nullptr;
+    for (const auto& cache: *parameters.createdCaches)
+    {
+        if (cache->isInitialized() && cache->get("remote").isValid())
+        {
+            dispatchCache = cache;
+        }
+    }
+    ASSERT_TRUE(dispatchCache);
+
+    int remoteChanges = 0;
+    QObject::connect(&connection, &OpenvpnConnection::remoteChanged,
+            [&remoteChanges](const QString&)
+            {
+                ++remoteChanges;
+            });
+    double dispatch = replay(*dispatchCache, events);
+
+    EXPECT_EQ(events.size(), chainHandled);
+    EXPECT_EQ(events.size() / OPENVPN_NAMES.size(), remoteChanges);
+
+    cout << "per-property cost, comparison chain: " << chain << " ns" << endl;
+    cout << "per-property cost, OpenvpnConnection: " << dispatch << " ns" << endl;
+
+    RecordProperty("ChainedNs", int(chain));
+    RecordProperty("DispatchNs", int(dispatch));
+}
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <indicator-network-test-base.h>
+#include <status-snapshot/reader.h>
+
+#include <QDBusMessage>
+#include <QDBusReply>
+#include <QElapsedTimer>
+
+#include <iostream>
+
+using namespace std;
+using namespace testing;
+
+namespace
+{
+
+class BenchmarkStatusSnapshot: public IndicatorNetworkTestBase
+{
+protected:
+    static constexpr int DBUS_READS = 1000;
+
+    static constexpr int SNAPSHOT_READS = 1000000;
+
+    /**
+     * Mean cost in microseconds of reading Status and FlightMode the way
+     * the snapshot replaces, i.e. with a blocking D-Bus call per property.
+     */
+    double dbusCost()
+    {
+        auto connection = dbusTestRunner.sessionConnection();
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < DBUS_READS; ++i)
+        {
+            for (const auto& name: {"Status", "FlightMode"})
+            {
+                auto message = QDBusMessage::createMethodCall(
+                        DBusTypes::DBUS_NAME, DBusTypes::SERVICE_PATH,
+                        "org.freedesktop.DBus.Properties", "Get");
+                message << QString(DBusTypes::SERVICE_INTERFACE) << QString(name);
+                QDBusReply<QDBusVariant> reply = connection.call(message);
+                EXPECT_TRUE(reply.isValid());
+            }
+        }
+        return double(timer.nsecsElapsed()) / DBUS_READS / 1000.0;
+    }
+
+    double snapshotCost(status_snapshot::Reader& reader)
+    {
+        status_snapshot::Status status;
+        int failures = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < SNAPSHOT_READS; ++i)
+        {
+            if (!reader.read(status))
+            {
+                ++failures;
+            }
+        }
+        double cost = double(timer.nsecsElapsed()) / SNAPSHOT_READS / 1000.0;
+        EXPECT_EQ(0, failures);
+        return cost;
+    }
+};
+
+TEST_F(BenchmarkStatusSnapshot, SnapshotAgainstDBus)
+{
+    setGlobalConnectedState(NM_STATE_CONNECTED_GLOBAL);
+    ASSERT_NO_THROW(startIndicator());
+
+    status_snapshot::Reader reader;
+    status_snapshot::Status status;
+    ASSERT_TRUE(reader.read(status));
+    EXPECT_EQ(status_snapshot::Connectivity::online, status.connectivity);
+
+    double dbus = dbusCost();
+    double snapshot = snapshotCost(reader);
+
+    cout << "status read, D-Bus:    " << dbus << " us" << endl;
+    cout << "status read, snapshot: " << snapshot << " us" << endl;
+
+    RecordProperty("DBusNs", int(dbus * 1000));
+    RecordProperty("SnapshotNs", int(snapshot * 1000));
+}
+
+}
@@ -18,6 +18,7 @@ __copyright__ = '(c) 2012 Canonical Ltd.'
 __license__ = 'LGPL 3+'
 
 import dbus
+import time
 import uuid
 import binascii
 
@@ -39,6 +40,9 @@ AGENT_MANAGER_OBJ = '/org/freedesktop/NetworkManager/AgentManager'
 AGENT_MANAGER_IFACE = 'org.freedesktop.NetworkManager.AgentManager'
 SYSTEM_BUS = True
 
+# Seconds each connection's GetSettings takes to answer
+GET_SETTINGS_DELAY = 0
+
 
 class NMState:
     '''Global state
@@ -251,6 +255,13 @@ def SetProperty(self, path, iface, name, value):
     obj.EmitSignal(iface, 'PropertiesChanged', 'a{sv}', [{name: value}])
 
 
+@dbus.service.method(MOCK_IFACE,
+                     in_signature='d', out_signature='')
+def SetGetSettingsDelay(self, seconds):
+    global GET_SETTINGS_DELAY
+    GET_SETTINGS_DELAY = seconds
+
+
 @dbus.service.method(MOCK_IFACE,
                      in_signature='u', out_signature='')
 def SetGlobalConnectionState(self, state):
@@ -791,6 +802,10 @@ def ConnectionUpdate(self, settings):
 
 
 def ConnectionGetSettings(self):
+    # Holds up everything else the mock has been asked to do meanwhile
+    if GET_SETTINGS_DELAY:
+        time.sleep(GET_SETTINGS_DELAY)
+
     # Deep copy the settings with the secrets stripped
     # out. (NOTE: copy.deepcopy doesn't work with dbus
     # types).
@@ -43,6 +43,7 @@ IndicatorNetworkTestBase::~IndicatorNetworkTestBase()
 void IndicatorNetworkTestBase::SetUp()
 {
     qputenv("INDICATOR_NETWORK_SETTINGS_PATH", temporaryDir.path().toUtf8().constData());
+    qputenv("INDICATOR_NETWORK_STATUS_SNAPSHOT_PATH", (temporaryDir.path() + "/status").toUtf8().constData());
 
     if (qEnvironmentVariableIsSet("TEST_WITH_BUSTLE"))
     {
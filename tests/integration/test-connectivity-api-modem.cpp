@@ -24,6 +24,8 @@
 #include <dbus-types.h>
 #include <NetworkManagerSettingsInterface.h>
 
+#include <QDBusInterface>
+#include <QDBusReply>
 #include <QDebug>
 #include <QTestEventLoop>
 
@@ -90,6 +92,34 @@ using namespace connectivityqt;
 namespace
 {
 
+class InterfacesAddedSpy: public QObject
+{
+    Q_OBJECT
+
+public:
+    InterfacesAddedSpy(const QDBusConnection& connection)
+    {
+        connection.connect(DBusTypes::DBUS_NAME,
+                           DBusTypes::OBJECT_MANAGER_PATH,
+                           "org.freedesktop.DBus.ObjectManager",
+                           "InterfacesAdded",
+                           this,
+                           SLOT(interfacesAdded(const QDBusObjectPath&, const QVariantDictMap&)));
+    }
+
+    QList<QPair<QDBusObjectPath, QVariantDictMap>> added;
+
+public Q_SLOTS:
+    void interfacesAdded(const QDBusObjectPath& path, const QVariantDictMap& interfaces)
+    {
+        added << qMakePair(path, interfaces);
+        Q_EMIT received();
+    }
+
+Q_SIGNALS:
+    void received();
+};
+
 class TestConnectivityApiModem: public IndicatorNetworkTestBase
 {
 protected:
@@ -319,4 +349,77 @@ TEST_F(TestConnectivityApiModem, ModemProperties)
     EXPECT_TRUE(modem->sim());
 }
 
+TEST_F(TestConnectivityApiModem, ObjectManager)
+{
+    // Add a physical device to use for the connection
+    setGlobalConnectedState(NM_STATE_CONNECTED_GLOBAL);
+    createWiFiDevice(NM_DEVICE_STATE_ACTIVATED);
+
+    // Start the indicator
+    ASSERT_NO_THROW(startIndicator());
+
+    // Connect the the service
+    auto connectivity(newConnectivity());
+
+    // Get the modems model
+    auto modems = getSortedModems(*connectivity);
+
+    DEFINE_MODEL_LISTENERS
+
+    WAIT_FOR_ROW_COUNT(rowsInsertedSpy, modems, 1)
+
+    QDBusInterface objectManager(DBusTypes::DBUS_NAME,
+                                 DBusTypes::OBJECT_MANAGER_PATH,
+                                 "org.freedesktop.DBus.ObjectManager",
+                                 dbusTestRunner.sessionConnection());
+    QDBusReply<QManagedObjectMap> reply = objectManager.call("GetManagedObjects");
+    ASSERT_TRUE(reply.isValid()) << reply.error().message().toStdString();
+
+    auto objects = reply.value();
+    QVariantMap modemProperties;
+    QMap<QDBusObjectPath, QVariantMap> simProperties;
+    for (auto it = objects.cbegin(); it != objects.cend(); ++it)
+    {
+        if (it->contains("com.ubuntu.connectivity1.Modem"))
+        {
+            modemProperties = it->value("com.ubuntu.connectivity1.Modem");
+        }
+        if (it->contains("com.ubuntu.connectivity1.Sim"))
+        {
+            simProperties[it.key()] = it->value("com.ubuntu.connectivity1.Sim");
+        }
+    }
+
+    EXPECT_EQ(1, modemProperties["Index"].toInt());
+    EXPECT_EQ("12345678-1234-1234-1234-000000000000", modemProperties["Serial"].toString().toStdString());
+    ASSERT_EQ(1, simProperties.size());
+    auto simPath = qvariant_cast<QDBusObjectPath>(modemProperties["Sim"]);
+    ASSERT_TRUE(simProperties.contains(simPath));
+    EXPECT_EQ("893581234000000000000", simProperties[simPath]["Iccid"].toString().toStdString());
+
+    InterfacesAddedSpy interfacesAddedSpy(dbusTestRunner.sessionConnection());
+    QSignalSpy receivedSpy(&interfacesAddedSpy, SIGNAL(received()));
+
+    createModem("ril_1");
+
+    WAIT_FOR_ROW_COUNT(rowsInsertedSpy, modems, 2)
+    while (interfacesAddedSpy.added.size() < 2 && receivedSpy.wait())
+    {
+    }
+
+    QStringList addedInterfaces;
+    for (const auto& added: interfacesAddedSpy.added)
+    {
+        addedInterfaces << added.second.keys();
+        if (added.second.contains("com.ubuntu.connectivity1.Modem"))
+        {
+            EXPECT_EQ(2, added.second["com.ubuntu.connectivity1.Modem"]["Index"].toInt());
+        }
+    }
+    addedInterfaces.sort();
+    EXPECT_EQ(QStringList({"com.ubuntu.connectivity1.Modem", "com.ubuntu.connectivity1.Sim"}), addedInterfaces);
 }
+
+}
+
+#include "test-connectivity-api-modem.moc"
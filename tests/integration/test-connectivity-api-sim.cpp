@@ -18,6 +18,7 @@
  *   Pete Woods <pete.woods@canonical.com>
  */
 
+#include <connectivityqt/modems-list-model.h>
 #include <connectivityqt/sim.h>
 #include <connectivityqt/sims-list-model.h>
 #include <indicator-network-test-base.h>
@@ -371,5 +372,65 @@ TEST_F(TestConnectivityApiSim, RoamingAllowed)
 //   test that roaming allowed has an effect.
 }
 
+/*
+ * The modem and the SIM share one set of oFono proxies. Whichever of them
+ * picks a proxy up second finds it already populated, and must not wait for
+ * change signals that have already been and gone.
+ */
+TEST_F(TestConnectivityApiSim, LateSimTakesInitialDataFromSharedProxy)
+{
+    auto modem2 = createModem("ril_1");
+    setConnectionManagerProperty(modem2, "Powered", true);
+    setSimManagerProperty(modem2, "CardIdentifier", "");
+
+    // Start the indicator
+    ASSERT_NO_THROW(startIndicator());
+
+    // Connect the the service
+    auto connectivity(newConnectivity());
+
+    // Both modems are up, so their proxies have fetched all their properties
+    QSignalSpy modemsRowsInsertedSpy(connectivity->modems(), SIGNAL(rowsInserted(const QModelIndex &, int, int)));
+    WAIT_FOR_ROW_COUNT(modemsRowsInsertedSpy, connectivity->modems(), 2)
+
+    QSignalSpy mobileDataEnabledSpy(connectivity.get(), SIGNAL(mobileDataEnabledUpdated(bool)));
+    QSignalSpy simForMobileDataSpy(connectivity.get(), SIGNAL(simForMobileDataUpdated(Sim*)));
+
+    // The new SIM adopts the connection manager the modem already has
+    setSimManagerProperty(modem2, "CardIdentifier", "893581234000000000001");
+
+    // With no settings, its powered connection manager turns mobile data on
+    while (!connectivity->mobileDataEnabled())
+    {
+        ASSERT_TRUE(mobileDataEnabledSpy.wait());
+    }
+    while (!connectivity->simForMobileData())
+    {
+        ASSERT_TRUE(simForMobileDataSpy.wait());
+    }
+    EXPECT_EQ("893581234000000000001", connectivity->simForMobileData()->iccid());
+}
+
+TEST_F(TestConnectivityApiSim, ModemWithoutSimBecomesReady)
+{
+    auto modem2 = createModem("ril_1");
+    setSimManagerProperty(modem2, "Present", false);
+    setSimManagerProperty(modem2, "CardIdentifier", "");
+
+    // Start the indicator
+    ASSERT_NO_THROW(startIndicator());
+
+    // Connect the the service
+    auto connectivity(newConnectivity());
+
+    // The modem with no SIM is only listed once it knows the SIM is absent
+    QSignalSpy modemsRowsInsertedSpy(connectivity->modems(), SIGNAL(rowsInserted(const QModelIndex &, int, int)));
+    WAIT_FOR_ROW_COUNT(modemsRowsInsertedSpy, connectivity->modems(), 2)
+
+    auto modems = getSortedModems(*connectivity);
+    EXPECT_FALSE(modems->data(modems->index(1, 0), ModemsListModel::RoleSim)
+            .value<connectivityqt::Sim*>());
+}
+
 
 }
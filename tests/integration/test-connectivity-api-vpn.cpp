@@ -296,6 +296,42 @@ TEST_F(TestConnectivityApiVpn, FollowsVpnState)
     EXPECT_EQ(CSL({{"banana", {false, true}}}), vpnList(*sortedVpnConnections));
 }
 
+TEST_F(TestConnectivityApiVpn, KeepsChangesMadeWhileConnectionsAreAdded)
+{
+    setGlobalConnectedState(NM_STATE_CONNECTED_GLOBAL);
+    auto device = createWiFiDevice(NM_DEVICE_STATE_ACTIVATED);
+
+    ASSERT_NO_THROW(startIndicator());
+
+    auto connectivity(newConnectivity());
+    auto sortedVpnConnections = getSortedVpnConnections(*connectivity);
+    EXPECT_EQ(CSL(), vpnList(*sortedVpnConnections));
+
+    QSignalSpy rowsInsertedSpy(sortedVpnConnections.get(), SIGNAL(rowsInserted(const QModelIndex &, int, int)));
+
+    // Rename each connection straight after adding it, so the rename goes
+    // out around the time the client's GetManagedObjects call is answered
+    for (const QString& id: {"apple", "banana", "coconut"})
+    {
+        auto path = createVpnConnection(id);
+        OrgFreedesktopNetworkManagerSettingsConnectionInterface interface(
+                NM_DBUS_SERVICE, path, dbusTestRunner.systemConnection());
+        QVariantDictMap settings = interface.GetSettings();
+        settings["connection"]["id"] = id + "2";
+        interface.Update(settings).waitForFinished();
+    }
+
+    WAIT_FOR_SIGNALS(rowsInsertedSpy, 3);
+
+    // A rename caught by the connection's own cache still takes a moment
+    CSL expected({{"apple2", {false, true}}, {"banana2", {false, true}}, {"coconut2", {false, true}}});
+    for (int i = 0; i < 50 && vpnList(*sortedVpnConnections) != expected; ++i)
+    {
+        QTestEventLoop::instance().enterLoopMSecs(100);
+    }
+    EXPECT_EQ(expected, vpnList(*sortedVpnConnections));
+}
+
 TEST_F(TestConnectivityApiVpn, UpdatesVpnState)
 {
     // Add a single VPN configuration
@@ -517,6 +553,62 @@ TEST_F(TestConnectivityApiVpn, WritesOpenvpnProperties)
     EXPECT_EQ("remote2", vpnData["remote"]);
 }
 
+TEST_F(TestConnectivityApiVpn, EditDuringSettingsRefreshKeepsEarlierEdit)
+{
+    auto appleConnection = createVpnConnection("apple", "org.freedesktop.NetworkManager.openvpn",
+    {
+        {"connection-type", "tls"},
+        {"remote", "remotey"},
+        {"ca", "/my/ca.crt"},
+        {"cert", "/my/cert.crt"},
+        {"cert-pass-flags", "1"},
+        {"key", "/my/key.key"}
+    });
+
+    setGlobalConnectedState(NM_STATE_CONNECTED_GLOBAL);
+    auto device = createWiFiDevice(NM_DEVICE_STATE_ACTIVATED);
+
+    ASSERT_NO_THROW(startIndicator());
+
+    auto connectivity(newConnectivity());
+    auto vpnConnections = connectivity->vpnConnections();
+    ASSERT_EQ(CSL({{"apple", {false, true}}}), vpnList(*vpnConnections));
+    auto connection = getOpenvpnConnection(vpnConnections, 0);
+    ASSERT_TRUE(connection);
+
+    OrgFreedesktopNetworkManagerSettingsConnectionInterface appleInterface(
+            NM_DBUS_SERVICE, appleConnection,
+            dbusTestRunner.systemConnection());
+    QSignalSpy appleInterfaceSpy(&appleInterface, SIGNAL(Updated()));
+    QSignalSpy caChangedSpy(connection, SIGNAL(caChanged(const QString &)));
+
+    // The refresh after the first update is slow to come back, so the
+    // second edit lands before it
+    auto delay = QDBusMessage::createMethodCall(
+            NM_DBUS_SERVICE, NM_DBUS_PATH, "org.freedesktop.DBus.Mock",
+            "SetGetSettingsDelay");
+    delay << 1.0;
+    ASSERT_TRUE(dbusTestRunner.systemConnection().call(delay).type() != QDBusMessage::ErrorMessage);
+
+    connection->setRemote("remote2");
+    WAIT_FOR_SIGNALS(appleInterfaceSpy, 1);
+
+    connection->setCa("/my/ca2.crt");
+    WAIT_FOR_SIGNALS(appleInterfaceSpy, 2);
+    WAIT_FOR_SIGNALS(caChangedSpy, 1);
+
+    delay.setArguments({0.0});
+    dbusTestRunner.systemConnection().call(delay);
+
+    QStringMap vpnData;
+    QVariantDictMap settings = appleInterface.GetSettings();
+    settings["vpn"]["data"].value<QDBusArgument>() >> vpnData;
+
+    EXPECT_EQ("remote2", vpnData["remote"]);
+    EXPECT_EQ("/my/ca2.crt", vpnData["ca"]);
+    EXPECT_EQ("remote2", connection->remote());
+}
+
 TEST_F(TestConnectivityApiVpn, CreatesOpenvpnConnection)
 {
     setGlobalConnectedState(NM_STATE_CONNECTED_GLOBAL);
@@ -581,5 +673,49 @@ TEST_F(TestConnectivityApiVpn, DeletesVpnConnection)
     EXPECT_EQ(0, vpnConnections->rowCount(QModelIndex()));
 }
 
+TEST_F(TestConnectivityApiVpn, SurvivesFlappingActiveConnections)
+{
+    auto appleConnection = createVpnConnection("apple");
+    auto bananaConnection = createVpnConnection("banana");
+
+    setGlobalConnectedState(NM_STATE_CONNECTED_GLOBAL);
+    auto device = createWiFiDevice(NM_DEVICE_STATE_ACTIVATED);
+
+    // Start the indicator
+    ASSERT_NO_THROW(startIndicator());
+
+    // Connect the the service
+    auto connectivity(newConnectivity());
+
+    auto sortedVpnConnections = getSortedVpnConnections(*connectivity);
+    ASSERT_EQ(CSL({{"apple", {false, true}}, {"banana", {false, true}}}), vpnList(*sortedVpnConnections));
+
+    QSignalSpy dataChangedSpy(sortedVpnConnections.get(), SIGNAL(dataChanged(const QModelIndex &, const QModelIndex &, const QVector<int> &)));
+
+    // Many short-lived active connections, without waiting for any of them
+    for (int i = 0; i < 100; ++i)
+    {
+        auto activeConnection = createActiveConnection(QString::number(i), device, appleConnection, "/");
+        removeActiveConnection(device, activeConnection);
+    }
+
+    // Only the last activation should count
+    auto activeConnection = createActiveConnection("final", device, bananaConnection, "/");
+
+    CSL expected({{"apple", {false, false}}, {"banana", {true, true}}});
+    while (vpnList(*sortedVpnConnections) != expected)
+    {
+        ASSERT_TRUE(dataChangedSpy.wait()) << "Waiting for the flapping to settle";
+    }
+
+    dataChangedSpy.clear();
+    removeActiveConnection(device, activeConnection);
+
+    expected = CSL({{"apple", {false, true}}, {"banana", {false, true}}});
+    while (vpnList(*sortedVpnConnections) != expected)
+    {
+        ASSERT_TRUE(dataChangedSpy.wait()) << "Waiting for the last connection to go away";
+    }
+}
 
 }
@@ -24,6 +24,8 @@
 #include <QDebug>
 #include <QTestEventLoop>
 
+#include <algorithm>
+
 using namespace std;
 using namespace testing;
 using namespace connectivityqt;
@@ -737,6 +739,71 @@ TEST_F(TestConnectivityApi, InsecureHotspotConfig)
     }
 }
 
+TEST_F(TestConnectivityApi, HotspotReactivatedWhenBooted)
+{
+    setGlobalConnectedState(NM_STATE_DISCONNECTED);
+    auto device = createWiFiDevice(NM_DEVICE_STATE_DISCONNECTED);
+
+    // Start the indicator
+    ASSERT_NO_THROW(startIndicator());
+
+    auto& nmMock = dbusMock.mockInterface(NM_DBUS_SERVICE,
+                           NM_DBUS_PATH,
+                           NM_DBUS_INTERFACE,
+                           QDBusConnection::SystemBus);
+    QSignalSpy nmMockCallSpy(
+                           &nmMock,
+                           SIGNAL(MethodCalled(const QString &, const QVariantList &)));
+
+    OrgFreedesktopNetworkManagerSettingsInterface settings(
+            NM_DBUS_SERVICE, NM_DBUS_PATH_SETTINGS, dbusTestRunner.systemConnection());
+    QSignalSpy settingsNewConnectionSpy(
+                           &settings,
+                           SIGNAL(NewConnection(const QDBusObjectPath &)));
+
+    // Connect the the service
+    auto connectivity(newConnectivity());
+
+    QSignalSpy enabledSpy(connectivity.get(), SIGNAL(hotspotEnabledUpdated(bool)));
+
+    connectivity->setHotspotPassword("the password");
+    connectivity->setHotspotEnabled(true);
+
+    if (enabledSpy.empty())
+    {
+        ASSERT_TRUE(enabledSpy.wait());
+    }
+    EXPECT_TRUE(connectivity->hotspotEnabled());
+
+    if (settingsNewConnectionSpy.empty())
+    {
+        ASSERT_TRUE(settingsNewConnectionSpy.wait());
+    }
+    auto connectionPath = qvariant_cast<QDBusObjectPath>(settingsNewConnectionSpy.first().first());
+
+    // Something else boots our connection off the device
+    nmMockCallSpy.clear();
+    removeActiveConnection(device, "/org/freedesktop/NetworkManager/ActiveConnection/0");
+
+    // The mock reports its own methods too, so wait for the one we want
+    auto activated = [&nmMockCallSpy]()
+    {
+        return any_of(nmMockCallSpy.begin(), nmMockCallSpy.end(), [](const QVariantList& call)
+        {
+            return call.first().toString() == "ActivateConnection";
+        });
+    };
+    while (!activated())
+    {
+        ASSERT_TRUE(nmMockCallSpy.wait());
+    }
+
+    auto call = getMethodCall(nmMockCallSpy, "ActivateConnection");
+    EXPECT_EQ(connectionPath, qvariant_cast<QDBusObjectPath>(call.at(0)));
+    EXPECT_EQ(device, qvariant_cast<QDBusObjectPath>(call.at(1)).path());
+    EXPECT_TRUE(connectivity->hotspotEnabled());
+}
+
 TEST_F(TestConnectivityApi, HotspotModemAvailable)
 {
     setGlobalConnectedState(NM_STATE_DISCONNECTED);
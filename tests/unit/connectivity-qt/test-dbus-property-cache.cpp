@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <connectivityqt/internal/dbus-property-cache.h>
+
+#include <libqtdbustest/DBusTestRunner.h>
+#include <QDBusMessage>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSignalSpy>
+#include <QThread>
+#include <QTimer>
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+using namespace std;
+using namespace testing;
+using namespace QtDBusTest;
+using namespace connectivityqt::internal;
+
+namespace
+{
+
+static const QString SERVICE("com.example.SlowService");
+static const QString INTERFACE("com.example.Test");
+static const QString PATH("/com/example/Test");
+
+// How long the remote side takes to answer every property read
+static constexpr int DELAY_MS = 500;
+
+class SlowService: public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.example.Test")
+    Q_PROPERTY(QString Value READ value)
+
+public:
+    QString value() const
+    {
+        ++m_reads;
+        QThread::msleep(DELAY_MS);
+        QMutexLocker lock(&m_mutex);
+        return m_value;
+    }
+
+    void setValue(const QString& value)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_value = value;
+    }
+
+    mutable atomic<int> m_reads{0};
+
+protected:
+    mutable QMutex m_mutex;
+
+    QString m_value = "first";
+};
+
+/**
+ * Records the longest gap between ticks of a short timer, i.e. the longest
+ * time the thread it lives on was unable to service its event loop.
+ */
+class Heartbeat
+{
+public:
+    Heartbeat()
+    {
+        m_timer.setInterval(10);
+        QObject::connect(&m_timer, &QTimer::timeout, [this]()
+        {
+            m_maxGap = max(m_maxGap, m_elapsed.restart());
+        });
+        m_elapsed.start();
+        m_timer.start();
+    }
+
+    qint64 maxGap() const
+    {
+        return m_maxGap;
+    }
+
+protected:
+    QTimer m_timer;
+
+    QElapsedTimer m_elapsed;
+
+    qint64 m_maxGap = 0;
+};
+
+class TestDBusPropertyCache: public Test
+{
+protected:
+    void SetUp() override
+    {
+        m_serviceConnection.reset(new QDBusConnection(
+                QDBusConnection::connectToBus(dbusTestRunner.sessionBus(), "slow-service")));
+        ASSERT_TRUE(m_serviceConnection->isConnected());
+
+        m_worker.start();
+        m_service.moveToThread(&m_worker);
+
+        ASSERT_TRUE(m_serviceConnection->registerObject(PATH, &m_service, QDBusConnection::ExportAllProperties));
+        ASSERT_TRUE(m_serviceConnection->registerService(SERVICE));
+    }
+
+    void TearDown() override
+    {
+        m_serviceConnection->unregisterObject(PATH);
+        m_serviceConnection->unregisterService(SERVICE);
+        m_serviceConnection.reset();
+        QDBusConnection::disconnectFromBus("slow-service");
+
+        m_worker.quit();
+        m_worker.wait();
+    }
+
+    void invalidate(const QStringList& names)
+    {
+        auto signal = QDBusMessage::createSignal(PATH, "org.freedesktop.DBus.Properties", "PropertiesChanged");
+        signal << INTERFACE << QVariantMap() << names;
+        m_serviceConnection->send(signal);
+    }
+
+    DBusTestRunner dbusTestRunner;
+
+    QThread m_worker;
+
+    SlowService m_service;
+
+    unique_ptr<QDBusConnection> m_serviceConnection;
+};
+
+TEST_F(TestDBusPropertyCache, NeverBlocksTheCallingThread)
+{
+    Heartbeat heartbeat;
+
+    QElapsedTimer constructing;
+    constructing.start();
+    DBusPropertyCache cache(SERVICE, INTERFACE, PATH, dbusTestRunner.sessionConnection());
+    EXPECT_LT(constructing.elapsed(), DELAY_MS / 2);
+    EXPECT_FALSE(cache.isInitialized());
+    EXPECT_FALSE(cache.get("Value").isValid());
+
+    QSignalSpy initializedSpy(&cache, SIGNAL(initialized()));
+    QSignalSpy changedSpy(&cache, SIGNAL(propertyChanged(const QString&, const QVariant&)));
+    ASSERT_TRUE(initializedSpy.wait(DELAY_MS * 10));
+
+    EXPECT_TRUE(cache.isInitialized());
+    EXPECT_EQ(QString("first"), cache.get("Value").toString());
+    EXPECT_LT(heartbeat.maxGap(), DELAY_MS / 2);
+    EXPECT_EQ(1, m_service.m_reads);
+
+    // Invalidated properties are re-fetched in the background as well
+    changedSpy.clear();
+    m_service.setValue("second");
+    invalidate({"Value"});
+    ASSERT_TRUE(changedSpy.wait(DELAY_MS * 10));
+
+    ASSERT_EQ(1, changedSpy.size());
+    EXPECT_EQ(QString("Value"), changedSpy.first().first().toString());
+    EXPECT_EQ(QString("second"), cache.get("Value").toString());
+    EXPECT_LT(heartbeat.maxGap(), DELAY_MS / 2);
+    EXPECT_EQ(2, m_service.m_reads);
+    EXPECT_EQ(1, initializedSpy.size());
+}
+
+}
+
+#include "test-dbus-property-cache.moc"
@@ -23,6 +23,7 @@
 #include <menumodel-cpp/action-group-exporter.h>
 #include <menumodel-cpp/action-group.h>
 #include <menumodel-cpp/menu-exporter.h>
+#include <menumodel-cpp/menu-merger.h>
 #include <menumodel-cpp/menu.h>
 
 #include <libqtdbustest/DBusTestRunner.h>
@@ -156,4 +157,40 @@ TEST_F(TestMenuExporter, ParameterizedActionActivation)
     EXPECT_EQ("hello", v.as<string>());
 }
 
+TEST_F(TestMenuExporter, MenuMergerInsert)
+{
+    auto first = make_shared<Menu>();
+    first->append(make_shared<MenuItem>("Apple", "prefix.apple"));
+    auto second = make_shared<Menu>();
+    second->append(make_shared<MenuItem>("Banana", "prefix.banana"));
+    second->append(make_shared<MenuItem>("Cherry", "prefix.cherry"));
+    auto third = make_shared<Menu>();
+    third->append(make_shared<MenuItem>("Damson", "prefix.damson"));
+
+    auto merger = make_shared<MenuMerger>();
+    merger->append(first);
+    merger->append(third);
+    merger->insert(second, 1);
+    menuExporter.reset(new MenuExporter(sessionBus, "/menus/path", merger));
+
+    // Items added afterwards must land in the right place
+    first->append(make_shared<MenuItem>("Apricot", "prefix.apricot"));
+
+    EXPECT_MATCHRESULT(mh::MenuMatcher(parameters("prefix"))
+        .item(mh::MenuItemMatcher().label("Apple"))
+        .item(mh::MenuItemMatcher().label("Apricot"))
+        .item(mh::MenuItemMatcher().label("Banana"))
+        .item(mh::MenuItemMatcher().label("Cherry"))
+        .item(mh::MenuItemMatcher().label("Damson"))
+        .match());
+
+    merger->remove(second);
+
+    EXPECT_MATCHRESULT(mh::MenuMatcher(parameters("prefix"))
+        .item(mh::MenuItemMatcher().label("Apple"))
+        .item(mh::MenuItemMatcher().label("Apricot"))
+        .item(mh::MenuItemMatcher().label("Damson"))
+        .match());
+}
+
 } // namespace
@@ -27,6 +27,7 @@
 
 #include <QCoreApplication>
 #include <QDBusConnection>
+#include <QStringList>
 #include <iostream>
 #include <memory>
 
@@ -41,16 +42,23 @@ public:
     ~DummyCredentialStore() {
     }
 
+    // One line for each call, so the tests can see how secrets are batched
     void
-    save (const QString&, const QString&, const QString&, const QString&,
-          const QString&)
+    save (const QString& uuid, const Secrets& secrets)
     {
+        QStringList saved;
+        for (const auto& secret: secrets)
+        {
+            saved << secret.settingName + "/" + secret.settingKey + "=" + secret.secret;
+        }
+        cout << "Saved " << uuid.toStdString() << ": "
+                << saved.join(", ").toStdString() << endl;
     }
 
-    QMap<QString, QString>
-    get (const QString&, const QString&)
+    void
+    get (const QString&, const QString&, GetCallback callback, ErrorCallback)
     {
-        return QMap<QString, QString> ();
+        callback(QMap<QString, QString> ());
     }
 
     void
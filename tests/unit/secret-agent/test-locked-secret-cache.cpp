@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <agent/LockedSecretCache.h>
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace testing;
+using namespace agent;
+
+namespace
+{
+
+class TestLockedSecretCache: public Test
+{
+protected:
+    void SetUp() override
+    {
+        // Nothing is cached where memory can't be locked, which leaves
+        // nothing to test
+        m_enabled = LockedSecretCache().isEnabled();
+        if (!m_enabled)
+        {
+            cout << "Unable to lock memory, skipping" << endl;
+        }
+    }
+
+    QMap<QString, QString> secrets(const QString& password)
+    {
+        return {{"psk", password}, {"wep-key0", QString()}};
+    }
+
+    bool m_enabled = false;
+};
+
+TEST_F(TestLockedSecretCache, FindsWhatWasInserted)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    LockedSecretCache cache;
+
+    QMap<QString, QString> found;
+    EXPECT_FALSE(cache.find("uuid", "802-11-wireless-security", found));
+
+    cache.insert("uuid", "802-11-wireless-security", secrets("päßwörd"));
+    ASSERT_TRUE(cache.find("uuid", "802-11-wireless-security", found));
+    EXPECT_EQ(secrets("päßwörd"), found);
+
+    EXPECT_FALSE(cache.find("uuid", "vpn", found));
+    EXPECT_FALSE(cache.find("other", "802-11-wireless-security", found));
+}
+
+TEST_F(TestLockedSecretCache, InsertReplaces)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    LockedSecretCache cache;
+
+    cache.insert("uuid", "vpn", secrets("old"));
+    cache.insert("uuid", "vpn", secrets("new"));
+
+    QMap<QString, QString> found;
+    ASSERT_TRUE(cache.find("uuid", "vpn", found));
+    EXPECT_EQ(secrets("new"), found);
+}
+
+TEST_F(TestLockedSecretCache, RemovesBySettingAndByConnection)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    LockedSecretCache cache;
+
+    cache.insert("a", "vpn", secrets("1"));
+    cache.insert("a", "gsm", secrets("2"));
+    cache.insert("b", "vpn", secrets("3"));
+
+    QMap<QString, QString> found;
+    cache.remove("a", "vpn");
+    EXPECT_FALSE(cache.find("a", "vpn", found));
+    EXPECT_TRUE(cache.find("a", "gsm", found));
+
+    cache.remove("a");
+    EXPECT_FALSE(cache.find("a", "gsm", found));
+    EXPECT_TRUE(cache.find("b", "vpn", found));
+
+    cache.clear();
+    EXPECT_FALSE(cache.find("b", "vpn", found));
+}
+
+TEST_F(TestLockedSecretCache, EvictsLeastRecentlyUsed)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    LockedSecretCache cache(2);
+
+    QMap<QString, QString> found;
+    cache.insert("a", "vpn", secrets("1"));
+    cache.insert("b", "vpn", secrets("2"));
+    EXPECT_TRUE(cache.find("a", "vpn", found));
+
+    cache.insert("c", "vpn", secrets("3"));
+    EXPECT_TRUE(cache.find("a", "vpn", found));
+    EXPECT_FALSE(cache.find("b", "vpn", found));
+    EXPECT_TRUE(cache.find("c", "vpn", found));
+}
+
+TEST_F(TestLockedSecretCache, OnlyChangedSecretsNeedSaving)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    LockedSecretCache cache;
+    cache.insert("uuid", "802-1x", {{"password", "same"}, {"pin", "1234"}});
+
+    CredentialStore::Secrets secrets {
+        {"802-1x", "password", "Password", "same"},
+        {"802-1x", "pin", "PIN", "4321"},
+        {"802-1x", "private-key-password", "Key password", "new"},
+        {"gsm", "pin", "PIN", "1234"}
+    };
+
+    auto changed = cache.changed("uuid", secrets);
+    ASSERT_EQ(3, changed.size());
+    EXPECT_EQ("pin", changed.at(0).settingKey);
+    EXPECT_EQ("private-key-password", changed.at(1).settingKey);
+    EXPECT_EQ("gsm", changed.at(2).settingName);
+
+    // Nothing changed, nothing to write
+    EXPECT_TRUE(cache.changed("uuid", {secrets.first()}).isEmpty());
+    EXPECT_EQ(1, cache.changed("other", {secrets.first()}).size());
+}
+
+TEST_F(TestLockedSecretCache, SkipsSecretsTooLargeForAnEntry)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    LockedSecretCache cache;
+
+    QMap<QString, QString> found;
+    cache.insert("uuid", "vpn", secrets(QString(LockedSecretCache::ENTRY_SIZE, 'x')));
+    EXPECT_FALSE(cache.find("uuid", "vpn", found));
+}
+
+}
@@ -92,6 +92,16 @@ protected:
 		return connection;
 	}
 
+	// The next line the agent writes, such as a save reported by its store
+	QString readLine() {
+		while (!secretAgent.canReadLine()) {
+			if (!secretAgent.waitForReadyRead(5000)) {
+				return QString();
+			}
+		}
+		return QString::fromUtf8(secretAgent.readLine()).trimmed();
+	}
+
 	QVariantDictMap expected(const QString &keyManagement,
 			const QString &keyName, const QString &password) {
 
@@ -301,16 +311,16 @@ TEST_F(TestSecretAgent, CancelGetSecrets) {
 	EXPECT_EQ("CloseNotification", closecall.at(0).toString().toStdString());
 }
 
-/* Ensures that if we request secrets twice we close the notification
-   for the first request */
+/* Ensures that a second interactive request waits for the first one's
+   notification to go before showing its own */
 TEST_F(TestSecretAgent, MultiSecrets) {
 	QSignalSpy notificationSpy(notificationsInterface.data(), SIGNAL(MethodCalled(const QString &, const QVariantList &)));
 
-	agentInterface->GetSecrets(
+	QDBusPendingReply<QVariantDictMap> first(agentInterface->GetSecrets(
 			connection(SecretAgent::NM_KEY_MGMT_WPA_PSK),
 			QDBusObjectPath("/connection/foo"),
 			SecretAgent::NM_WIRELESS_SECURITY_SETTING_NAME, QStringList(),
-			5);
+			5));
 
 	if (notificationSpy.empty())
 	{
@@ -329,21 +339,58 @@ TEST_F(TestSecretAgent, MultiSecrets) {
 			SecretAgent::NM_WIRELESS_SECURITY_SETTING_NAME, QStringList(),
 			5);
 
-	if (notificationSpy.empty())
+	EXPECT_FALSE(notificationSpy.wait(200));
+
+	agentInterface->CancelGetSecrets(QDBusObjectPath("/connection/foo"),
+			SecretAgent::NM_WIRELESS_SECURITY_SETTING_NAME);
+
+	first.waitForFinished();
+	ASSERT_TRUE(first.isError());
+	EXPECT_EQ("org.freedesktop.NetworkManager.SecretAgent.AgentCanceled", first.error().name().toStdString());
+
+	while (notificationSpy.size() < 2)
 	{
 		ASSERT_TRUE(notificationSpy.wait());
 	}
-	if (notificationSpy.size() == 1)
+
+	const QVariantList &closecall(notificationSpy.at(0));
+	EXPECT_EQ("CloseNotification", closecall.at(0).toString().toStdString());
+
+	const QVariantList &newnotify(notificationSpy.at(1));
+	EXPECT_EQ("Notify", newnotify.at(0).toString().toStdString());
+}
+
+/* Ensures that identical concurrent requests share one notification and
+   are all answered */
+TEST_F(TestSecretAgent, DuplicateSecrets) {
+	QSignalSpy notificationSpy(notificationsInterface.data(), SIGNAL(MethodCalled(const QString &, const QVariantList &)));
+
+	QList<QDBusPendingReply<QVariantDictMap>> replies;
+	for (int i = 0; i < 2; ++i)
+	{
+		replies << agentInterface->GetSecrets(
+				connection(SecretAgent::NM_KEY_MGMT_WPA_PSK),
+				QDBusObjectPath("/connection/foo"),
+				SecretAgent::NM_WIRELESS_SECURITY_SETTING_NAME, QStringList(),
+				5);
+	}
+
+	if (notificationSpy.empty())
 	{
 		ASSERT_TRUE(notificationSpy.wait());
 	}
+	EXPECT_FALSE(notificationSpy.wait(200));
+	ASSERT_EQ(1, notificationSpy.size());
 
-	ASSERT_EQ(2, notificationSpy.size());
-	const QVariantList &closecall(notificationSpy.at(1));
-	EXPECT_EQ("CloseNotification", closecall.at(0).toString().toStdString());
+	agentInterface->CancelGetSecrets(QDBusObjectPath("/connection/foo"),
+			SecretAgent::NM_WIRELESS_SECURITY_SETTING_NAME);
 
-	const QVariantList &newnotify(notificationSpy.at(0));
-	EXPECT_EQ("Notify", newnotify.at(0).toString().toStdString());
+	for (auto& reply: replies)
+	{
+		reply.waitForFinished();
+		ASSERT_TRUE(reply.isError());
+		EXPECT_EQ("org.freedesktop.NetworkManager.SecretAgent.AgentCanceled", reply.error().name().toStdString());
+	}
 }
 
 TEST_F(TestSecretAgent, SaveSecrets) {
@@ -351,6 +398,53 @@ TEST_F(TestSecretAgent, SaveSecrets) {
 			QDBusObjectPath("/connection/foo")).waitForFinished();
 }
 
+TEST_F(TestSecretAgent, SaveSecretsOf8021xInOneBatch) {
+	QVariantMap conn;
+	conn[SecretAgent::NM_CONNECTION_ID] = "the ssid";
+	conn[SecretAgent::NM_CONNECTION_UUID] = "uuid-8021x";
+	conn[SecretAgent::NM_CONNECTION_TYPE] = "802-11-wireless";
+
+	QVariantMap eap;
+	eap["identity"] = "user";
+	eap[SecretAgent::NM_802_1X_PASSWORD] = "password";
+	eap[SecretAgent::NM_802_1X_PRIVATE_KEY_PASSWORD] = "key password";
+	eap[SecretAgent::NM_802_1X_PIN] = "1234";
+
+	QVariantDictMap connection;
+	connection[SecretAgent::NM_CONNECTION_SETTING_NAME] = conn;
+	connection[SecretAgent::NM_802_1X_SETTING_NAME] = eap;
+
+	agentInterface->SaveSecrets(connection,
+			QDBusObjectPath("/connection/foo")).waitForFinished();
+
+	EXPECT_EQ("Saved uuid-8021x: 802-1x/password=password, 802-1x/pin=1234, "
+			"802-1x/private-key-password=key password", readLine().toStdString());
+	EXPECT_FALSE(secretAgent.waitForReadyRead(200));
+}
+
+TEST_F(TestSecretAgent, SaveSecretsOfVpnInOneBatch) {
+	QVariantMap conn;
+	conn[SecretAgent::NM_CONNECTION_ID] = "the vpn";
+	conn[SecretAgent::NM_CONNECTION_UUID] = "uuid-vpn";
+	conn[SecretAgent::NM_CONNECTION_TYPE] = SecretAgent::NM_VPN_SETTING_NAME;
+
+	QVariantMap vpn;
+	vpn[SecretAgent::NM_VPN_SERVICE_TYPE] = "org.freedesktop.NetworkManager.openvpn";
+	vpn[SecretAgent::NM_VPN_SECRETS] = QVariant::fromValue(QStringMap{
+		{"cert-pass", "cert password"}, {"password", "password"}});
+
+	QVariantDictMap connection;
+	connection[SecretAgent::NM_CONNECTION_SETTING_NAME] = conn;
+	connection[SecretAgent::NM_VPN_SETTING_NAME] = vpn;
+
+	agentInterface->SaveSecrets(connection,
+			QDBusObjectPath("/connection/foo")).waitForFinished();
+
+	EXPECT_EQ("Saved uuid-vpn: vpn/cert-pass=cert password, vpn/password=password",
+			readLine().toStdString());
+	EXPECT_FALSE(secretAgent.waitForReadyRead(200));
+}
+
 TEST_F(TestSecretAgent, DeleteSecrets) {
 	agentInterface->DeleteSecrets(QVariantDictMap(),
 			QDBusObjectPath("/connection/foo")).waitForFinished();
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <status-snapshot/reader.h>
+#include <status-snapshot/writer.h>
+
+#include <QTemporaryDir>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace std;
+using namespace testing;
+using namespace status_snapshot;
+
+namespace
+{
+
+class TestStatusSnapshot: public Test
+{
+protected:
+    static Status allOn()
+    {
+        Status status;
+        status.connectivity = Connectivity::online;
+        status.bandwidthLimited = true;
+        status.flightMode = true;
+        status.wifiEnabled = true;
+        status.modemAvailable = true;
+        status.hotspotEnabled = true;
+        return status;
+    }
+
+    string path() const
+    {
+        return temporaryDir.path().toStdString() + "/indicator-network/status";
+    }
+
+    QTemporaryDir temporaryDir;
+};
+
+TEST_F(TestStatusSnapshot, ReadsWhatWasPublished)
+{
+    Writer writer(path());
+    Reader reader(path());
+
+    Status status;
+    ASSERT_TRUE(reader.read(status));
+    EXPECT_EQ(Status(), status);
+
+    writer.publish(allOn());
+    ASSERT_TRUE(reader.read(status));
+    EXPECT_EQ(allOn(), status);
+
+    auto connecting = allOn();
+    connecting.connectivity = Connectivity::connecting;
+    connecting.wifiEnabled = false;
+    writer.publish(connecting);
+    ASSERT_TRUE(reader.read(status));
+    EXPECT_EQ(connecting, status);
+}
+
+TEST_F(TestStatusSnapshot, NothingToReadWithoutWriter)
+{
+    Reader reader(path());
+
+    Status status;
+    EXPECT_FALSE(reader.read(status));
+
+    {
+        Writer writer(path());
+        writer.publish(allOn());
+        ASSERT_TRUE(reader.read(status));
+        EXPECT_EQ(allOn(), status);
+    }
+
+    EXPECT_FALSE(reader.read(status));
+}
+
+TEST_F(TestStatusSnapshot, FollowsReplacementWriter)
+{
+    Reader reader(path());
+    Status status;
+
+    // A writer that never retires its region, as if it had crashed
+    auto first = make_unique<Writer>(path());
+    first->publish(allOn());
+    ASSERT_TRUE(reader.read(status));
+    EXPECT_EQ(allOn(), status);
+
+    Writer second(path());
+    second.publish(Status());
+    ASSERT_TRUE(reader.read(status));
+    EXPECT_EQ(Status(), status);
+}
+
+TEST_F(TestStatusSnapshot, ConcurrentReadsAreNeverTorn)
+{
+    Writer writer(path());
+    Reader reader(path());
+
+    atomic<bool> stop(false);
+    thread publisher([&]()
+    {
+        bool on = false;
+        while (!stop)
+        {
+            writer.publish(on ? allOn() : Status());
+            on = !on;
+        }
+    });
+
+    int reads = 0;
+    for (int i = 0; i < 1000000; ++i)
+    {
+        Status status;
+        if (reader.read(status))
+        {
+            ++reads;
+            ASSERT_TRUE(status == Status() || status == allOn());
+        }
+    }
+
+    stop = true;
+    publisher.join();
+
+    EXPECT_GT(reads, 0);
+}
+
+}
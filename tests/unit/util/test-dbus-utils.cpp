@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <util/dbus-utils.h>
+
+#include <libqtdbustest/DBusTestRunner.h>
+#include <QSignalSpy>
+#include <QTimer>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace testing;
+using namespace QtDBusTest;
+
+namespace
+{
+
+static const QString PATH("/com/example/Object");
+
+class TestObject
+{
+public:
+    int first() const
+    {
+        return 1;
+    }
+
+    int second() const
+    {
+        return 2;
+    }
+};
+
+enum class Property
+{
+    First,
+    Second
+};
+
+constexpr DBusUtils::PropertyDescriptor<TestObject> PROPERTIES[] =
+{
+    DBUS_UTILS_PROPERTY(TestObject, Property::First, "First", first),
+    DBUS_UTILS_PROPERTY(TestObject, Property::Second, "Second", second)
+};
+
+class PropertiesChangedSpy: public QObject
+{
+    Q_OBJECT
+
+public:
+    PropertiesChangedSpy(QDBusConnection& connection)
+    {
+        connection.connect(QString(), PATH, "org.freedesktop.DBus.Properties",
+                           "PropertiesChanged", this,
+                           SLOT(propertiesChanged(const QString&, const QVariantMap&, const QStringList&)));
+    }
+
+public Q_SLOTS:
+    void propertiesChanged(const QString& interface, const QVariantMap& changed, const QStringList&)
+    {
+        Q_EMIT received(interface, changed);
+    }
+
+Q_SIGNALS:
+    void received(const QString& interface, const QVariantMap& changed);
+};
+
+class TestDBusUtils: public Test
+{
+protected:
+    void SetUp() override
+    {
+        m_listener.reset(new QDBusConnection(
+                QDBusConnection::connectToBus(dbusTestRunner.sessionBus(), "listener")));
+        m_spy.reset(new PropertiesChangedSpy(*m_listener));
+        m_received.reset(new QSignalSpy(m_spy.get(), SIGNAL(received(const QString&, const QVariantMap&))));
+    }
+
+    void TearDown() override
+    {
+        m_received.reset();
+        m_spy.reset();
+        m_listener.reset();
+        QDBusConnection::disconnectFromBus("listener");
+    }
+
+    DBusTestRunner dbusTestRunner;
+
+    TestObject m_object;
+
+    unique_ptr<QDBusConnection> m_listener;
+
+    unique_ptr<PropertiesChangedSpy> m_spy;
+
+    unique_ptr<QSignalSpy> m_received;
+};
+
+TEST_F(TestDBusUtils, BurstIsSentAsOneSignal)
+{
+    const QString interface("com.example.Burst");
+    DBusUtils::CoalescingPolicy policy;
+    policy.window = 100;
+    policy.maxLatency = 1000;
+    DBusUtils::setCoalescingPolicy(interface, policy);
+
+    DBusUtils::PropertyNotifier<TestObject> properties(
+            m_object, PROPERTIES, dbusTestRunner.sessionConnection(), PATH, interface);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        properties.notify({Property::First});
+    }
+    properties.notify({Property::Second});
+
+    // Nothing goes out before the window has passed
+    EXPECT_TRUE(m_received->isEmpty());
+    EXPECT_EQ(0u, DBusUtils::coalescingStatistics(interface).emitted);
+
+    ASSERT_TRUE(m_received->wait());
+    EXPECT_FALSE(m_received->wait(300));
+
+    ASSERT_EQ(1, m_received->size());
+    EXPECT_EQ(interface, m_received->first().at(0).toString());
+    auto changed = m_received->first().at(1).toMap();
+    EXPECT_EQ(QVariantMap({{"First", 1}, {"Second", 2}}), changed);
+
+    auto statistics = DBusUtils::coalescingStatistics(interface);
+    EXPECT_EQ(1u, statistics.emitted);
+    EXPECT_EQ(10u, statistics.suppressed);
+
+    bool listed = false;
+    for (const auto& entry: DBusUtils::coalescingStatistics())
+    {
+        if (entry.first == interface)
+        {
+            listed = true;
+            EXPECT_EQ(100, entry.second.policy.window);
+            EXPECT_EQ(1u, entry.second.statistics.emitted);
+            EXPECT_EQ(10u, entry.second.statistics.suppressed);
+        }
+    }
+    EXPECT_TRUE(listed);
+}
+
+TEST_F(TestDBusUtils, BypassPropertiesAreSentStraightAway)
+{
+    const QString interface("com.example.Bypass");
+    DBusUtils::CoalescingPolicy policy;
+    // Far longer than we wait for the signal
+    policy.window = 60000;
+    policy.maxLatency = 60000;
+    policy.bypass = DBusUtils::propertyMask({Property::Second});
+    DBusUtils::setCoalescingPolicy(interface, policy);
+
+    DBusUtils::PropertyNotifier<TestObject> properties(
+            m_object, PROPERTIES, dbusTestRunner.sessionConnection(), PATH, interface);
+
+    properties.notify({Property::First});
+    properties.notify({Property::Second});
+
+    ASSERT_TRUE(m_received->wait());
+
+    // The waiting change goes out with the bypassing one
+    ASSERT_EQ(1, m_received->size());
+    EXPECT_EQ(QVariantMap({{"First", 1}, {"Second", 2}}), m_received->first().at(1).toMap());
+}
+
+TEST_F(TestDBusUtils, SteadyStreamStillHonoursMaximumLatency)
+{
+    const QString interface("com.example.Stream");
+    DBusUtils::CoalescingPolicy policy;
+    policy.window = 100;
+    policy.maxLatency = 200;
+    DBusUtils::setCoalescingPolicy(interface, policy);
+
+    DBusUtils::PropertyNotifier<TestObject> properties(
+            m_object, PROPERTIES, dbusTestRunner.sessionConnection(), PATH, interface);
+
+    // A change every 50ms never leaves a quiet 100ms window
+    QTimer stream;
+    stream.setInterval(50);
+    QObject::connect(&stream, &QTimer::timeout, [&properties]()
+    {
+        properties.notify({Property::First});
+    });
+    stream.start();
+
+    // Without the maximum latency nothing would arrive while the stream
+    // keeps going
+    ASSERT_TRUE(m_received->wait());
+    EXPECT_TRUE(stream.isActive());
+
+    stream.stop();
+}
+
+TEST_F(TestDBusUtils, FlushSendsEverythingNow)
+{
+    const QString interface("com.example.Flush");
+    DBusUtils::CoalescingPolicy policy;
+    // Far longer than we wait for the signal
+    policy.window = 60000;
+    policy.maxLatency = 60000;
+    DBusUtils::setCoalescingPolicy(interface, policy);
+
+    DBusUtils::PropertyNotifier<TestObject> properties(
+            m_object, PROPERTIES, dbusTestRunner.sessionConnection(), PATH, interface);
+
+    properties.notify({Property::First});
+    DBusUtils::flushPropertyChanges();
+    EXPECT_EQ(1u, DBusUtils::coalescingStatistics(interface).emitted);
+
+    ASSERT_TRUE(m_received->wait());
+    ASSERT_EQ(1, m_received->size());
+}
+
+TEST_F(TestDBusUtils, CallsAreBucketedByLatency)
+{
+    DBusUtils::resetCallStatistics();
+
+    DBusUtils::recordCall("com.example.Calls.Method", DBusUtils::CallKind::sync, 500);
+    DBusUtils::recordCall("com.example.Calls.Method", DBusUtils::CallKind::sync, 3000);
+    DBusUtils::recordCall("com.example.Calls.Method", DBusUtils::CallKind::sync, 3999);
+    DBusUtils::recordCall("com.example.Calls.Method", DBusUtils::CallKind::async, 60000000000);
+
+    auto statistics = DBusUtils::callStatistics();
+    ASSERT_EQ(2, statistics.size());
+
+    for (const auto& entry: statistics)
+    {
+        EXPECT_EQ("com.example.Calls", entry.first.interface);
+        EXPECT_EQ("Method", entry.first.member);
+
+        const auto& call = entry.second;
+        if (entry.first.kind == DBusUtils::CallKind::sync)
+        {
+            EXPECT_EQ(3u, call.calls);
+            EXPECT_EQ(6u, call.totalMicroseconds);
+            EXPECT_EQ(3u, call.maxMicroseconds);
+            // Under 1us, then two under 4us
+            EXPECT_EQ(1u, call.buckets[0]);
+            EXPECT_EQ(2u, call.buckets[2]);
+        }
+        else
+        {
+            EXPECT_EQ(1u, call.calls);
+            EXPECT_EQ(1u, call.buckets[DBusUtils::CallStatistics::BUCKETS - 1]);
+        }
+    }
+
+    DBusUtils::resetCallStatistics();
+    EXPECT_TRUE(DBusUtils::callStatistics().isEmpty());
+}
+
+}
+
+#include "test-dbus-utils.moc"
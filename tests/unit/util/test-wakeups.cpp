@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <util/wakeups.h>
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace testing;
+
+namespace
+{
+
+class TestWakeups: public Test
+{
+protected:
+    void SetUp() override
+    {
+        // Time only moves when the test says so
+        util::wakeups::install(QCoreApplication::instance(), [this]()
+        {
+            return m_now;
+        });
+    }
+
+    void TearDown() override
+    {
+        util::wakeups::uninstall();
+    }
+
+    void advanceSeconds(int seconds)
+    {
+        m_now += qint64(seconds) * 1000000000;
+    }
+
+    qint64 m_now = qint64(1000) * 1000000000;
+};
+
+TEST_F(TestWakeups, TimerWakeupsAreCountedByName)
+{
+    const int TICKS = 20;
+
+    QEventLoop loop;
+    QTimer timer;
+    timer.setObjectName("test ticker");
+    timer.setInterval(1);
+
+    int ticks = 0;
+    QObject::connect(&timer, &QTimer::timeout, [&ticks, &loop]()
+    {
+        if (++ticks == TICKS)
+        {
+            loop.quit();
+        }
+    });
+    timer.start();
+    loop.exec();
+    timer.stop();
+
+    // Only whole seconds are counted
+    EXPECT_DOUBLE_EQ(0.0, util::wakeups::total().lastTenSeconds);
+    advanceSeconds(1);
+
+    auto rates = util::wakeups::rates();
+    ASSERT_FALSE(rates.isEmpty());
+
+    // The loop blocks between ticks, apart from the last one or two, which
+    // start and stop the count
+    EXPECT_EQ("timer test ticker", rates.first().source);
+    EXPECT_GE(rates.first().lastTenSeconds, (TICKS - 2) / 10.0);
+    EXPECT_LE(rates.first().lastTenSeconds, TICKS / 10.0);
+    EXPECT_DOUBLE_EQ(rates.first().lastTenSeconds * 10.0,
+                     rates.first().lastMinute * 60.0);
+
+    EXPECT_GE(util::wakeups::total().lastTenSeconds,
+              rates.first().lastTenSeconds);
+
+    // Idle for a whole minute, the source is forgotten
+    advanceSeconds(61);
+    EXPECT_TRUE(util::wakeups::rates().isEmpty());
+}
+
+}